@@ -20,49 +20,163 @@ LOG_MODULE_REGISTER(fw_update);
 
 static struct flash_img_context flash_context;
 
-static void ota_fw_receive(const void *data, size_t offset, size_t len, bool is_last)
+/* Firmware data is collected in two buffers. While one is written to flash
+ * on the writer work queue, the other one keeps receiving data.
+ */
+struct fw_write_buf
 {
-    LOG_DBG("Received %d bytes at offset %d", len, offset);
+    struct k_work work;
+    size_t len;
+    bool flush;
+    uint8_t data[CONFIG_EXAMPLE_FW_UPDATE_WRITE_BUF_SIZE];
+};
+
+static struct fw_write_buf write_bufs[2];
+static struct fw_write_buf *fill_buf;
+static size_t next_buf;
+static K_SEM_DEFINE(free_bufs, 2, 2);
+static int write_err;
+
+static struct k_work_q writer_work_q;
+static K_THREAD_STACK_DEFINE(writer_stack, CONFIG_EXAMPLE_FW_UPDATE_WRITER_STACK_SIZE);
+
+static void request_upgrade(void)
+{
+    int err = boot_request_upgrade(BOOT_UPGRADE_PERMANENT);
+    if (err)
+    {
+        LOG_ERR("Failed to request upgrade");
+        return;
+    }
 
-    int err = 0;
+    LOG_INF("Rebooting to apply upgrade");
 
-    if (0 == offset)
+#if IS_ENABLED(CONFIG_LOG)
+    while (log_process())
     {
-        err = flash_img_init(&flash_context);
-        if (err)
+    }
+#endif
+
+    k_sleep(K_SECONDS(3));
+
+    sys_reboot(SYS_REBOOT_WARM);
+}
+
+static void write_buf_process(struct k_work *work)
+{
+    struct fw_write_buf *buf = CONTAINER_OF(work, struct fw_write_buf, work);
+
+    if (0 == write_err)
+    {
+        write_err = flash_img_buffered_write(&flash_context, buf->data, buf->len, buf->flush);
+        if (write_err)
         {
-            LOG_ERR("Failed to init flash write");
-            return;
+            LOG_ERR("Failed to write to flash: %d", write_err);
+        }
+        else if (buf->flush)
+        {
+            request_upgrade();
         }
     }
 
-    err = flash_img_buffered_write(&flash_context, data, len, is_last);
-    if (err)
+    k_sem_give(&free_bufs);
+}
+
+/* Buffers are written in order, so they become free in the order they were filled */
+static struct fw_write_buf *write_buf_get(void)
+{
+    if (NULL == fill_buf)
     {
-        LOG_ERR("Failed to write to flash: %d", err);
-        return;
+        k_sem_take(&free_bufs, K_FOREVER);
+
+        fill_buf = &write_bufs[next_buf];
+        next_buf = (next_buf + 1) % ARRAY_SIZE(write_bufs);
+
+        fill_buf->len = 0;
+        fill_buf->flush = false;
     }
 
-    if (is_last)
+    return fill_buf;
+}
+
+static void write_buf_submit(bool flush)
+{
+    struct fw_write_buf *buf = write_buf_get();
+
+    buf->flush = flush;
+    fill_buf = NULL;
+
+    k_work_submit_to_queue(&writer_work_q, &buf->work);
+}
+
+static int fw_write_start(void)
+{
+    static bool started;
+
+    if (!started)
+    {
+        k_work_queue_start(&writer_work_q,
+                           writer_stack,
+                           K_THREAD_STACK_SIZEOF(writer_stack),
+                           K_LOWEST_APPLICATION_THREAD_PRIO,
+                           NULL);
+
+        for (size_t i = 0; i < ARRAY_SIZE(write_bufs); i++)
+        {
+            k_work_init(&write_bufs[i].work, write_buf_process);
+        }
+
+        started = true;
+    }
+
+    /* Let writes of an abandoned download finish before starting over */
+    k_work_queue_drain(&writer_work_q, false);
+
+    if (NULL != fill_buf)
     {
-        err = boot_request_upgrade(BOOT_UPGRADE_PERMANENT);
+        fill_buf->len = 0;
+    }
+
+    write_err = flash_img_init(&flash_context);
+    return write_err;
+}
+
+static void ota_fw_receive(const void *data, size_t offset, size_t len, bool is_last)
+{
+    LOG_DBG("Received %d bytes at offset %d", len, offset);
+
+    if (0 == offset)
+    {
+        int err = fw_write_start();
         if (err)
         {
-            LOG_ERR("Failed to request upgrade");
+            LOG_ERR("Failed to init flash write");
             return;
         }
+    }
 
-        LOG_INF("Rebooting to apply upgrade");
+    const uint8_t *bytes = data;
 
-#if IS_ENABLED(CONFIG_LOG)
-        while (log_process())
+    while (len > 0)
+    {
+        struct fw_write_buf *buf = write_buf_get();
+        size_t copy = MIN(len, sizeof(buf->data) - buf->len);
+
+        memcpy(&buf->data[buf->len], bytes, copy);
+        buf->len += copy;
+        bytes += copy;
+        len -= copy;
+
+        if (buf->len == sizeof(buf->data))
         {
+            write_buf_submit(false);
         }
-#endif
-
-        k_sleep(K_SECONDS(3));
+    }
 
-        sys_reboot(SYS_REBOOT_WARM);
+    if (is_last)
+    {
+        /* The SDK only sets is_last once the image hash is verified */
+        write_buf_submit(true);
     }
 }
 
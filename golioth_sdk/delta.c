@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <pouch/port.h>
+POUCH_LOG_REGISTER(ota_delta, CONFIG_GOLIOTH_LOG_LEVEL);
+
+#include <errno.h>
+#include <string.h>
+
+#include "delta.h"
+
+static size_t header_len(uint8_t op)
+{
+    return (DELTA_OP_INSERT == op) ? 5 : DELTA_HEADER_MAX_LEN;
+}
+
+static uint32_t get_le32(const uint8_t *buf)
+{
+    return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32_t) buf[3] << 24);
+}
+
+/** Copy or patch source data, in chunks that fit the scratch buffer */
+static int apply_source(struct delta_patch *patch, const uint8_t *diff, size_t len)
+{
+    while (len > 0)
+    {
+        size_t chunk = MIN(len, sizeof(patch->buf));
+
+        int err = patch->read(patch->src_offset, patch->buf, chunk, patch->user_data);
+        if (err)
+        {
+            POUCH_LOG_ERR("Failed to read source at %u: %d",
+                          (unsigned int) patch->src_offset,
+                          err);
+            return err;
+        }
+
+        if (NULL != diff)
+        {
+            for (size_t i = 0; i < chunk; i++)
+            {
+                patch->buf[i] += diff[i];
+            }
+            diff += chunk;
+        }
+
+        err = patch->write(patch->buf, chunk, patch->user_data);
+        if (err)
+        {
+            return err;
+        }
+
+        patch->src_offset += chunk;
+        patch->remaining -= chunk;
+        len -= chunk;
+    }
+
+    return 0;
+}
+
+void delta_patch_init(struct delta_patch *patch,
+                      delta_read_cb read,
+                      delta_write_cb write,
+                      void *user_data)
+{
+    memset(patch, 0, sizeof(*patch));
+    patch->read = read;
+    patch->write = write;
+    patch->user_data = user_data;
+}
+
+int delta_patch_feed(struct delta_patch *patch, const void *data, size_t len, bool is_last)
+{
+    const uint8_t *p = data;
+    int err;
+
+    while (len > 0)
+    {
+        if (0 == patch->remaining)
+        {
+            /* Collect the next record header */
+            patch->header[patch->header_len++] = *p++;
+            len--;
+
+            if (patch->header[0] > DELTA_OP_DIFF)
+            {
+                POUCH_LOG_ERR("Unknown delta op %u", patch->header[0]);
+                return -EBADMSG;
+            }
+
+            if (patch->header_len < header_len(patch->header[0]))
+            {
+                continue;
+            }
+
+            patch->op = patch->header[0];
+            patch->remaining = get_le32(&patch->header[1]);
+            if (DELTA_OP_INSERT != patch->op)
+            {
+                patch->src_offset = get_le32(&patch->header[5]);
+            }
+            patch->header_len = 0;
+
+            if (DELTA_OP_COPY == patch->op)
+            {
+                /* Copies don't carry any data in the artifact */
+                err = apply_source(patch, NULL, patch->remaining);
+                if (err)
+                {
+                    return err;
+                }
+            }
+
+            continue;
+        }
+
+        size_t chunk = MIN(len, patch->remaining);
+
+        if (DELTA_OP_INSERT == patch->op)
+        {
+            err = patch->write(p, chunk, patch->user_data);
+            patch->remaining -= chunk;
+        }
+        else
+        {
+            err = apply_source(patch, p, chunk);
+        }
+
+        if (err)
+        {
+            return err;
+        }
+
+        p += chunk;
+        len -= chunk;
+    }
+
+    if (is_last && (0 != patch->header_len || 0 != patch->remaining))
+    {
+        POUCH_LOG_ERR("Delta artifact ended in the middle of a record");
+        return -EBADMSG;
+    }
+
+    return 0;
+}
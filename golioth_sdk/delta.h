@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * A delta artifact is a sequence of records that build the new image from
+ * the running one. Each record starts with a header:
+ *
+ *   | op (1 byte) | len (4 bytes, LE) | source offset (4 bytes, LE) |
+ *
+ * The source offset is only present for COPY and DIFF records.
+ *
+ *   COPY:   Copy len bytes from the running image at the source offset.
+ *   INSERT: Append the len bytes that follow the header.
+ *   DIFF:   Add the len bytes that follow the header, byte by byte and
+ *           modulo 256, to the running image at the source offset.
+ */
+enum delta_op
+{
+    DELTA_OP_COPY = 0,
+    DELTA_OP_INSERT = 1,
+    DELTA_OP_DIFF = 2,
+};
+
+#define DELTA_HEADER_MAX_LEN 9
+
+/**
+ * Read from the running image.
+ *
+ * @retval  0  On success
+ * @retval <0  POSIX error code
+ */
+typedef int (*delta_read_cb)(size_t offset, void *buf, size_t len, void *user_data);
+
+/**
+ * Write the next part of the new image.
+ *
+ * @retval  0  On success
+ * @retval <0  POSIX error code
+ */
+typedef int (*delta_write_cb)(const void *data, size_t len, void *user_data);
+
+/** Streaming delta patch, decoded as the artifact arrives */
+struct delta_patch
+{
+    delta_read_cb read;
+    delta_write_cb write;
+    void *user_data;
+    uint8_t header[DELTA_HEADER_MAX_LEN];
+    size_t header_len;
+    /** Op of the current record, valid once its header is complete */
+    uint8_t op;
+    /** Bytes of the current record that are yet to be applied */
+    uint32_t remaining;
+    uint32_t src_offset;
+    uint8_t buf[CONFIG_GOLIOTH_OTA_DELTA_BUF_SIZE];
+};
+
+void delta_patch_init(struct delta_patch *patch,
+                      delta_read_cb read,
+                      delta_write_cb write,
+                      void *user_data);
+
+/**
+ * Apply the next chunk of a delta artifact.
+ *
+ * @retval  0       On success
+ * @retval -EBADMSG Malformed artifact, or it ended in the middle of a record
+ * @retval <0       Error returned from the read or write callback
+ */
+int delta_patch_feed(struct delta_patch *patch, const void *data, size_t len, bool is_last);
@@ -8,87 +8,232 @@
 #include <pouch/events.h>
 #include <pouch/port.h>
 #include <pouch/uplink.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "dispatch.h"
 
 POUCH_LOG_REGISTER(glth_dispatch, CONFIG_GOLIOTH_LOG_LEVEL);
 
-static struct golioth_downlink_service *last_seen = NULL;
+/* Stream IDs are 5 bits in the block header */
+#define DOWNLINK_STREAM_ID_COUNT 32
 
-static void pouch_downlink_start(unsigned int stream_id, const char *path, uint16_t content_type)
+struct route
 {
-    POUCH_LOG_DBG("Downlink start: %d, %s, %d", stream_id, path, content_type);
-    POUCH_LOG_INF("Receiving Downlink entry on path %s", path);
+    struct golioth_downlink_service *service;
+    /** Length of the path prefix, without the '*' wildcard */
+    size_t prefix_len;
+    bool partial;
+    /** Index of the longest route that is a prefix of this route, or -1 */
+    int parent;
+};
 
-    POUCH_STRUCT_SECTION_FOREACH(golioth_downlink_service, service)
+/** Routes sorted by path prefix, one for each registered service */
+static struct route *routes;
+static size_t route_count;
+
+/** Context of each active stream */
+static struct
+{
+    struct golioth_downlink_service *service;
+    void *ctx;
+} streams[DOWNLINK_STREAM_ID_COUNT];
+
+static int path_cmp(const char *a, size_t a_len, const char *b, size_t b_len)
+{
+    int cmp = memcmp(a, b, MIN(a_len, b_len));
+    if (cmp != 0)
     {
-        size_t path_len = strlen(service->path);
-        bool partial = service->path[path_len - 1] == '*';
-        if (partial)
+        return cmp;
+    }
+
+    return (a_len > b_len) - (a_len < b_len);
+}
+
+static bool route_is_prefix(const struct route *route, const char *path, size_t path_len)
+{
+    return path_len >= route->prefix_len
+        && 0 == memcmp(route->service->path, path, route->prefix_len);
+}
+
+/** Find the route with the longest prefix of @p path */
+static const struct route *route_find(const char *path, size_t path_len)
+{
+    /* Find the last route that sorts before or at the path */
+    size_t lo = 0;
+    size_t hi = route_count;
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (path_cmp(routes[mid].service->path, routes[mid].prefix_len, path, path_len) <= 0)
         {
-            path_len--;
+            lo = mid + 1;
         }
-        if (0 == strncmp(service->path, path, path_len))
+        else
         {
-            POUCH_LOG_DBG("Found match for path %s", path);
-            last_seen = service;
-            service->data->downlink_id = stream_id;
-            if (NULL != service->start_cb)
-            {
-                const char *path_remainder = NULL;
-                if (partial && (strlen(path + path_len) > 0))
-                {
-                    path_remainder = path + path_len;
-                }
-                service->start_cb(stream_id, path_remainder);
-            }
-            break;
+            hi = mid;
         }
     }
 
-    if (NULL == last_seen)
+    /* Every route that is a prefix of the path sorts between the prefix and
+     * the path itself, so it's a prefix of that last route as well. Walk up
+     * its prefixes until one matches.
+     */
+    for (int i = (int) lo - 1; i >= 0; i = routes[i].parent)
     {
-        POUCH_LOG_DBG("No handler registered for path %s", path);
+        if (route_is_prefix(&routes[i], path, path_len))
+        {
+            return &routes[i];
+        }
     }
+
+    return NULL;
 }
 
-static void pouch_downlink_data(unsigned int stream_id, const void *data, size_t len, bool is_last)
+void golioth_downlink_ctx_set(golioth_downlink_id_t id, void *ctx)
 {
-    POUCH_LOG_DBG("Downlink data: %d", stream_id);
+    if (id < 0 || id >= DOWNLINK_STREAM_ID_COUNT)
+    {
+        return;
+    }
+
+    streams[id].ctx = ctx;
+}
+
+void *golioth_downlink_ctx_get(golioth_downlink_id_t id)
+{
+    if (id < 0 || id >= DOWNLINK_STREAM_ID_COUNT)
+    {
+        return NULL;
+    }
+
+    return streams[id].ctx;
+}
 
-    struct golioth_downlink_service *active_service = NULL;
+static void dispatch_init(void)
+{
+    size_t service_count = 0;
+    POUCH_STRUCT_SECTION_COUNT(golioth_downlink_service, &service_count);
+
+    route_count = 0;
 
-    if (NULL != last_seen && last_seen->data->downlink_id == stream_id)
+    /* The services are only known at link time, allocate their routes once at startup */
+    routes = malloc(service_count * sizeof(routes[0]));
+    if (NULL == routes && service_count > 0)
     {
-        active_service = last_seen;
+        POUCH_LOG_ERR("Failed to allocate %u downlink routes", (unsigned int) service_count);
+        return;
     }
-    else
+
+    POUCH_STRUCT_SECTION_FOREACH(golioth_downlink_service, service)
     {
-        POUCH_STRUCT_SECTION_FOREACH(golioth_downlink_service, service)
+        struct route route = {
+            .service = service,
+            .prefix_len = strlen(service->path),
+        };
+
+        route.partial = service->path[route.prefix_len - 1] == '*';
+        if (route.partial)
         {
-            if (service->data->downlink_id == stream_id)
-            {
-                active_service = service;
-                break;
-            }
+            route.prefix_len--;
         }
+
+        /* Insertion sort, there are only a handful of services */
+        size_t i = route_count++;
+        while (i > 0
+               && path_cmp(routes[i - 1].service->path,
+                           routes[i - 1].prefix_len,
+                           service->path,
+                           route.prefix_len)
+                      > 0)
+        {
+            routes[i] = routes[i - 1];
+            i--;
+        }
+        routes[i] = route;
     }
 
-    if (NULL != active_service)
+    for (size_t i = 0; i < route_count; i++)
     {
-        active_service->data_cb(stream_id, data, len, is_last);
-        if (is_last)
+        int parent = (int) i - 1;
+        while (parent >= 0
+               && !route_is_prefix(&routes[parent],
+                                   routes[i].service->path,
+                                   routes[i].prefix_len))
         {
-            POUCH_LOG_INF("Finished entry for %s", active_service->path);
+            parent = routes[parent].parent;
+        }
 
-            active_service->data->downlink_id = DOWNLINK_ID_INVALID;
-            last_seen = NULL;
+        routes[i].parent = parent;
+    }
+}
+POUCH_APPLICATION_STARTUP_HOOK(dispatch_init);
+
+static void pouch_downlink_start(unsigned int stream_id,
+                                 const char *path,
+                                 size_t path_len,
+                                 uint16_t content_type)
+{
+    POUCH_LOG_DBG("Downlink start: %d, %.*s, %d", stream_id, (int) path_len, path, content_type);
+    POUCH_LOG_INF("Receiving Downlink entry on path %.*s", (int) path_len, path);
+
+    stream_id %= DOWNLINK_STREAM_ID_COUNT;
+
+    if (NULL != streams[stream_id].service)
+    {
+        POUCH_LOG_WRN("Stream %u for %s was interrupted",
+                      stream_id,
+                      streams[stream_id].service->path);
+    }
+
+    streams[stream_id].service = NULL;
+    streams[stream_id].ctx = NULL;
+
+    const struct route *route = route_find(path, path_len);
+    if (NULL == route)
+    {
+        POUCH_LOG_DBG("No handler registered for path %.*s", (int) path_len, path);
+        return;
+    }
+
+    POUCH_LOG_DBG("Found match for path %.*s", (int) path_len, path);
+
+    struct golioth_downlink_service *service = route->service;
+    streams[stream_id].service = service;
+
+    if (NULL != service->start_cb)
+    {
+        const char *path_remainder = NULL;
+        size_t path_remainder_len = 0;
+        if (route->partial && path_len > route->prefix_len)
+        {
+            path_remainder = path + route->prefix_len;
+            path_remainder_len = path_len - route->prefix_len;
         }
+        service->start_cb(stream_id, path_remainder, path_remainder_len);
     }
-    else
+}
+
+static void pouch_downlink_data(unsigned int stream_id, const void *data, size_t len, bool is_last)
+{
+    POUCH_LOG_DBG("Downlink data: %d", stream_id);
+
+    stream_id %= DOWNLINK_STREAM_ID_COUNT;
+
+    struct golioth_downlink_service *service = streams[stream_id].service;
+    if (NULL == service)
     {
         POUCH_LOG_DBG("Dropping message for stream_id %d", stream_id);
+        return;
+    }
+
+    service->data_cb(stream_id, data, len, is_last);
+    if (is_last)
+    {
+        POUCH_LOG_INF("Finished entry for %s", service->path);
+
+        streams[stream_id].service = NULL;
+        streams[stream_id].ctx = NULL;
     }
 }
 
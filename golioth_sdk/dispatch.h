@@ -13,7 +13,8 @@
 typedef int golioth_downlink_id_t;
 
 typedef void (*golioth_service_downlink_start_cb)(golioth_downlink_id_t id,
-                                                  const char *path_remainder);
+                                                  const char *path_remainder,
+                                                  size_t path_remainder_len);
 typedef void (*golioth_service_downlink_data_cb)(golioth_downlink_id_t id,
                                                  const void *data,
                                                  size_t len,
@@ -22,29 +23,41 @@ typedef void (*golioth_service_uplink_cb)(void);
 
 #define DOWNLINK_ID_INVALID (-1)
 
-struct golioth_downlink_service_data
-{
-    golioth_downlink_id_t downlink_id;
-};
-
 struct golioth_downlink_service
 {
     const char *path;
     golioth_service_downlink_start_cb start_cb;
     golioth_service_downlink_data_cb data_cb;
-    struct golioth_downlink_service_data *data;
 };
 
 #define GOLIOTH_DOWNLINK_HANDLER(_name, _path, _start_cb, _data_cb)             \
     POUCH_STATIC_ASSERT((_path != NULL) && (_data_cb != NULL),                  \
                         "_path, and _data_cb must not be NULL");                \
-    static struct golioth_downlink_service_data _name##_data = {                \
-        .downlink_id = DOWNLINK_ID_INVALID,                                     \
-    };                                                                          \
     static POUCH_STRUCT_SECTION_ITERABLE(golioth_downlink_service,              \
                                          _golioth_downlink_service_##_name) = { \
         .path = _path,                                                          \
         .start_cb = _start_cb,                                                  \
         .data_cb = _data_cb,                                                    \
-        .data = &_name##_data,                                                  \
     }
+
+/**
+ * Attach a service context to a downlink stream.
+ *
+ * Downlink streams may be interleaved, so services that keep state across the
+ * blocks of a stream should attach it to the stream in their start callback.
+ * The context is detached when the stream ends, or when its ID is reused by
+ * a new stream.
+ *
+ * @param id Downlink stream ID passed to the start callback.
+ * @param ctx Service context.
+ */
+void golioth_downlink_ctx_set(golioth_downlink_id_t id, void *ctx);
+
+/**
+ * Get the service context attached to a downlink stream.
+ *
+ * @param id Downlink stream ID.
+ *
+ * @return The context attached with @ref golioth_downlink_ctx_set, or NULL.
+ */
+void *golioth_downlink_ctx_get(golioth_downlink_id_t id);
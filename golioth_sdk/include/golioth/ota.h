@@ -53,6 +53,15 @@ struct golioth_ota_manifest_handler
 /**
  * Callback for receiving data for a registered OTA component.
  *
+ * Blocks are always delivered in order. If a download is interrupted, a
+ * later sync may resume it, in which case the first block of the resumed
+ * download continues at the offset where the interrupted one stopped.
+ *
+ * With CONFIG_GOLIOTH_OTA_VERIFY, the SHA-256 of the component is checked
+ * against the manifest before the last block is delivered, so \ref is_last
+ * is only set for a verified component. If verification fails, the last
+ * block is dropped and the component is marked idle.
+ *
  * @param data Pointer to a block of the component.
  * @param offset Offset of \ref data within the component.
  * @param len Length of \ref data.
@@ -63,12 +72,31 @@ typedef void (*golioth_ota_component_receive)(const void *data,
                                               size_t len,
                                               bool is_last);
 
+/**
+ * Callback for reading the running version of a registered OTA component.
+ *
+ * Delta updates are applied against the running version, which is read
+ * through this callback while the new version is passed to the receive
+ * callback.
+ *
+ * @param offset Offset within the running version of the component.
+ * @param buf Buffer to read into.
+ * @param len Number of bytes to read.
+ *
+ * @return 0 on success or a negative error code on failure.
+ */
+typedef int (*golioth_ota_component_read)(size_t offset, void *buf, size_t len);
+
 struct golioth_ota_registered_component_data
 {
     char target[CONFIG_GOLIOTH_OTA_MAX_VERSION_LEN];
     uint8_t target_hash[GOLIOTH_OTA_COMPONENT_HASH_BIN_LEN];
     size_t size;
     uint8_t state;
+    /** The target is a delta against the running version */
+    bool delta;
+    /** The manifest offered a delta that can't be applied to the running version */
+    bool rejected;
 };
 
 struct golioth_ota_registered_component
@@ -76,6 +104,7 @@ struct golioth_ota_registered_component
     const char *name;
     const char *version;
     golioth_ota_component_receive receive;
+    golioth_ota_component_read read;
     struct golioth_ota_registered_component_data *data;
 };
 
@@ -103,11 +132,44 @@ struct golioth_ota_registered_component
         .data = &ota_component_data_##_name,                                    \
     }
 
+/**
+ * Register an OTA component that can be updated with delta artifacts.
+ *
+ * Same as @ref GOLIOTH_OTA_COMPONENT, but the manifest may offer a delta
+ * against the running version of the component instead of the full image.
+ * The delta is applied as it's received, so the receive callback still gets
+ * the full new image, in order. For deltas, the last call to the receive
+ * callback may have a length of 0.
+ *
+ * Requires CONFIG_GOLIOTH_OTA_DELTA.
+ *
+ * @param _name The name of the C structure holding this information.
+ * @param _package The name of the package on Golioth.
+ * @param _version The current version of the component.
+ * @param _receive A callback for accepting blocks of data for the component.
+ * @param _read A callback for reading the running version of the component.
+ */
+#define GOLIOTH_OTA_DELTA_COMPONENT(_name, _package, _version, _receive, _read) \
+    struct golioth_ota_registered_component_data ota_component_data_##_name = { \
+        .target = _version,                                                     \
+        .state = 0,                                                             \
+    };                                                                          \
+    const POUCH_STRUCT_SECTION_ITERABLE(golioth_ota_registered_component,       \
+                                        ota_component_##_name) = {              \
+        .name = _package,                                                       \
+        .version = _version,                                                    \
+        .receive = _receive,                                                    \
+        .read = _read,                                                          \
+        .data = &ota_component_data_##_name,                                    \
+    }
+
 /* Component state API */
 
 /** Mark a component for download.
  *
  * Components marked for download will be received in the next Downlink.
+ * Components with a delta target that can't be applied to the running version
+ * can't be downloaded.
  *
  * @param name The name of the component to mark.
  */
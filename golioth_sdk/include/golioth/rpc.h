@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <pouch/port.h>
+#include <zcbor_common.h>
+
+/** RPC status codes, following the gRPC status codes */
+enum golioth_rpc_status
+{
+    GOLIOTH_RPC_OK = 0,
+    GOLIOTH_RPC_CANCELED = 1,
+    GOLIOTH_RPC_UNKNOWN = 2,
+    GOLIOTH_RPC_INVALID_ARGUMENT = 3,
+    GOLIOTH_RPC_DEADLINE_EXCEEDED = 4,
+    GOLIOTH_RPC_NOT_FOUND = 5,
+    GOLIOTH_RPC_ALREADY_EXISTS = 6,
+    GOLIOTH_RPC_PERMISSION_DENIED = 7,
+    GOLIOTH_RPC_RESOURCE_EXHAUSTED = 8,
+    GOLIOTH_RPC_FAILED_PRECONDITION = 9,
+    GOLIOTH_RPC_ABORTED = 10,
+    GOLIOTH_RPC_OUT_OF_RANGE = 11,
+    GOLIOTH_RPC_UNIMPLEMENTED = 12,
+    GOLIOTH_RPC_INTERNAL = 13,
+    GOLIOTH_RPC_UNAVAILABLE = 14,
+    GOLIOTH_RPC_DATA_LOSS = 15,
+    GOLIOTH_RPC_UNAUTHENTICATED = 16,
+};
+
+/**
+ * Callback for an RPC method.
+ *
+ * @param request_params_array zcbor decode state inside the list of RPC
+ *                             parameters.
+ * @param response_detail_map zcbor encode state inside the map of response
+ *                            details. Key/value pairs added here are
+ *                            returned to the caller.
+ * @param callback_arg The argument registered with the callback.
+ *
+ * @return Status of the RPC, returned to the caller.
+ */
+typedef enum golioth_rpc_status (*golioth_rpc_cb)(zcbor_state_t *request_params_array,
+                                                  zcbor_state_t *response_detail_map,
+                                                  void *callback_arg);
+
+struct golioth_rpc_handler
+{
+    const char *method;
+    golioth_rpc_cb callback;
+    void *callback_arg;
+};
+
+/**
+ * Register an RPC method.
+ *
+ * The reply to an RPC is written to the uplink as soon as the callback
+ * returns. If the uplink of the same session is still open, the reply is
+ * delivered in the same sync as the request.
+ *
+ * @param _method The name of the RPC method.
+ * @param _callback The callback to execute for the method.
+ * @param _callback_arg Argument passed to the callback.
+ */
+#define GOLIOTH_RPC_HANDLER(_method, _callback, _callback_arg)                                   \
+    static const POUCH_STRUCT_SECTION_ITERABLE(golioth_rpc_handler, rpc_handler_##_callback) = { \
+        .method = _method,                                                                       \
+        .callback = _callback,                                                                   \
+        .callback_arg = _callback_arg,                                                           \
+    }
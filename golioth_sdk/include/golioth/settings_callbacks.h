@@ -62,3 +62,31 @@ struct golioth_settings_handler
             golioth_string_setting_cb: GOLIOTH_SETTING_VALUE_TYPE_STRING),                        \
         .generic = _function,                                                                     \
     }
+
+/**
+ * Callback function type for GOLIOTH_SETTINGS_COMMIT_HANDLER()
+ *
+ * Called once after all settings of a settings update have been passed to
+ * their handlers.
+ */
+typedef void (*golioth_settings_commit_cb)(void);
+
+struct golioth_settings_commit_handler
+{
+    golioth_settings_commit_cb commit;
+};
+
+/**
+ * Register a settings commit handler.
+ *
+ * Use this macro to register a callback to be executed after a batch of
+ * settings has been received. Settings handlers can then only stage new
+ * values, and the commit handler applies or persists them all at once.
+ *
+ * @param _function The callback function to execute.
+ */
+#define GOLIOTH_SETTINGS_COMMIT_HANDLER(_function)                            \
+    static const POUCH_STRUCT_SECTION_ITERABLE(golioth_settings_commit_handler, \
+                                               commit_handler_##_function) = {  \
+        .commit = _function,                                                  \
+    }
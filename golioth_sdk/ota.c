@@ -5,6 +5,7 @@
  */
 
 #include <errno.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <pouch/port.h>
@@ -13,13 +14,23 @@ POUCH_LOG_REGISTER(ota, CONFIG_GOLIOTH_LOG_LEVEL);
 #include <pouch/types.h>
 #include <pouch/uplink.h>
 
+#include <golioth/ota.h>
+
 #include "zcbor_utils.h"
 #include <zcbor_decode.h>
 
+#if CONFIG_GOLIOTH_OTA_VERIFY
+#include <psa/crypto.h>
+#endif
+
 #include "dispatch.h"
 #include "ota.h"
 #include "hex.h"
 
+#if CONFIG_GOLIOTH_OTA_DELTA
+#include "delta.h"
+#endif
+
 #define GOLIOTH_OTA_COMPONENT_PATH_PREFIX ".u/c/"
 #define GOLIOTH_OTA_MANIFEST_PATH "/.u/desired"
 
@@ -34,8 +45,9 @@ POUCH_LOG_REGISTER(ota, CONFIG_GOLIOTH_LOG_LEVEL);
    - package name (string)
    - current version (string)
    - target version (string)
+   - resume offset (uint32)
  */
-#define OTA_STATUS_FIXED_SIZE 21
+#define OTA_STATUS_FIXED_SIZE 28
 #define OTA_STATUS_ENCODE_BUF_SIZE                                  \
     (OTA_STATUS_FIXED_SIZE + 2 * CONFIG_GOLIOTH_OTA_MAX_VERSION_LEN \
      + CONFIG_GOLIOTH_OTA_MAX_PACKAGE_NAME_LEN)
@@ -61,18 +73,177 @@ enum
     COMPONENT_KEY_SIZE = 4,
     COMPONENT_KEY_URI = 5,
     COMPONENT_KEY_BOOTLOADER = 6,
+    COMPONENT_KEY_DELTA_FROM = 7,
 };
 
-struct
+struct component_download
 {
     golioth_downlink_id_t downlink_id;
     size_t offset;
     char name[CONFIG_GOLIOTH_OTA_MAX_PACKAGE_NAME_LEN + 1];
     char version[CONFIG_GOLIOTH_OTA_MAX_VERSION_LEN + 1];
-} component_download = {
-    .downlink_id = DOWNLINK_ID_INVALID,
+#if CONFIG_GOLIOTH_OTA_VERIFY
+    /** Hash of the data received so far, kept across interruptions */
+    psa_hash_operation_t hash;
+#endif
+#if CONFIG_GOLIOTH_OTA_DELTA
+    /** The artifact is a delta, applied to the running version as it arrives */
+    bool delta;
+    /** Offset in the new image, which differs from the artifact offset for deltas */
+    size_t image_offset;
+    struct delta_patch patch;
+#endif
 };
 
+/** Component downloads, either in progress or interrupted */
+static struct component_download downloads[CONFIG_GOLIOTH_OTA_MAX_CONCURRENT_DOWNLOADS];
+
+static bool download_is_active(const struct component_download *download)
+{
+    return golioth_downlink_ctx_get(download->downlink_id) == download;
+}
+
+static struct component_download *download_find(const char *name)
+{
+    for (size_t i = 0; i < sizeof(downloads) / sizeof(downloads[0]); i++)
+    {
+        if (0 == strcmp(downloads[i].name, name))
+        {
+            return &downloads[i];
+        }
+    }
+
+    return NULL;
+}
+
+/** Get a slot for a new download, preferring slots without an interrupted download */
+static struct component_download *download_alloc(void)
+{
+    struct component_download *inactive = NULL;
+
+    for (size_t i = 0; i < sizeof(downloads) / sizeof(downloads[0]); i++)
+    {
+        if ('\0' == downloads[i].name[0])
+        {
+            return &downloads[i];
+        }
+
+        if (NULL == inactive && !download_is_active(&downloads[i]))
+        {
+            inactive = &downloads[i];
+        }
+    }
+
+    return inactive;
+}
+
+static void download_clear(struct component_download *download)
+{
+#if CONFIG_GOLIOTH_OTA_VERIFY
+    (void) psa_hash_abort(&download->hash);
+#endif
+
+    /* Nothing left to resume */
+    memset(download, 0, sizeof(*download));
+    download->downlink_id = DOWNLINK_ID_INVALID;
+}
+
+#if CONFIG_GOLIOTH_OTA_VERIFY
+static int download_hash_start(struct component_download *download)
+{
+    /* The slot may hold the hash of an abandoned download */
+    (void) psa_hash_abort(&download->hash);
+    download->hash = psa_hash_operation_init();
+
+    psa_status_t status = psa_hash_setup(&download->hash, PSA_ALG_SHA_256);
+    if (PSA_SUCCESS != status)
+    {
+        POUCH_LOG_ERR("Failed to start hash: %d", (int) status);
+        return -EIO;
+    }
+
+    return 0;
+}
+
+/** Add a block to the download hash, and verify the hash on the last block */
+static int download_hash_update(struct component_download *download,
+                                const void *data,
+                                size_t len,
+                                bool is_last)
+{
+    psa_status_t status = psa_hash_update(&download->hash, data, len);
+    if (PSA_SUCCESS != status)
+    {
+        POUCH_LOG_ERR("Failed to hash %s: %d", download->name, (int) status);
+        return -EIO;
+    }
+
+    if (!is_last)
+    {
+        return 0;
+    }
+
+    uint8_t hash[GOLIOTH_OTA_COMPONENT_HASH_BIN_LEN];
+    size_t hash_len;
+
+    status = psa_hash_finish(&download->hash, hash, sizeof(hash), &hash_len);
+    if (PSA_SUCCESS != status)
+    {
+        POUCH_LOG_ERR("Failed to hash %s: %d", download->name, (int) status);
+        return -EIO;
+    }
+
+    return golioth_ota_verify_component(download->name, hash);
+}
+#endif
+
+/** Pass image data on to the component, verifying it first if enabled */
+static int download_deliver(struct component_download *download,
+                            size_t offset,
+                            const void *data,
+                            size_t len,
+                            bool is_last)
+{
+#if CONFIG_GOLIOTH_OTA_VERIFY
+    /* Verify before passing on the last block, so the component never
+     * completes with bad data.
+     */
+    int err = download_hash_update(download, data, len, is_last);
+    if (err)
+    {
+        return err;
+    }
+#endif
+
+    golioth_ota_receive_component(download->name, download->version, offset, data, len, is_last);
+
+    return 0;
+}
+
+#if CONFIG_GOLIOTH_OTA_DELTA
+static int download_source_read(size_t offset, void *buf, size_t len, void *user_data)
+{
+    struct component_download *download = user_data;
+
+    return golioth_ota_read_component(download->name, offset, buf, len);
+}
+
+static int download_image_write(const void *data, size_t len, void *user_data)
+{
+    struct component_download *download = user_data;
+
+    int err = download_deliver(download, download->image_offset, data, len, false);
+    if (err)
+    {
+        return err;
+    }
+
+    download->image_offset += len;
+
+    return 0;
+}
+#endif
+
 static int component_entry_decode_value(zcbor_state_t *zsd, void *void_value)
 {
     struct component_tstr_value *value = void_value;
@@ -97,145 +268,330 @@ static int component_entry_decode_value(zcbor_state_t *zsd, void *void_value)
     return 0;
 }
 
-static void ota_receive_manifest(golioth_downlink_id_t id,
-                                 const void *data,
-                                 size_t len,
-                                 bool is_last)
+static struct
 {
-    ZCBOR_STATE_D(zsd, 3, data, len, 1, 0);
+    struct zcbor_stream stream;
+    golioth_downlink_id_t id;
+    bool has_key;
+    uint32_t key;
+} manifest_parser;
 
-    bool ok = zcbor_map_start_decode(zsd);
-    if (!ok)
+static int manifest_component_decode(const struct zcbor_stream_event *event)
+{
+    ZCBOR_STATE_D(zsd, 2, event->payload, event->len, 1, 0);
+
+    struct golioth_ota_component component = {};
+    struct component_tstr_value package = {
+        component.package,
+        sizeof(component.package) - 1,
+    };
+    struct component_tstr_value version = {
+        component.version,
+        sizeof(component.version) - 1,
+    };
+
+    struct component_tstr_value delta_from = {
+        component.delta_from,
+        sizeof(component.delta_from) - 1,
+    };
+
+    char hash_str[GOLIOTH_OTA_COMPONENT_HASH_HEX_LEN + 1];
+    struct component_tstr_value hash_tstr = {
+        hash_str,
+        sizeof(hash_str) - 1,
+    };
+
+    struct zcbor_map_entry map_entries[] = {
+        ZCBOR_U32_MAP_ENTRY(COMPONENT_KEY_PACKAGE, component_entry_decode_value, &package),
+        ZCBOR_U32_MAP_ENTRY(COMPONENT_KEY_VERSION, component_entry_decode_value, &version),
+        ZCBOR_U32_MAP_ENTRY(COMPONENT_KEY_SIZE, zcbor_map_int32_decode, &component.size),
+        ZCBOR_U32_MAP_ENTRY(COMPONENT_KEY_HASH, component_entry_decode_value, &hash_tstr),
+        ZCBOR_U32_MAP_ENTRY_OPTIONAL(COMPONENT_KEY_DELTA_FROM,
+                                     component_entry_decode_value,
+                                     &delta_from),
+    };
+
+    int err = zcbor_map_decode(zsd, map_entries, sizeof(map_entries) / sizeof(map_entries[0]));
+    if (err)
     {
         POUCH_LOG_ERR("Failed to deserialize manifest");
-        return;
+        return -EBADMSG;
     }
 
-    while (!zcbor_list_or_map_end(zsd))
+    size_t hash_buf_len = hex2bin(hash_str,
+                                  GOLIOTH_OTA_COMPONENT_HASH_HEX_LEN,
+                                  component.hash,
+                                  sizeof(component.hash));
+    if (GOLIOTH_OTA_COMPONENT_HASH_BIN_LEN != hash_buf_len)
     {
-        uint32_t key;
-        ok = zcbor_uint32_decode(zsd, &key);
-        if (!ok)
+        POUCH_LOG_ERR("Failed to deserialize hash");
+        return -EBADMSG;
+    }
+
+    golioth_ota_manifest_receive_one(&component);
+
+    return 0;
+}
+
+static int manifest_key_step(const struct zcbor_stream_event *event)
+{
+    if (ZCBOR_STREAM_END == event->type)
+    {
+        if (MANIFEST_KEY_COMPONENTS == manifest_parser.key)
         {
-            POUCH_LOG_ERR("Failed to deserialize manifest");
-            return;
+            golioth_ota_manifest_complete();
         }
 
-        if (MANIFEST_KEY_COMPONENTS == key)
+        manifest_parser.has_key = false;
+        return 0;
+    }
+
+    if (!manifest_parser.has_key)
+    {
+        ZCBOR_STATE_D(zsd, 1, event->payload, event->len, 1, 0);
+
+        if (ZCBOR_STREAM_ITEM != event->type || !zcbor_uint32_decode(zsd, &manifest_parser.key))
         {
-            ok = zcbor_list_start_decode(zsd);
-            if (!ok)
+            POUCH_LOG_ERR("Failed to deserialize manifest");
+            return -EBADMSG;
+        }
+
+        manifest_parser.has_key = true;
+        return 0;
+    }
+
+    if (MANIFEST_KEY_COMPONENTS == manifest_parser.key && ZCBOR_STREAM_LIST_START != event->type)
+    {
+        POUCH_LOG_ERR("Failed to deserialize manifest");
+        return -EBADMSG;
+    }
+
+    if (ZCBOR_STREAM_ITEM == event->type)
+    {
+        manifest_parser.has_key = false;
+    }
+
+    /* Lists and maps keep the key until their end */
+    return 0;
+}
+
+static int manifest_step(const struct zcbor_stream_event *event, void *user_data)
+{
+    switch (event->depth)
+    {
+        case 0:
+            if (ZCBOR_STREAM_ITEM == event->type || ZCBOR_STREAM_LIST_START == event->type)
             {
                 POUCH_LOG_ERR("Failed to deserialize manifest");
-                return;
+                return -EBADMSG;
             }
-
-            while (!zcbor_list_or_map_end(zsd))
+            return 0;
+        case 1:
+            return manifest_key_step(event);
+        case 2:
+            if (!manifest_parser.has_key || MANIFEST_KEY_COMPONENTS != manifest_parser.key)
             {
-                struct golioth_ota_component component = {};
-                struct component_tstr_value package = {
-                    component.package,
-                    sizeof(component.package) - 1,
-                };
-                struct component_tstr_value version = {
-                    component.version,
-                    sizeof(component.version) - 1,
-                };
-
-                char hash_str[GOLIOTH_OTA_COMPONENT_HASH_HEX_LEN + 1];
-                struct component_tstr_value hash_tstr = {
-                    hash_str,
-                    sizeof(hash_str) - 1,
-                };
-
-                struct zcbor_map_entry map_entries[] = {
-                    ZCBOR_U32_MAP_ENTRY(COMPONENT_KEY_PACKAGE,
-                                        component_entry_decode_value,
-                                        &package),
-                    ZCBOR_U32_MAP_ENTRY(COMPONENT_KEY_VERSION,
-                                        component_entry_decode_value,
-                                        &version),
-                    ZCBOR_U32_MAP_ENTRY(COMPONENT_KEY_SIZE,
-                                        zcbor_map_int32_decode,
-                                        &component.size),
-                    ZCBOR_U32_MAP_ENTRY(COMPONENT_KEY_HASH,
-                                        component_entry_decode_value,
-                                        &hash_tstr),
-                };
-
-                int err = zcbor_map_decode(zsd,
-                                           map_entries,
-                                           sizeof(map_entries) / sizeof(map_entries[0]));
-                if (err)
-                {
-                    POUCH_LOG_ERR("Failed to deserialize manifest");
-                    return;
-                }
-
-                size_t hash_buf_len = hex2bin(hash_str,
-                                              GOLIOTH_OTA_COMPONENT_HASH_HEX_LEN,
-                                              component.hash,
-                                              sizeof(component.hash));
-                if (GOLIOTH_OTA_COMPONENT_HASH_BIN_LEN != hash_buf_len)
-                {
-                    POUCH_LOG_ERR("Failed to deserialize hash");
-                    return;
-                }
-
-                golioth_ota_manifest_receive_one(&component);
+                return 0;
             }
 
-            golioth_ota_manifest_complete();
-
-            ok = zcbor_list_or_map_end(zsd);
-            if (!ok)
+            if (ZCBOR_STREAM_MAP_START == event->type)
             {
-                POUCH_LOG_ERR("Failed to deserialize manifest");
-                return;
+                /* Each component is decoded as a whole */
+                return ZCBOR_STREAM_COLLECT;
             }
-        }
-        else
-        {
-            ok = zcbor_any_skip(zsd, NULL);
-            if (!ok)
+
+            if (ZCBOR_STREAM_ITEM != event->type)
             {
                 POUCH_LOG_ERR("Failed to deserialize manifest");
-                return;
+                return -EBADMSG;
             }
-        }
+
+            return manifest_component_decode(event);
+        default:
+            return 0;
+    }
+}
+
+static void ota_receive_manifest_start(golioth_downlink_id_t id,
+                                       const char *path_remainder,
+                                       size_t path_remainder_len)
+{
+    if (golioth_downlink_ctx_get(manifest_parser.id) == &manifest_parser)
+    {
+        POUCH_LOG_WRN("Manifest downlink was interrupted");
+        golioth_downlink_ctx_set(manifest_parser.id, NULL);
+    }
+
+    memset(&manifest_parser, 0, sizeof(manifest_parser));
+    zcbor_stream_init(&manifest_parser.stream, manifest_step, NULL);
+    manifest_parser.id = id;
+
+    golioth_downlink_ctx_set(id, &manifest_parser);
+}
+
+static void ota_receive_manifest(golioth_downlink_id_t id,
+                                 const void *data,
+                                 size_t len,
+                                 bool is_last)
+{
+    if (golioth_downlink_ctx_get(id) != &manifest_parser)
+    {
+        return;
+    }
+
+    int err = zcbor_stream_feed(&manifest_parser.stream, data, len, is_last);
+    if (err)
+    {
+        POUCH_LOG_ERR("Failed to deserialize manifest: %d", err);
+    }
+
+    if (err || is_last)
+    {
+        golioth_downlink_ctx_set(id, NULL);
     }
 }
 
-static void ota_receive_component_start(golioth_downlink_id_t id, const char *path_remainder)
+#if CONFIG_GOLIOTH_OTA_RESUME
+/* Enough for any offset in a 32 bit address space */
+#define COMPONENT_OFFSET_MAX_DIGITS 10
+
+static int component_offset_parse(const char *str, size_t len, size_t *offset)
 {
-    const char *delimiter = strchr(path_remainder, '@');
-    if (NULL != delimiter)
+    char buf[COMPONENT_OFFSET_MAX_DIGITS + 1];
+
+    /* strtoul() also takes whitespace and signs, so check the first digit here */
+    if (0 == len || len >= sizeof(buf) || str[0] < '0' || str[0] > '9')
+    {
+        return -EINVAL;
+    }
+
+    memcpy(buf, str, len);
+    buf[len] = '\0';
+
+    char *end;
+    errno = 0;
+    unsigned long value = strtoul(buf, &end, 10);
+    if ('\0' != *end || ERANGE == errno)
+    {
+        return -EINVAL;
+    }
+
+    *offset = value;
+    return 0;
+}
+#endif
+
+static void ota_receive_component_start(golioth_downlink_id_t id,
+                                        const char *path_remainder,
+                                        size_t path_remainder_len)
+{
+    struct component_download *download;
+    char name[CONFIG_GOLIOTH_OTA_MAX_PACKAGE_NAME_LEN + 1];
+    char version[CONFIG_GOLIOTH_OTA_MAX_VERSION_LEN + 1];
+    size_t offset = 0;
+
+    const char *delimiter = NULL;
+    if (NULL != path_remainder)
+    {
+        delimiter = memchr(path_remainder, '@', path_remainder_len);
+    }
+    if (NULL == delimiter)
+    {
+        return;
+    }
+
+    size_t name_len = ((intptr_t) delimiter) - ((intptr_t) path_remainder);
+    if (name_len >= sizeof(name))
+    {
+        POUCH_LOG_ERR("Component name too large");
+        return;
+    }
+    memcpy(name, path_remainder, name_len);
+    name[name_len] = '\0';
+
+    const char *version_start = delimiter + 1;
+    size_t version_len = path_remainder_len - name_len - 1;
+
+#if CONFIG_GOLIOTH_OTA_RESUME
+    /* A resumed stream carries the offset of its first byte: "<name>@<version>/<offset>" */
+    const char *offset_delimiter = memchr(version_start, '/', version_len);
+    if (NULL != offset_delimiter)
     {
-        component_download.downlink_id = id;
-        size_t name_len = ((intptr_t) delimiter) - ((intptr_t) path_remainder);
-        if (name_len >= sizeof(component_download.name))
+        const char *offset_str = offset_delimiter + 1;
+        size_t offset_len = version_len - (offset_str - version_start);
+
+        version_len = ((intptr_t) offset_delimiter) - ((intptr_t) version_start);
+        if (0 != component_offset_parse(offset_str, offset_len, &offset))
         {
-            POUCH_LOG_ERR("Component name too large");
-            component_download.downlink_id = DOWNLINK_ID_INVALID;
+            POUCH_LOG_ERR("Invalid component offset");
             return;
         }
-        memcpy(component_download.name, path_remainder, name_len);
-        component_download.name[name_len] = '\0';
-        size_t version_len = strlen(delimiter + 1);
-        if (version_len >= sizeof(component_download.version))
+    }
+#endif
+
+    if (version_len >= sizeof(version))
+    {
+        POUCH_LOG_ERR("Component version too large");
+        return;
+    }
+    memcpy(version, version_start, version_len);
+    version[version_len] = '\0';
+
+    download = download_find(name);
+    if (NULL != download && download_is_active(download))
+    {
+        POUCH_LOG_ERR("%s is already being downloaded", name);
+        return;
+    }
+
+    if (0 != offset)
+    {
+        /* Data is only ever delivered contiguously, so the stream must pick
+         * up exactly where the interrupted download of the same artifact
+         * stopped.
+         */
+        if (NULL == download || 0 != strcmp(version, download->version)
+            || offset != download->offset)
         {
-            POUCH_LOG_ERR("Component version too large");
-            component_download.downlink_id = DOWNLINK_ID_INVALID;
+            POUCH_LOG_ERR("Cannot resume %s@%s from offset %zu", name, version, offset);
             return;
         }
-        memcpy(component_download.version, delimiter + 1, version_len);
-        component_download.version[version_len] = '\0';
-        component_download.offset = 0;
+
+        POUCH_LOG_INF("Resuming %s@%s from offset %zu", name, version, offset);
     }
-    else
+
+    if (NULL == download)
+    {
+        download = download_alloc();
+        if (NULL == download)
+        {
+            POUCH_LOG_ERR("Too many concurrent component downloads");
+            return;
+        }
+    }
+
+#if CONFIG_GOLIOTH_OTA_VERIFY
+    if (0 == offset && 0 != download_hash_start(download))
+    {
+        return;
+    }
+#endif
+
+    memcpy(download->name, name, name_len + 1);
+    memcpy(download->version, version, version_len + 1);
+
+#if CONFIG_GOLIOTH_OTA_DELTA
+    if (0 == offset)
     {
-        component_download.downlink_id = DOWNLINK_ID_INVALID;
+        download->delta = golioth_ota_component_is_delta(name);
+        download->image_offset = 0;
+        delta_patch_init(&download->patch, download_source_read, download_image_write, download);
     }
+#endif
+
+    download->offset = offset;
+    download->downlink_id = id;
+    golioth_downlink_ctx_set(id, download);
 }
 
 static void ota_receive_component_data(golioth_downlink_id_t id,
@@ -243,15 +599,43 @@ static void ota_receive_component_data(golioth_downlink_id_t id,
                                        size_t len,
                                        bool is_last)
 {
-    if (DOWNLINK_ID_INVALID != component_download.downlink_id)
+    struct component_download *download = golioth_downlink_ctx_get(id);
+    if (NULL == download)
     {
-        golioth_ota_receive_component(component_download.name,
-                                      component_download.version,
-                                      component_download.offset,
-                                      data,
-                                      len,
-                                      is_last);
-        component_download.offset += len;
+        return;
+    }
+
+    int err;
+
+#if CONFIG_GOLIOTH_OTA_DELTA
+    if (download->delta)
+    {
+        err = delta_patch_feed(&download->patch, data, len, is_last);
+        if (!err && is_last)
+        {
+            err = download_deliver(download, download->image_offset, NULL, 0, true);
+        }
+    }
+    else
+#endif
+    {
+        err = download_deliver(download, download->offset, data, len, is_last);
+    }
+
+    if (err)
+    {
+        POUCH_LOG_ERR("Abandoning download of %s@%s: %d", download->name, download->version, err);
+        golioth_ota_mark_idle(download->name);
+        golioth_downlink_ctx_set(id, NULL);
+        download_clear(download);
+        return;
+    }
+
+    download->offset += len;
+
+    if (is_last)
+    {
+        download_clear(download);
     }
 }
 
@@ -261,10 +645,15 @@ static void ota_uplink(void)
     const char *current_version = NULL;
     const char *target_version = NULL;
     enum golioth_ota_state state = GOLIOTH_OTA_STATE_IDLE;
+    enum golioth_ota_reason reason = GOLIOTH_OTA_REASON_READY;
     int component_idx = 0;
 
-    while (
-        golioth_ota_get_status(component_idx++, &name, &current_version, &target_version, &state))
+    while (golioth_ota_get_status(component_idx++,
+                                  &name,
+                                  &current_version,
+                                  &target_version,
+                                  &state,
+                                  &reason))
     {
         uint8_t encode_buf[OTA_STATUS_ENCODE_BUF_SIZE];
         ZCBOR_STATE_E(zse, 1, encode_buf, sizeof(encode_buf), 1);
@@ -281,7 +670,7 @@ static void ota_uplink(void)
             return;
         }
 
-        ok = zcbor_tstr_put_lit(zse, "r") && zcbor_uint32_put(zse, 0);
+        ok = zcbor_tstr_put_lit(zse, "r") && zcbor_uint32_put(zse, reason);
         if (!ok)
         {
             return;
@@ -308,6 +697,22 @@ static void ota_uplink(void)
             }
         }
 
+#if CONFIG_GOLIOTH_OTA_RESUME
+        /* Report how much of an interrupted download we already have, so the
+         * server can resume the component stream from there.
+         */
+        const struct component_download *download = download_find(name);
+        if (GOLIOTH_OTA_STATE_DOWNLOADING == state && NULL != download && 0 != download->offset
+            && 0 == strcmp(target_version, download->version))
+        {
+            ok = zcbor_tstr_put_lit(zse, "o") && zcbor_uint32_put(zse, (uint32_t) download->offset);
+            if (!ok)
+            {
+                return;
+            }
+        }
+#endif
+
         ok = zcbor_map_end_encode(zse, 1);
         if (!ok)
         {
@@ -331,7 +736,10 @@ static void ota_uplink(void)
     }
 }
 
-GOLIOTH_DOWNLINK_HANDLER(ota_manifest, GOLIOTH_OTA_MANIFEST_PATH, NULL, ota_receive_manifest);
+GOLIOTH_DOWNLINK_HANDLER(ota_manifest,
+                         GOLIOTH_OTA_MANIFEST_PATH,
+                         ota_receive_manifest_start,
+                         ota_receive_manifest);
 GOLIOTH_DOWNLINK_HANDLER(ota_component,
                          "/" GOLIOTH_OTA_COMPONENT_PATH_PREFIX "*",
                          ota_receive_component_start,
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #define GOLIOTH_OTA_COMPONENT_HASH_BIN_LEN 32
@@ -19,12 +20,21 @@ enum golioth_ota_state
     GOLIOTH_OTA_STATE_UPDATING,
 };
 
+/** Reason reported with the OTA state, following the Golioth OTA reason codes */
+enum golioth_ota_reason
+{
+    GOLIOTH_OTA_REASON_READY = 0,
+    GOLIOTH_OTA_REASON_UNSUPPORTED_PACKAGE_TYPE = 6,
+};
+
 struct golioth_ota_component
 {
     char package[CONFIG_GOLIOTH_OTA_MAX_PACKAGE_NAME_LEN + 1];
     char version[CONFIG_GOLIOTH_OTA_MAX_VERSION_LEN + 1];
     uint8_t hash[GOLIOTH_OTA_COMPONENT_HASH_BIN_LEN];
     int32_t size;
+    /** Version the artifact is a delta against, empty for full images */
+    char delta_from[CONFIG_GOLIOTH_OTA_MAX_VERSION_LEN + 1];
 };
 
 /* To be implemented by upper half */
@@ -37,8 +47,13 @@ int golioth_ota_receive_component(const char *name,
                                   const void *data,
                                   size_t len,
                                   bool is_last);
+bool golioth_ota_component_is_delta(const char *name);
+int golioth_ota_read_component(const char *name, size_t offset, void *buf, size_t len);
+int golioth_ota_verify_component(const char *name,
+                                 const uint8_t hash[GOLIOTH_OTA_COMPONENT_HASH_BIN_LEN]);
 bool golioth_ota_get_status(int component_idx,
                             const char **name,
                             const char **current_version,
                             const char **target_version,
-                            enum golioth_ota_state *state);
+                            enum golioth_ota_state *state,
+                            enum golioth_ota_reason *reason);
@@ -34,6 +34,15 @@ static int golioth_ota_set_status(const char *name, enum golioth_ota_state state
 
 int golioth_ota_mark_for_download(const char *name)
 {
+    POUCH_STRUCT_SECTION_FOREACH(golioth_ota_registered_component, component)
+    {
+        if (0 == strcmp(component->name, name) && component->data->rejected)
+        {
+            POUCH_LOG_WRN("Not downloading %s, the delta doesn't apply", name);
+            return -ENOTSUP;
+        }
+    }
+
     return golioth_ota_set_status(name, GOLIOTH_OTA_STATE_DOWNLOADING);
 }
 
@@ -66,6 +75,30 @@ int golioth_ota_manifest_receive_one(const struct golioth_ota_component *compone
                    component->hash,
                    GOLIOTH_OTA_COMPONENT_HASH_BIN_LEN);
             registered->data->size = component->size;
+            registered->data->delta = ('\0' != component->delta_from[0]);
+            registered->data->rejected = false;
+
+            if (registered->data->delta
+                && (NULL == registered->read
+                    || 0 != strcmp(component->delta_from, registered->version)))
+            {
+                POUCH_LOG_WRN("Cannot apply delta from %s to %s@%s",
+                              component->delta_from,
+                              registered->name,
+                              registered->version);
+
+                /* Patching against the wrong base would corrupt the image, so don't offer the
+                 * update to the application, and refuse to download it. The rejection is
+                 * reported in the OTA state, so the server can offer the full image instead.
+                 */
+                strncpy(registered->data->target,
+                        registered->version,
+                        sizeof(registered->data->target));
+                registered->data->target[sizeof(registered->data->target) - 1] = '\0';
+                registered->data->delta = false;
+                registered->data->rejected = true;
+                registered->data->state = GOLIOTH_OTA_STATE_IDLE;
+            }
         }
     }
 
@@ -123,11 +156,66 @@ int golioth_ota_receive_component(const char *name,
     return 0;
 }
 
+bool golioth_ota_component_is_delta(const char *name)
+{
+    POUCH_STRUCT_SECTION_FOREACH(golioth_ota_registered_component, registered)
+    {
+        if (0 == strcmp(registered->name, name))
+        {
+            return registered->data->delta;
+        }
+    }
+
+    return false;
+}
+
+int golioth_ota_read_component(const char *name, size_t offset, void *buf, size_t len)
+{
+    POUCH_STRUCT_SECTION_FOREACH(golioth_ota_registered_component, registered)
+    {
+        if (0 == strcmp(registered->name, name))
+        {
+            if (NULL == registered->read)
+            {
+                return -ENOTSUP;
+            }
+
+            return registered->read(offset, buf, len);
+        }
+    }
+
+    return -ENOENT;
+}
+
+int golioth_ota_verify_component(const char *name,
+                                 const uint8_t hash[GOLIOTH_OTA_COMPONENT_HASH_BIN_LEN])
+{
+    POUCH_STRUCT_SECTION_FOREACH(golioth_ota_registered_component, registered)
+    {
+        if (0 == strcmp(registered->name, name))
+        {
+            const uint8_t *target_hash = registered->data->target_hash;
+
+            if (0 != memcmp(target_hash, hash, GOLIOTH_OTA_COMPONENT_HASH_BIN_LEN))
+            {
+                POUCH_LOG_ERR("Hash mismatch for %s", name);
+                return -EBADMSG;
+            }
+
+            POUCH_LOG_INF("Verified %s", name);
+            return 0;
+        }
+    }
+
+    return -ENOENT;
+}
+
 bool golioth_ota_get_status(int component_idx,
                             const char **name,
                             const char **current_version,
                             const char **target_version,
-                            enum golioth_ota_state *state)
+                            enum golioth_ota_state *state,
+                            enum golioth_ota_reason *reason)
 {
     int count = 0;
     POUCH_STRUCT_SECTION_COUNT(golioth_ota_registered_component, &count);
@@ -143,6 +231,8 @@ bool golioth_ota_get_status(int component_idx,
     *current_version = component->version;
     *target_version = component->data->target;
     *state = component->data->state;
+    *reason = component->data->rejected ? GOLIOTH_OTA_REASON_UNSUPPORTED_PACKAGE_TYPE
+                                        : GOLIOTH_OTA_REASON_READY;
 
     return true;
 }
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <pouch/port.h>
+POUCH_LOG_REGISTER(golioth_rpc, CONFIG_GOLIOTH_LOG_LEVEL);
+
+#include <errno.h>
+#include <string.h>
+#include <pouch/types.h>
+#include <pouch/uplink.h>
+#include "zcbor_utils.h"
+
+#include <zcbor_decode.h>
+#include <zcbor_encode.h>
+
+#include <golioth/rpc.h>
+
+#include "dispatch.h"
+
+#define RPC_DOWNLINK_PATH "/.rpc"
+#define RPC_UPLINK_PATH ".rpc/status"
+
+/* Maximum number of key/value pairs in the response details */
+#define RPC_RESPONSE_DETAIL_MAX_PAIRS 16
+
+struct rpc_request
+{
+    golioth_downlink_id_t id;
+    /** Hold on the uplink pouch, so the reply goes out in the same pouch */
+    bool held;
+    /** Uplink session the hold was taken in */
+    uint32_t held_session;
+    bool overflow;
+    size_t len;
+    uint8_t buf[CONFIG_GOLIOTH_RPC_MAX_REQUEST_LEN];
+};
+
+static struct rpc_request request;
+
+#if CONFIG_GOLIOTH_RPC_AWAIT_REQUESTS
+/** Hold on the uplink pouch while requests may still arrive in the downlink */
+static bool session_held;
+/** Uplink session the hold was taken in */
+static uint32_t session_held_id;
+#endif
+
+static bool hold_take(uint32_t *session_id)
+{
+    *session_id = pouch_uplink_session_id();
+    return (0 == pouch_uplink_hold());
+}
+
+/* Holds are dropped when their uplink session ends, so only release the current session's hold */
+static void hold_release(bool *held, uint32_t session_id)
+{
+    if (*held && session_id == pouch_uplink_session_id())
+    {
+        pouch_uplink_release();
+    }
+
+    *held = false;
+}
+
+struct rpc_params
+{
+    const uint8_t *start;
+    size_t len;
+};
+
+static int rpc_params_decode(zcbor_state_t *zsd, void *value)
+{
+    struct rpc_params *params = value;
+
+    params->start = zsd->payload;
+
+    if (!zcbor_any_skip(zsd, NULL))
+    {
+        return -EBADMSG;
+    }
+
+    params->len = zsd->payload - params->start;
+
+    return 0;
+}
+
+static const struct golioth_rpc_handler *rpc_handler_find(const struct zcbor_string *method)
+{
+    POUCH_STRUCT_SECTION_FOREACH(golioth_rpc_handler, handler)
+    {
+        if (strlen(handler->method) == method->len
+            && 0 == memcmp(handler->method, method->value, method->len))
+        {
+            return handler;
+        }
+    }
+
+    return NULL;
+}
+
+static enum golioth_rpc_status rpc_call(const struct golioth_rpc_handler *handler,
+                                        const struct rpc_params *params,
+                                        zcbor_state_t *zse)
+{
+    ZCBOR_STATE_D(zsd, 2, params->start, params->len, 1, 0);
+
+    if (!zcbor_list_start_decode(zsd))
+    {
+        return GOLIOTH_RPC_INVALID_ARGUMENT;
+    }
+
+    return handler->callback(zsd, zse, handler->callback_arg);
+}
+
+static void rpc_reply(const struct zcbor_string *call_id,
+                      const struct golioth_rpc_handler *handler,
+                      const struct rpc_params *params)
+{
+    uint8_t buf[CONFIG_GOLIOTH_RPC_MAX_RESPONSE_LEN];
+    ZCBOR_STATE_E(zse, 2, buf, sizeof(buf), 1);
+
+    bool ok = zcbor_map_start_encode(zse, 3) && zcbor_tstr_put_lit(zse, "id")
+           && zcbor_tstr_encode(zse, call_id) && zcbor_tstr_put_lit(zse, "detail")
+           && zcbor_map_start_encode(zse, RPC_RESPONSE_DETAIL_MAX_PAIRS);
+    if (!ok)
+    {
+        POUCH_LOG_ERR("Could not form RPC reply");
+        return;
+    }
+
+    enum golioth_rpc_status status = GOLIOTH_RPC_UNIMPLEMENTED;
+    if (NULL != handler)
+    {
+        status = rpc_call(handler, params, zse);
+    }
+    else
+    {
+        POUCH_LOG_WRN("Unknown RPC method");
+    }
+
+    ok = zcbor_map_end_encode(zse, RPC_RESPONSE_DETAIL_MAX_PAIRS)
+      && zcbor_tstr_put_lit(zse, "statusCode") && zcbor_uint32_put(zse, status)
+      && zcbor_map_end_encode(zse, 3);
+    if (!ok)
+    {
+        POUCH_LOG_ERR("Could not form RPC reply");
+        return;
+    }
+
+    int err = pouch_uplink_entry_write(RPC_UPLINK_PATH,
+                                       POUCH_CONTENT_TYPE_CBOR,
+                                       buf,
+                                       zse->payload - buf,
+                                       POUCH_FOREVER);
+    if (err)
+    {
+        POUCH_LOG_ERR("Could not write RPC reply: %d", err);
+    }
+}
+
+static void rpc_request_handle(void)
+{
+    struct zcbor_string call_id = {};
+    struct zcbor_string method = {};
+    struct rpc_params params = {};
+
+    ZCBOR_STATE_D(zsd, 2, request.buf, request.len, 1, 0);
+
+    struct zcbor_map_entry map_entries[] = {
+        ZCBOR_TSTR_LIT_MAP_ENTRY("id", zcbor_map_tstr_decode, &call_id),
+        ZCBOR_TSTR_LIT_MAP_ENTRY("method", zcbor_map_tstr_decode, &method),
+        ZCBOR_TSTR_LIT_MAP_ENTRY("params", rpc_params_decode, &params),
+    };
+
+    int err = zcbor_map_decode(zsd, map_entries, sizeof(map_entries) / sizeof(map_entries[0]));
+    if (err)
+    {
+        POUCH_LOG_ERR("Failed to decode RPC request: %d", err);
+        return;
+    }
+
+    POUCH_LOG_DBG("RPC %.*s", (int) method.len, method.value);
+
+    rpc_reply(&call_id, rpc_handler_find(&method), &params);
+}
+
+static void rpc_request_end(void)
+{
+    golioth_downlink_ctx_set(request.id, NULL);
+
+    hold_release(&request.held, request.held_session);
+
+#if CONFIG_GOLIOTH_RPC_AWAIT_REQUESTS
+    /* The reply is out, there's no need to wait for more requests */
+    hold_release(&session_held, session_held_id);
+#endif
+}
+
+static void rpc_downlink_start(golioth_downlink_id_t id,
+                               const char *path_remainder,
+                               size_t path_remainder_len)
+{
+    if (golioth_downlink_ctx_get(request.id) == &request)
+    {
+        POUCH_LOG_WRN("RPC request was interrupted");
+        rpc_request_end();
+    }
+
+    request.id = id;
+    request.len = 0;
+    request.overflow = false;
+    request.held = hold_take(&request.held_session);
+
+    golioth_downlink_ctx_set(id, &request);
+}
+
+static void rpc_downlink(golioth_downlink_id_t id, const void *data, size_t len, bool is_last)
+{
+    if (golioth_downlink_ctx_get(id) != &request)
+    {
+        return;
+    }
+
+    if (len > sizeof(request.buf) - request.len)
+    {
+        request.overflow = true;
+    }
+    else
+    {
+        memcpy(&request.buf[request.len], data, len);
+        request.len += len;
+    }
+
+    if (!is_last)
+    {
+        return;
+    }
+
+    if (request.overflow)
+    {
+        POUCH_LOG_ERR("RPC request too large");
+    }
+    else
+    {
+        rpc_request_handle();
+    }
+
+    rpc_request_end();
+}
+
+#if CONFIG_GOLIOTH_RPC_AWAIT_REQUESTS
+static void rpc_uplink(void)
+{
+    /* Keep the pouch open for replies to requests in this session's downlink */
+    session_held = hold_take(&session_held_id);
+}
+
+POUCH_UPLINK_HANDLER(rpc_uplink);
+#endif
+
+GOLIOTH_DOWNLINK_HANDLER(rpc, RPC_DOWNLINK_PATH, rpc_downlink_start, rpc_downlink);
@@ -8,6 +8,7 @@
 POUCH_LOG_REGISTER(golioth_settings, CONFIG_GOLIOTH_LOG_LEVEL);
 
 #include <errno.h>
+#include <string.h>
 #include <pouch/types.h>
 #include <pouch/uplink.h>
 #include "zcbor_utils.h"
@@ -26,137 +27,266 @@ POUCH_LOG_REGISTER(golioth_settings, CONFIG_GOLIOTH_LOG_LEVEL);
 
 static int64_t settings_version = -1;
 
-static int settings_decode(zcbor_state_t *zsd, void *value)
+enum settings_key
 {
-    struct zcbor_string label;
-    bool ok;
+    SETTINGS_KEY_NONE,
+    SETTINGS_KEY_SETTINGS,
+    SETTINGS_KEY_VERSION,
+    SETTINGS_KEY_OTHER,
+};
 
-    if (zcbor_nil_expect(zsd, NULL))
+static struct
+{
+    struct zcbor_stream stream;
+    golioth_downlink_id_t id;
+    enum settings_key key;
+    bool has_name;
+    /** Number of settings received, to commit at the end of the downlink */
+    size_t received;
+    char name[GOLIOTH_SETTINGS_MAX_NAME_LEN + 1];
+} parser;
+
+static bool item_tstr_decode(const struct zcbor_stream_event *event, struct zcbor_string *str)
+{
+    ZCBOR_STATE_D(zsd, 1, event->payload, event->len, 1, 0);
+
+    return zcbor_tstr_decode(zsd, str);
+}
+
+static bool setting_value_decode(const struct zcbor_stream_event *event,
+                                 struct setting_value *value)
+{
+    ZCBOR_STATE_D(zsd, 1, event->payload, event->len, 1, 0);
+
+    zcbor_major_type_t major_type = ZCBOR_MAJOR_TYPE(*zsd->payload);
+
+    switch (major_type)
     {
-        /* No settings are set */
-        return -ENOENT;
+        case ZCBOR_MAJOR_TYPE_TSTR:
+        {
+            struct zcbor_string str;
+
+            if (!zcbor_tstr_decode(zsd, &str))
+            {
+                return false;
+            }
+
+            value->type = GOLIOTH_SETTING_VALUE_TYPE_STRING;
+            value->str_val.data = (char *) str.value;
+            value->str_val.len = str.len;
+            return true;
+        }
+        case ZCBOR_MAJOR_TYPE_PINT:
+        case ZCBOR_MAJOR_TYPE_NINT:
+            value->type = GOLIOTH_SETTING_VALUE_TYPE_INT;
+            return zcbor_int32_decode(zsd, &value->int_val);
+        case ZCBOR_MAJOR_TYPE_SIMPLE:
+            if (zcbor_float_decode(zsd, &value->float_val))
+            {
+                value->type = GOLIOTH_SETTING_VALUE_TYPE_FLOAT;
+                return true;
+            }
+
+            if (zcbor_bool_decode(zsd, &value->bool_val))
+            {
+                value->type = GOLIOTH_SETTING_VALUE_TYPE_BOOL;
+                return true;
+            }
+
+            return false;
+        default:
+            return false;
     }
+}
 
-    ok = zcbor_map_start_decode(zsd);
-    if (!ok)
+static int settings_key_step(const struct zcbor_stream_event *event)
+{
+    struct zcbor_string key;
+
+    if (event->type != ZCBOR_STREAM_ITEM || !item_tstr_decode(event, &key))
     {
-        POUCH_LOG_WRN("Did not start CBOR list correctly");
+        POUCH_LOG_ERR("Failed to get key");
         return -EBADMSG;
     }
 
-    while (!zcbor_list_or_map_end(zsd))
+    if (key.len == sizeof("settings") - 1 && memcmp(key.value, "settings", key.len) == 0)
+    {
+        parser.key = SETTINGS_KEY_SETTINGS;
+    }
+    else if (key.len == sizeof("version") - 1 && memcmp(key.value, "version", key.len) == 0)
+    {
+        parser.key = SETTINGS_KEY_VERSION;
+    }
+    else
+    {
+        parser.key = SETTINGS_KEY_OTHER;
+    }
+
+    return 0;
+}
+
+static int settings_value_step(const struct zcbor_stream_event *event)
+{
+    if (event->type != ZCBOR_STREAM_ITEM)
     {
-        struct setting_value value;
-        memset(&value, 0, sizeof(value));
+        if (parser.key == SETTINGS_KEY_SETTINGS && event->type != ZCBOR_STREAM_MAP_START)
+        {
+            POUCH_LOG_WRN("Settings are not a map");
+            return -EBADMSG;
+        }
 
-        bool data_type_valid = true;
+        /* The key is reset by the end of the container */
+        return 0;
+    }
 
-        /* Handle item */
-        ok = zcbor_tstr_decode(zsd, &label);
-        if (!ok)
+    if (parser.key == SETTINGS_KEY_VERSION)
+    {
+        ZCBOR_STATE_D(zsd, 1, event->payload, event->len, 1, 0);
+
+        if (!zcbor_int64_decode(zsd, &settings_version))
         {
-            POUCH_LOG_ERR("Failed to get label");
+            POUCH_LOG_ERR("Failed to decode version");
             return -EBADMSG;
         }
+    }
 
-        char key[GOLIOTH_SETTINGS_MAX_NAME_LEN + 1] = {};
+    /* A nil settings value means no settings are set */
 
-        /* Copy setting label/name and ensure it's NULL-terminated */
-        memcpy(key, label.value, MIN(GOLIOTH_SETTINGS_MAX_NAME_LEN, label.len));
+    parser.key = SETTINGS_KEY_NONE;
 
-        value.key = key;
+    return 0;
+}
 
-        zcbor_major_type_t major_type = ZCBOR_MAJOR_TYPE(*zsd->payload);
+static int setting_step(const struct zcbor_stream_event *event)
+{
+    if (event->type == ZCBOR_STREAM_END)
+    {
+        /* End of an unsupported list or map value */
+        parser.has_name = false;
+        return 0;
+    }
 
-        switch (major_type)
+    if (!parser.has_name)
+    {
+        struct zcbor_string label;
+
+        if (event->type != ZCBOR_STREAM_ITEM || !item_tstr_decode(event, &label))
         {
-            case ZCBOR_MAJOR_TYPE_TSTR:
+            POUCH_LOG_ERR("Failed to get label");
+            return -EBADMSG;
+        }
+
+        /* Copy setting label/name and ensure it's NULL-terminated */
+        memset(parser.name, 0, sizeof(parser.name));
+        memcpy(parser.name, label.value, MIN(GOLIOTH_SETTINGS_MAX_NAME_LEN, label.len));
+        parser.has_name = true;
+
+        return 0;
+    }
+
+    if (event->type != ZCBOR_STREAM_ITEM)
+    {
+        /* Unsupported type, skipped until its end */
+        return 0;
+    }
+
+    struct setting_value value;
+    memset(&value, 0, sizeof(value));
+
+    value.key = parser.name;
+
+    if (setting_value_decode(event, &value))
+    {
+        golioth_settings_receive_one(&value);
+        parser.received++;
+    }
+
+    parser.has_name = false;
+
+    return 0;
+}
+
+static int settings_step(const struct zcbor_stream_event *event, void *user_data)
+{
+    switch (event->depth)
+    {
+        case 0:
+            if (event->type == ZCBOR_STREAM_ITEM || event->type == ZCBOR_STREAM_LIST_START)
             {
-                struct zcbor_string str;
-
-                ok = zcbor_tstr_decode(zsd, &str);
-                if (!ok)
-                {
-                    data_type_valid = false;
-                    break;
-                }
-
-                value.type = GOLIOTH_SETTING_VALUE_TYPE_STRING;
-                value.str_val.data = (char *) str.value;
-                value.str_val.len = str.len;
-                break;
+                POUCH_LOG_WRN("Settings downlink is not a map");
+                return -EBADMSG;
             }
-            case ZCBOR_MAJOR_TYPE_PINT:
-            case ZCBOR_MAJOR_TYPE_NINT:
+            return 0;
+        case 1:
+            if (event->type == ZCBOR_STREAM_END)
             {
-                value.type = GOLIOTH_SETTING_VALUE_TYPE_INT;
-                ok = zcbor_int32_decode(zsd, &value.int_val);
-                if (!ok)
-                {
-                    data_type_valid = false;
-                    break;
-                }
-
-                break;
+                parser.key = SETTINGS_KEY_NONE;
+                return 0;
             }
-            case ZCBOR_MAJOR_TYPE_SIMPLE:
+
+            if (parser.key == SETTINGS_KEY_NONE)
             {
-                if (zcbor_float_decode(zsd, &value.float_val))
-                {
-                    value.type = GOLIOTH_SETTING_VALUE_TYPE_FLOAT;
-                }
-                else if (zcbor_bool_decode(zsd, &value.bool_val))
-                {
-                    value.type = GOLIOTH_SETTING_VALUE_TYPE_BOOL;
-                }
-                else
-                {
-                    data_type_valid = false;
-                }
-                break;
+                return settings_key_step(event);
             }
-            default:
-                data_type_valid = false;
-                break;
-        }
 
-        if (data_type_valid)
-        {
-            golioth_settings_receive_one(&value);
-        }
-        else
-        {
-            ok = zcbor_any_skip(zsd, NULL);
-            if (!ok)
+            return settings_value_step(event);
+        case 2:
+            if (parser.key != SETTINGS_KEY_SETTINGS)
             {
-                POUCH_LOG_ERR("Failed to skip unsupported type");
-                return -EBADMSG;
+                return 0;
             }
-        }
+
+            return setting_step(event);
+        default:
+            /* Contents of unsupported values */
+            return 0;
     }
+}
 
-    ok = zcbor_map_end_decode(zsd);
-    if (!ok)
+static void settings_downlink_start(golioth_downlink_id_t id,
+                                    const char *path_remainder,
+                                    size_t path_remainder_len)
+{
+    POUCH_LOG_DBG("Received settings downlink");
+
+    if (golioth_downlink_ctx_get(parser.id) == &parser)
     {
-        POUCH_LOG_WRN("Did not end CBOR list correctly");
-        return -EBADMSG;
+        POUCH_LOG_WRN("Settings downlink was interrupted");
+        golioth_downlink_ctx_set(parser.id, NULL);
     }
 
-    return 0;
+    memset(&parser, 0, sizeof(parser));
+    zcbor_stream_init(&parser.stream, settings_step, NULL);
+    parser.id = id;
+
+    golioth_downlink_ctx_set(id, &parser);
 }
 
 static void settings_downlink(golioth_downlink_id_t id, const void *data, size_t len, bool is_last)
 {
-    POUCH_LOG_DBG("Received settings downlink");
+    if (golioth_downlink_ctx_get(id) != &parser)
+    {
+        return;
+    }
 
-    ZCBOR_STATE_D(zsd, 2, data, len, 1, 0);
+    int err = zcbor_stream_feed(&parser.stream, data, len, is_last);
+    if (err)
+    {
+        POUCH_LOG_ERR("Failed to decode settings: %d", err);
+    }
 
-    struct zcbor_map_entry map_entries[] = {
-        ZCBOR_TSTR_LIT_MAP_ENTRY("settings", settings_decode, NULL),
-        ZCBOR_TSTR_LIT_MAP_ENTRY("version", zcbor_map_int64_decode, &settings_version),
-    };
+    /* Settings that were received before an error have been applied, and
+     * must be committed as well.
+     */
+    if ((err || is_last) && parser.received > 0)
+    {
+        golioth_settings_commit();
+    }
 
-    zcbor_map_decode(zsd, map_entries, sizeof(map_entries) / sizeof(map_entries[0]));
+    if (err || is_last)
+    {
+        golioth_downlink_ctx_set(id, NULL);
+    }
 }
 
 static void settings_uplink(void)
@@ -165,7 +295,15 @@ static void settings_uplink(void)
     uint8_t buf[64];
     zcbor_new_encode_state(zse, 3, buf, sizeof(buf), 1);
 
-    bool ok = zcbor_map_start_encode(zse, 2);
+    bool ok = zcbor_map_start_encode(zse, 3);
+    if (!ok)
+    {
+        POUCH_LOG_ERR("Could not form settings uplink");
+        return;
+    }
+
+    /* Hash of the applied settings, so only changed settings need to be sent */
+    ok = zcbor_tstr_put_lit(zse, "hash") && zcbor_uint32_put(zse, golioth_settings_hash());
     if (!ok)
     {
         POUCH_LOG_ERR("Could not form settings uplink");
@@ -197,7 +335,7 @@ static void settings_uplink(void)
             return;
         }
     }
-    ok = zcbor_map_end_encode(zse, 2);
+    ok = zcbor_map_end_encode(zse, 3);
     if (!ok)
     {
         POUCH_LOG_ERR("Could not form settings uplink");
@@ -211,5 +349,8 @@ static void settings_uplink(void)
                              POUCH_FOREVER);
 }
 
-GOLIOTH_DOWNLINK_HANDLER(settings, SETTINGS_DOWNLINK_PATH, NULL, settings_downlink);
+GOLIOTH_DOWNLINK_HANDLER(settings,
+                         SETTINGS_DOWNLINK_PATH,
+                         settings_downlink_start,
+                         settings_downlink);
 POUCH_UPLINK_HANDLER(settings_uplink);
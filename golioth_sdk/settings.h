@@ -28,3 +28,5 @@ struct setting_value
 };
 
 int golioth_settings_receive_one(const struct setting_value *value);
+void golioth_settings_commit(void);
+uint32_t golioth_settings_hash(void);
@@ -12,37 +12,169 @@ POUCH_LOG_REGISTER(settings_callbacks, CONFIG_GOLIOTH_LOG_LEVEL);
 #include <string.h>
 #include "settings.h"
 
-int golioth_settings_receive_one(const struct setting_value *value)
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME 16777619u
+
+/** Settings handlers sorted by key */
+static const struct golioth_settings_handler *handlers[CONFIG_GOLIOTH_SETTINGS_MAX_HANDLERS];
+static size_t handler_count;
+
+/** Hash of the value last applied by each handler, 0 if none */
+static uint32_t applied_hashes[CONFIG_GOLIOTH_SETTINGS_MAX_HANDLERS];
+/** XOR of all applied hashes, which doesn't depend on the order settings arrive in */
+static uint32_t settings_hash;
+
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t len)
 {
-    POUCH_STRUCT_SECTION_FOREACH(golioth_settings_handler, setting)
+    const uint8_t *bytes = data;
+
+    for (size_t i = 0; i < len; i++)
     {
-        if (0 == strcmp(setting->key, value->key))
-        {
-            if (setting->type != value->type)
-            {
-                return -EINVAL;
-            }
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+
+    return hash;
+}
 
-            switch (setting->type)
-            {
-                case GOLIOTH_SETTING_VALUE_TYPE_INT:
-                    return setting->int_cb(value->int_val);
+static uint32_t setting_hash(const struct setting_value *value)
+{
+    uint8_t type = value->type;
+    uint32_t hash = fnv1a(FNV_OFFSET_BASIS, value->key, strlen(value->key) + 1);
 
-                case GOLIOTH_SETTING_VALUE_TYPE_BOOL:
-                    return setting->bool_cb(value->bool_val);
+    hash = fnv1a(hash, &type, sizeof(type));
 
-                case GOLIOTH_SETTING_VALUE_TYPE_FLOAT:
-                    return setting->float_cb(value->float_val);
+    switch (value->type)
+    {
+        case GOLIOTH_SETTING_VALUE_TYPE_INT:
+            return fnv1a(hash, &value->int_val, sizeof(value->int_val));
+        case GOLIOTH_SETTING_VALUE_TYPE_BOOL:
+        {
+            uint8_t bool_val = value->bool_val;
+            return fnv1a(hash, &bool_val, sizeof(bool_val));
+        }
+        case GOLIOTH_SETTING_VALUE_TYPE_FLOAT:
+            return fnv1a(hash, &value->float_val, sizeof(value->float_val));
+        case GOLIOTH_SETTING_VALUE_TYPE_STRING:
+            return fnv1a(hash, value->str_val.data, value->str_val.len);
+        default:
+            return hash;
+    }
+}
 
-                case GOLIOTH_SETTING_VALUE_TYPE_STRING:
-                    return setting->string_cb(value->str_val.data, value->str_val.len);
+static int handler_find(const char *key)
+{
+    size_t lo = 0;
+    size_t hi = handler_count;
 
-                default:
-                    POUCH_LOG_ERR("Unknown settings type");
-                    break;
-            }
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(handlers[mid]->key, key);
+        if (cmp == 0)
+        {
+            return (int) mid;
         }
+
+        if (cmp < 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return -ENOENT;
+}
+
+static int setting_apply(const struct golioth_settings_handler *setting,
+                         const struct setting_value *value)
+{
+    switch (setting->type)
+    {
+        case GOLIOTH_SETTING_VALUE_TYPE_INT:
+            return setting->int_cb(value->int_val);
+
+        case GOLIOTH_SETTING_VALUE_TYPE_BOOL:
+            return setting->bool_cb(value->bool_val);
+
+        case GOLIOTH_SETTING_VALUE_TYPE_FLOAT:
+            return setting->float_cb(value->float_val);
+
+        case GOLIOTH_SETTING_VALUE_TYPE_STRING:
+            return setting->string_cb(value->str_val.data, value->str_val.len);
+
+        default:
+            POUCH_LOG_ERR("Unknown settings type");
+            break;
     }
 
     return -ENOENT;
 }
+
+int golioth_settings_receive_one(const struct setting_value *value)
+{
+    int idx = handler_find(value->key);
+    if (idx < 0)
+    {
+        return idx;
+    }
+
+    const struct golioth_settings_handler *setting = handlers[idx];
+    if (setting->type != value->type)
+    {
+        return -EINVAL;
+    }
+
+    int err = setting_apply(setting, value);
+    if (err)
+    {
+        return err;
+    }
+
+    uint32_t hash = setting_hash(value);
+
+    settings_hash ^= applied_hashes[idx] ^ hash;
+    applied_hashes[idx] = hash;
+
+    return 0;
+}
+
+void golioth_settings_commit(void)
+{
+    POUCH_STRUCT_SECTION_FOREACH(golioth_settings_commit_handler, handler)
+    {
+        handler->commit();
+    }
+}
+
+uint32_t golioth_settings_hash(void)
+{
+    return settings_hash;
+}
+
+static void settings_callbacks_init(void)
+{
+    handler_count = 0;
+
+    /* The section is sorted by symbol name, not by key */
+    POUCH_STRUCT_SECTION_FOREACH(golioth_settings_handler, setting)
+    {
+        if (handler_count == CONFIG_GOLIOTH_SETTINGS_MAX_HANDLERS)
+        {
+            POUCH_LOG_ERR("Too many settings handlers, ignoring %s", setting->key);
+            continue;
+        }
+
+        /* Insertion sort, only done once */
+        size_t i = handler_count++;
+        while (i > 0 && strcmp(handlers[i - 1]->key, setting->key) > 0)
+        {
+            handlers[i] = handlers[i - 1];
+            i--;
+        }
+        handlers[i] = setting;
+    }
+}
+POUCH_APPLICATION_STARTUP_HOOK(settings_callbacks_init);
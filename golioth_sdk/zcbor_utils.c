@@ -8,14 +8,29 @@
 POUCH_LOG_REGISTER(zcbor_util, CONFIG_POUCH_COMMON_LOG_LEVEL);
 
 #include <errno.h>
+#include <string.h>
 #include "zcbor_utils.h"
 
+/** Marks an indefinite length list or map in zcbor_stream::remaining */
+#define STREAM_INDEFINITE UINT32_MAX
+
+#define CBOR_BREAK 0xff
+
+/**
+ * Get the entry for @p key, starting at the @p hint index.
+ *
+ * Maps are usually encoded in the same order as the entries, so the search
+ * starts right after the previous match and normally finds the entry there.
+ */
 static struct zcbor_map_entry *map_entry_get(struct zcbor_map_entry *entries,
                                              size_t num_entries,
+                                             size_t hint,
                                              struct zcbor_map_key *key)
 {
-    for (struct zcbor_map_entry *entry = entries; entry < &entries[num_entries]; entry++)
+    for (size_t i = 0; i < num_entries; i++)
     {
+        struct zcbor_map_entry *entry = &entries[(hint + i) % num_entries];
+
         switch (entry->key.type)
         {
             case ZCBOR_MAP_KEY_TYPE_U32:
@@ -114,10 +129,21 @@ int zcbor_map_decode(zcbor_state_t *zsd, struct zcbor_map_entry *entries, size_t
 {
     struct zcbor_map_entry *entry;
     size_t num_decoded = 0;
+    size_t num_required = 0;
+    size_t required_decoded = 0;
+    size_t hint = 0;
     struct zcbor_map_key key;
     int err = 0;
     bool ok;
 
+    for (size_t i = 0; i < num_entries; i++)
+    {
+        if (!entries[i].optional)
+        {
+            num_required++;
+        }
+    }
+
     ok = zcbor_map_start_decode(zsd);
     if (!ok)
     {
@@ -133,9 +159,11 @@ int zcbor_map_decode(zcbor_state_t *zsd, struct zcbor_map_entry *entries, size_t
             return err;
         }
 
-        entry = map_entry_get(entries, num_entries, &key);
+        entry = map_entry_get(entries, num_entries, hint, &key);
         if (entry)
         {
+            hint = (entry - entries) + 1;
+
             err = entry->decode(zsd, entry->value);
             if (err)
             {
@@ -143,6 +171,10 @@ int zcbor_map_decode(zcbor_state_t *zsd, struct zcbor_map_entry *entries, size_t
             }
 
             num_decoded++;
+            if (!entry->optional)
+            {
+                required_decoded++;
+            }
         }
         else
         {
@@ -160,7 +192,7 @@ int zcbor_map_decode(zcbor_state_t *zsd, struct zcbor_map_entry *entries, size_t
         goto map_end_decode;
     }
 
-    if (num_decoded < num_entries)
+    if (required_decoded < num_required)
     {
         return -EBADMSG;
     }
@@ -175,3 +207,412 @@ map_end_decode:
 
     return err;
 }
+
+struct cbor_token
+{
+    zcbor_major_type_t major_type;
+    bool indefinite;
+    bool is_break;
+    uint64_t arg;
+    /** Length of the token: the header for lists, maps and tags, the whole item otherwise */
+    size_t len;
+};
+
+static int cbor_token_decode(const uint8_t *buf, size_t len, struct cbor_token *token)
+{
+    if (len < 1)
+    {
+        return -EAGAIN;
+    }
+
+    uint8_t additional = buf[0] & 0x1f;
+
+    token->major_type = ZCBOR_MAJOR_TYPE(buf[0]);
+    token->indefinite = false;
+    token->is_break = buf[0] == CBOR_BREAK;
+    token->arg = additional;
+    token->len = 1;
+
+    if (token->is_break)
+    {
+        return 0;
+    }
+
+    if (additional == 31)
+    {
+        if (token->major_type != ZCBOR_MAJOR_TYPE_LIST && token->major_type != ZCBOR_MAJOR_TYPE_MAP)
+        {
+            /* Indefinite length strings are not supported */
+            return -EBADMSG;
+        }
+
+        token->indefinite = true;
+        return 0;
+    }
+
+    if (additional > 27)
+    {
+        return -EBADMSG;
+    }
+
+    if (additional >= 24)
+    {
+        size_t arg_len = 1 << (additional - 24);
+        if (len < 1 + arg_len)
+        {
+            return -EAGAIN;
+        }
+
+        token->arg = 0;
+        for (size_t i = 1; i <= arg_len; i++)
+        {
+            token->arg = (token->arg << 8) | buf[i];
+        }
+        token->len += arg_len;
+    }
+
+    if (token->major_type == ZCBOR_MAJOR_TYPE_BSTR || token->major_type == ZCBOR_MAJOR_TYPE_TSTR)
+    {
+        if (len - token->len < token->arg)
+        {
+            return -EAGAIN;
+        }
+        token->len += token->arg;
+    }
+
+    return 0;
+}
+
+static bool cbor_token_is_container(const struct cbor_token *token)
+{
+    return token->major_type == ZCBOR_MAJOR_TYPE_LIST || token->major_type == ZCBOR_MAJOR_TYPE_MAP;
+}
+
+static uint64_t cbor_token_count(const struct cbor_token *token)
+{
+    return (token->major_type == ZCBOR_MAJOR_TYPE_MAP) ? 2 * token->arg : token->arg;
+}
+
+/** Get the length of the complete data item at the start of @a buf */
+static int cbor_item_len(const uint8_t *buf, size_t len, size_t *item_len)
+{
+    uint64_t remaining[ZCBOR_STREAM_MAX_DEPTH];
+    size_t depth = 0;
+    size_t offset = 0;
+
+    while (true)
+    {
+        struct cbor_token token;
+        int err = cbor_token_decode(&buf[offset], len - offset, &token);
+        if (err)
+        {
+            return err;
+        }
+
+        offset += token.len;
+
+        if (token.major_type == ZCBOR_MAJOR_TYPE_TAG && !token.is_break)
+        {
+            continue;
+        }
+
+        if (token.is_break)
+        {
+            if (depth == 0 || remaining[depth - 1] != STREAM_INDEFINITE)
+            {
+                return -EBADMSG;
+            }
+            depth--;
+        }
+        else if (cbor_token_is_container(&token)
+                 && (token.indefinite || cbor_token_count(&token) > 0))
+        {
+            if (depth == ZCBOR_STREAM_MAX_DEPTH)
+            {
+                return -ENOMEM;
+            }
+
+            remaining[depth++] = token.indefinite ? STREAM_INDEFINITE : cbor_token_count(&token);
+            continue;
+        }
+
+        /* An item is complete, so are the containers it completes */
+        while (depth > 0 && remaining[depth - 1] != STREAM_INDEFINITE)
+        {
+            if (--remaining[depth - 1] > 0)
+            {
+                break;
+            }
+            depth--;
+        }
+
+        if (depth == 0)
+        {
+            *item_len = offset;
+            return 0;
+        }
+    }
+}
+
+static int stream_emit(struct zcbor_stream *stream,
+                       enum zcbor_stream_event_type type,
+                       const uint8_t *payload,
+                       size_t len)
+{
+    struct zcbor_stream_event event = {
+        .type = type,
+        .depth = stream->depth,
+        .payload = payload,
+        .len = len,
+    };
+
+    return stream->step(&event, stream->user_data);
+}
+
+static int stream_item_complete(struct zcbor_stream *stream)
+{
+    while (stream->depth > 0 && stream->remaining[stream->depth - 1] != STREAM_INDEFINITE)
+    {
+        if (--stream->remaining[stream->depth - 1] > 0)
+        {
+            return 0;
+        }
+
+        stream->depth--;
+
+        int err = stream_emit(stream, ZCBOR_STREAM_END, NULL, 0);
+        if (err < 0)
+        {
+            return err;
+        }
+    }
+
+    if (stream->depth == 0)
+    {
+        stream->done = true;
+    }
+
+    return 0;
+}
+
+/** Process a complete token, or a complete collected list or map */
+static int stream_process(struct zcbor_stream *stream, const uint8_t *item, size_t len)
+{
+    struct cbor_token token;
+    int err;
+
+    if (stream->collecting)
+    {
+        stream->collecting = false;
+
+        err = stream_emit(stream, ZCBOR_STREAM_ITEM, item, len);
+        if (err < 0)
+        {
+            return err;
+        }
+
+        return stream_item_complete(stream);
+    }
+
+    err = cbor_token_decode(item, len, &token);
+    if (err)
+    {
+        return err;
+    }
+
+    if (token.is_break)
+    {
+        if (stream->depth == 0 || stream->remaining[stream->depth - 1] != STREAM_INDEFINITE)
+        {
+            return -EBADMSG;
+        }
+
+        stream->depth--;
+
+        err = stream_emit(stream, ZCBOR_STREAM_END, NULL, 0);
+        if (err < 0)
+        {
+            return err;
+        }
+
+        return stream_item_complete(stream);
+    }
+
+    if (token.major_type == ZCBOR_MAJOR_TYPE_TAG)
+    {
+        /* Tags only annotate the next item */
+        return 0;
+    }
+
+    if (!cbor_token_is_container(&token))
+    {
+        err = stream_emit(stream, ZCBOR_STREAM_ITEM, item, len);
+        if (err < 0)
+        {
+            return err;
+        }
+
+        return stream_item_complete(stream);
+    }
+
+    err = stream_emit(stream,
+                      token.major_type == ZCBOR_MAJOR_TYPE_MAP ? ZCBOR_STREAM_MAP_START
+                                                               : ZCBOR_STREAM_LIST_START,
+                      NULL,
+                      0);
+    if (err < 0)
+    {
+        return err;
+    }
+
+    if (err == ZCBOR_STREAM_COLLECT)
+    {
+        /* Collect the rest of the container behind its header */
+        if (item != stream->carry)
+        {
+            memcpy(stream->carry, item, len);
+        }
+        stream->carry_len = len;
+        stream->collecting = true;
+        return 0;
+    }
+
+    if (!token.indefinite && cbor_token_count(&token) == 0)
+    {
+        err = stream_emit(stream, ZCBOR_STREAM_END, NULL, 0);
+        if (err < 0)
+        {
+            return err;
+        }
+
+        return stream_item_complete(stream);
+    }
+
+    if (stream->depth == ZCBOR_STREAM_MAX_DEPTH)
+    {
+        return -ENOMEM;
+    }
+
+    stream->remaining[stream->depth++] =
+        token.indefinite ? STREAM_INDEFINITE : (uint32_t) cbor_token_count(&token);
+
+    return 0;
+}
+
+static int stream_next_len(struct zcbor_stream *stream,
+                           const uint8_t *buf,
+                           size_t len,
+                           size_t *next_len)
+{
+    if (stream->collecting)
+    {
+        return cbor_item_len(buf, len, next_len);
+    }
+
+    struct cbor_token token;
+    int err = cbor_token_decode(buf, len, &token);
+    if (err)
+    {
+        return err;
+    }
+
+    *next_len = token.len;
+    return 0;
+}
+
+void zcbor_stream_init(struct zcbor_stream *stream, zcbor_stream_step_cb step, void *user_data)
+{
+    memset(stream, 0, sizeof(*stream));
+    stream->step = step;
+    stream->user_data = user_data;
+}
+
+int zcbor_stream_feed(struct zcbor_stream *stream, const void *data, size_t len, bool is_last)
+{
+    const uint8_t *p = data;
+    int err = stream->err;
+
+    while (!err && !stream->done)
+    {
+        const uint8_t *item;
+        size_t item_len;
+
+        if (stream->carry_len > 0)
+        {
+            /* Complete the carried over item with the new data */
+            size_t copied = MIN(len, sizeof(stream->carry) - stream->carry_len);
+            memcpy(&stream->carry[stream->carry_len], p, copied);
+
+            err = stream_next_len(stream, stream->carry, stream->carry_len + copied, &item_len);
+            if (err == -EAGAIN)
+            {
+                if (stream->carry_len + copied == sizeof(stream->carry))
+                {
+                    POUCH_LOG_ERR("CBOR item too large");
+                    err = -ENOMEM;
+                    break;
+                }
+
+                stream->carry_len += copied;
+                err = 0;
+                break;
+            }
+
+            if (err)
+            {
+                break;
+            }
+
+            size_t used = item_len - stream->carry_len;
+            p += used;
+            len -= used;
+
+            item = stream->carry;
+            stream->carry_len = 0;
+        }
+        else
+        {
+            if (len == 0)
+            {
+                break;
+            }
+
+            err = stream_next_len(stream, p, len, &item_len);
+            if (err == -EAGAIN)
+            {
+                if (len >= sizeof(stream->carry))
+                {
+                    POUCH_LOG_ERR("CBOR item too large");
+                    err = -ENOMEM;
+                    break;
+                }
+
+                memcpy(stream->carry, p, len);
+                stream->carry_len = len;
+                err = 0;
+                break;
+            }
+
+            if (err)
+            {
+                break;
+            }
+
+            item = p;
+            p += item_len;
+            len -= item_len;
+        }
+
+        err = stream_process(stream, item, item_len);
+    }
+
+    if (!err && is_last && !stream->done)
+    {
+        POUCH_LOG_ERR("CBOR stream ended early");
+        err = -EBADMSG;
+    }
+
+    stream->err = err;
+
+    return err;
+}
@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#pragma once
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -33,6 +35,8 @@ struct zcbor_map_entry
     struct zcbor_map_key key;
     int (*decode)(zcbor_state_t *zsd, void *value);
     void *value;
+    /** The entry may be missing from the map */
+    bool optional;
 };
 
 /**
@@ -82,8 +86,8 @@ int zcbor_map_tstr_decode(zcbor_state_t *zsd, void *value);
 /**
  * @brief Decode CBOR map with specified entries
  *
- * Decode CBOR map with entries specified by @a entries. All specified entries need to exist in
- * processed CBOR map.
+ * Decode CBOR map with entries specified by @a entries. All specified entries, except optional
+ * ones, need to exist in processed CBOR map.
  *
  * @param[inout] zsd          The current state of the decoding
  * @param[in]    entries      Array with entries to be decoded
@@ -114,6 +118,25 @@ int zcbor_map_decode(zcbor_state_t *zsd, struct zcbor_map_entry *entries, size_t
         .value = _value,                           \
     }
 
+/**
+ * @brief Define optional CBOR map entry to be decoded, referenced by uint32_t key
+ *
+ * @param _u32     Map key
+ * @param _decode  Map value decode callback
+ * @param _value   Value passed to decode callback
+ */
+#define ZCBOR_U32_MAP_ENTRY_OPTIONAL(_u32, _decode, _value) \
+    {                                                       \
+        .key =                                              \
+            {                                               \
+                .type = ZCBOR_MAP_KEY_TYPE_U32,             \
+                .u32 = _u32,                                \
+            },                                              \
+        .decode = _decode,                                  \
+        .value = _value,                                    \
+        .optional = true,                                   \
+    }
+
 /**
  * @brief Define CBOR map entry to be decoded, referenced by literal string key
  *
@@ -132,6 +155,99 @@ int zcbor_map_decode(zcbor_state_t *zsd, struct zcbor_map_entry *entries, size_t
         .value = _value,                                                      \
     }
 
+/** Maximum nesting depth of lists and maps in a CBOR stream */
+#define ZCBOR_STREAM_MAX_DEPTH 8
+
+/** Return value of a step callback to receive a list or map as a single item */
+#define ZCBOR_STREAM_COLLECT 1
+
+enum zcbor_stream_event_type
+{
+    /** Complete data item */
+    ZCBOR_STREAM_ITEM,
+    /** Start of a list, its items follow */
+    ZCBOR_STREAM_LIST_START,
+    /** Start of a map, its keys and values follow */
+    ZCBOR_STREAM_MAP_START,
+    /** End of a list or map */
+    ZCBOR_STREAM_END,
+};
+
+struct zcbor_stream_event
+{
+    enum zcbor_stream_event_type type;
+    /** Nesting depth, 0 for the top level item */
+    size_t depth;
+    /** Encoded data item, for ZCBOR_STREAM_ITEM events */
+    const uint8_t *payload;
+    /** Length of @a payload */
+    size_t len;
+};
+
+/**
+ * @brief Step callback for a CBOR stream
+ *
+ * Called for every data item in the stream, in order. Items are only passed
+ * to the callback once they're complete. Lists and maps are passed as a
+ * start event, followed by their contents and an end event, unless the
+ * callback returns ZCBOR_STREAM_COLLECT from the start event. The whole list
+ * or map is then passed as a single ZCBOR_STREAM_ITEM event instead.
+ *
+ * @param[in] event      Stream event
+ * @param[in] user_data  User data passed to zcbor_stream_init()
+ *
+ * @retval  0                    Continue
+ * @retval  ZCBOR_STREAM_COLLECT Collect the list or map as a single item
+ * @retval <0                    POSIX error code, stops the stream
+ */
+typedef int (*zcbor_stream_step_cb)(const struct zcbor_stream_event *event, void *user_data);
+
+/**
+ * @brief Resumable CBOR decoder
+ *
+ * Decodes CBOR data that arrives in chunks, with constant memory. Data items
+ * that are split across chunks are carried over in a bounded buffer, so only
+ * single items (and collected lists or maps) must fit in
+ * CONFIG_GOLIOTH_ZCBOR_STREAM_CARRY_LEN bytes.
+ */
+struct zcbor_stream
+{
+    zcbor_stream_step_cb step;
+    void *user_data;
+    /** Items left in each open list or map */
+    uint32_t remaining[ZCBOR_STREAM_MAX_DEPTH];
+    size_t depth;
+    bool collecting;
+    bool done;
+    int err;
+    size_t carry_len;
+    uint8_t carry[CONFIG_GOLIOTH_ZCBOR_STREAM_CARRY_LEN];
+};
+
+/**
+ * @brief Initialize a CBOR stream
+ *
+ * @param[out] stream     Stream to initialize
+ * @param[in]  step       Callback for the data items in the stream
+ * @param[in]  user_data  User data passed to @a step
+ */
+void zcbor_stream_init(struct zcbor_stream *stream, zcbor_stream_step_cb step, void *user_data);
+
+/**
+ * @brief Feed the next chunk of a CBOR stream
+ *
+ * @param[inout] stream   The stream
+ * @param[in]    data     Chunk of CBOR data
+ * @param[in]    len      Length of @a data
+ * @param[in]    is_last  Whether this is the last chunk of the stream
+ *
+ * @retval  0       On success
+ * @retval -EBADMSG Malformed CBOR, or the stream ended before the top level item
+ * @retval -ENOMEM  A data item doesn't fit in the carry buffer, or is nested too deep
+ * @retval <0       Other error returned from the step callback
+ */
+int zcbor_stream_feed(struct zcbor_stream *stream, const void *data, size_t len, bool is_last);
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,11 +24,13 @@
  * See @ref content_types.
  *
  * @param stream_id Stream ID (0 if not a stream).
- * @param path The path of the entry.
+ * @param path The path of the entry. Not NULL terminated, and only valid during the callback.
+ * @param path_len The length of the path.
  * @param content_type The content type of the entry.
  */
 typedef void (*pouch_downlink_start_cb)(unsigned int stream_id,
                                         const char *path,
+                                        size_t path_len,
                                         uint16_t content_type);
 
 /**
@@ -44,6 +46,46 @@ typedef void (*pouch_downlink_data_cb)(unsigned int stream_id,
                                        size_t len,
                                        bool is_last);
 
+/** Largest entry fragment or path passed to a queued handler in a single callback */
+#define POUCH_DOWNLINK_EVENT_DATA_MAX \
+    ((CONFIG_POUCH_BLOCK_SIZE) > UINT8_MAX ? (CONFIG_POUCH_BLOCK_SIZE) : UINT8_MAX)
+
+/** Copy of a downlink callback, pending in a handler queue. Internal to Pouch. */
+struct pouch_downlink_event
+{
+    unsigned int stream_id;
+    bool is_start;
+    bool is_last;
+    uint16_t content_type;
+    size_t len;
+    /** Entry data, or the path for start events */
+    uint8_t data[POUCH_DOWNLINK_EVENT_DATA_MAX];
+};
+
+/**
+ * Queue for running a downlink handler on its own work queue.
+ *
+ * Use @ref POUCH_DOWNLINK_HANDLER_QUEUED to define a handler with a queue.
+ */
+struct pouch_downlink_handler_queue
+{
+    /** Work queue to run the handler on, or NULL for the shared handler work queue */
+    pouch_work_q_t *work_queue;
+    /** Events that can be pending at the same time */
+    struct pouch_downlink_event *events;
+    /** Storage for the pending and the free event queues, each @ref depth pointers long */
+    uint8_t *buf;
+    uint8_t *free_buf;
+    /** Number of entries in @ref events */
+    size_t depth;
+
+    /* Internal state, initialized by Pouch */
+    pouch_msgq_t pending;
+    pouch_msgq_t free;
+    pouch_work_t work;
+    const struct pouch_downlink_handler *handler;
+};
+
 /**
  * Pouch event handler
  *
@@ -54,6 +96,8 @@ struct pouch_downlink_handler
 {
     pouch_downlink_start_cb start_cb;
     pouch_downlink_data_cb data_cb;
+    /** Queue for running the callbacks outside the downlink thread, or NULL to run them inline */
+    struct pouch_downlink_handler_queue *queue;
 };
 
 /**
@@ -67,3 +111,42 @@ struct pouch_downlink_handler
     static const POUCH_STRUCT_SECTION_ITERABLE(     \
         pouch_downlink_handler,                     \
         _pouch_downlink_handler_##_callback) = {.start_cb = _start_cb, .data_cb = _data_cb};
+
+/**
+ * Register a downlink handler that runs on its own work queue
+ *
+ * The callbacks get a copy of the downlink data, and run on @p _work_queue
+ * instead of the downlink thread, so a slow handler doesn't delay the other
+ * handlers. Up to @p _depth callbacks may be pending for the handler, each in
+ * a statically allocated event of POUCH_DOWNLINK_EVENT_DATA_MAX bytes. When
+ * all events are pending, the downlink waits for the handler to catch up, so
+ * the handler always gets every callback, in order.
+ *
+ * @p _work_queue must be started by the application, and must not be a Pouch
+ * work queue. Pass NULL to share the work queue enabled by
+ * CONFIG_POUCH_DOWNLINK_HANDLER_WORK_QUEUE with other handlers.
+ *
+ * @param _name Name of the handler
+ * @param _start_cb The callback function to be called when the downlink pouch entry/stream starts
+ * @param _data_cb The callback function to be called when the downlink pouch entry/stream is
+ * reassembled
+ * @param _work_queue Pointer to the work queue to run the callbacks on, or NULL
+ * @param _depth Maximum number of pending callbacks
+ */
+#define POUCH_DOWNLINK_HANDLER_QUEUED(_name, _start_cb, _data_cb, _work_queue, _depth)   \
+    static struct pouch_downlink_event _pouch_downlink_handler_events_##_name[_depth];   \
+    static void *_pouch_downlink_handler_buf_##_name[_depth];                            \
+    static void *_pouch_downlink_handler_free_buf_##_name[_depth];                       \
+    static struct pouch_downlink_handler_queue _pouch_downlink_handler_queue_##_name = { \
+        .work_queue = _work_queue,                                                       \
+        .events = _pouch_downlink_handler_events_##_name,                                \
+        .buf = (uint8_t *) _pouch_downlink_handler_buf_##_name,                          \
+        .free_buf = (uint8_t *) _pouch_downlink_handler_free_buf_##_name,                \
+        .depth = _depth,                                                                 \
+    };                                                                                   \
+    static const POUCH_STRUCT_SECTION_ITERABLE(pouch_downlink_handler,                   \
+                                               _pouch_downlink_handler_##_name) = {      \
+        .start_cb = _start_cb,                                                           \
+        .data_cb = _data_cb,                                                             \
+        .queue = &_pouch_downlink_handler_queue_##_name,                                 \
+    }
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <zephyr/device.h>
+
+/** Serial gateway end callback */
+typedef void (*pouch_gateway_uart_end_t)(const struct device *uart);
+
+/**
+ * Start a Pouch gateway session with the device on the other end of a UART.
+ *
+ * Reads the device's info, provisions certificates if needed, and then transfers the uplink and
+ * downlink. The UART must support the async API, and should be dedicated to Pouch.
+ *
+ * @param uart The UART device.
+ * @param callback Callback to call when the session has finished.
+ *
+ * @retval -EBUSY A session is already in progress.
+ */
+int pouch_gateway_uart_start(const struct device *uart, pouch_gateway_uart_end_t callback);
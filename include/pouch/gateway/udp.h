@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <zephyr/net/socket.h>
+
+/** UDP gateway end callback, called at the end of each session */
+typedef void (*pouch_gateway_udp_end_t)(const struct sockaddr *peer);
+
+/**
+ * Start serving Pouch devices over UDP.
+ *
+ * Listens on CONFIG_POUCH_UDP_PORT, and starts a session with each device that requests a sync,
+ * up to CONFIG_POUCH_GATEWAY_UDP_MAX_SESSIONS devices at a time.
+ *
+ * @param callback Callback to call when a session has finished.
+ *
+ * @retval -EALREADY The gateway is already listening.
+ */
+int pouch_gateway_udp_start(pouch_gateway_udp_end_t callback);
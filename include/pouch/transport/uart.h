@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <zephyr/device.h>
+
+/**
+ * Start serving Pouch on a UART.
+ *
+ * The device answers a Pouch gateway on the other end of the UART, using COBS framed SAR packets.
+ * The UART must support the async API, and should be dedicated to Pouch.
+ *
+ * @param uart The UART device.
+ *
+ * @return 0 on success, or a negative error code.
+ */
+int pouch_uart_start(const struct device *uart);
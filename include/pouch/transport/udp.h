@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+/**
+ * Request a Pouch sync over UDP.
+ *
+ * Opens the socket to the gateway at CONFIG_POUCH_UDP_GATEWAY_ADDR on the first call, and asks
+ * the gateway to start a session with the device. Call it again to request another session.
+ *
+ * The UDP transport doesn't recover lost control packets, and is meant for local links, such as
+ * loopback between native_sim instances.
+ *
+ * @return 0 on success, or a negative error code.
+ */
+int pouch_udp_start(void);
@@ -31,5 +31,19 @@ enum pouch_result pouch_uplink_fill(struct pouch_uplink *uplink, uint8_t *dst, s
 /** Get the error status of the uplink */
 int pouch_uplink_error(struct pouch_uplink *uplink);
 
+/**
+ * Confirm delivery of uplink data.
+ *
+ * Transports call this when the receiving end has acknowledged data returned by
+ * @ref pouch_uplink_fill. If the transfer is interrupted, the pouch resumes from the first
+ * unconfirmed block in the next uplink session. Has no effect unless
+ * CONFIG_POUCH_UPLINK_RESUME is enabled.
+ *
+ * @param uplink Uplink session
+ * @param len Number of bytes confirmed since the previous call, or SIZE_MAX to confirm all data
+ * that has been passed to the transport.
+ */
+void pouch_uplink_confirm(struct pouch_uplink *uplink, size_t len);
+
 /** Finish the uplink session */
 void pouch_uplink_finish(struct pouch_uplink *uplink);
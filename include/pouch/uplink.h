@@ -28,7 +28,8 @@ typedef void (*pouch_uplink_handler_t)(void);
  * uplink is started.
  *
  * The pouch uplink will be closed once all uplink handlers have been called,
- * and all streams are closed.
+ * all holds are released (see @ref pouch_uplink_hold()), and all streams are
+ * closed.
  */
 #define POUCH_UPLINK_HANDLER(handler)                                  \
     static const POUCH_TYPE_SECTION_ITERABLE(pouch_uplink_handler_t,   \
@@ -56,6 +57,40 @@ int pouch_uplink_entry_write(const char *path,
                              size_t len,
                              pouch_timeout_t timeout);
 
+/**
+ * Keep the pouch of the current uplink session open.
+ *
+ * The pouch is normally closed right after the uplink handlers have run. A
+ * hold keeps it open after that, so entries can still be added, e.g. replies
+ * to requests received in the downlink of the same session. Each successful
+ * call must be matched by a call to @ref pouch_uplink_release(). The pouch
+ * is closed anyway if the holds aren't released within
+ * CONFIG_POUCH_UPLINK_HOLD_TIMEOUT_MS after the uplink handlers have run.
+ *
+ * @retval 0 The pouch is held open
+ * @retval -ENODEV There is no uplink session
+ * @retval -EALREADY The pouch is already being closed
+ */
+int pouch_uplink_hold(void);
+
+/**
+ * Release a hold taken with @ref pouch_uplink_hold().
+ *
+ * The pouch is closed once the last hold is released.
+ */
+void pouch_uplink_release(void);
+
+/**
+ * Get the ID of the current uplink session.
+ *
+ * The ID changes every time an uplink session ends. Holders can compare it
+ * against the ID at the time of @ref pouch_uplink_hold() to avoid releasing a
+ * hold in a later session, as holds are dropped when their session ends.
+ *
+ * @return The current uplink session ID.
+ */
+uint32_t pouch_uplink_session_id(void);
+
 /**
  * Close the current uplink session by finalizing the open pouch.
  *
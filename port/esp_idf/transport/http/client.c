@@ -399,6 +399,7 @@ static int send_pouch_uplink(struct sync_context *sync)
     else
     {
         ESP_LOGI(TAG, "Sync successful: %d", status_code);
+        pouch_uplink_confirm(sync->uplink, SIZE_MAX);
     }
 
     esp_http_client_close(sync->client);
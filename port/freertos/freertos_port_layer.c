@@ -200,6 +200,11 @@ pouch_timeout_t pouch_timepoint_timeout(pouch_timepoint_t tp)
     return tp;
 }
 
+uint32_t pouch_uptime_ms(void)
+{
+    return (uint32_t) (((uint64_t) xTaskGetTickCount() * 1000) / configTICK_RATE_HZ);
+}
+
 /*--------------------------------------------------
  * Linked List
  *------------------------------------------------*/
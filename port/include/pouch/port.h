@@ -522,6 +522,8 @@ typedef pouch_timepoint_internal_t pouch_timepoint_t;
 pouch_timepoint_t pouch_timepoint_get(pouch_timeout_t timeout);
 /** Get a timeout value from a timepoint */
 pouch_timeout_t pouch_timepoint_timeout(pouch_timepoint_t tp);
+/** Get the time since boot in milliseconds. Wraps around after ~49 days. */
+uint32_t pouch_uptime_ms(void);
 
 /*--------------------------------------------------
  * Message Queue
@@ -560,6 +560,9 @@ static int pouch_coap_sync_block2_cb(const uint8_t *data,
     return 0;
 }
 
+/* Length of the last Block1 chunk, confirmed once the server requests the next one */
+static size_t uplink_chunk_len;
+
 /*
  * Stream a Block1 chunk from the pouch uplink into @p buf.
  *
@@ -577,6 +580,10 @@ static int pouch_uplink_chunk_cb(uint8_t *buf,
     size_t total = 0;
     int err;
 
+    /* The server acknowledged the previous Block1 chunk before requesting the next one */
+    pouch_uplink_confirm(uplink, uplink_chunk_len);
+    uplink_chunk_len = 0;
+
     while (total < buf_size)
     {
         size_t requested = buf_size - total;
@@ -593,6 +600,7 @@ static int pouch_uplink_chunk_cb(uint8_t *buf,
         {
             *chunk_len = total;
             *is_last = true;
+            uplink_chunk_len = total;
             return 0;
         }
 
@@ -609,6 +617,7 @@ static int pouch_uplink_chunk_cb(uint8_t *buf,
 
     *chunk_len = total;
     *is_last = false;
+    uplink_chunk_len = total;
     return 0;
 }
 
@@ -625,11 +634,17 @@ static int pouch_coap_send_uplink(void)
         return -ENOMEM;
     }
 
+    uplink_chunk_len = 0;
+
     err = pouch_coap_blockwise_post_streaming(COAP_PATH_POUCH,
                                               pouch_uplink_chunk_cb,
                                               uplink,
                                               pouch_coap_sync_block2_cb,
                                               &state);
+    if (!err)
+    {
+        pouch_uplink_confirm(uplink, SIZE_MAX);
+    }
 
     pouch_uplink_finish(uplink);
     pouch_downlink_finish();
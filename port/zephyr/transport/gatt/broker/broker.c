@@ -5,11 +5,14 @@
  */
 #include "types.h"
 #include "discover.h"
+#include "link.h"
 #include "../common.h"
 #include "transport/sar/receiver.h"
 #include "transport/sar/sender.h"
 #include "transport/endpoints/broker/endpoints.h"
 
+#include <zephyr/net_buf.h>
+
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(broker, CONFIG_POUCH_GATEWAY_GATT_LOG_LEVEL);
 
@@ -43,15 +46,25 @@ static struct broker_bt_gatt_device devices[CONFIG_BT_MAX_CONN] = {
 };
 
 static void discover_complete(struct broker_bt_gatt_device *device, bool success);
+static void link_ready(struct broker_bt_gatt_device *device);
 static void sub_complete(struct broker_bt_gatt_device *device, enum broker_bt_attr attr);
 static void link_complete(struct broker_bt_gatt_device *device, enum broker_bt_attr attr);
 static void close_subscriptions(struct broker_bt_gatt_device *device);
+#if CONFIG_POUCH_GATEWAY_GATT_L2CAP
+static void l2cap_resume(struct k_work *work);
+#endif
 
 static void broker_locks_init(void)
 {
     for (size_t i = 0; i < CONFIG_BT_MAX_CONN; i++)
     {
         pouch_mutex_init(&devices[i].lock);
+#if CONFIG_POUCH_GATEWAY_GATT_L2CAP
+        for (enum broker_bt_attr attr = 0; attr < BROKER_BT_ATTRS; attr++)
+        {
+            k_work_init(&devices[i].chars[attr].l2cap.resume, l2cap_resume);
+        }
+#endif
     }
 }
 POUCH_APPLICATION_STARTUP_HOOK(broker_locks_init);
@@ -76,6 +89,7 @@ struct broker_bt_gatt_device *broker_bt_gatt_device(struct bt_conn *conn)
 static void finish(struct broker_bt_gatt_device *device)
 {
     close_subscriptions(device);
+    gateway_bt_link_done(device);
 
     if (device->callback && device->conn)
     {
@@ -92,7 +106,14 @@ static int bearer_send(struct pouch_bearer *bearer, const uint8_t *buf, size_t l
         return -ENOENT;
     }
 
-    return bt_gatt_write_without_response(device->conn, c->handle.value, buf, len, false);
+    int err = bt_gatt_write_without_response(device->conn, c->handle.value, buf, len, false);
+    if (err)
+    {
+        return err;
+    }
+
+    device->stats.tx_bytes += len;
+    return 0;
 }
 
 static void bearer_close(struct pouch_bearer *bearer, bool success)
@@ -224,6 +245,8 @@ static uint8_t notify_cb(struct bt_conn *conn,
         return BT_GATT_ITER_STOP;
     }
 
+    device->stats.rx_bytes += length;
+
     int err = recv(c, data, length);
     if (err)
     {
@@ -289,6 +312,250 @@ static int subscribe(struct broker_bt_gatt_device *device,
     return 0;
 }
 
+#if CONFIG_POUCH_GATEWAY_GATT_L2CAP
+
+enum l2cap_state
+{
+    L2CAP_IDLE,
+    L2CAP_CONNECTING,
+    L2CAP_CONNECTED,
+    L2CAP_CLOSING,
+};
+
+static void l2cap_tx_buf_destroy(struct net_buf *buf);
+
+NET_BUF_POOL_FIXED_DEFINE(l2cap_tx_pool,
+                          CONFIG_POUCH_GATEWAY_GATT_L2CAP_TX_BUFS,
+                          BT_L2CAP_SDU_BUF_SIZE(CONFIG_POUCH_GATEWAY_GATT_L2CAP_MTU),
+                          CONFIG_BT_CONN_TX_USER_DATA_SIZE,
+                          l2cap_tx_buf_destroy);
+// One RX buffer for the uplink and downlink of each device:
+NET_BUF_POOL_FIXED_DEFINE(l2cap_rx_pool,
+                          CONFIG_BT_MAX_CONN * 2,
+                          BT_L2CAP_SDU_BUF_SIZE(CONFIG_POUCH_GATEWAY_GATT_L2CAP_MTU),
+                          8,
+                          NULL);
+
+static void l2cap_tx_buf_destroy(struct net_buf *buf)
+{
+    net_buf_destroy(buf);
+
+    // The pool is shared, so any channel that ran out of buffers can proceed:
+    for (size_t i = 0; i < CONFIG_BT_MAX_CONN; i++)
+    {
+        for (enum broker_bt_attr attr = 0; attr < BROKER_BT_ATTRS; attr++)
+        {
+            struct characteristic *c = &devices[i].chars[attr];
+            if (atomic_cas(&c->l2cap.blocked, true, false))
+            {
+                k_work_submit(&c->l2cap.resume);
+            }
+        }
+    }
+}
+
+static inline struct characteristic *l2cap_characteristic(struct bt_l2cap_chan *chan)
+{
+    return CONTAINER_OF(chan, struct characteristic, l2cap.chan.chan);
+}
+
+static int l2cap_bearer_send(struct pouch_bearer *bearer, const uint8_t *buf, size_t len)
+{
+    struct characteristic *c = CONTAINER_OF(bearer, struct characteristic, bearer);
+    struct broker_bt_gatt_device *device = device_from_characteristic(c);
+    if (device == NULL)
+    {
+        return -ENOENT;
+    }
+
+    // Mark the channel as blocked before allocating, so a buffer released in between isn't missed:
+    atomic_set(&c->l2cap.blocked, true);
+    struct net_buf *tx = net_buf_alloc(&l2cap_tx_pool, K_NO_WAIT);
+    if (tx == NULL)
+    {
+        return -EAGAIN;
+    }
+
+    atomic_set(&c->l2cap.blocked, false);
+
+    net_buf_reserve(tx, BT_L2CAP_SDU_CHAN_SEND_RESERVE);
+    net_buf_add_mem(tx, buf, len);
+
+    int err = bt_l2cap_chan_send(&c->l2cap.chan.chan, tx);
+    if (err < 0)
+    {
+        net_buf_unref(tx);
+        return err;
+    }
+
+    device->stats.tx_bytes += len;
+    return 0;
+}
+
+static void l2cap_bearer_close(struct pouch_bearer *bearer, bool success)
+{
+    struct characteristic *c = CONTAINER_OF(bearer, struct characteristic, bearer);
+
+    bearer_close(bearer, success);
+
+    // The disconnect reports the end of the transfer:
+    if (c->l2cap.state == L2CAP_CONNECTED)
+    {
+        bt_l2cap_chan_disconnect(&c->l2cap.chan.chan);
+    }
+}
+
+static void l2cap_resume(struct k_work *work)
+{
+    struct characteristic *c = CONTAINER_OF(work, struct characteristic, l2cap.resume);
+
+    if (c->l2cap.state == L2CAP_CONNECTED)
+    {
+        bearer_ready(&c->bearer);
+    }
+}
+
+static void l2cap_connected(struct bt_l2cap_chan *chan)
+{
+    struct characteristic *c = l2cap_characteristic(chan);
+
+    c->l2cap.state = L2CAP_CONNECTED;
+    c->bearer.maxlen = MIN(c->l2cap.chan.tx.mtu, CONFIG_POUCH_GATEWAY_GATT_L2CAP_MTU);
+
+    LOG_DBG("%p: L2CAP connected, MTU: %u", c, c->bearer.maxlen);
+
+    int err = open(c);
+    if (err)
+    {
+        LOG_ERR("Failed to open bearer");
+        bt_l2cap_chan_disconnect(chan);
+    }
+}
+
+static void l2cap_disconnected(struct bt_l2cap_chan *chan)
+{
+    struct characteristic *c = l2cap_characteristic(chan);
+    struct broker_bt_gatt_device *device = device_from_characteristic(c);
+    enum broker_bt_attr attr = c - device->chars;
+    enum l2cap_state state = c->l2cap.state;
+
+    c->l2cap.state = L2CAP_IDLE;
+    k_work_cancel(&c->l2cap.resume);
+
+    switch (state)
+    {
+        case L2CAP_CONNECTING:
+            // The device didn't accept the channel:
+            LOG_WRN("L2CAP channel rejected, falling back to GATT");
+            c->subscribed = false;
+            if (subscribe(device, attr, c->callback))
+            {
+                c->callback(device, attr);
+            }
+            break;
+        case L2CAP_CONNECTED:
+            LOG_DBG("%p: L2CAP disconnected", c);
+            close(c);
+            c->subscribed = false;
+            c->callback(device, attr);
+            break;
+        default:
+            // Closed along with the other subscriptions, which reported the end of the transfer.
+            break;
+    }
+}
+
+static struct net_buf *l2cap_alloc_buf(struct bt_l2cap_chan *chan)
+{
+    return net_buf_alloc(&l2cap_rx_pool, K_FOREVER);
+}
+
+static int l2cap_recv(struct bt_l2cap_chan *chan, struct net_buf *buf)
+{
+    struct characteristic *c = l2cap_characteristic(chan);
+    struct broker_bt_gatt_device *device = device_from_characteristic(c);
+
+    device->stats.rx_bytes += buf->len;
+
+    int err = recv(c, buf->data, buf->len);
+    if (err)
+    {
+        LOG_ERR("Recv failed: %d", err);
+        finish(device);
+    }
+
+    return 0;
+}
+
+static const struct bt_l2cap_chan_ops l2cap_ops = {
+    .connected = l2cap_connected,
+    .disconnected = l2cap_disconnected,
+    .alloc_buf = l2cap_alloc_buf,
+    .recv = l2cap_recv,
+};
+
+static int l2cap_connect(struct broker_bt_gatt_device *device,
+                         enum broker_bt_attr attr,
+                         uint16_t psm,
+                         broker_bt_gatt_char_done_t callback)
+{
+    struct characteristic *c = &device->chars[attr];
+
+    c->bearer.close = l2cap_bearer_close;
+    c->bearer.ready = bearer_ready;
+    c->bearer.send = l2cap_bearer_send;
+    c->bearer.ctx = &device->node;
+
+    c->l2cap.chan = (struct bt_l2cap_le_chan){
+        .chan.ops = &l2cap_ops,
+        .rx.mtu = CONFIG_POUCH_GATEWAY_GATT_L2CAP_MTU,
+    };
+    atomic_set(&c->l2cap.blocked, false);
+    c->l2cap.state = L2CAP_CONNECTING;
+    c->subscribed = true;
+    c->callback = callback;
+
+    int err = bt_l2cap_chan_connect(device->conn, &c->l2cap.chan.chan, psm);
+    if (err)
+    {
+        c->l2cap.state = L2CAP_IDLE;
+        c->subscribed = false;
+        return err;
+    }
+
+    return 0;
+}
+
+static void l2cap_close(struct characteristic *c)
+{
+    if (c->l2cap.state == L2CAP_CONNECTING || c->l2cap.state == L2CAP_CONNECTED)
+    {
+        c->l2cap.state = L2CAP_CLOSING;
+        bt_l2cap_chan_disconnect(&c->l2cap.chan.chan);
+    }
+}
+
+#endif
+
+/** Open the uplink or downlink, over L2CAP if the device supports it. */
+static int start_link(struct broker_bt_gatt_device *device, enum broker_bt_attr attr, uint16_t psm)
+{
+#if CONFIG_POUCH_GATEWAY_GATT_L2CAP
+    if (psm != 0)
+    {
+        int err = l2cap_connect(device, attr, psm, link_complete);
+        if (err == 0)
+        {
+            return 0;
+        }
+
+        LOG_WRN("L2CAP connect failed (%d), falling back to GATT", err);
+    }
+#endif
+
+    return subscribe(device, attr, link_complete);
+}
+
 static void close_subscriptions(struct broker_bt_gatt_device *device)
 {
     for (enum broker_bt_attr i = 0; i < BROKER_BT_ATTRS; i++)
@@ -296,6 +563,9 @@ static void close_subscriptions(struct broker_bt_gatt_device *device)
         struct characteristic *c = &device->chars[i];
         if (c->subscribed)
         {
+#if CONFIG_POUCH_GATEWAY_GATT_L2CAP
+            l2cap_close(c);
+#endif
             close(c);
             c->callback(device, i);
             c->subscribed = false;
@@ -345,6 +615,17 @@ static void discover_complete(struct broker_bt_gatt_device *device, bool success
         return;
     }
 
+    int err = gateway_bt_link_setup(device, link_ready);
+    if (err)
+    {
+        LOG_ERR("Link setup failed: %d", err);
+        finish(device);
+        return;
+    }
+}
+
+static void link_ready(struct broker_bt_gatt_device *device)
+{
     // Start by reading the info endpoint:
     int err = subscribe(device, BROKER_BT_ATTR_INFO, sub_complete);
     if (err)
@@ -397,13 +678,13 @@ static void sub_complete(struct broker_bt_gatt_device *device, enum broker_bt_at
     }
 
     // start link:
-    err = subscribe(device, BROKER_BT_ATTR_DOWNLINK, link_complete);
+    err = start_link(device, BROKER_BT_ATTR_DOWNLINK, device->node.l2cap_downlink_psm);
     if (err)
     {
         finish(device);
         return;
     }
-    err = subscribe(device, BROKER_BT_ATTR_UPLINK, link_complete);
+    err = start_link(device, BROKER_BT_ATTR_UPLINK, device->node.l2cap_uplink_psm);
     if (err)
     {
         finish(device);
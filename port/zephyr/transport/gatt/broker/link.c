@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "link.h"
+#include "types.h"
+#include "broker.h"
+
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/kernel.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(gatt_link, CONFIG_POUCH_GATEWAY_GATT_LOG_LEVEL);
+
+static void complete(struct broker_bt_gatt_device *device)
+{
+    LOG_DBG("Link ready, MTU: %u", bt_gatt_get_mtu(device->conn));
+
+    device->link.callback(device);
+}
+
+#if CONFIG_POUCH_GATEWAY_GATT_LINK_SETUP
+
+#define TRANSFER_PARAM                                                \
+    BT_LE_CONN_PARAM(CONFIG_POUCH_GATEWAY_GATT_TRANSFER_INTERVAL_MIN, \
+                     CONFIG_POUCH_GATEWAY_GATT_TRANSFER_INTERVAL_MAX, \
+                     0,                                               \
+                     CONFIG_POUCH_GATEWAY_GATT_SUPERVISION_TIMEOUT)
+#define IDLE_PARAM                                                  \
+    BT_LE_CONN_PARAM(CONFIG_POUCH_GATEWAY_GATT_IDLE_INTERVAL_MIN,   \
+                     CONFIG_POUCH_GATEWAY_GATT_IDLE_INTERVAL_MAX,   \
+                     0,                                             \
+                     CONFIG_POUCH_GATEWAY_GATT_SUPERVISION_TIMEOUT)
+
+static void request_phy(struct broker_bt_gatt_device *device)
+{
+#if CONFIG_BT_USER_PHY_UPDATE
+    int err = bt_conn_le_phy_update(device->conn, BT_CONN_LE_PHY_PARAM_2M);
+    if (err)
+    {
+        LOG_WRN("2M PHY request failed: %d", err);
+    }
+#endif
+}
+
+static void request_data_len(struct broker_bt_gatt_device *device)
+{
+#if CONFIG_BT_USER_DATA_LEN_UPDATE
+    int err = bt_conn_le_data_len_update(device->conn, BT_LE_DATA_LEN_PARAM_MAX);
+    if (err)
+    {
+        LOG_WRN("Data length request failed: %d", err);
+    }
+#endif
+}
+
+static void request_conn_param(struct broker_bt_gatt_device *device,
+                               const struct bt_le_conn_param *param)
+{
+    int err = bt_conn_le_param_update(device->conn, param);
+    if (err && err != -EALREADY)
+    {
+        LOG_WRN("Connection parameter request failed: %d", err);
+    }
+}
+
+static void mtu_exchanged(struct bt_conn *conn, uint8_t err, struct bt_gatt_exchange_params *params)
+{
+    struct broker_bt_gatt_device *device = broker_bt_gatt_device(conn);
+
+    if (err)
+    {
+        // The transfer can still proceed with the default MTU:
+        LOG_WRN("MTU exchange failed: %u", err);
+    }
+
+    complete(device);
+}
+
+#endif /* CONFIG_POUCH_GATEWAY_GATT_LINK_SETUP */
+
+int gateway_bt_link_setup(struct broker_bt_gatt_device *device,
+                          broker_bt_gatt_link_callback_t on_complete)
+{
+    device->link.callback = on_complete;
+    device->stats.start = k_uptime_get_32();
+    device->stats.rx_bytes = 0;
+    device->stats.tx_bytes = 0;
+
+#if CONFIG_POUCH_GATEWAY_GATT_LINK_SETUP
+    // These complete in the background, and only affect the throughput:
+    request_phy(device);
+    request_data_len(device);
+    request_conn_param(device, TRANSFER_PARAM);
+
+    // The MTU decides the size of the bearer packets, so it must be settled before subscribing:
+    device->link.mtu_params.func = mtu_exchanged;
+    int err = bt_gatt_exchange_mtu(device->conn, &device->link.mtu_params);
+    if (err == -EALREADY)
+    {
+        complete(device);
+        return 0;
+    }
+
+    return err;
+#else
+    complete(device);
+    return 0;
+#endif
+}
+
+void gateway_bt_link_done(struct broker_bt_gatt_device *device)
+{
+    if (device->conn == NULL)
+    {
+        return;
+    }
+
+    uint32_t elapsed = k_uptime_get_32() - device->stats.start;
+    uint32_t bytes = device->stats.rx_bytes + device->stats.tx_bytes;
+
+    LOG_INF("rx: %u B, tx: %u B in %u ms (%u B/s)",
+            device->stats.rx_bytes,
+            device->stats.tx_bytes,
+            elapsed,
+            elapsed ? (uint32_t) (((uint64_t) bytes * 1000) / elapsed) : 0);
+
+#if CONFIG_POUCH_GATEWAY_GATT_LINK_SETUP
+    request_conn_param(device, IDLE_PARAM);
+#endif
+}
+
+#if CONFIG_POUCH_GATEWAY_GATT_LINK_SETUP
+
+#if CONFIG_BT_USER_PHY_UPDATE
+static void on_phy_updated(struct bt_conn *conn, struct bt_conn_le_phy_info *param)
+{
+    LOG_DBG("PHY: tx: 0x%x, rx: 0x%x", param->tx_phy, param->rx_phy);
+}
+#endif
+
+#if CONFIG_BT_USER_DATA_LEN_UPDATE
+static void on_data_len_updated(struct bt_conn *conn, struct bt_conn_le_data_len_info *info)
+{
+    LOG_DBG("Data length: tx: %u, rx: %u", info->tx_max_len, info->rx_max_len);
+}
+#endif
+
+static void on_param_updated(struct bt_conn *conn,
+                             uint16_t interval,
+                             uint16_t latency,
+                             uint16_t timeout)
+{
+    LOG_DBG("Connection interval: %u, latency: %u, timeout: %u", interval, latency, timeout);
+}
+
+BT_CONN_CB_DEFINE(gateway_link_listener) = {
+#if CONFIG_BT_USER_PHY_UPDATE
+    .le_phy_updated = on_phy_updated,
+#endif
+#if CONFIG_BT_USER_DATA_LEN_UPDATE
+    .le_data_len_updated = on_data_len_updated,
+#endif
+    .le_param_updated = on_param_updated,
+};
+
+#endif
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include "types.h"
+
+/**
+ * Request link parameters for a fast transfer: 2M PHY, maximum data length, largest ATT MTU and a
+ * short connection interval. The requests are best effort, and @p on_complete is called once the
+ * MTU exchange is done, whether the peer accepted the other parameters or not.
+ */
+int gateway_bt_link_setup(struct broker_bt_gatt_device *device,
+                          broker_bt_gatt_link_callback_t on_complete);
+
+/** Relax the connection interval after a transfer, and report the throughput. */
+void gateway_bt_link_done(struct broker_bt_gatt_device *device);
@@ -10,6 +10,7 @@
 #include <pouch/gateway/bt/connect.h>
 #include <pouch/port.h>
 #include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/l2cap.h>
 
 struct broker_bt_gatt_device;
 
@@ -34,6 +35,7 @@ typedef void (*broker_bt_gatt_char_done_t)(struct broker_bt_gatt_device *device,
                                            enum broker_bt_attr attr);
 typedef void (*broker_bt_gatt_discover_callback_t)(struct broker_bt_gatt_device *device,
                                                    bool success);
+typedef void (*broker_bt_gatt_link_callback_t)(struct broker_bt_gatt_device *device);
 
 /** BLE GATT Pouch characteristic, as seen from the GATT client's side */
 struct characteristic
@@ -48,6 +50,18 @@ struct characteristic
         uint16_t ccc;
     } handle;
 
+#if CONFIG_POUCH_GATEWAY_GATT_L2CAP
+    /** L2CAP channel, used instead of the GATT characteristic if the device supports it */
+    struct
+    {
+        struct bt_l2cap_le_chan chan;
+        struct k_work resume;
+        /** The transport is waiting for a TX buffer */
+        atomic_t blocked;
+        uint8_t state;
+    } l2cap;
+#endif
+
     broker_bt_gatt_char_done_t callback;
     bool subscribed;
     enum characteristic_type type;
@@ -68,6 +82,18 @@ struct broker_bt_gatt_device
         struct bt_gatt_discover_params params;
         broker_bt_gatt_discover_callback_t callback;
     } discover;
+    struct
+    {
+        struct bt_gatt_exchange_params mtu_params;
+        broker_bt_gatt_link_callback_t callback;
+    } link;
+    /** Throughput counters for the current connection */
+    struct
+    {
+        uint32_t start;
+        uint32_t rx_bytes;
+        uint32_t tx_bytes;
+    } stats;
     struct pouch_gateway_node_info node;
     struct bt_conn *conn;
     pouch_gateway_bt_end_t callback;
@@ -56,6 +56,12 @@ struct pouch_characteristic
     const struct bt_gatt_attr *attr;
     struct bt_conn *conn;
 
+    /** Notifications that haven't completed yet */
+    atomic_t in_flight;
+    /** The transport is waiting for a notification to complete */
+    atomic_t blocked;
+    struct k_work resume;
+
     // higher level handler:
     enum characteristic_type type;
     union
@@ -65,14 +71,61 @@ struct pouch_characteristic
     };
 };
 
+static void notify_sent(struct bt_conn *conn, void *user_data)
+{
+    struct pouch_characteristic *c = user_data;
+
+    atomic_dec(&c->in_flight);
+    if (atomic_cas(&c->blocked, true, false))
+    {
+        // Resume outside of the Bluetooth stack's context:
+        k_work_submit(&c->resume);
+    }
+}
+
 static int bearer_send(struct pouch_bearer *bearer, const uint8_t *buf, size_t len)
 {
     struct pouch_characteristic *c = CONTAINER_OF(bearer, struct pouch_characteristic, bearer);
 
+    if (atomic_get(&c->in_flight) >= CONFIG_POUCH_TRANSPORT_GATT_NOTIFY_IN_FLIGHT)
+    {
+        atomic_set(&c->blocked, true);
+
+        // A notification may have completed before we were marked as blocked:
+        if (atomic_get(&c->in_flight) >= CONFIG_POUCH_TRANSPORT_GATT_NOTIFY_IN_FLIGHT)
+        {
+            return -EAGAIN;
+        }
+
+        atomic_set(&c->blocked, false);
+    }
+
+    atomic_inc(&c->in_flight);
+
     LOG_DBG("%p: tx: %u", c, len);
     LOG_HEXDUMP_DBG(buf, len, "tx");
 
-    return bt_gatt_notify(c->conn, c->attr, buf, len);
+    struct bt_gatt_notify_params params = {
+        .attr = c->attr,
+        .data = buf,
+        .len = len,
+        .func = notify_sent,
+        .user_data = c,
+    };
+
+    int err = bt_gatt_notify_cb(c->conn, &params);
+    if (err)
+    {
+        atomic_dec(&c->in_flight);
+        if (err == -ENOMEM && atomic_get(&c->in_flight) > 0)
+        {
+            // Out of TX buffers, wait for the next notification to complete:
+            atomic_set(&c->blocked, true);
+            return -EAGAIN;
+        }
+    }
+
+    return err;
 }
 
 static void bearer_close(struct pouch_bearer *bearer, bool success)
@@ -100,6 +153,16 @@ static void bearer_ready(struct pouch_bearer *bearer)
     }
 }
 
+static void resume(struct k_work *work)
+{
+    struct pouch_characteristic *c = CONTAINER_OF(work, struct pouch_characteristic, resume);
+
+    if (c->conn != NULL)
+    {
+        bearer_ready(&c->bearer);
+    }
+}
+
 static struct pouch_characteristic *pouch_characteristic(const struct bt_gatt_attr *attr)
 {
     return attr->user_data;
@@ -189,6 +252,9 @@ static ssize_t ccc_write(struct bt_conn *conn, const struct bt_gatt_attr *ccc_at
     c->conn = conn;
     c->attr = attr;
     c->bearer.maxlen = mtu - BT_ATT_OVERHEAD;
+    atomic_set(&c->in_flight, 0);
+    atomic_set(&c->blocked, false);
+    k_work_init(&c->resume, resume);
 
     int err = open(c);
     if (err)
@@ -210,6 +276,7 @@ static void ccc_changed(const struct bt_gatt_attr *ccc_attr, uint16_t value)
 
     LOG_DBG("%p: close", c);
     close(c);
+    k_work_cancel(&c->resume);
 
     c->conn = NULL;
     c->attr = NULL;
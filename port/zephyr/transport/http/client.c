@@ -172,6 +172,12 @@ static int pouch_http_response_callback(struct http_response *rsp,
 
     if (0 == ctx->rcv_offset)
     {
+        // The gateway received the whole uplink, so the pouch won't have to be resumed:
+        if (ctx->uplink)
+        {
+            pouch_uplink_confirm(ctx->uplink, SIZE_MAX);
+        }
+
         pouch_downlink_start();
     }
 
@@ -308,10 +314,11 @@ static int pouch_http_payload_callback(int sock, struct http_request *req, void
     payload_size += ret;
 
     LOG_INF("Uplink chunks sent: %zu bytes", payload_size);
+
+    // The uplink is confirmed by the response, and finished once the request completes:
     err = 0;
 
 finish_with_error:
-    pouch_uplink_finish(sync->uplink);
     return err;
 }
 
@@ -529,6 +536,10 @@ static int send_pouch_uplink(struct sync_context *sync)
     };
 
     int ret = http_client_req(_sock, &req, HTTP_TIMEOUT_MS, sync);
+
+    pouch_uplink_finish(sync->uplink);
+    sync->uplink = NULL;
+
     if (ret < 0)
     {
         LOG_ERR("Failed to send HTTP request: %d", ret);
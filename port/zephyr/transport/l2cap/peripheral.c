@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/l2cap.h>
+#include <zephyr/net_buf.h>
+
+#include "transport/sar/receiver.h"
+#include "transport/sar/sender.h"
+#include "transport/endpoints/device/endpoints.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(pouch_l2cap, CONFIG_POUCH_L2CAP_LOG_LEVEL);
+
+#if IS_ENABLED(CONFIG_POUCH_TRANSPORT_GATT_PERM_AUTHEN)
+#define SEC_LEVEL BT_SECURITY_L3
+#else
+#define SEC_LEVEL BT_SECURITY_L2
+#endif
+
+#define CHANNEL_INIT(_psm, _type, _field, _handler)                   \
+    {                                                                 \
+        .server =                                                     \
+            {                                                         \
+                .psm = (_psm),                                        \
+                .sec_level = SEC_LEVEL,                               \
+                .accept = accept,                                     \
+            },                                                        \
+        .chan.chan.ops = &chan_ops,                                   \
+        .bearer =                                                     \
+            {                                                         \
+                .send = bearer_send,                                  \
+                .close = bearer_close,                                \
+                .ready = bearer_ready,                                \
+            },                                                        \
+        .type = (_type),                                              \
+        ._field = &((struct pouch_##_field){.endpoint = (_handler)}), \
+    }
+
+enum channel_type
+{
+    CHANNEL_RECEIVER,
+    CHANNEL_SENDER,
+};
+
+/** L2CAP channel carrying a single Pouch endpoint */
+struct pouch_channel
+{
+    struct bt_l2cap_server server;
+    struct bt_l2cap_le_chan chan;
+    struct pouch_bearer bearer;
+
+    /** The transport is waiting for a TX buffer */
+    atomic_t blocked;
+    struct k_work resume;
+
+    // higher level handler:
+    enum channel_type type;
+    union
+    {
+        struct pouch_sender *sender;
+        struct pouch_receiver *receiver;
+    };
+};
+
+static void tx_buf_destroy(struct net_buf *buf);
+
+NET_BUF_POOL_FIXED_DEFINE(tx_pool,
+                          CONFIG_POUCH_TRANSPORT_L2CAP_TX_BUFS,
+                          BT_L2CAP_SDU_BUF_SIZE(CONFIG_POUCH_TRANSPORT_L2CAP_MTU),
+                          CONFIG_BT_CONN_TX_USER_DATA_SIZE,
+                          tx_buf_destroy);
+// One RX buffer for each channel:
+NET_BUF_POOL_FIXED_DEFINE(rx_pool,
+                          2,
+                          BT_L2CAP_SDU_BUF_SIZE(CONFIG_POUCH_TRANSPORT_L2CAP_MTU),
+                          8,
+                          NULL);
+
+static int accept(struct bt_conn *conn,
+                  struct bt_l2cap_server *server,
+                  struct bt_l2cap_chan **chan);
+static const struct bt_l2cap_chan_ops chan_ops;
+static int bearer_send(struct pouch_bearer *bearer, const uint8_t *buf, size_t len);
+static void bearer_close(struct pouch_bearer *bearer, bool success);
+static void bearer_ready(struct pouch_bearer *bearer);
+
+static struct pouch_channel channels[] = {
+    CHANNEL_INIT(CONFIG_POUCH_TRANSPORT_L2CAP_UPLINK_PSM,
+                 CHANNEL_SENDER,
+                 sender,
+                 &pouch_device_endpoint_uplink),
+    CHANNEL_INIT(CONFIG_POUCH_TRANSPORT_L2CAP_DOWNLINK_PSM,
+                 CHANNEL_RECEIVER,
+                 receiver,
+                 &pouch_device_endpoint_downlink),
+};
+
+static void tx_buf_destroy(struct net_buf *buf)
+{
+    net_buf_destroy(buf);
+
+    // The pool is shared, so any channel that ran out of buffers can proceed:
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        if (atomic_cas(&channels[i].blocked, true, false))
+        {
+            k_work_submit(&channels[i].resume);
+        }
+    }
+}
+
+static int bearer_send(struct pouch_bearer *bearer, const uint8_t *buf, size_t len)
+{
+    struct pouch_channel *c = CONTAINER_OF(bearer, struct pouch_channel, bearer);
+
+    // Mark the channel as blocked before allocating, so a buffer released in between isn't missed:
+    atomic_set(&c->blocked, true);
+    struct net_buf *tx = net_buf_alloc(&tx_pool, K_NO_WAIT);
+    if (tx == NULL)
+    {
+        return -EAGAIN;
+    }
+
+    atomic_set(&c->blocked, false);
+
+    LOG_DBG("%p: tx: %u", c, len);
+
+    net_buf_reserve(tx, BT_L2CAP_SDU_CHAN_SEND_RESERVE);
+    net_buf_add_mem(tx, buf, len);
+
+    int err = bt_l2cap_chan_send(&c->chan.chan, tx);
+    if (err < 0)
+    {
+        net_buf_unref(tx);
+        return err;
+    }
+
+    return 0;
+}
+
+static void bearer_close(struct pouch_bearer *bearer, bool success)
+{
+    struct pouch_channel *c = CONTAINER_OF(bearer, struct pouch_channel, bearer);
+
+    LOG_DBG("%p: close (%s)", c, success ? "success" : "fail");
+    bt_l2cap_chan_disconnect(&c->chan.chan);
+}
+
+static void bearer_ready(struct pouch_bearer *bearer)
+{
+    struct pouch_channel *c = CONTAINER_OF(bearer, struct pouch_channel, bearer);
+
+    switch (c->type)
+    {
+        case CHANNEL_RECEIVER:
+            return pouch_receiver_ready(c->receiver);
+        case CHANNEL_SENDER:
+            return pouch_sender_ready(c->sender);
+    }
+}
+
+static void resume(struct k_work *work)
+{
+    struct pouch_channel *c = CONTAINER_OF(work, struct pouch_channel, resume);
+
+    if (c->chan.chan.conn != NULL)
+    {
+        bearer_ready(&c->bearer);
+    }
+}
+
+static void chan_connected(struct bt_l2cap_chan *chan)
+{
+    struct pouch_channel *c = CONTAINER_OF(chan, struct pouch_channel, chan.chan);
+
+    c->bearer.maxlen = MIN(c->chan.tx.mtu, CONFIG_POUCH_TRANSPORT_L2CAP_MTU);
+    atomic_set(&c->blocked, false);
+
+    LOG_DBG("%p: open, MTU: %u", c, c->bearer.maxlen);
+
+    int err;
+    switch (c->type)
+    {
+        case CHANNEL_RECEIVER:
+            err = pouch_receiver_open(c->receiver,
+                                      &c->bearer,
+                                      CONFIG_POUCH_TRANSPORT_L2CAP_WINDOW_SIZE);
+            break;
+        case CHANNEL_SENDER:
+            err = pouch_sender_open(c->sender, &c->bearer);
+            break;
+        default:
+            err = -ENOTSUP;
+            break;
+    }
+
+    if (err)
+    {
+        LOG_ERR("Failed to open transport: %d", err);
+        bt_l2cap_chan_disconnect(chan);
+    }
+}
+
+static void chan_disconnected(struct bt_l2cap_chan *chan)
+{
+    struct pouch_channel *c = CONTAINER_OF(chan, struct pouch_channel, chan.chan);
+
+    LOG_DBG("%p: disconnected", c);
+
+    k_work_cancel(&c->resume);
+
+    switch (c->type)
+    {
+        case CHANNEL_RECEIVER:
+            pouch_receiver_close(c->receiver);
+            break;
+        case CHANNEL_SENDER:
+            pouch_sender_close(c->sender);
+            break;
+    }
+}
+
+static struct net_buf *chan_alloc_buf(struct bt_l2cap_chan *chan)
+{
+    return net_buf_alloc(&rx_pool, K_FOREVER);
+}
+
+static int chan_recv(struct bt_l2cap_chan *chan, struct net_buf *buf)
+{
+    struct pouch_channel *c = CONTAINER_OF(chan, struct pouch_channel, chan.chan);
+    int err = -EINVAL;
+
+    LOG_DBG("%p: rx: %u", c, buf->len);
+
+    switch (c->type)
+    {
+        case CHANNEL_RECEIVER:
+            err = pouch_receiver_recv(c->receiver, buf->data, buf->len);
+            break;
+        case CHANNEL_SENDER:
+            err = pouch_sender_recv(c->sender, buf->data, buf->len);
+            break;
+    }
+
+    if (err)
+    {
+        LOG_ERR("Recv failed: %d", err);
+    }
+
+    // The buffer is released by the stack, errors are handled by the transport:
+    return 0;
+}
+
+static const struct bt_l2cap_chan_ops chan_ops = {
+    .connected = chan_connected,
+    .disconnected = chan_disconnected,
+    .alloc_buf = chan_alloc_buf,
+    .recv = chan_recv,
+};
+
+static int accept(struct bt_conn *conn,
+                  struct bt_l2cap_server *server,
+                  struct bt_l2cap_chan **chan)
+{
+    struct pouch_channel *c = CONTAINER_OF(server, struct pouch_channel, server);
+
+    if (c->chan.chan.conn != NULL)
+    {
+        LOG_WRN("%p: already connected", c);
+        return -ENOMEM;
+    }
+
+    c->chan.rx.mtu = CONFIG_POUCH_TRANSPORT_L2CAP_MTU;
+    *chan = &c->chan.chan;
+
+    return 0;
+}
+
+static void pouch_l2cap_init(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        k_work_init(&channels[i].resume, resume);
+
+        int err = bt_l2cap_server_register(&channels[i].server);
+        if (err)
+        {
+            LOG_ERR("Failed to register PSM 0x%x: %d", channels[i].server.psm, err);
+        }
+    }
+}
+POUCH_APPLICATION_STARTUP_HOOK(pouch_l2cap_init);
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "mux.h"
+
+#include "transport/sar/receiver.h"
+#include "transport/sar/sender.h"
+#include "transport/endpoints/device/endpoints.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(pouch_mux, CONFIG_POUCH_TRANSPORT_LOG_LEVEL);
+
+#define CHANNEL_INIT(_type, _field, _endpoint)                         \
+    {                                                                  \
+        .bearer =                                                      \
+            {                                                          \
+                .send = bearer_send,                                   \
+                .close = bearer_close,                                 \
+                .ready = bearer_ready,                                 \
+            },                                                         \
+        .type = (_type),                                               \
+        ._field = &((struct pouch_##_field){.endpoint = (_endpoint)}), \
+    }
+
+enum channel_type
+{
+    CHANNEL_NONE,
+    CHANNEL_RECEIVER,
+    CHANNEL_SENDER,
+};
+
+/** Pouch endpoint on the device's link */
+struct pouch_channel
+{
+    struct pouch_bearer bearer;
+    bool open;
+    /** The transport is waiting for the link */
+    atomic_t blocked;
+
+    // higher level handler:
+    enum channel_type type;
+    union
+    {
+        struct pouch_sender *sender;
+        struct pouch_receiver *receiver;
+    };
+};
+
+static int bearer_send(struct pouch_bearer *bearer, const uint8_t *buf, size_t len);
+static int bearer_sendv(struct pouch_bearer *bearer,
+                        const struct pouch_bearer_pkt *pkts,
+                        size_t count);
+static void bearer_close(struct pouch_bearer *bearer, bool success);
+static void bearer_ready(struct pouch_bearer *bearer);
+
+static struct pouch_mux_link *link;
+
+static struct pouch_channel channels[POUCH_MUX_CHANNELS] = {
+    [POUCH_MUX_CHANNEL_INFO] = CHANNEL_INIT(CHANNEL_SENDER, sender, &pouch_device_endpoint_info),
+    [POUCH_MUX_CHANNEL_DOWNLINK] =
+        CHANNEL_INIT(CHANNEL_RECEIVER, receiver, &pouch_device_endpoint_downlink),
+    [POUCH_MUX_CHANNEL_UPLINK] =
+        CHANNEL_INIT(CHANNEL_SENDER, sender, &pouch_device_endpoint_uplink),
+#if CONFIG_POUCH_ENCRYPTION_SAEAD
+    [POUCH_MUX_CHANNEL_SERVER_CERT] =
+        CHANNEL_INIT(CHANNEL_RECEIVER, receiver, &pouch_device_endpoint_server_cert),
+    [POUCH_MUX_CHANNEL_DEVICE_CERT] =
+        CHANNEL_INIT(CHANNEL_SENDER, sender, &pouch_device_endpoint_device_cert),
+#endif
+};
+
+static inline uint8_t channel_id(const struct pouch_channel *c)
+{
+    return c - channels;
+}
+
+static int bearer_send(struct pouch_bearer *bearer, const uint8_t *buf, size_t len)
+{
+    struct pouch_channel *c = CONTAINER_OF(bearer, struct pouch_channel, bearer);
+
+    // Mark the channel as blocked before sending, so the link can't become ready in between:
+    atomic_set(&c->blocked, true);
+    int err = link->send(link, channel_id(c), buf, len, K_NO_WAIT);
+    if (err != -EAGAIN)
+    {
+        atomic_set(&c->blocked, false);
+    }
+
+    return err;
+}
+
+static int bearer_sendv(struct pouch_bearer *bearer,
+                        const struct pouch_bearer_pkt *pkts,
+                        size_t count)
+{
+    struct pouch_channel *c = CONTAINER_OF(bearer, struct pouch_channel, bearer);
+
+    atomic_set(&c->blocked, true);
+    int ret = link->sendv(link, channel_id(c), pkts, count, K_NO_WAIT);
+    if (ret != -EAGAIN)
+    {
+        atomic_set(&c->blocked, false);
+    }
+
+    return ret;
+}
+
+static void bearer_close(struct pouch_bearer *bearer, bool success)
+{
+    struct pouch_channel *c = CONTAINER_OF(bearer, struct pouch_channel, bearer);
+
+    LOG_DBG("%u: close (%s)", channel_id(c), success ? "success" : "fail");
+
+    if (c->open && !success)
+    {
+        (void) pouch_mux_control(link, channel_id(c), POUCH_MUX_CMD_ABORT);
+    }
+
+    c->open = false;
+}
+
+static void bearer_ready(struct pouch_bearer *bearer)
+{
+    struct pouch_channel *c = CONTAINER_OF(bearer, struct pouch_channel, bearer);
+
+    switch (c->type)
+    {
+        case CHANNEL_RECEIVER:
+            return pouch_receiver_ready(c->receiver);
+        case CHANNEL_SENDER:
+            return pouch_sender_ready(c->sender);
+        case CHANNEL_NONE:
+            break;
+    }
+}
+
+static void close(struct pouch_channel *c)
+{
+    // Closing ends the transfer, which shouldn't be reported back to the broker:
+    c->open = false;
+
+    switch (c->type)
+    {
+        case CHANNEL_RECEIVER:
+            pouch_receiver_close(c->receiver);
+            break;
+        case CHANNEL_SENDER:
+            pouch_sender_close(c->sender);
+            break;
+        case CHANNEL_NONE:
+            break;
+    }
+}
+
+static int open(struct pouch_channel *c)
+{
+    if (c->open)
+    {
+        // The broker started over:
+        close(c);
+    }
+
+    atomic_set(&c->blocked, false);
+    c->open = true;
+
+    int err;
+    switch (c->type)
+    {
+        case CHANNEL_RECEIVER:
+            err = pouch_receiver_open(c->receiver, &c->bearer, link->window);
+            break;
+        case CHANNEL_SENDER:
+            err = pouch_sender_open(c->sender, &c->bearer);
+            break;
+        default:
+            err = -ENOTSUP;
+            break;
+    }
+
+    if (err)
+    {
+        c->open = false;
+    }
+
+    return err;
+}
+
+static void control(struct pouch_channel *c, const uint8_t *payload, size_t len)
+{
+    if (len != 1)
+    {
+        return;
+    }
+
+    switch (payload[0])
+    {
+        case POUCH_MUX_CMD_OPEN:
+        {
+            LOG_DBG("%u: open", channel_id(c));
+            int err = open(c);
+            if (err)
+            {
+                LOG_ERR("Failed to open channel %u: %d", channel_id(c), err);
+                (void) pouch_mux_control(link, channel_id(c), POUCH_MUX_CMD_ABORT);
+            }
+            break;
+        }
+        case POUCH_MUX_CMD_ABORT:
+            LOG_DBG("%u: aborted", channel_id(c));
+            if (c->open)
+            {
+                close(c);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void pouch_mux_device_recv(uint8_t channel, uint8_t *packet, size_t len)
+{
+    uint8_t id = channel & ~POUCH_MUX_CONTROL;
+    if (id >= POUCH_MUX_CHANNELS)
+    {
+        return;
+    }
+
+    struct pouch_channel *c = &channels[id];
+
+    if (channel & POUCH_MUX_CONTROL)
+    {
+        control(c, packet, len);
+        return;
+    }
+
+    if (!c->open)
+    {
+        LOG_DBG("%u: dropping packet for closed channel", id);
+        return;
+    }
+
+    int err = -EINVAL;
+    switch (c->type)
+    {
+        case CHANNEL_RECEIVER:
+            err = pouch_receiver_recv(c->receiver, packet, len);
+            break;
+        case CHANNEL_SENDER:
+            err = pouch_sender_recv(c->sender, packet, len);
+            break;
+        case CHANNEL_NONE:
+            break;
+    }
+
+    if (err)
+    {
+        LOG_ERR("Recv failed: %d", err);
+    }
+}
+
+void pouch_mux_device_ready(void)
+{
+    // The link is shared, so any channel that was waiting for it can proceed:
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        if (channels[i].open && atomic_cas(&channels[i].blocked, true, false))
+        {
+            bearer_ready(&channels[i].bearer);
+        }
+    }
+}
+
+void pouch_mux_device_start(struct pouch_mux_link *l)
+{
+    link = l;
+
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++)
+    {
+        channels[i].bearer.maxlen = link->maxlen;
+        channels[i].bearer.sendv = link->sendv ? bearer_sendv : NULL;
+    }
+}
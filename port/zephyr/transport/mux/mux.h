@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <zephyr/kernel.h>
+
+#include "transport/bearer.h"
+
+/**
+ * Channel multiplexing for links that carry all Pouch endpoints, such as serial and UDP links.
+ *
+ * Every packet on the link is tagged with a channel number. The broker opens each channel with a
+ * control packet before opening its own side, and either side can abort a channel.
+ */
+
+/** Channels multiplexed on the link, one for each endpoint */
+enum pouch_mux_channel
+{
+    POUCH_MUX_CHANNEL_INFO,
+    POUCH_MUX_CHANNEL_DOWNLINK,
+    POUCH_MUX_CHANNEL_UPLINK,
+    POUCH_MUX_CHANNEL_SERVER_CERT,
+    POUCH_MUX_CHANNEL_DEVICE_CERT,
+
+    POUCH_MUX_CHANNELS,
+};
+
+/** Channel flag for control packets. Control packets carry a single command byte. */
+#define POUCH_MUX_CONTROL 0x80
+
+enum pouch_mux_command
+{
+    /** Open the channel. Sent by the broker before it opens its side of the channel. */
+    POUCH_MUX_CMD_OPEN,
+    /** The transfer on the channel failed, and the peer should close it. */
+    POUCH_MUX_CMD_ABORT,
+    /** The device requests a session. Only used on links that can't detect the device. */
+    POUCH_MUX_CMD_SYNC,
+};
+
+struct pouch_mux_link;
+
+/**
+ * Send a packet on a channel.
+ *
+ * @retval -EAGAIN The link can't take the packet before the timeout. The link calls the ready
+ * function of the mux once it can take more packets.
+ */
+typedef int (*pouch_mux_send_t)(struct pouch_mux_link *link,
+                                uint8_t channel,
+                                const uint8_t *packet,
+                                size_t len,
+                                k_timeout_t timeout);
+
+/**
+ * Send several packets on a channel in a single link operation.
+ *
+ * Returns the number of packets the link accepted, in order, or -EAGAIN if it can't take any of
+ * them before the timeout. The link calls the ready function of the mux once it can take more
+ * packets.
+ */
+typedef int (*pouch_mux_sendv_t)(struct pouch_mux_link *link,
+                                 uint8_t channel,
+                                 const struct pouch_bearer_pkt *pkts,
+                                 size_t count,
+                                 k_timeout_t timeout);
+
+/** Link carrying the multiplexed channels */
+struct pouch_mux_link
+{
+    pouch_mux_send_t send;
+    /** Optional vectored send, for links that can carry several packets in one operation */
+    pouch_mux_sendv_t sendv;
+    /** Largest packet the link can carry */
+    size_t maxlen;
+    /** Receiver window for each channel */
+    uint8_t window;
+};
+
+/** Send a control command for a channel */
+static inline int pouch_mux_control(struct pouch_mux_link *link,
+                                    uint8_t channel,
+                                    enum pouch_mux_command cmd)
+{
+    uint8_t payload = cmd;
+
+    return link->send(link, POUCH_MUX_CONTROL | channel, &payload, 1, K_MSEC(100));
+}
+
+/**
+ * Serve the device endpoints on a link.
+ *
+ * A device only has a single link.
+ */
+void pouch_mux_device_start(struct pouch_mux_link *link);
+
+/** Pass a packet received on the device's link to the mux */
+void pouch_mux_device_recv(uint8_t channel, uint8_t *packet, size_t len);
+
+/** Resume the device's channels that are waiting for the link */
+void pouch_mux_device_ready(void);
@@ -0,0 +1,421 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "session.h"
+
+#include "transport/endpoints/broker/endpoints.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(mux_session, CONFIG_POUCH_GATEWAY_LOG_LEVEL);
+
+enum channel_type
+{
+    CHANNEL_RECEIVER,
+    CHANNEL_SENDER,
+};
+
+static const struct
+{
+    enum channel_type type;
+    const struct pouch_endpoint *endpoint;
+} channel_types[POUCH_MUX_CHANNELS] = {
+    [POUCH_MUX_CHANNEL_INFO] = {CHANNEL_RECEIVER, &broker_endpoint_info},
+    [POUCH_MUX_CHANNEL_DEVICE_CERT] = {CHANNEL_RECEIVER, &broker_endpoint_device_cert},
+    [POUCH_MUX_CHANNEL_SERVER_CERT] = {CHANNEL_SENDER, &broker_endpoint_server_cert},
+    [POUCH_MUX_CHANNEL_UPLINK] = {CHANNEL_RECEIVER, &broker_endpoint_uplink},
+    [POUCH_MUX_CHANNEL_DOWNLINK] = {CHANNEL_SENDER, &broker_endpoint_downlink},
+};
+
+typedef void (*channel_done_t)(struct pouch_mux_session *session, enum pouch_mux_channel id);
+
+static void sub_complete(struct pouch_mux_session *session, enum pouch_mux_channel id);
+static void link_complete(struct pouch_mux_session *session, enum pouch_mux_channel id);
+
+static inline enum pouch_mux_channel channel_id(const struct pouch_mux_session_channel *c)
+{
+    return c - c->session->channels;
+}
+
+static inline enum channel_type channel_type(const struct pouch_mux_session_channel *c)
+{
+    return channel_types[channel_id(c)].type;
+}
+
+static void close(struct pouch_mux_session_channel *c)
+{
+    c->open = false;
+
+    /* This must be a recursive lock, as the transport may end the transfer while it's receiving
+     * a packet, which ends up here.
+     */
+    pouch_mutex_lock(&c->session->lock, POUCH_FOREVER);
+    switch (channel_type(c))
+    {
+        case CHANNEL_RECEIVER:
+            pouch_receiver_close(&c->receiver);
+            break;
+        case CHANNEL_SENDER:
+            pouch_sender_close(&c->sender);
+            break;
+    }
+    pouch_mutex_unlock(&c->session->lock);
+}
+
+static void finish(struct pouch_mux_session *session)
+{
+    if (!session->active)
+    {
+        return;
+    }
+
+    session->active = false;
+
+    for (enum pouch_mux_channel i = 0; i < POUCH_MUX_CHANNELS; i++)
+    {
+        struct pouch_mux_session_channel *c = &session->channels[i];
+        if (c->open)
+        {
+            (void) pouch_mux_control(session->link, i, POUCH_MUX_CMD_ABORT);
+            close(c);
+        }
+    }
+
+    if (session->end)
+    {
+        session->end(session);
+    }
+}
+
+static int bearer_send(struct pouch_bearer *bearer, const uint8_t *buf, size_t len)
+{
+    struct pouch_mux_session_channel *c =
+        CONTAINER_OF(bearer, struct pouch_mux_session_channel, bearer);
+    struct pouch_mux_link *link = c->session->link;
+
+    // Mark the channel as blocked before sending, so the link can't become ready in between:
+    atomic_set(&c->blocked, true);
+    int err = link->send(link, channel_id(c), buf, len, K_NO_WAIT);
+    if (err != -EAGAIN)
+    {
+        atomic_set(&c->blocked, false);
+    }
+
+    return err;
+}
+
+static int bearer_sendv(struct pouch_bearer *bearer,
+                        const struct pouch_bearer_pkt *pkts,
+                        size_t count)
+{
+    struct pouch_mux_session_channel *c =
+        CONTAINER_OF(bearer, struct pouch_mux_session_channel, bearer);
+    struct pouch_mux_link *link = c->session->link;
+
+    atomic_set(&c->blocked, true);
+    int ret = link->sendv(link, channel_id(c), pkts, count, K_NO_WAIT);
+    if (ret != -EAGAIN)
+    {
+        atomic_set(&c->blocked, false);
+    }
+
+    return ret;
+}
+
+static void bearer_close(struct pouch_bearer *bearer, bool success)
+{
+    struct pouch_mux_session_channel *c =
+        CONTAINER_OF(bearer, struct pouch_mux_session_channel, bearer);
+    bool was_open = c->open;
+
+    LOG_DBG("%u: %s", channel_id(c), success ? "success" : "fail");
+    c->open = false;
+
+    if (!success)
+    {
+        if (was_open)
+        {
+            (void) pouch_mux_control(c->session->link, channel_id(c), POUCH_MUX_CMD_ABORT);
+        }
+
+        finish(c->session);
+        return;
+    }
+
+    k_work_submit(&c->done);
+}
+
+static void bearer_ready(struct pouch_bearer *bearer)
+{
+    struct pouch_mux_session_channel *c =
+        CONTAINER_OF(bearer, struct pouch_mux_session_channel, bearer);
+
+    pouch_mutex_lock(&c->session->lock, POUCH_FOREVER);
+    switch (channel_type(c))
+    {
+        case CHANNEL_RECEIVER:
+            pouch_receiver_ready(&c->receiver);
+            break;
+        case CHANNEL_SENDER:
+            pouch_sender_ready(&c->sender);
+            break;
+    }
+    pouch_mutex_unlock(&c->session->lock);
+}
+
+static void done_work(struct k_work *work)
+{
+    struct pouch_mux_session_channel *c =
+        CONTAINER_OF(work, struct pouch_mux_session_channel, done);
+
+    if (c->session->active)
+    {
+        c->callback(c->session, channel_id(c));
+    }
+}
+
+static int open(struct pouch_mux_session *session,
+                enum pouch_mux_channel id,
+                channel_done_t callback)
+{
+    struct pouch_mux_session_channel *c = &session->channels[id];
+    int err;
+
+    c->bearer.close = bearer_close;
+    c->bearer.ready = bearer_ready;
+    c->bearer.send = bearer_send;
+    c->bearer.sendv = session->link->sendv ? bearer_sendv : NULL;
+    c->bearer.ctx = &session->node;
+    c->bearer.maxlen = session->link->maxlen;
+    c->callback = callback;
+    atomic_set(&c->blocked, false);
+
+    // Hold the lock until both sides are open, so the device's first packet can't overtake us:
+    pouch_mutex_lock(&session->lock, POUCH_FOREVER);
+
+    err = pouch_mux_control(session->link, id, POUCH_MUX_CMD_OPEN);
+    if (err)
+    {
+        goto unlock;
+    }
+
+    c->open = true;
+
+    switch (channel_type(c))
+    {
+        case CHANNEL_RECEIVER:
+            err = pouch_receiver_open(&c->receiver, &c->bearer, session->link->window);
+            break;
+        case CHANNEL_SENDER:
+            err = pouch_sender_open(&c->sender, &c->bearer);
+            break;
+    }
+
+    if (err)
+    {
+        LOG_ERR("Failed to open channel %u: %d", id, err);
+        c->open = false;
+        (void) pouch_mux_control(session->link, id, POUCH_MUX_CMD_ABORT);
+    }
+
+unlock:
+    pouch_mutex_unlock(&session->lock);
+    return err;
+}
+
+static void control(struct pouch_mux_session_channel *c, const uint8_t *payload, size_t len)
+{
+    if (len != 1 || payload[0] != POUCH_MUX_CMD_ABORT)
+    {
+        return;
+    }
+
+    LOG_WRN("%u: aborted by device", channel_id(c));
+    if (c->open)
+    {
+        close(c);
+        finish(c->session);
+    }
+}
+
+void pouch_mux_session_recv(struct pouch_mux_session *session,
+                            uint8_t channel,
+                            uint8_t *packet,
+                            size_t len)
+{
+    uint8_t id = channel & ~POUCH_MUX_CONTROL;
+    if (id >= POUCH_MUX_CHANNELS)
+    {
+        return;
+    }
+
+    struct pouch_mux_session_channel *c = &session->channels[id];
+
+    if (channel & POUCH_MUX_CONTROL)
+    {
+        control(c, packet, len);
+        return;
+    }
+
+    pouch_mutex_lock(&session->lock, POUCH_FOREVER);
+    if (!c->open)
+    {
+        LOG_DBG("%u: dropping packet for closed channel", id);
+        pouch_mutex_unlock(&session->lock);
+        return;
+    }
+
+    int err = -EINVAL;
+    switch (channel_type(c))
+    {
+        case CHANNEL_RECEIVER:
+            err = pouch_receiver_recv(&c->receiver, packet, len);
+            break;
+        case CHANNEL_SENDER:
+            err = pouch_sender_recv(&c->sender, packet, len);
+            break;
+    }
+    pouch_mutex_unlock(&session->lock);
+
+    if (err)
+    {
+        LOG_ERR("Recv failed: %d", err);
+        finish(session);
+    }
+}
+
+void pouch_mux_session_ready(struct pouch_mux_session *session)
+{
+    // The link is shared, so any channel that was waiting for it can proceed:
+    for (enum pouch_mux_channel i = 0; i < POUCH_MUX_CHANNELS; i++)
+    {
+        struct pouch_mux_session_channel *c = &session->channels[i];
+        if (c->open && atomic_cas(&c->blocked, true, false))
+        {
+            bearer_ready(&c->bearer);
+        }
+    }
+}
+
+void pouch_mux_session_init(struct pouch_mux_session *session,
+                            struct pouch_mux_link *link,
+                            pouch_mux_session_end_t end)
+{
+    pouch_mutex_init(&session->lock);
+    session->link = link;
+    session->end = end;
+    session->active = false;
+
+    for (enum pouch_mux_channel i = 0; i < POUCH_MUX_CHANNELS; i++)
+    {
+        struct pouch_mux_session_channel *c = &session->channels[i];
+
+        c->session = session;
+        c->open = false;
+        k_work_init(&c->done, done_work);
+
+        switch (channel_types[i].type)
+        {
+            case CHANNEL_RECEIVER:
+                c->receiver = (struct pouch_receiver){.endpoint = channel_types[i].endpoint};
+                break;
+            case CHANNEL_SENDER:
+                c->sender = (struct pouch_sender){.endpoint = channel_types[i].endpoint};
+                break;
+        }
+    }
+}
+
+int pouch_mux_session_start(struct pouch_mux_session *session)
+{
+    if (session->active)
+    {
+        return -EBUSY;
+    }
+
+    session->active = true;
+
+    // Start by reading the info endpoint:
+    int err = open(session, POUCH_MUX_CHANNEL_INFO, sub_complete);
+    if (err)
+    {
+        session->active = false;
+        return err;
+    }
+
+    return 0;
+}
+
+void pouch_mux_session_abort(struct pouch_mux_session *session)
+{
+    finish(session);
+}
+
+static void sub_complete(struct pouch_mux_session *session, enum pouch_mux_channel id)
+{
+    int err;
+
+    if (!session->node.server_cert_provisioned)
+    {
+        if (id == POUCH_MUX_CHANNEL_SERVER_CERT)
+        {
+            LOG_ERR("Failed to provision server cert");
+            finish(session);
+            return;
+        }
+
+        err = open(session, POUCH_MUX_CHANNEL_SERVER_CERT, sub_complete);
+        if (err)
+        {
+            finish(session);
+        }
+
+        return;
+    }
+
+    if (!session->node.device_cert_provisioned)
+    {
+        if (id == POUCH_MUX_CHANNEL_DEVICE_CERT)
+        {
+            LOG_ERR("Failed to provision device cert");
+            finish(session);
+            return;
+        }
+
+        err = open(session, POUCH_MUX_CHANNEL_DEVICE_CERT, sub_complete);
+        if (err)
+        {
+            finish(session);
+        }
+
+        return;
+    }
+
+    // start link:
+    err = open(session, POUCH_MUX_CHANNEL_DOWNLINK, link_complete);
+    if (err)
+    {
+        finish(session);
+        return;
+    }
+    err = open(session, POUCH_MUX_CHANNEL_UPLINK, link_complete);
+    if (err)
+    {
+        finish(session);
+        return;
+    }
+}
+
+static void link_complete(struct pouch_mux_session *session, enum pouch_mux_channel id)
+{
+    if (session->channels[POUCH_MUX_CHANNEL_DOWNLINK].open
+        || session->channels[POUCH_MUX_CHANNEL_UPLINK].open)
+    {
+        // wait for both uplink and downlink to finish
+        return;
+    }
+
+    finish(session);
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include "mux.h"
+
+#include "gateway/types.h"
+#include "transport/bearer.h"
+#include "transport/sar/receiver.h"
+#include "transport/sar/sender.h"
+
+struct pouch_mux_session;
+
+typedef void (*pouch_mux_session_end_t)(struct pouch_mux_session *session);
+
+/** Pouch endpoint on a multiplexed link, as seen from the broker's side */
+struct pouch_mux_session_channel
+{
+    struct pouch_bearer bearer;
+    struct pouch_mux_session *session;
+    bool open;
+    /** The transport is waiting for the link */
+    atomic_t blocked;
+    /** Reports the end of the transfer outside of the transport's context */
+    struct k_work done;
+    void (*callback)(struct pouch_mux_session *session, enum pouch_mux_channel id);
+
+    union
+    {
+        struct pouch_sender sender;
+        struct pouch_receiver receiver;
+    };
+};
+
+/** Broker session with a single device on a multiplexed link */
+struct pouch_mux_session
+{
+    pouch_mutex_t lock;
+    struct pouch_mux_link *link;
+    struct pouch_mux_session_channel channels[POUCH_MUX_CHANNELS];
+    struct pouch_gateway_node_info node;
+    /** A session is in progress */
+    bool active;
+    pouch_mux_session_end_t end;
+};
+
+/**
+ * Initialize a session on a link.
+ *
+ * @param session Session to initialize
+ * @param link Link to the device
+ * @param end Called when a session has finished, successfully or not
+ */
+void pouch_mux_session_init(struct pouch_mux_session *session,
+                            struct pouch_mux_link *link,
+                            pouch_mux_session_end_t end);
+
+/**
+ * Start a session.
+ *
+ * Reads the device's info, provisions certificates if needed, and then transfers the uplink and
+ * downlink.
+ *
+ * @retval -EBUSY A session is already in progress.
+ */
+int pouch_mux_session_start(struct pouch_mux_session *session);
+
+/** Abort the session in progress */
+void pouch_mux_session_abort(struct pouch_mux_session *session);
+
+/** Pass a packet received on the session's link */
+void pouch_mux_session_recv(struct pouch_mux_session *session,
+                            uint8_t channel,
+                            uint8_t *packet,
+                            size_t len);
+
+/** Resume the session's channels that are waiting for the link */
+void pouch_mux_session_ready(struct pouch_mux_session *session);
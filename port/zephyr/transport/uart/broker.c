@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <pouch/gateway/uart.h>
+
+#include "link.h"
+#include "../mux/session.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(uart_broker, CONFIG_POUCH_UART_LOG_LEVEL);
+
+static struct
+{
+    struct pouch_uart_link link;
+    struct pouch_mux_session session;
+    pouch_gateway_uart_end_t callback;
+} broker;
+
+static void link_recv(struct pouch_uart_link *link, uint8_t channel, uint8_t *packet, size_t len)
+{
+    pouch_mux_session_recv(&broker.session, channel, packet, len);
+}
+
+static void link_ready(struct pouch_uart_link *link)
+{
+    pouch_mux_session_ready(&broker.session);
+}
+
+static void session_end(struct pouch_mux_session *session)
+{
+    if (broker.callback)
+    {
+        broker.callback(broker.link.uart);
+    }
+}
+
+static void broker_init(void)
+{
+    pouch_mux_session_init(&broker.session, &broker.link.mux, session_end);
+}
+POUCH_APPLICATION_STARTUP_HOOK(broker_init);
+
+int pouch_gateway_uart_start(const struct device *uart, pouch_gateway_uart_end_t callback)
+{
+    if (broker.session.active)
+    {
+        return -EBUSY;
+    }
+
+    if (broker.link.uart != uart)
+    {
+        int err = pouch_uart_link_start(&broker.link, uart, link_recv, link_ready);
+        if (err)
+        {
+            LOG_ERR("Failed to start link: %d", err);
+            return err;
+        }
+    }
+
+    broker.callback = callback;
+
+    return pouch_mux_session_start(&broker.session);
+}
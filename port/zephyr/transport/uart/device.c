@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <pouch/transport/uart.h>
+
+#include "link.h"
+
+static struct pouch_uart_link link;
+
+static void link_recv(struct pouch_uart_link *l, uint8_t channel, uint8_t *packet, size_t len)
+{
+    pouch_mux_device_recv(channel, packet, len);
+}
+
+static void link_ready(struct pouch_uart_link *l)
+{
+    pouch_mux_device_ready();
+}
+
+int pouch_uart_start(const struct device *uart)
+{
+    pouch_mux_device_start(&link.mux);
+
+    return pouch_uart_link_start(&link, uart, link_recv, link_ready);
+}
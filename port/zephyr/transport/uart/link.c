@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "link.h"
+
+#include <zephyr/drivers/uart.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(pouch_uart_link, CONFIG_POUCH_UART_LOG_LEVEL);
+
+static void frame_received(void *ctx, uint8_t channel, uint8_t *packet, size_t len)
+{
+    struct pouch_uart_link *link = ctx;
+
+    LOG_DBG("rx: channel 0x%02x, %u bytes", channel, len);
+
+    link->recv(link, channel, packet, len);
+}
+
+static void rx_work(struct k_work *work)
+{
+    struct pouch_uart_link *link = CONTAINER_OF(work, struct pouch_uart_link, rx.work);
+
+    atomic_val_t overruns = atomic_clear(&link->rx.overruns);
+    if (overruns)
+    {
+        LOG_WRN("RX ring full, lost %ld bytes", (long) overruns);
+    }
+
+    uint8_t *data;
+    uint32_t len;
+    while ((len = ring_buf_get_claim(&link->rx.ring, &data, CONFIG_POUCH_UART_RX_RING_SIZE)) > 0)
+    {
+        // Frames are decoded in place, and handed to the transport without further copies:
+        int dropped = pouch_frame_decoder_push(&link->rx.decoder, data, len);
+        if (dropped)
+        {
+            LOG_WRN("Dropped %d invalid frames", dropped);
+        }
+
+        ring_buf_get_finish(&link->rx.ring, len);
+    }
+}
+
+static void tx_ready_work(struct k_work *work)
+{
+    struct pouch_uart_link *link = CONTAINER_OF(work, struct pouch_uart_link, tx.ready);
+
+    link->ready(link);
+}
+
+/** Start transmitting the frame at the front of the queue. Must be called with the lock held. */
+static int tx_start(struct pouch_uart_link *link)
+{
+    if (link->tx.active || link->tx.count == 0 || link->tx.frames[link->tx.head].len == 0)
+    {
+        return 0;
+    }
+
+    int err = uart_tx(link->uart,
+                      link->tx.frames[link->tx.head].buf,
+                      link->tx.frames[link->tx.head].len,
+                      SYS_FOREVER_US);
+    if (err)
+    {
+        // Drop the frame, so it doesn't stall the queue:
+        link->tx.frames[link->tx.head].len = 0;
+        link->tx.head = (link->tx.head + 1) % POUCH_UART_TX_FRAMES;
+        link->tx.count--;
+        return err;
+    }
+
+    link->tx.active = true;
+    return 0;
+}
+
+static void tx_done(struct pouch_uart_link *link)
+{
+    K_SPINLOCK(&link->tx.lock)
+    {
+        link->tx.frames[link->tx.head].len = 0;
+        link->tx.head = (link->tx.head + 1) % POUCH_UART_TX_FRAMES;
+        link->tx.count--;
+        link->tx.active = false;
+
+        (void) tx_start(link);
+    }
+
+    k_sem_give(&link->tx.released);
+    k_work_submit(&link->tx.ready);
+}
+
+static void uart_callback(const struct device *dev, struct uart_event *evt, void *user_data)
+{
+    struct pouch_uart_link *link = user_data;
+
+    switch (evt->type)
+    {
+        case UART_TX_DONE:
+        case UART_TX_ABORTED:
+            tx_done(link);
+            break;
+        case UART_RX_RDY:
+        {
+            const uint8_t *data = &evt->data.rx.buf[evt->data.rx.offset];
+            uint32_t written = ring_buf_put(&link->rx.ring, data, evt->data.rx.len);
+            if (written < evt->data.rx.len)
+            {
+                // The lost bytes corrupt a frame, which is dropped by its CRC:
+                atomic_add(&link->rx.overruns, evt->data.rx.len - written);
+            }
+
+            k_work_submit(&link->rx.work);
+            break;
+        }
+        case UART_RX_BUF_REQUEST:
+            (void) uart_rx_buf_rsp(dev,
+                                   link->rx.dma[link->rx.next],
+                                   sizeof(link->rx.dma[link->rx.next]));
+            link->rx.next ^= 1;
+            break;
+        case UART_RX_DISABLED:
+            // Reception stops on line errors, restart it:
+            link->rx.next = 1;
+            (void) uart_rx_enable(dev,
+                                  link->rx.dma[0],
+                                  sizeof(link->rx.dma[0]),
+                                  CONFIG_POUCH_UART_RX_TIMEOUT_US);
+            break;
+        case UART_RX_STOPPED:
+            LOG_WRN("RX stopped: %d", evt->data.rx_stop.reason);
+            break;
+        default:
+            break;
+    }
+}
+
+static int link_sendv(struct pouch_mux_link *mux,
+                      uint8_t channel,
+                      const struct pouch_bearer_pkt *pkts,
+                      size_t count,
+                      k_timeout_t timeout)
+{
+    struct pouch_uart_link *link = CONTAINER_OF(mux, struct pouch_uart_link, mux);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pkts[i].len > CONFIG_POUCH_UART_MTU)
+        {
+            return -EMSGSIZE;
+        }
+    }
+
+    k_spinlock_key_t key;
+    for (;;)
+    {
+        key = k_spin_lock(&link->tx.lock);
+        if (link->tx.count < POUCH_UART_TX_FRAMES)
+        {
+            break;
+        }
+
+        k_spin_unlock(&link->tx.lock, key);
+
+        if (K_TIMEOUT_EQ(timeout, K_NO_WAIT) || k_sem_take(&link->tx.released, timeout) != 0)
+        {
+            return -EAGAIN;
+        }
+    }
+
+    // Reserve the buffer, and encode the frames outside the lock:
+    uint8_t slot = (link->tx.head + link->tx.count) % POUCH_UART_TX_FRAMES;
+    link->tx.frames[slot].len = 0;
+    link->tx.count++;
+    k_spin_unlock(&link->tx.lock, key);
+
+    uint8_t *buf = link->tx.frames[slot].buf;
+    size_t encoded = 0;
+    size_t n = 0;
+    for (; n < count; n++)
+    {
+        if (encoded + POUCH_FRAME_ENCODED_MAX(pkts[n].len) > POUCH_UART_TX_BUF_SIZE)
+        {
+            break;
+        }
+
+        encoded += pouch_frame_encode(channel, pkts[n].buf, pkts[n].len, &buf[encoded]);
+    }
+
+    LOG_DBG("tx: channel 0x%02x, %u packets, %u bytes", channel, n, encoded);
+
+    int err = 0;
+    K_SPINLOCK(&link->tx.lock)
+    {
+        link->tx.frames[slot].len = encoded;
+        err = tx_start(link);
+    }
+
+    return err ? err : n;
+}
+
+static int link_send(struct pouch_mux_link *mux,
+                     uint8_t channel,
+                     const uint8_t *packet,
+                     size_t len,
+                     k_timeout_t timeout)
+{
+    struct pouch_bearer_pkt pkt = {
+        .buf = packet,
+        .len = len,
+    };
+
+    int ret = link_sendv(mux, channel, &pkt, 1, timeout);
+
+    return (ret < 0) ? ret : 0;
+}
+
+int pouch_uart_link_start(struct pouch_uart_link *link,
+                          const struct device *uart,
+                          pouch_uart_link_recv_t recv,
+                          pouch_uart_link_ready_t ready)
+{
+    if (!device_is_ready(uart))
+    {
+        return -ENODEV;
+    }
+
+    link->mux.send = link_send;
+    link->mux.sendv = link_sendv;
+    link->mux.maxlen = CONFIG_POUCH_UART_MTU;
+    link->mux.window = CONFIG_POUCH_UART_WINDOW_SIZE;
+    link->uart = uart;
+    link->recv = recv;
+    link->ready = ready;
+
+    ring_buf_init(&link->rx.ring, sizeof(link->rx.ring_buf), link->rx.ring_buf);
+    k_work_init(&link->rx.work, rx_work);
+    pouch_frame_decoder_init(&link->rx.decoder,
+                             link->rx.frame,
+                             sizeof(link->rx.frame),
+                             frame_received,
+                             link);
+
+    link->tx.head = 0;
+    link->tx.count = 0;
+    link->tx.active = false;
+    k_sem_init(&link->tx.released, 0, 1);
+    k_work_init(&link->tx.ready, tx_ready_work);
+
+    int err = uart_callback_set(uart, uart_callback, link);
+    if (err)
+    {
+        LOG_ERR("UART async API not supported: %d", err);
+        return err;
+    }
+
+    link->rx.next = 1;
+    return uart_rx_enable(uart,
+                          link->rx.dma[0],
+                          sizeof(link->rx.dma[0]),
+                          CONFIG_POUCH_UART_RX_TIMEOUT_US);
+}
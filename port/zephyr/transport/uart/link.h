@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/ring_buffer.h>
+
+#include "transport/serial/frame.h"
+#include "../mux/mux.h"
+
+#define POUCH_UART_TX_FRAMES 2
+/** Each TX buffer holds a batch of encoded frames, written to the UART in a single transfer */
+#define POUCH_UART_TX_BUF_SIZE                                                          \
+    (POUCH_FRAME_ENCODED_MAX(CONFIG_POUCH_UART_MTU) * CONFIG_POUCH_TRANSPORT_SAR_BATCH)
+
+struct pouch_uart_link;
+
+/** Called for every valid frame, from the system work queue */
+typedef void (*pouch_uart_link_recv_t)(struct pouch_uart_link *link,
+                                       uint8_t channel,
+                                       uint8_t *packet,
+                                       size_t len);
+/** Called from the system work queue every time a TX frame is released */
+typedef void (*pouch_uart_link_ready_t)(struct pouch_uart_link *link);
+
+/** Framed serial link on an async UART */
+struct pouch_uart_link
+{
+    struct pouch_mux_link mux;
+    const struct device *uart;
+    pouch_uart_link_recv_t recv;
+    pouch_uart_link_ready_t ready;
+
+    struct
+    {
+        /** Ping-pong DMA buffers */
+        uint8_t dma[2][CONFIG_POUCH_UART_RX_DMA_BUF_SIZE];
+        uint8_t next;
+        /** Received bytes waiting to be decoded */
+        struct ring_buf ring;
+        uint8_t ring_buf[CONFIG_POUCH_UART_RX_RING_SIZE];
+        atomic_t overruns;
+        struct k_work work;
+        struct pouch_frame_decoder decoder;
+        uint8_t frame[CONFIG_POUCH_UART_MTU + POUCH_FRAME_OVERHEAD];
+    } rx;
+
+    struct
+    {
+        struct
+        {
+            uint8_t buf[POUCH_UART_TX_BUF_SIZE];
+            /** Length of the encoded frames, or 0 while they're being encoded */
+            size_t len;
+        } frames[POUCH_UART_TX_FRAMES];
+        /** Frame at the front of the queue */
+        uint8_t head;
+        uint8_t count;
+        bool active;
+        struct k_spinlock lock;
+        /** Given every time a frame is released */
+        struct k_sem released;
+        struct k_work ready;
+    } tx;
+};
+
+/**
+ * Start the link on the given UART.
+ *
+ * The UART must support the async API. Packets are sent through the link's mux, and packets are
+ * encoded straight into a TX buffer.
+ */
+int pouch_uart_link_start(struct pouch_uart_link *link,
+                          const struct device *uart,
+                          pouch_uart_link_recv_t recv,
+                          pouch_uart_link_ready_t ready);
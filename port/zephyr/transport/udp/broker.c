@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <pouch/gateway/udp.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/net/net_ip.h>
+#include <zephyr/net/socket.h>
+
+#include "../mux/session.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(udp_broker, CONFIG_POUCH_UDP_LOG_LEVEL);
+
+/** Session with a single device, identified by its address */
+struct udp_session
+{
+    struct pouch_mux_link mux;
+    struct pouch_mux_session session;
+    struct sockaddr peer;
+    socklen_t peer_len;
+    bool used;
+    /** Throughput counters for the current session */
+    struct
+    {
+        uint32_t start;
+        uint32_t rx_bytes;
+        uint32_t tx_bytes;
+    } stats;
+};
+
+static struct
+{
+    int sock;
+    struct k_mutex tx_lock;
+    /** Protects the used flags, as sessions end outside of the RX thread */
+    struct k_mutex sessions_lock;
+    /** Datagrams hold the channel followed by the packet */
+    uint8_t tx_buf[1 + CONFIG_POUCH_UDP_MTU];
+    uint8_t rx_buf[1 + CONFIG_POUCH_UDP_MTU];
+    struct udp_session sessions[CONFIG_POUCH_GATEWAY_UDP_MAX_SESSIONS];
+    pouch_gateway_udp_end_t callback;
+} broker = {
+    .sock = -1,
+};
+
+static K_THREAD_STACK_DEFINE(rx_stack, CONFIG_POUCH_UDP_RX_STACK_SIZE);
+static struct k_thread rx_thread;
+
+static int link_send(struct pouch_mux_link *mux,
+                     uint8_t channel,
+                     const uint8_t *packet,
+                     size_t len,
+                     k_timeout_t timeout)
+{
+    struct udp_session *s = CONTAINER_OF(mux, struct udp_session, mux);
+
+    if (len > CONFIG_POUCH_UDP_MTU)
+    {
+        return -EMSGSIZE;
+    }
+
+    k_mutex_lock(&broker.tx_lock, K_FOREVER);
+    broker.tx_buf[0] = channel;
+    memcpy(&broker.tx_buf[1], packet, len);
+    ssize_t ret = zsock_sendto(broker.sock, broker.tx_buf, len + 1, 0, &s->peer, s->peer_len);
+    k_mutex_unlock(&broker.tx_lock);
+
+    if (ret < 0)
+    {
+        LOG_ERR("Send failed: %d", errno);
+        return -errno;
+    }
+
+    s->stats.tx_bytes += len;
+    return 0;
+}
+
+static void session_used_set(struct udp_session *s, bool used)
+{
+    k_mutex_lock(&broker.sessions_lock, K_FOREVER);
+    s->used = used;
+    k_mutex_unlock(&broker.sessions_lock);
+}
+
+static void session_end(struct pouch_mux_session *session)
+{
+    struct udp_session *s = CONTAINER_OF(session, struct udp_session, session);
+
+    uint32_t elapsed = k_uptime_get_32() - s->stats.start;
+    uint32_t bytes = s->stats.rx_bytes + s->stats.tx_bytes;
+
+    LOG_INF("%u: rx: %u B, tx: %u B in %u ms (%u B/s)",
+            (unsigned int) (s - broker.sessions),
+            s->stats.rx_bytes,
+            s->stats.tx_bytes,
+            elapsed,
+            elapsed ? (uint32_t) (((uint64_t) bytes * 1000) / elapsed) : 0);
+
+    if (broker.callback)
+    {
+        broker.callback(&s->peer);
+    }
+
+    session_used_set(s, false);
+}
+
+static bool peer_equal(const struct udp_session *s, const struct sockaddr *addr)
+{
+    if (s->peer.sa_family != addr->sa_family)
+    {
+        return false;
+    }
+
+    if (addr->sa_family == AF_INET6)
+    {
+        return net_sin6(&s->peer)->sin6_port == net_sin6(addr)->sin6_port
+            && net_ipv6_addr_cmp(&net_sin6(&s->peer)->sin6_addr, &net_sin6(addr)->sin6_addr);
+    }
+
+    return net_sin(&s->peer)->sin_port == net_sin(addr)->sin_port
+        && net_ipv4_addr_cmp(&net_sin(&s->peer)->sin_addr, &net_sin(addr)->sin_addr);
+}
+
+static struct udp_session *session_find(const struct sockaddr *addr)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(broker.sessions); i++)
+    {
+        if (broker.sessions[i].used && peer_equal(&broker.sessions[i], addr))
+        {
+            return &broker.sessions[i];
+        }
+    }
+
+    return NULL;
+}
+
+static struct udp_session *session_alloc(const struct sockaddr *addr, socklen_t addr_len)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(broker.sessions); i++)
+    {
+        struct udp_session *s = &broker.sessions[i];
+        if (!s->used)
+        {
+            s->used = true;
+            memcpy(&s->peer, addr, addr_len);
+            s->peer_len = addr_len;
+            return s;
+        }
+    }
+
+    return NULL;
+}
+
+static void sync_requested(const struct sockaddr *addr, socklen_t addr_len)
+{
+    /* Sessions may end with the mux session lock held, so don't hold the sessions lock while
+     * calling into the mux session.
+     */
+    k_mutex_lock(&broker.sessions_lock, K_FOREVER);
+    struct udp_session *s = session_find(addr);
+    bool restart = (s != NULL);
+    if (s == NULL)
+    {
+        s = session_alloc(addr, addr_len);
+    }
+    k_mutex_unlock(&broker.sessions_lock);
+
+    if (s == NULL)
+    {
+        LOG_WRN("No free sessions");
+        return;
+    }
+
+    if (restart)
+    {
+        // The device started over, so the session in progress won't finish:
+        pouch_mux_session_abort(&s->session);
+        session_used_set(s, true);
+    }
+
+    s->stats.start = k_uptime_get_32();
+    s->stats.rx_bytes = 0;
+    s->stats.tx_bytes = 0;
+
+    int err = pouch_mux_session_start(&s->session);
+    if (err)
+    {
+        LOG_ERR("Failed to start session: %d", err);
+        session_used_set(s, false);
+    }
+}
+
+static void rx_loop(void *p1, void *p2, void *p3)
+{
+    while (true)
+    {
+        struct sockaddr addr;
+        socklen_t addr_len = sizeof(addr);
+
+        ssize_t len = zsock_recvfrom(broker.sock,
+                                     broker.rx_buf,
+                                     sizeof(broker.rx_buf),
+                                     0,
+                                     &addr,
+                                     &addr_len);
+        if (len < 0)
+        {
+            LOG_ERR("Recv failed: %d", errno);
+            k_sleep(K_MSEC(100));
+            continue;
+        }
+
+        if (len < 1)
+        {
+            continue;
+        }
+
+        uint8_t channel = broker.rx_buf[0];
+        if ((channel & POUCH_MUX_CONTROL) && len == 2 && broker.rx_buf[1] == POUCH_MUX_CMD_SYNC)
+        {
+            sync_requested(&addr, addr_len);
+            continue;
+        }
+
+        k_mutex_lock(&broker.sessions_lock, K_FOREVER);
+        struct udp_session *s = session_find(&addr);
+        k_mutex_unlock(&broker.sessions_lock);
+        if (s == NULL)
+        {
+            LOG_DBG("Dropping datagram from unknown device");
+            continue;
+        }
+
+        s->stats.rx_bytes += len - 1;
+        pouch_mux_session_recv(&s->session, channel, &broker.rx_buf[1], len - 1);
+    }
+}
+
+int pouch_gateway_udp_start(pouch_gateway_udp_end_t callback)
+{
+    if (broker.sock >= 0)
+    {
+        return -EALREADY;
+    }
+
+    struct sockaddr addr = {0};
+    socklen_t addr_len;
+
+    if (IS_ENABLED(CONFIG_NET_IPV4))
+    {
+        net_sin(&addr)->sin_family = AF_INET;
+        net_sin(&addr)->sin_port = htons(CONFIG_POUCH_UDP_PORT);
+        addr_len = sizeof(struct sockaddr_in);
+    }
+    else
+    {
+        net_sin6(&addr)->sin6_family = AF_INET6;
+        net_sin6(&addr)->sin6_port = htons(CONFIG_POUCH_UDP_PORT);
+        addr_len = sizeof(struct sockaddr_in6);
+    }
+
+    int sock = zsock_socket(addr.sa_family, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0)
+    {
+        LOG_ERR("Failed to create socket: %d", errno);
+        return -errno;
+    }
+
+    if (zsock_bind(sock, &addr, addr_len) < 0)
+    {
+        int err = -errno;
+        LOG_ERR("Failed to bind port %u: %d", CONFIG_POUCH_UDP_PORT, err);
+        zsock_close(sock);
+        return err;
+    }
+
+    k_mutex_init(&broker.tx_lock);
+    k_mutex_init(&broker.sessions_lock);
+    broker.callback = callback;
+    broker.sock = sock;
+
+    for (size_t i = 0; i < ARRAY_SIZE(broker.sessions); i++)
+    {
+        struct udp_session *s = &broker.sessions[i];
+
+        s->mux.send = link_send;
+        s->mux.maxlen = CONFIG_POUCH_UDP_MTU;
+        s->mux.window = CONFIG_POUCH_UDP_WINDOW_SIZE;
+        pouch_mux_session_init(&s->session, &s->mux, session_end);
+    }
+
+    k_thread_create(&rx_thread,
+                    rx_stack,
+                    K_THREAD_STACK_SIZEOF(rx_stack),
+                    rx_loop,
+                    NULL,
+                    NULL,
+                    NULL,
+                    CONFIG_POUCH_UDP_RX_PRIORITY,
+                    0,
+                    K_NO_WAIT);
+    k_thread_name_set(&rx_thread, "pouch_udp_broker");
+
+    LOG_INF("Listening on port %u", CONFIG_POUCH_UDP_PORT);
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <pouch/transport/udp.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/net/net_ip.h>
+#include <zephyr/net/socket.h>
+
+#include "../mux/mux.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(pouch_udp, CONFIG_POUCH_UDP_LOG_LEVEL);
+
+static struct
+{
+    struct pouch_mux_link mux;
+    int sock;
+    struct k_mutex tx_lock;
+    /** Datagrams hold the channel followed by the packet */
+    uint8_t tx_buf[1 + CONFIG_POUCH_UDP_MTU];
+    uint8_t rx_buf[1 + CONFIG_POUCH_UDP_MTU];
+} udp = {
+    .sock = -1,
+};
+
+static K_THREAD_STACK_DEFINE(rx_stack, CONFIG_POUCH_UDP_RX_STACK_SIZE);
+static struct k_thread rx_thread;
+
+static int link_send(struct pouch_mux_link *mux,
+                     uint8_t channel,
+                     const uint8_t *packet,
+                     size_t len,
+                     k_timeout_t timeout)
+{
+    if (len > CONFIG_POUCH_UDP_MTU)
+    {
+        return -EMSGSIZE;
+    }
+
+    k_mutex_lock(&udp.tx_lock, K_FOREVER);
+    udp.tx_buf[0] = channel;
+    memcpy(&udp.tx_buf[1], packet, len);
+    ssize_t ret = zsock_send(udp.sock, udp.tx_buf, len + 1, 0);
+    k_mutex_unlock(&udp.tx_lock);
+
+    if (ret < 0)
+    {
+        LOG_ERR("Send failed: %d", errno);
+        return -errno;
+    }
+
+    return 0;
+}
+
+static void rx_loop(void *p1, void *p2, void *p3)
+{
+    while (true)
+    {
+        ssize_t len = zsock_recv(udp.sock, udp.rx_buf, sizeof(udp.rx_buf), 0);
+        if (len < 0)
+        {
+            LOG_ERR("Recv failed: %d", errno);
+            k_sleep(K_MSEC(100));
+            continue;
+        }
+
+        if (len < 1)
+        {
+            continue;
+        }
+
+        pouch_mux_device_recv(udp.rx_buf[0], &udp.rx_buf[1], len - 1);
+    }
+}
+
+static int udp_open(void)
+{
+    struct sockaddr addr = {0};
+
+    if (!net_ipaddr_parse(CONFIG_POUCH_UDP_GATEWAY_ADDR,
+                          strlen(CONFIG_POUCH_UDP_GATEWAY_ADDR),
+                          &addr))
+    {
+        LOG_ERR("Invalid gateway address: %s", CONFIG_POUCH_UDP_GATEWAY_ADDR);
+        return -EINVAL;
+    }
+
+    if (addr.sa_family == AF_INET6)
+    {
+        net_sin6(&addr)->sin6_port = htons(CONFIG_POUCH_UDP_PORT);
+    }
+    else
+    {
+        net_sin(&addr)->sin_port = htons(CONFIG_POUCH_UDP_PORT);
+    }
+
+    int sock = zsock_socket(addr.sa_family, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0)
+    {
+        LOG_ERR("Failed to create socket: %d", errno);
+        return -errno;
+    }
+
+    // Only accept datagrams from the gateway:
+    if (zsock_connect(sock, &addr, sizeof(addr)) < 0)
+    {
+        int err = -errno;
+        LOG_ERR("Failed to connect socket: %d", err);
+        zsock_close(sock);
+        return err;
+    }
+
+    udp.sock = sock;
+    udp.mux.send = link_send;
+    udp.mux.maxlen = CONFIG_POUCH_UDP_MTU;
+    udp.mux.window = CONFIG_POUCH_UDP_WINDOW_SIZE;
+    k_mutex_init(&udp.tx_lock);
+
+    pouch_mux_device_start(&udp.mux);
+
+    k_thread_create(&rx_thread,
+                    rx_stack,
+                    K_THREAD_STACK_SIZEOF(rx_stack),
+                    rx_loop,
+                    NULL,
+                    NULL,
+                    NULL,
+                    CONFIG_POUCH_UDP_RX_PRIORITY,
+                    0,
+                    K_NO_WAIT);
+    k_thread_name_set(&rx_thread, "pouch_udp");
+
+    return 0;
+}
+
+int pouch_udp_start(void)
+{
+    if (udp.sock < 0)
+    {
+        int err = udp_open();
+        if (err)
+        {
+            return err;
+        }
+    }
+
+    return pouch_mux_control(&udp.mux, 0, POUCH_MUX_CMD_SYNC);
+}
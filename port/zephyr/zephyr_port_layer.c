@@ -115,6 +115,11 @@ pouch_timeout_t pouch_timepoint_timeout(pouch_timepoint_t tp)
     return sys_timepoint_timeout(tp);
 }
 
+uint32_t pouch_uptime_ms(void)
+{
+    return k_uptime_get_32();
+}
+
 /*--------------------------------------------------
  * Linked List
  *------------------------------------------------*/
@@ -19,6 +19,14 @@ int crypto_session_start(void);
 /** Notify the crypto module that the pouch session is ending */
 void crypto_session_end(void);
 
+/**
+ * Notify the crypto module that the transport session ended with an incomplete uplink pouch.
+ *
+ * Ends the downlink session, but keeps the uplink session alive, so the pouch can be resumed in
+ * the next transport session. Must be followed by @ref crypto_session_end once the pouch is done.
+ */
+void crypto_session_suspend(void);
+
 /** Start a new downlink pouch */
 int crypto_downlink_start(const struct encryption_info *encryption_info);
 
@@ -36,15 +44,15 @@ int crypto_header_get(struct encryption_info *encryption_info);
 struct pouch_buf *crypto_block_buf_alloc(void);
 
 /**
- * Decrypt a block of data.
+ * Decrypt a block of data in place.
  *
- * @param block buffer where encrypted input is located
- * @param decrypted buffer where decrypted data will be written. Only valid when return code is 0.
+ * @param block buffer where encrypted input is located. Holds the plaintext block when the return
+ * code is 0.
  *
  * @return 0 if successful
  * @return negative error code on failure
  */
-int crypto_decrypt_block(const struct pouch_buf *block, struct pouch_buf *decrypted);
+int crypto_decrypt_block(struct pouch_buf *block);
 
 /**
  * Encrypt a block of data.
@@ -34,6 +34,8 @@ int crypto_session_start(void)
 
 void crypto_session_end(void) {}
 
+void crypto_session_suspend(void) {}
+
 int crypto_downlink_start(const struct encryption_info *encryption_info)
 {
     if (encryption_info->Union_choice != encryption_info_union_plaintext_info_m_c)
@@ -63,13 +65,9 @@ struct pouch_buf *crypto_block_buf_alloc(void)
     return buf_alloc(MAX_PLAINTEXT_BLOCK_SIZE);
 }
 
-int crypto_decrypt_block(const struct pouch_buf *block, struct pouch_buf *decrypted)
+int crypto_decrypt_block(struct pouch_buf *block)
 {
-    struct pouch_bufview v;
-    pouch_bufview_init(&v, block);
-
-    size_t payload_len = pouch_bufview_available(&v);
-    pouch_bufview_memcpy(&v, buf_claim(decrypted, payload_len), payload_len);
+    /* Blocks are sent in plaintext */
     return 0;
 }
 
@@ -77,11 +77,19 @@ int crypto_downlink_start(const struct encryption_info *encryption_info)
         id.value.sequential.seqnum = session->session_id_sequential_m.seq;
     }
 
+    enum session_block_mode block_mode = SESSION_BLOCK_MODE_CHAINED;
+    if (session->block_mode_present
+        && session->block_mode.block_mode_choice == session_info_block_mode_independent_m_c)
+    {
+        block_mode = SESSION_BLOCK_MODE_INDEPENDENT;
+    }
+
     int err = saead_downlink_session_start(
         &id,
         session->algorithm_choice == session_info_algorithm_aes_gcm_m_c ? PSA_ALG_GCM
                                                                         : PSA_ALG_CHACHA20_POLY1305,
         session->max_block_size_log,
+        block_mode,
         pkey);
     if (err)
     {
@@ -102,6 +110,11 @@ void crypto_session_end(void)
     saead_downlink_session_end();
 }
 
+void crypto_session_suspend(void)
+{
+    saead_downlink_session_end();
+}
+
 int crypto_pouch_start(void)
 {
     return saead_uplink_pouch_start();
@@ -118,9 +131,9 @@ struct pouch_buf *crypto_block_buf_alloc(void)
     return saead_downlink_block_buf_alloc();
 }
 
-int crypto_decrypt_block(const struct pouch_buf *block, struct pouch_buf *decrypted)
+int crypto_decrypt_block(struct pouch_buf *block)
 {
-    return saead_downlink_block_decrypt(block, decrypted);
+    return saead_downlink_block_decrypt(block);
 }
 
 struct pouch_buf *crypto_encrypt_block(struct pouch_buf *block)
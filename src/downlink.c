@@ -5,6 +5,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <errno.h>
 #include <pouch/downlink.h>
@@ -14,7 +15,6 @@
 #include "cddl/header_decode.h"
 
 #include "block.h"
-#include <pouch/blockbuf.h>
 #include "buf.h"
 #include "crypto.h"
 #include "downlink.h"
@@ -22,70 +22,219 @@
 
 POUCH_LOG_REGISTER(downlink, CONFIG_POUCH_COMMON_LOG_LEVEL);
 
-static struct pouch_buf *encrypted;
-static bool pouch_header;
+/* Largest downlink pouch header that can be reassembled */
+#define DOWNLINK_HEADER_MAX_LEN 128
+
+#define CIPHERTEXT_BUF_SIZE \
+    ROUND_UP(POUCH_BUF_OVERHEAD + MAX_CIPHERTEXT_BLOCK_SIZE, sizeof(void *))
+
+enum reassembly_state
+{
+    REASSEMBLY_IDLE,
+    REASSEMBLY_HEADER,
+    REASSEMBLY_BLOCK_SIZE,
+    REASSEMBLY_BLOCK,
+    /** The pouch can't be parsed, drop the rest of it */
+    REASSEMBLY_ERROR,
+};
+
+/** Incremental parser for the incoming ciphertext */
+static struct
+{
+    enum reassembly_state state;
+    /** Header bytes received so far */
+    uint8_t header[DOWNLINK_HEADER_MAX_LEN];
+    size_t header_len;
+    /** Block that is being filled */
+    struct pouch_buf *block;
+    /** Bytes missing from the current block */
+    size_t remaining;
+} reassembly;
+
+/** Pool of ciphertext blocks, shared by the reassembly, the decryption and the dispatch */
+static struct
+{
+    uint8_t storage[CONFIG_POUCH_DOWNLINK_CIPHERTEXT_BLOCK_COUNT][CIPHERTEXT_BUF_SIZE]
+        __attribute__((aligned(sizeof(void *))));
+    pouch_buf_queue_t free;
+    pouch_sem_t available;
+} ciphertext;
 
 static struct
 {
     pouch_buf_queue_t queue;
     pouch_work_t work;
     pouch_work_q_t *work_queue;
+    /** Decrypted blocks that may be in flight at once */
+    pouch_sem_t slots;
 } decrypt;
 
+static struct
+{
+    /** Decrypted blocks waiting for the handlers */
+    pouch_buf_queue_t queue;
+    pouch_work_t work;
+    pouch_work_q_t *work_queue;
+} dispatch;
+
+#if CONFIG_POUCH_DOWNLINK_PIPELINE_DEPTH > 1
+POUCH_THREAD_STACK_DEFINE(downlink_dispatch_stack, CONFIG_POUCH_DOWNLINK_DISPATCH_STACK_SIZE);
+static pouch_work_q_t dispatch_work_queue;
+#endif
+
 static void decrypt_blocks(pouch_work_t *work);
+static void dispatch_blocks(pouch_work_t *work);
+
+/**
+ * Reserve @p count ciphertext blocks without waiting.
+ *
+ * The reassembly runs on the bearer's receive path, which must not block on the decryption.
+ *
+ * @return true if all the blocks were reserved, false if none were.
+ */
+static bool ciphertext_blocks_reserve(size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pouch_sem_take(&ciphertext.available, POUCH_NO_WAIT) != 0)
+        {
+            while (i--)
+            {
+                pouch_sem_give(&ciphertext.available);
+            }
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** Take a block reserved with ciphertext_blocks_reserve() */
+static struct pouch_buf *ciphertext_block_take(void)
+{
+    struct pouch_buf *block = buf_queue_get(&ciphertext.free);
+    buf_init(block);
+
+    return block;
+}
+
+static void ciphertext_block_free(struct pouch_buf *block)
+{
+    if (block == NULL)
+    {
+        return;
+    }
+
+    buf_queue_submit(&ciphertext.free, block);
+    pouch_sem_give(&ciphertext.available);
+}
 
 int downlink_init(pouch_work_q_t *pouch_work_queue)
 {
+    buf_queue_init(&ciphertext.free);
+    for (int i = 0; i < CONFIG_POUCH_DOWNLINK_CIPHERTEXT_BLOCK_COUNT; i++)
+    {
+        struct pouch_buf *block = (struct pouch_buf *) ciphertext.storage[i];
+        buf_init(block);
+        buf_queue_submit(&ciphertext.free, block);
+    }
+    pouch_sem_init(&ciphertext.available,
+                   CONFIG_POUCH_DOWNLINK_CIPHERTEXT_BLOCK_COUNT,
+                   CONFIG_POUCH_DOWNLINK_CIPHERTEXT_BLOCK_COUNT);
+
     buf_queue_init(&decrypt.queue);
     pouch_work_init(&decrypt.work, decrypt_blocks);
     decrypt.work_queue = pouch_work_queue;
+    pouch_sem_init(&decrypt.slots,
+                   CONFIG_POUCH_DOWNLINK_PIPELINE_DEPTH,
+                   CONFIG_POUCH_DOWNLINK_PIPELINE_DEPTH);
+
+    buf_queue_init(&dispatch.queue);
+    pouch_work_init(&dispatch.work, dispatch_blocks);
+
+#if CONFIG_POUCH_DOWNLINK_PIPELINE_DEPTH > 1
+    /* Run the handlers on their own thread, so decryption of the next
+     * blocks can continue while a slow handler processes the current one.
+     */
+    pouch_work_queue_init(&dispatch_work_queue);
+    pouch_work_queue_start(&dispatch_work_queue,
+                           downlink_dispatch_stack,
+                           CONFIG_POUCH_DOWNLINK_DISPATCH_STACK_SIZE,
+                           CONFIG_POUCH_DOWNLINK_DISPATCH_PRIORITY,
+                           "downlink_workq");
+    dispatch.work_queue = &dispatch_work_queue;
+#else
+    dispatch.work_queue = pouch_work_queue;
+#endif
 
     return 0;
 }
 
-static void decrypt_blocks(pouch_work_t *work)
+static void drop_encrypted_blocks(void)
 {
     struct pouch_buf *encrypted_block;
-    struct pouch_buf *decrypted_block = blockbuf_alloc(POUCH_FOREVER);
-    if (decrypted_block == NULL)
-    {
-        POUCH_LOG_ERR("Failed to allocate decrypt block");
-        return;
-    }
 
     while ((encrypted_block = buf_queue_get(&decrypt.queue)) != NULL)
     {
-        int err;
-        // Reset the target buffer
-        buf_restore(decrypted_block, POUCH_BUF_STATE_INITIAL);
+        ciphertext_block_free(encrypted_block);
+    }
+}
 
-        /* Decrypt this block */
-        err = crypto_decrypt_block(encrypted_block, decrypted_block);
+static void decrypt_blocks(pouch_work_t *work)
+{
+    while (!buf_queue_is_empty(&decrypt.queue))
+    {
+        /* Stop when the pipeline is full. dispatch_blocks() resubmits this
+         * work when it releases a slot.
+         */
+        if (pouch_sem_take(&decrypt.slots, POUCH_NO_WAIT) != 0)
+        {
+            break;
+        }
 
-        /* Encrypted block was consumed; free buffer no matter the outcome */
-        /* buffers were allocated then enqueued in pouch_downlink_push() */
-        buf_free(encrypted_block);
+        struct pouch_buf *block = buf_queue_get(&decrypt.queue);
 
-        /* Test to see if decrypt buffer contains valid data */
+        /* Decrypt this block in place */
+        int err = crypto_decrypt_block(block);
         if (err)
         {
             POUCH_LOG_ERR("Failed to decrypt block: %d", err);
-            // TODO: Abort the downlink
+            /* buffers were allocated then enqueued in pouch_downlink_push() */
+            ciphertext_block_free(block);
+            pouch_sem_give(&decrypt.slots);
+            /* The rest of the pouch can't be authenticated without this block */
+            drop_encrypted_blocks();
             break;
         }
 
-        err = pouch_downlink_block_push(decrypted_block);
+        /* buffers pushed to the queue are freed in dispatch_blocks() */
+        buf_queue_submit(&dispatch.queue, block);
+        pouch_work_submit_to_queue(dispatch.work_queue, &dispatch.work);
+
+        pouch_yield();  // let other threads run
+    }
+}
+
+static void dispatch_blocks(pouch_work_t *work)
+{
+    struct pouch_buf *decrypted_block;
+
+    while ((decrypted_block = buf_queue_get(&dispatch.queue)) != NULL)
+    {
+        int err = pouch_downlink_block_push(decrypted_block);
         if (err)
         {
             POUCH_LOG_ERR("Failed to push block: %d", err);
             // TODO: Abort the downlink
-            break;
         }
 
-        pouch_yield();  // let other threads run
-    }
+        ciphertext_block_free(decrypted_block);
+        pouch_sem_give(&decrypt.slots);
 
-    blockbuf_free(decrypted_block);
+        /* Let the decryption continue if it was waiting for a slot */
+        pouch_work_submit_to_queue(decrypt.work_queue, &decrypt.work);
+    }
 }
 
 static int block_downlink_push(struct pouch_buf *pouch_buf)
@@ -98,30 +247,122 @@ void pouch_downlink_start(void)
 {
     POUCH_LOG_DBG("Pouch downlink start");
 
-    pouch_header = false;
+    ciphertext_block_free(reassembly.block);
+    reassembly.block = NULL;
+    reassembly.header_len = 0;
+    reassembly.state = REASSEMBLY_HEADER;
+}
 
-    encrypted = buf_alloc(MAX_CIPHERTEXT_BLOCK_SIZE);
-    if (!encrypted)
+/**
+ * Find the length of the CBOR data item at the start of @p buf.
+ *
+ * Only checks the structure of the item, so the header can be decoded once
+ * it's complete, instead of on every push.
+ *
+ * @retval 0 The item is complete, and @p item_len is set to its length.
+ * @retval -EAGAIN The item is incomplete.
+ * @retval -EBADMSG The item uses indefinite lengths or reserved values.
+ */
+static int cbor_item_len(const uint8_t *buf, size_t len, size_t *item_len)
+{
+    size_t offset = 0;
+    uint64_t pending = 1;
+
+    while (pending)
     {
-        POUCH_LOG_ERR("Failed to allocate pouch buf");
-        return;
+        if (offset >= len)
+        {
+            return -EAGAIN;
+        }
+
+        uint8_t major_type = buf[offset] >> 5;
+        uint8_t additional = buf[offset] & 0x1f;
+        uint64_t arg = additional;
+        offset++;
+
+        if (additional >= 24)
+        {
+            if (additional > 27)
+            {
+                return -EBADMSG;
+            }
+
+            size_t arg_len = 1 << (additional - 24);
+            if (len - offset < arg_len)
+            {
+                return -EAGAIN;
+            }
+
+            arg = 0;
+            for (size_t i = 0; i < arg_len; i++)
+            {
+                arg = (arg << 8) | buf[offset++];
+            }
+        }
+
+        pending--;
+
+        switch (major_type)
+        {
+            case 2: /* bstr */
+            case 3: /* tstr */
+                if (len - offset < arg)
+                {
+                    return -EAGAIN;
+                }
+                offset += arg;
+                break;
+            case 4: /* array */
+                pending += arg;
+                break;
+            case 5: /* map */
+                pending += 2 * arg;
+                break;
+            case 6: /* tag */
+                pending += 1;
+                break;
+            default:
+                break;
+        }
     }
+
+    *item_len = offset;
+    return 0;
 }
 
-static int pouch_downlink_parse_header(struct pouch_bufview *v, size_t *header_len)
+/**
+ * Parse the pouch header from the bytes received so far.
+ *
+ * @retval 0 The header was parsed, and @p header_len is set to its length.
+ * @retval -EAGAIN The header is incomplete.
+ * @retval -EBADMSG The header is malformed.
+ */
+static int pouch_downlink_parse_header(size_t *header_len)
 {
-    const uint8_t *header_raw = pouch_bufview_read(v, 0);
     struct pouch_header header;
+    size_t decoded_len;
     int ret;
 
-    ret = cbor_decode_pouch_header(header_raw, pouch_bufview_available(v), &header, header_len);
+    ret = cbor_item_len(reassembly.header, reassembly.header_len, header_len);
+    if (ret == -EAGAIN && reassembly.header_len < sizeof(reassembly.header))
+    {
+        return -EAGAIN;
+    }
+
+    if (ret)
+    {
+        POUCH_LOG_ERR("Invalid pouch header length");
+        return -EBADMSG;
+    }
+
+    ret = cbor_decode_pouch_header(reassembly.header, *header_len, &header, &decoded_len);
     if (ret != ZCBOR_SUCCESS)
     {
-        POUCH_LOG_DBG("Failed to decode pouch header: %d", ret);
-        return -EIO;
+        POUCH_LOG_ERR("Failed to decode pouch header: %d", ret);
+        return -EBADMSG;
     }
 
-    POUCH_LOG_HEXDUMP(header_raw, *header_len, "pouch header raw");
+    POUCH_LOG_HEXDUMP(reassembly.header, *header_len, "pouch header raw");
 
     POUCH_LOG_DBG("Header version %d", (int) header.version);
     POUCH_LOG_DBG("Encryption type %s",
@@ -141,108 +382,205 @@ static int pouch_downlink_parse_header(struct pouch_bufview *v, size_t *header_l
     return 0;
 }
 
-int pouch_downlink_push(const void *buf, size_t buf_len)
+/** Consume header bytes, returns the number of bytes that belong to the header */
+static size_t header_push(const uint8_t *buf, size_t buf_len)
 {
-    const uint8_t *buf_p = buf;
+    size_t copied = MIN(buf_len, sizeof(reassembly.header) - reassembly.header_len);
+    memcpy(&reassembly.header[reassembly.header_len], buf, copied);
+    reassembly.header_len += copied;
 
-    POUCH_LOG_HEXDUMP(buf, buf_len, "Pouch downlink push: ");
-
-    while (buf_len)
+    size_t header_len = 0;
+    int err = pouch_downlink_parse_header(&header_len);
+    if (err == -EAGAIN)
     {
-        if (!encrypted)
-        {
-            POUCH_LOG_WRN("No pouch_buf allocated");
-            return -ENOMEM;
-        }
+        return copied;
+    }
 
-        if (buf_size_get(encrypted) >= MAX_CIPHERTEXT_BLOCK_SIZE)
-        {
-            POUCH_LOG_ERR("No more space for pouch header");
-            return -ENOMEM;
-        }
+    if (err)
+    {
+        /* Match previous behavior but needs more differentiation. Future work tracked here:
+         * https://github.com/golioth/firmware-issue-tracker/issues/924
+         */
+        reassembly.state = REASSEMBLY_ERROR;
+        return buf_len;
+    }
 
-        size_t buf_written = MIN(buf_len, MAX_CIPHERTEXT_BLOCK_SIZE - buf_size_get(encrypted));
-        buf_write(encrypted, buf_p, buf_written);
+    reassembly.state = REASSEMBLY_BLOCK_SIZE;
 
-        buf_p += buf_written;
-        buf_len -= buf_written;
+    /* Everything past the header is the start of the first block */
+    return copied - (reassembly.header_len - header_len);
+}
 
-        struct pouch_bufview v;
-        pouch_bufview_init(&v, encrypted);
+/**
+ * Count the ciphertext blocks that reassembling @p buf_len more bytes would start.
+ *
+ * Walks the same states as reassemble(), without consuming anything, so the blocks can be
+ * reserved before any of the bytes are.
+ */
+static size_t blocks_needed(const uint8_t *buf, size_t buf_len)
+{
+    enum reassembly_state state = reassembly.state;
+    size_t remaining = reassembly.remaining;
+    bool has_block = (reassembly.block != NULL);
+    size_t size_len = 0;
+    uint16_t block_size = 0;
+    size_t count = 0;
+
+    if (state == REASSEMBLY_HEADER)
+    {
+        /* The header buffer past header_len is free, and header_push() copies the same bytes */
+        size_t copied = MIN(buf_len, sizeof(reassembly.header) - reassembly.header_len);
+        memcpy(&reassembly.header[reassembly.header_len], buf, copied);
 
-        if (!pouch_header)
+        size_t header_len;
+        if (cbor_item_len(reassembly.header, reassembly.header_len + copied, &header_len))
         {
-            size_t header_len = 0;
-            int err = pouch_downlink_parse_header(&v, &header_len);
-            if (err)
-            {
-                /* Match previous behavior but needs more differentiation. Future work tracked here:
-                 * https://github.com/golioth/firmware-issue-tracker/issues/924
-                 */
-                return 0;
-            }
+            return 0;
+        }
 
-            pouch_header = true;
+        size_t skipped = header_len - reassembly.header_len;
+        buf += skipped;
+        buf_len -= skipped;
+        state = REASSEMBLY_BLOCK_SIZE;
+    }
 
-            /* Align first block with encrypted start */
-            buf_trim_start(encrypted, header_len);
+    if (state == REASSEMBLY_BLOCK_SIZE && has_block)
+    {
+        /* The block holds the part of the size field received so far */
+        struct pouch_bufview v;
+        uint8_t byte;
 
-            POUCH_LOG_HEXDUMP(pouch_bufview_read(&v, 0), pouch_bufview_available(&v), "remaining");
+        pouch_bufview_init(&v, reassembly.block);
+        while (pouch_bufview_read_byte(&v, &byte) == 0)
+        {
+            block_size = (block_size << 8) | byte;
+            size_len++;
         }
+    }
 
-        if (pouch_bufview_available(&v) > sizeof(uint16_t))
+    while (buf_len > 0 && (state == REASSEMBLY_BLOCK_SIZE || state == REASSEMBLY_BLOCK))
+    {
+        if (state == REASSEMBLY_BLOCK_SIZE)
         {
-            uint16_t block_size;
-            int err = pouch_bufview_read_be16(&v, &block_size);
-            if (err)
+            if (!has_block)
             {
-                POUCH_LOG_ERR("Failed to read block size: %d", err);
-                return err;
+                count++;
+                has_block = true;
             }
 
-            if (block_size > MAX_BLOCK_SIZE_FIELD_VALUE)
+            block_size = (block_size << 8) | *buf;
+            buf++;
+            buf_len--;
+
+            if (++size_len == sizeof(uint16_t))
             {
-                POUCH_LOG_ERR("Block size %u is bigger than supported %u",
-                              (unsigned int) block_size,
-                              (unsigned int) (MAX_BLOCK_SIZE_FIELD_VALUE));
-                return -ENOMEM;
+                if (block_size > MAX_BLOCK_SIZE_FIELD_VALUE)
+                {
+                    break;
+                }
+
+                remaining = block_size;
+                state = REASSEMBLY_BLOCK;
+                size_len = 0;
+                block_size = 0;
             }
+        }
+        else
+        {
+            size_t consumed = MIN(buf_len, remaining);
+            buf += consumed;
+            buf_len -= consumed;
+            remaining -= consumed;
+        }
 
-            if (pouch_bufview_available(&v) >= block_size)
-            {
-                POUCH_LOG_DBG("Block ready %d available %d",
-                              (int) block_size,
-                              (int) pouch_bufview_available(&v));
+        if (state == REASSEMBLY_BLOCK && remaining == 0)
+        {
+            has_block = false;
+            state = REASSEMBLY_BLOCK_SIZE;
+        }
+    }
 
-                struct pouch_buf *encrypted_block = encrypted;
+    return count;
+}
+
+/** Reassemble ciphertext blocks, taking new blocks from the @p reserved ones */
+static int reassemble(const uint8_t *buf_p, size_t buf_len, size_t *reserved)
+{
+    while (buf_len)
+    {
+        size_t consumed;
 
-                encrypted = buf_alloc(MAX_CIPHERTEXT_BLOCK_SIZE);
-                if (!encrypted)
+        switch (reassembly.state)
+        {
+            case REASSEMBLY_IDLE:
+                POUCH_LOG_WRN("Downlink not started");
+                return -ENOMEM;
+            case REASSEMBLY_ERROR:
+                return 0;
+            case REASSEMBLY_HEADER:
+                consumed = header_push(buf_p, buf_len);
+                break;
+            case REASSEMBLY_BLOCK_SIZE:
+                if (reassembly.block == NULL)
                 {
-                    POUCH_LOG_ERR("Failed to allocate pouch buf");
-                    buf_free(encrypted_block);
-                    return -ENOMEM;
+                    if (*reserved == 0)
+                    {
+                        POUCH_LOG_ERR("No block reserved");
+                        return -ENOMEM;
+                    }
+
+                    reassembly.block = ciphertext_block_take();
+                    (*reserved)--;
                 }
 
-                if (pouch_bufview_available(&v) > block_size)
+                consumed = MIN(buf_len, sizeof(uint16_t) - buf_size_get(reassembly.block));
+                buf_write(reassembly.block, buf_p, consumed);
+
+                if (buf_size_get(reassembly.block) == sizeof(uint16_t))
                 {
-                    const uint8_t *remaining = pouch_bufview_read(&v, 0);
-                    remaining += block_size;
-                    size_t remaining_len = pouch_bufview_available(&v) - block_size;
+                    struct pouch_bufview v;
+                    uint16_t block_size;
+
+                    pouch_bufview_init(&v, reassembly.block);
+                    pouch_bufview_read_be16(&v, &block_size);
+
+                    if (block_size > MAX_BLOCK_SIZE_FIELD_VALUE)
+                    {
+                        POUCH_LOG_ERR("Block size %u is bigger than supported %u",
+                                      (unsigned int) block_size,
+                                      (unsigned int) (MAX_BLOCK_SIZE_FIELD_VALUE));
+                        reassembly.state = REASSEMBLY_ERROR;
+                        return -ENOMEM;
+                    }
+
+                    reassembly.remaining = block_size;
+                    reassembly.state = REASSEMBLY_BLOCK;
+                }
+                break;
+            case REASSEMBLY_BLOCK:
+                consumed = MIN(buf_len, reassembly.remaining);
+                buf_write(reassembly.block, buf_p, consumed);
+                reassembly.remaining -= consumed;
+                break;
+            default:
+                return -EINVAL;
+        }
 
-                    POUCH_LOG_HEXDUMP(remaining, remaining_len, "remaining");
+        buf_p += consumed;
+        buf_len -= consumed;
 
-                    buf_write(encrypted, remaining, remaining_len);
-                    buf_trim_end(encrypted_block, remaining_len);
-                }
+        if (reassembly.state == REASSEMBLY_BLOCK && reassembly.remaining == 0)
+        {
+            POUCH_LOG_DBG("Block ready %d", (int) buf_size_get(reassembly.block));
 
-                /* buffers pushed to queue are freed in decrypt_blocks(). */
-                err = block_downlink_push(encrypted_block);
-                if (0 > err)
-                {
-                    POUCH_LOG_ERR("Failed to enqueue block: %d", err);
-                    return err;
-                }
+            /* buffers pushed to queue are freed in decrypt_blocks(). */
+            int err = block_downlink_push(reassembly.block);
+            reassembly.block = NULL;
+            reassembly.state = REASSEMBLY_BLOCK_SIZE;
+            if (0 > err)
+            {
+                POUCH_LOG_ERR("Failed to enqueue block: %d", err);
+                return err;
             }
         }
     }
@@ -250,19 +588,54 @@ int pouch_downlink_push(const void *buf, size_t buf_len)
     return 0;
 }
 
+int pouch_downlink_push(const void *buf, size_t buf_len)
+{
+    POUCH_LOG_HEXDUMP(buf, buf_len, "Pouch downlink push: ");
+
+    /* Reserve every block this push needs up front, so it either consumes all of the data or
+     * none of it. When the decryption is holding all the blocks, the transport drops the data and
+     * gets it again later, instead of blocking the bearer's receive path.
+     */
+    size_t reserved = blocks_needed(buf, buf_len);
+    if (!ciphertext_blocks_reserve(reserved))
+    {
+        POUCH_LOG_DBG("No free blocks, %u needed", (unsigned int) reserved);
+        return -EAGAIN;
+    }
+
+    int err = reassemble(buf, buf_len, &reserved);
+
+    /* Reserved blocks are left over if the pouch turned out to be malformed */
+    while (reserved--)
+    {
+        pouch_sem_give(&ciphertext.available);
+    }
+
+    return err;
+}
+
 void pouch_downlink_finish(void)
 {
-    buf_free(encrypted);
-    encrypted = NULL;
+    ciphertext_block_free(reassembly.block);
+    reassembly.block = NULL;
+    reassembly.state = REASSEMBLY_IDLE;
 }
 
 void pouch_downlink_flush(void)
 {
     /*
-     * Block until any in-flight decrypt work has completed. The decrypt work
-     * queue is a single FIFO worker and decrypt_blocks() drains its whole buffer
-     * queue per run, so flushing the queue waits for every block pushed so far to
-     * be decrypted.
+     * Block until every block pushed so far has been decrypted and passed to
+     * the handlers. Both work queues are single FIFO workers that drain their
+     * whole buffer queue per run, but the decryption stops early when the
+     * pipeline is full, and is resubmitted by the dispatch worker. Keep
+     * flushing both queues until the decryption has caught up, then wait for
+     * the queued handlers to process what was dispatched to them.
      */
-    pouch_work_queue_flush(decrypt.work_queue);
+    do
+    {
+        pouch_work_queue_flush(decrypt.work_queue);
+        pouch_work_queue_flush(dispatch.work_queue);
+    } while (!buf_queue_is_empty(&decrypt.queue));
+
+    downlink_handlers_flush();
 }
@@ -59,15 +59,148 @@ static const char *entry_content_format_str(int content_format)
     return "unsupported";
 }
 
-static void downlink_start(unsigned int stream_id, const char *path, uint16_t content_type)
+POUCH_STATIC_ASSERT(MAX_BLOCK_PAYLOAD_SIZE <= POUCH_DOWNLINK_EVENT_DATA_MAX,
+                    "Downlink events must fit a whole block");
+
+#if CONFIG_POUCH_DOWNLINK_HANDLER_WORK_QUEUE
+POUCH_THREAD_STACK_DEFINE(downlink_handler_stack,
+                          CONFIG_POUCH_DOWNLINK_HANDLER_WORK_QUEUE_STACK_SIZE);
+static pouch_work_q_t downlink_handler_work_q;
+#endif
+
+static void handler_queue_process(pouch_work_t *work)
+{
+    struct pouch_downlink_handler_queue *queue =
+        CONTAINER_OF(work, struct pouch_downlink_handler_queue, work);
+    struct pouch_downlink_event *event;
+
+    while (0 == pouch_msgq_get(&queue->pending, &event, POUCH_NO_WAIT))
+    {
+        if (event->is_start)
+        {
+            queue->handler->start_cb(event->stream_id,
+                                     (const char *) event->data,
+                                     event->len,
+                                     event->content_type);
+        }
+        else
+        {
+            queue->handler->data_cb(event->stream_id, event->data, event->len, event->is_last);
+        }
+
+        pouch_msgq_put(&queue->free, &event, POUCH_NO_WAIT);
+    }
+}
+
+/** Get a free event for the handler. Waits for the handler to catch up instead of dropping data. */
+static struct pouch_downlink_event *handler_queue_event_get(
+    struct pouch_downlink_handler_queue *queue)
+{
+    struct pouch_downlink_event *event;
+
+    pouch_msgq_get(&queue->free, &event, POUCH_FOREVER);
+
+    return event;
+}
+
+static void handler_queue_submit(struct pouch_downlink_handler_queue *queue,
+                                 struct pouch_downlink_event *event,
+                                 const void *data,
+                                 size_t len)
+{
+    event->len = len;
+    memcpy(event->data, data, len);
+
+    pouch_msgq_put(&queue->pending, &event, POUCH_NO_WAIT);
+    pouch_work_submit_to_queue(queue->work_queue, &queue->work);
+}
+
+static void downlink_handlers_init(void)
+{
+#if CONFIG_POUCH_DOWNLINK_HANDLER_WORK_QUEUE
+    pouch_work_queue_init(&downlink_handler_work_q);
+    pouch_work_queue_start(&downlink_handler_work_q,
+                           downlink_handler_stack,
+                           CONFIG_POUCH_DOWNLINK_HANDLER_WORK_QUEUE_STACK_SIZE,
+                           CONFIG_POUCH_DOWNLINK_HANDLER_WORK_QUEUE_PRIORITY,
+                           "downlink_handler_workq");
+#endif
+
+    POUCH_STRUCT_SECTION_FOREACH(pouch_downlink_handler, handler)
+    {
+        struct pouch_downlink_handler_queue *queue = handler->queue;
+        if (queue == NULL)
+        {
+            continue;
+        }
+
+        if (queue->work_queue == NULL)
+        {
+#if CONFIG_POUCH_DOWNLINK_HANDLER_WORK_QUEUE
+            queue->work_queue = &downlink_handler_work_q;
+#else
+            POUCH_LOG_ERR("Enable CONFIG_POUCH_DOWNLINK_HANDLER_WORK_QUEUE for shared handlers");
+            continue;
+#endif
+        }
+
+        queue->handler = handler;
+        pouch_msgq_init(&queue->pending,
+                        queue->buf,
+                        queue->depth * sizeof(struct pouch_downlink_event *),
+                        sizeof(struct pouch_downlink_event *));
+        pouch_msgq_init(&queue->free,
+                        queue->free_buf,
+                        queue->depth * sizeof(struct pouch_downlink_event *),
+                        sizeof(struct pouch_downlink_event *));
+        for (size_t i = 0; i < queue->depth; i++)
+        {
+            struct pouch_downlink_event *event = &queue->events[i];
+            pouch_msgq_put(&queue->free, &event, POUCH_NO_WAIT);
+        }
+
+        pouch_work_init(&queue->work, handler_queue_process);
+    }
+}
+
+void downlink_handlers_flush(void)
+{
+    POUCH_STRUCT_SECTION_FOREACH(pouch_downlink_handler, handler)
+    {
+        if (handler->queue != NULL && handler->queue->handler != NULL)
+        {
+            pouch_work_queue_flush(handler->queue->work_queue);
+        }
+    }
+}
+POUCH_APPLICATION_STARTUP_HOOK(downlink_handlers_init);
+
+static void downlink_start(unsigned int stream_id,
+                           const char *path,
+                           size_t path_len,
+                           uint16_t content_type)
 {
     POUCH_LOG_DBG("Entry stream_id: %u", stream_id);
-    POUCH_LOG_DBG("Entry path: %s", path);
+    POUCH_LOG_DBG("Entry path: %.*s", (int) path_len, path);
     POUCH_LOG_DBG("Entry content_type: %u", content_type);
 
     POUCH_STRUCT_SECTION_FOREACH(pouch_downlink_handler, handler)
     {
-        handler->start_cb(stream_id, path, content_type);
+        if (handler->queue != NULL && handler->queue->handler != NULL)
+        {
+            struct pouch_downlink_event *event = handler_queue_event_get(handler->queue);
+
+            event->stream_id = stream_id;
+            event->is_start = true;
+            event->is_last = false;
+            event->content_type = content_type;
+
+            handler_queue_submit(handler->queue, event, path, path_len);
+        }
+        else
+        {
+            handler->start_cb(stream_id, path, path_len, content_type);
+        }
     }
 }
 
@@ -79,7 +212,21 @@ static void downlink_data(unsigned int stream_id, const void *data, size_t len,
 
     POUCH_STRUCT_SECTION_FOREACH(pouch_downlink_handler, handler)
     {
-        handler->data_cb(stream_id, data, len, is_last);
+        if (handler->queue != NULL && handler->queue->handler != NULL)
+        {
+            struct pouch_downlink_event *event = handler_queue_event_get(handler->queue);
+
+            event->stream_id = stream_id;
+            event->is_start = false;
+            event->is_last = is_last;
+            event->content_type = 0;
+
+            handler_queue_submit(handler->queue, event, data, len);
+        }
+        else
+        {
+            handler->data_cb(stream_id, data, len, is_last);
+        }
     }
 }
 
@@ -91,7 +238,6 @@ static int pouch_downlink_entries_push(struct pouch_bufview *v)
     const uint8_t *data;
     uint16_t data_len;
     uint16_t content_type;
-    uint8_t path_null_term[256];
 
     while (pouch_bufview_available(v))
     {
@@ -131,11 +277,7 @@ static int pouch_downlink_entries_push(struct pouch_bufview *v)
             return -ENODATA;
         }
 
-        /* Copy path to add NULL terminator */
-        memcpy(path_null_term, path, path_len);
-        path_null_term[path_len] = '\0';
-
-        downlink_start(0, (char *) path_null_term, content_type);
+        downlink_start(0, (const char *) path, path_len, content_type);
         downlink_data(0, data, data_len, true);
     }
 
@@ -156,7 +298,6 @@ static int pouch_downlink_stream_push(struct pouch_bufview *v,
         const uint8_t *path;
         uint8_t path_len;
         uint16_t content_type;
-        uint8_t path_null_term[256];
 
         err = pouch_bufview_read_be16(v, &content_type);
         if (err)
@@ -181,11 +322,7 @@ static int pouch_downlink_stream_push(struct pouch_bufview *v,
             return -ENODATA;
         }
 
-        /* Copy path to add NULL terminator */
-        memcpy(path_null_term, path, path_len);
-        path_null_term[path_len] = '\0';
-
-        downlink_start(stream_id, (char *) path_null_term, content_type);
+        downlink_start(stream_id, (const char *) path, path_len, content_type);
     }
 
     data_len = pouch_bufview_available(v);
@@ -10,3 +10,6 @@
 
 int pouch_downlink_block_push(struct pouch_buf *pouch_buf);
 int entry_block_close(pouch_timeout_t timeout);
+
+/** Block until the queued downlink handlers have run for every callback so far */
+void downlink_handlers_flush(void);
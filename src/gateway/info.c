@@ -63,7 +63,9 @@ void pouch_gateway_info_abort(struct pouch_gateway_info_context *context)
 
 int pouch_gateway_info_finish(struct pouch_gateway_info_context *context,
                               bool *server_cert_provisioned,
-                              bool *device_cert_provisioned)
+                              bool *device_cert_provisioned,
+                              uint16_t *l2cap_uplink_psm,
+                              uint16_t *l2cap_downlink_psm)
 {
     struct pouch_gatt_info info;
     uint8_t server_cert_serial_buf[CERT_SERIAL_MAXLEN];
@@ -87,6 +89,8 @@ int pouch_gateway_info_finish(struct pouch_gateway_info_context *context,
         (server_cert_serial.len > 0
          && zcbor_compare_strings(&info.server_cert_snr, &server_cert_serial));
     *device_cert_provisioned = !!(info.flags & INFO_FLAG_DEVICE_PROVISIONED);
+    *l2cap_uplink_psm = info.l2cap_uplink_psm_present ? info.l2cap_uplink_psm : 0;
+    *l2cap_downlink_psm = info.l2cap_downlink_psm_present ? info.l2cap_downlink_psm : 0;
 
     pouch_gateway_info_abort(context);
 
@@ -41,8 +41,12 @@ void pouch_gateway_info_abort(struct pouch_gateway_info_context *context);
  * @param context The info context.
  * @param[out] server_cert_provisioned Set to true if server cert is provisioned.
  * @param[out] device_cert_provisioned Set to true if device cert is provisioned.
+ * @param[out] l2cap_uplink_psm L2CAP PSM for the uplink, or 0 if the device only supports GATT.
+ * @param[out] l2cap_downlink_psm L2CAP PSM for the downlink, or 0 if the device only supports GATT.
  * @return 0 on success, negative on error.
  */
 int pouch_gateway_info_finish(struct pouch_gateway_info_context *context,
                               bool *server_cert_provisioned,
-                              bool *device_cert_provisioned);
+                              bool *device_cert_provisioned,
+                              uint16_t *l2cap_uplink_psm,
+                              uint16_t *l2cap_downlink_psm);
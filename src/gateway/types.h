@@ -22,5 +22,8 @@ struct pouch_gateway_node_info
     struct pouch_gateway_server_cert_context *server_cert_ctx;
     bool server_cert_provisioned;
     bool device_cert_provisioned;
+    /** L2CAP PSMs advertised by the node, or 0 if it only supports GATT */
+    uint16_t l2cap_uplink_psm;
+    uint16_t l2cap_downlink_psm;
     pouch_work_t close_work;
 };
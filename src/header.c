@@ -19,8 +19,8 @@
 
 #define POUCH_HEADER_VERSION 1
 
-// CBOR array start + version
-#define POUCH_HEADER_OVERHEAD 2
+// CBOR array start + version + optional first block index
+#define POUCH_HEADER_OVERHEAD 7
 
 #if defined(CONFIG_POUCH_ENCRYPTION_MOCK)
 
@@ -32,15 +32,19 @@
 #define POUCH_HEADER_MAX_LEN \
     (POUCH_HEADER_OVERHEAD + POUCH_HEADER_OVERHEAD_ENCRYPTION_NONE + POUCH_DEVICE_ID_MAX_LEN)
 #elif defined(CONFIG_POUCH_ENCRYPTION_SAEAD)
-#define POUCH_HEADER_MAX_LEN (16 + SESSION_ID_LEN + CERT_REF_SHORT_LEN)
+// The optional block mode adds a single byte:
+#define POUCH_HEADER_MAX_LEN \
+    (POUCH_HEADER_OVERHEAD + 15 + SESSION_ID_LEN + CERT_REF_SHORT_LEN)
 #else
 #error "Unsupported encryption type"
 #endif
 
-static int write_header(struct pouch_buf *buf, size_t maxlen)
+static int write_header(struct pouch_buf *buf, size_t maxlen, uint32_t first_block)
 {
     struct pouch_header header = {
         .version = POUCH_HEADER_VERSION,
+        .first_block = first_block,
+        .first_block_present = (first_block != 0),
     };
 
     int err = crypto_header_get(&header.encryption_info_m);
@@ -61,7 +65,7 @@ static int write_header(struct pouch_buf *buf, size_t maxlen)
     return 0;
 }
 
-struct pouch_buf *pouch_header_create(void)
+struct pouch_buf *pouch_header_create(uint32_t first_block)
 {
     struct pouch_buf *header = buf_alloc(POUCH_HEADER_MAX_LEN);
     if (!header)
@@ -69,7 +73,7 @@ struct pouch_buf *pouch_header_create(void)
         return NULL;
     }
 
-    int err = write_header(header, POUCH_HEADER_MAX_LEN);
+    int err = write_header(header, POUCH_HEADER_MAX_LEN, first_block);
     if (err)
     {
         buf_free(header);
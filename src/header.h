@@ -10,5 +10,8 @@
 
 /**
  * Allocate and encode a pouch header.
+ *
+ * @param first_block Index of the first block in this transfer. Non-zero when resuming an
+ * interrupted pouch.
  */
-struct pouch_buf *pouch_header_create(void);
+struct pouch_buf *pouch_header_create(uint32_t first_block);
@@ -36,7 +36,9 @@ static struct
 } server;
 
 /** Check that this session is a valid follow up to the previous downlink session */
-static bool is_valid_downlink(const struct session_id *id, psa_algorithm_t algorithm)
+static bool is_valid_downlink(const struct session_id *id,
+                              psa_algorithm_t algorithm,
+                              enum session_block_mode block_mode)
 {
     if (!pouch_atomic_test_bit(&downlink.flags, SESSION_VALID))
     {
@@ -51,6 +53,12 @@ static bool is_valid_downlink(const struct session_id *id, psa_algorithm_t algor
         return false;
     }
 
+    if (session_id_is_equal(&downlink.id, id) && downlink.block_mode != block_mode)
+    {
+        POUCH_LOG_ERR("Block mode doesn't match");
+        return false;
+    }
+
     if (id->initiator == POUCH_ROLE_SERVER)
     {
         // This was initiated by the server. If it's sequential, we can validate the sequence
@@ -70,11 +78,12 @@ static bool is_valid_downlink(const struct session_id *id, psa_algorithm_t algor
 int saead_downlink_session_start(const struct session_id *id,
                                  psa_algorithm_t algorithm,
                                  uint8_t max_block_size_log,
+                                 enum session_block_mode block_mode,
                                  psa_key_id_t private_key)
 {
     psa_key_id_t session_key;
 
-    if (!is_valid_downlink(id, algorithm))
+    if (!is_valid_downlink(id, algorithm, block_mode))
     {
         POUCH_LOG_ERR("Invalid downlink");
         return -EBADMSG;
@@ -89,7 +98,7 @@ int saead_downlink_session_start(const struct session_id *id,
             return -EBADMSG;
         }
 
-        if (!saead_uplink_session_matches(id, max_block_size_log, algorithm))
+        if (!saead_uplink_session_matches(id, max_block_size_log, algorithm, block_mode))
         {
             // The server claims to use our uplink's session, but it doesn't match
             POUCH_LOG_ERR("Session reuse failed: No match");
@@ -108,6 +117,7 @@ int saead_downlink_session_start(const struct session_id *id,
         session_key = session_key_generate(id,
                                            algorithm,
                                            max_block_size_log,
+                                           block_mode,
                                            private_key,
                                            &pubkey,
                                            DOWNLINK_KEY_USAGE);
@@ -122,6 +132,7 @@ int saead_downlink_session_start(const struct session_id *id,
     downlink.flags = POUCH_ATOMIC_INIT(0);
     downlink.pouch.id = 0;
     downlink.algorithm = algorithm;
+    downlink.block_mode = block_mode;
     downlink.key = session_key;
     downlink.id = *id;
 
@@ -151,7 +162,7 @@ struct pouch_buf *saead_downlink_block_buf_alloc(void)
     return session_block_buf_alloc();
 }
 
-int saead_downlink_block_decrypt(const struct pouch_buf *block, struct pouch_buf *decrypted)
+int saead_downlink_block_decrypt(struct pouch_buf *block)
 {
     if (!pouch_atomic_test_bit(&downlink.flags, SESSION_ACTIVE))
     {
@@ -159,7 +170,7 @@ int saead_downlink_block_decrypt(const struct pouch_buf *block, struct pouch_buf
         return -ENOTCONN;
     }
 
-    int err = session_decrypt_block(&downlink, block, decrypted);
+    int err = session_decrypt_block(&downlink, block);
     if (0 != err)
     {
         return err;
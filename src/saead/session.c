@@ -23,7 +23,7 @@ POUCH_LOG_REGISTER(saead_session, CONFIG_POUCH_COMMON_LOG_LEVEL);
 #define BASE64_STRLEN(buflen) (4 * DIV_ROUND_UP(buflen, 3))
 
 #define NONCE_LEN 12
-#define INFO_MAX_LEN (12 + BASE64_STRLEN(SESSION_ID_LEN) + 1)
+#define INFO_MAX_LEN (14 + BASE64_STRLEN(SESSION_ID_LEN) + 1)
 #define SAEAD_KEY_SIZE(alg) ((alg) == PSA_ALG_CHACHA20_POLY1305 ? 32 : 16)
 
 #define SESSION_KEY_TYPE(alg) \
@@ -73,6 +73,7 @@ int session_id_generate(struct session_id *id)
 static ssize_t session_key_info_build(const struct session_id *id,
                                       psa_algorithm_t algorithm,
                                       uint8_t max_block_size_log,
+                                      enum session_block_mode block_mode,
                                       char *buf)
 {
     char session_id[BASE64_STRLEN(SESSION_ID_LEN) + 1];
@@ -90,18 +91,22 @@ static ssize_t session_key_info_build(const struct session_id *id,
 
     session_id[id_len] = '\0';
 
+    // Chained sessions keep the original info string, independent block sessions derive a
+    // separate key so the same nonce is never used for both modes.
     return sprintf(buf,
-                   "E0:%c:%s:C%c%c:%02X",
+                   "E0:%c:%s:C%c%c:%02X%s",
                    id->initiator == POUCH_ROLE_DEVICE ? 'D' : 'S',
                    session_id,
                    algorithm == PSA_ALG_CHACHA20_POLY1305 ? 'C' : 'A',
                    id->type == SESSION_ID_TYPE_SEQUENTIAL ? 'S' : 'R',
-                   max_block_size_log);
+                   max_block_size_log,
+                   block_mode == SESSION_BLOCK_MODE_INDEPENDENT ? ":I" : "");
 }
 
 psa_key_id_t session_key_generate(const struct session_id *id,
                                   psa_algorithm_t algorithm,
                                   uint8_t max_block_size_log,
+                                  enum session_block_mode block_mode,
                                   psa_key_id_t private_key,
                                   const struct pubkey *pubkey,
                                   psa_key_usage_t usage)
@@ -140,7 +145,11 @@ psa_key_id_t session_key_generate(const struct session_id *id,
     }
 
     uint8_t info[INFO_MAX_LEN];
-    ssize_t info_len = session_key_info_build(id, algorithm, max_block_size_log, (char *) info);
+    ssize_t info_len = session_key_info_build(id,
+                                              algorithm,
+                                              max_block_size_log,
+                                              block_mode,
+                                              (char *) info);
     if (info_len < 0)
     {
         POUCH_LOG_ERR("Failed session key build: %zd", info_len);
@@ -189,14 +198,26 @@ int session_pouch_start(struct session *session, pouch_id_t pouch_id)
 
 static void nonce_generate(const struct session *session,
                            enum pouch_role sender,
+                           uint32_t block_index,
                            uint8_t nonce[NONCE_LEN])
 {
     pouch_put_be16(session->pouch.id, &nonce[0]);
-    pouch_put_be16(session->pouch.block_index, &nonce[2]);
+    pouch_put_be16(block_index, &nonce[2]);
     nonce[4] = sender;
     memset(&nonce[5], 0, NONCE_LEN - 5);
 }
 
+/** Length of the associated data for the block at the given index in the session's pouch */
+static size_t ad_len(const struct session *session, uint32_t block_index)
+{
+    if (session->block_mode == SESSION_BLOCK_MODE_INDEPENDENT || block_index == 0)
+    {
+        return 0;
+    }
+
+    return sizeof(session->pouch.ad);
+}
+
 struct pouch_buf *session_encrypt_block(struct session *session, struct pouch_buf *block)
 {
     struct pouch_buf *encrypted = buf_alloc(MAX_CIPHERTEXT_BLOCK_SIZE);
@@ -207,7 +228,7 @@ struct pouch_buf *session_encrypt_block(struct session *session, struct pouch_bu
     }
 
     uint8_t nonce[NONCE_LEN];
-    nonce_generate(session, POUCH_ROLE_DEVICE, nonce);
+    nonce_generate(session, POUCH_ROLE_DEVICE, session->pouch.block_index, nonce);
 
     POUCH_LOG_DBG("Session key: %d", (int) session->key);
 
@@ -241,7 +262,7 @@ struct pouch_buf *session_encrypt_block(struct session *session, struct pouch_bu
                          nonce,
                          sizeof(nonce),
                          session->pouch.ad,
-                         session->pouch.block_index > 0 ? sizeof(session->pouch.ad) : 0,
+                         ad_len(session, session->pouch.block_index),
                          pouch_bufview_read(&plaintext, plaintext_len),
                          plaintext_len,
                          ciphertext,
@@ -273,12 +294,14 @@ struct pouch_buf *session_block_buf_alloc(void)
     return buf_alloc(MAX_PLAINTEXT_BLOCK_SIZE);
 }
 
-int session_decrypt_block(struct session *session,
-                          const struct pouch_buf *block,
-                          struct pouch_buf *decrypted)
+/** Decrypt the block at the given index in place, and pass its authentication tag back */
+static int block_decrypt(struct session *session,
+                         struct pouch_buf *block,
+                         uint32_t block_index,
+                         uint8_t tag[AUTH_TAG_LEN])
 {
     uint8_t nonce[NONCE_LEN];
-    nonce_generate(session, POUCH_ROLE_SERVER, nonce);
+    nonce_generate(session, POUCH_ROLE_SERVER, block_index, nonce);
 
     struct pouch_bufview ciphertext;
     pouch_bufview_init(&ciphertext, block);
@@ -299,22 +322,23 @@ int session_decrypt_block(struct session *session,
 
     size_t payload_len = ciphertext_len - AUTH_TAG_LEN;
 
-    block_size_write(decrypted, payload_len);
-
+    /* Decrypt in place. The plaintext ends where the tag starts, so the tag
+     * is still intact afterwards.
+     */
+    uint8_t *data = (uint8_t *) pouch_bufview_read(&ciphertext, ciphertext_len);
     size_t plaintext_len;
 
-    psa_status_t status =
-        psa_aead_decrypt(session->key,
-                         session->algorithm,
-                         nonce,
-                         sizeof(nonce),
-                         session->pouch.ad,
-                         session->pouch.block_index > 0 ? sizeof(session->pouch.ad) : 0,
-                         pouch_bufview_read(&ciphertext, payload_len),
-                         ciphertext_len,
-                         buf_claim(decrypted, payload_len),
-                         payload_len,
-                         &plaintext_len);
+    psa_status_t status = psa_aead_decrypt(session->key,
+                                           session->algorithm,
+                                           nonce,
+                                           sizeof(nonce),
+                                           session->pouch.ad,
+                                           ad_len(session, block_index),
+                                           data,
+                                           ciphertext_len,
+                                           data,
+                                           payload_len,
+                                           &plaintext_len);
     if (status != PSA_SUCCESS)
     {
         POUCH_LOG_ERR("Failed decryption: %d", (int) status);
@@ -327,11 +351,45 @@ int session_decrypt_block(struct session *session,
         return -EINVAL;
     }
 
-    // prepare for the next block:
-    pouch_bufview_memcpy(&ciphertext, &session->pouch.ad, AUTH_TAG_LEN);
-    session->pouch.block_index++;
+    memcpy(tag, &data[payload_len], AUTH_TAG_LEN);
+
+    /* Turn the block into a plaintext block */
+    buf_trim_end(block, AUTH_TAG_LEN);
+    pouch_put_be16(payload_len, data - sizeof(uint16_t));
 
     pouch_atomic_set_bit(&session->flags, SESSION_VALID);
 
     return 0;
 }
+
+int session_decrypt_block(struct session *session, struct pouch_buf *block)
+{
+    uint8_t tag[AUTH_TAG_LEN];
+
+    int err = block_decrypt(session, block, session->pouch.block_index, tag);
+    if (err)
+    {
+        return err;
+    }
+
+    // prepare for the next block:
+    memcpy(&session->pouch.ad, tag, AUTH_TAG_LEN);
+    session->pouch.block_index++;
+
+    return 0;
+}
+
+int session_decrypt_block_at(struct session *session,
+                             struct pouch_buf *block,
+                             uint32_t block_index)
+{
+    uint8_t tag[AUTH_TAG_LEN];
+
+    // Chained blocks can only be authenticated with the tag of the block before them
+    if (session->block_mode != SESSION_BLOCK_MODE_INDEPENDENT)
+    {
+        return -ENOTSUP;
+    }
+
+    return block_decrypt(session, block, block_index, tag);
+}
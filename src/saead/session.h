@@ -44,6 +44,17 @@ struct session_id
     } value;
 };
 
+/** How consecutive blocks of a pouch are authenticated */
+enum session_block_mode
+{
+    /** Each block's associated data is the authentication tag of the previous block */
+    SESSION_BLOCK_MODE_CHAINED,
+    /** Blocks are only bound to their position through the nonce, and can be decrypted in any
+     * order.
+     */
+    SESSION_BLOCK_MODE_INDEPENDENT,
+};
+
 enum session_flags
 {
     SESSION_VALID,
@@ -56,6 +67,7 @@ struct session
     struct session_id id;
     pouch_atomic_t flags;
     psa_algorithm_t algorithm;
+    enum session_block_mode block_mode;
     psa_key_id_t key;
     struct
     {
@@ -78,6 +90,7 @@ int session_id_generate(struct session_id *id);
 psa_key_id_t session_key_generate(const struct session_id *id,
                                   psa_algorithm_t algorithm,
                                   uint8_t max_block_size_log,
+                                  enum session_block_mode block_mode,
                                   psa_key_id_t private_key,
                                   const struct pubkey *pubkey,
                                   psa_key_usage_t usage);
@@ -100,13 +113,32 @@ struct pouch_buf *session_encrypt_block(struct session *session, struct pouch_bu
 /**
  * Decrypt the next block in the given session
  *
+ * The block is decrypted in place. On success, it holds the plaintext block, with the block
+ * size updated and the authentication tag removed.
+ *
  * @session session struct used as context across multiple blocks
  * @param block buffer where encrypted input is located
- * @param decrypted buffer where decrypted data will be written. Only valid when return code is 0.
  *
  * @return 0 if successful
  * @return negative error code on failure
  */
-int session_decrypt_block(struct session *session,
-                          const struct pouch_buf *block,
-                          struct pouch_buf *decrypted);
+int session_decrypt_block(struct session *session, struct pouch_buf *block);
+
+/**
+ * Decrypt the block at the given index in the session's pouch
+ *
+ * Only available in sessions with independent blocks, where a block can be authenticated
+ * without the blocks before it. The block is decrypted in place like in session_decrypt_block(),
+ * but the session doesn't move on to the next block, so blocks may be decrypted in any order.
+ *
+ * @session session struct the block belongs to
+ * @param block buffer where encrypted input is located
+ * @param block_index index of the block in the pouch
+ *
+ * @return 0 if successful
+ * @return -ENOTSUP if the session uses chained blocks
+ * @return negative error code on failure
+ */
+int session_decrypt_block_at(struct session *session,
+                             struct pouch_buf *block,
+                             uint32_t block_index);
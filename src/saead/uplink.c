@@ -15,6 +15,12 @@
 
 POUCH_LOG_REGISTER(saead_uplink, CONFIG_POUCH_COMMON_LOG_LEVEL);
 
+#if CONFIG_POUCH_ENCRYPTION_INDEPENDENT_BLOCKS
+#define UPLINK_BLOCK_MODE SESSION_BLOCK_MODE_INDEPENDENT
+#else
+#define UPLINK_BLOCK_MODE SESSION_BLOCK_MODE_CHAINED
+#endif
+
 static struct session uplink;
 
 int saead_uplink_session_start(psa_algorithm_t algorithm, psa_key_id_t private_key)
@@ -38,6 +44,7 @@ int saead_uplink_session_start(psa_algorithm_t algorithm, psa_key_id_t private_k
     uplink.key = session_key_generate(&uplink.id,
                                       algorithm,
                                       MAX_BLOCK_PAYLOAD_SIZE_LOG,
+                                      UPLINK_BLOCK_MODE,
                                       private_key,
                                       &pubkey,
                                       PSA_KEY_USAGE_ENCRYPT);
@@ -48,6 +55,7 @@ int saead_uplink_session_start(psa_algorithm_t algorithm, psa_key_id_t private_k
     }
 
     uplink.algorithm = algorithm;
+    uplink.block_mode = UPLINK_BLOCK_MODE;
     uplink.pouch.id = 0;
     pouch_atomic_set_bit(&uplink.flags, SESSION_VALID);
     pouch_atomic_set_bit(&uplink.flags, SESSION_ACTIVE);
@@ -88,6 +96,10 @@ int saead_uplink_header_get(struct saead_info *info)
     info->session.initiator_choice = session_info_initiator_device_m_c;
     info->session.max_block_size_log = MAX_BLOCK_PAYLOAD_SIZE_LOG;
 
+    // Chained is the implicit default, so the field is only included for independent blocks:
+    info->session.block_mode_present = (uplink.block_mode == SESSION_BLOCK_MODE_INDEPENDENT);
+    info->session.block_mode.block_mode_choice = session_info_block_mode_independent_m_c;
+
     const uint8_t *cert_ref = cert_ref_get();
     if (cert_ref == NULL)
     {
@@ -125,11 +137,12 @@ void saead_uplink_session_end(void)
 
 bool saead_uplink_session_matches(const struct session_id *id,
                                   uint8_t max_block_size_log,
-                                  psa_algorithm_t algorithm)
+                                  psa_algorithm_t algorithm,
+                                  enum session_block_mode block_mode)
 {
     return pouch_atomic_test_bit(&uplink.flags, SESSION_VALID)
         && session_id_is_equal(id, &uplink.id) && max_block_size_log == MAX_BLOCK_PAYLOAD_SIZE_LOG
-        && uplink.algorithm == algorithm;
+        && uplink.algorithm == algorithm && uplink.block_mode == block_mode;
 }
 
 psa_key_id_t saead_uplink_session_key_copy(psa_key_usage_t usage)
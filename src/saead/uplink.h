@@ -30,7 +30,8 @@ struct pouch_buf *saead_uplink_encrypt_block(struct pouch_buf *block);
  */
 bool saead_uplink_session_matches(const struct session_id *id,
                                   uint8_t max_block_size_log,
-                                  psa_algorithm_t algorithm);
+                                  psa_algorithm_t algorithm,
+                                  enum session_block_mode block_mode);
 
 /** Make a copy of the uplink session's session key. */
 psa_key_id_t saead_uplink_session_key_copy(psa_key_usage_t usage);
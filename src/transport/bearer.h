@@ -12,24 +12,73 @@
 
 struct pouch_bearer;
 
+/** Packet in a vectored send */
+struct pouch_bearer_pkt
+{
+    const uint8_t *buf;
+    size_t len;
+};
+
 typedef int (*pouch_bearer_send_t)(struct pouch_bearer *bearer, const uint8_t *buf, size_t len);
+typedef int (*pouch_bearer_sendv_t)(struct pouch_bearer *bearer,
+                                    const struct pouch_bearer_pkt *pkts,
+                                    size_t count);
 typedef void (*pouch_bearer_ready_t)(struct pouch_bearer *bearer);
 typedef void (*pouch_bearer_close_t)(struct pouch_bearer *bearer, bool success);
 
 struct pouch_bearer
 {
     pouch_bearer_send_t send;
+    /** Optional vectored send, for bearers that can carry several packets in one operation */
+    pouch_bearer_sendv_t sendv;
     pouch_bearer_close_t close;
     pouch_bearer_ready_t ready;
     size_t maxlen;
     void *ctx;
 };
 
+/**
+ * Send a packet over the bearer.
+ *
+ * Returns -EAGAIN if the bearer can't take the packet right now. The packet is not sent, and the
+ * bearer calls the transport's ready function once it can take more packets.
+ */
 static inline int pouch_bearer_send(struct pouch_bearer *bearer, const uint8_t *buf, size_t len)
 {
     return bearer->send(bearer, buf, len);
 }
 
+/**
+ * Send several packets over the bearer in a single operation.
+ *
+ * Each packet reaches the peer as if it was sent on its own with pouch_bearer_send(). Bearers
+ * without a vectored send function send the packets one by one.
+ *
+ * Returns the number of packets the bearer accepted, in order. If the bearer doesn't accept all
+ * of them, sending the remaining packets again returns the error. Returns -EAGAIN if the bearer
+ * can't take any packets right now, and calls the transport's ready function once it can.
+ */
+static inline int pouch_bearer_sendv(struct pouch_bearer *bearer,
+                                     const struct pouch_bearer_pkt *pkts,
+                                     size_t count)
+{
+    if (bearer->sendv)
+    {
+        return bearer->sendv(bearer, pkts, count);
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        int err = bearer->send(bearer, pkts[i].buf, pkts[i].len);
+        if (err)
+        {
+            return (i > 0) ? (int) i : err;
+        }
+    }
+
+    return count;
+}
+
 static inline void pouch_bearer_close(struct pouch_bearer *bearer, bool success)
 {
     bearer->close(bearer, success);
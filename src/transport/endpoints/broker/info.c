@@ -45,7 +45,9 @@ static void end(struct pouch_bearer *bearer, bool success)
 
     int err = pouch_gateway_info_finish(node->info_ctx,
                                         &node->server_cert_provisioned,
-                                        &node->device_cert_provisioned);
+                                        &node->device_cert_provisioned,
+                                        &node->l2cap_uplink_psm,
+                                        &node->l2cap_downlink_psm);
     if (err)
     {
         pouch_bearer_close(bearer, false);
@@ -50,6 +50,12 @@ static int build_info_data(void)
                 .value = snr,
                 .len = snr_len,
             },
+#if CONFIG_POUCH_TRANSPORT_BLE_L2CAP
+        .pouch_gatt_info_l2cap_uplink_psm = CONFIG_POUCH_TRANSPORT_L2CAP_UPLINK_PSM,
+        .pouch_gatt_info_l2cap_uplink_psm_present = true,
+        .pouch_gatt_info_l2cap_downlink_psm = CONFIG_POUCH_TRANSPORT_L2CAP_DOWNLINK_PSM,
+        .pouch_gatt_info_l2cap_downlink_psm_present = true,
+#endif
     };
 
     info.len = INFO_MAX_SIZE;
@@ -5,6 +5,7 @@
  */
 
 #include <errno.h>
+#include <stdint.h>
 #include <pouch/transport/certificate.h>
 #include <pouch/transport/uplink.h>
 #include "endpoints.h"
@@ -33,8 +34,21 @@ static enum pouch_result send(struct pouch_bearer *bearer, void *dst, size_t *ds
     return pouch_uplink_fill(uplink, dst, dst_len);
 }
 
+static void ack(struct pouch_bearer *bearer, size_t len)
+{
+    if (uplink != NULL)
+    {
+        pouch_uplink_confirm(uplink, len);
+    }
+}
+
 static void end(struct pouch_bearer *bearer, bool success)
 {
+    if (success && uplink != NULL)
+    {
+        pouch_uplink_confirm(uplink, SIZE_MAX);
+    }
+
     pouch_uplink_finish(uplink);
     uplink = NULL;
 }
@@ -43,4 +57,5 @@ const struct pouch_endpoint pouch_device_endpoint_uplink = {
     .start = start,
     .send = send,
     .end = end,
+    .ack = ack,
 };
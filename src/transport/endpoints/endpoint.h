@@ -32,6 +32,8 @@ struct pouch_endpoint
      *
      * @return 0 if the data was processed successfully, or an error code if the data could not be
      * processed.
+     * @retval -EAGAIN The endpoint can't take the data right now, and hasn't consumed any of it.
+     * The transfer continues, and the sender has to send the data again.
      */
     int (*recv)(struct pouch_bearer *bearer, const void *buf, size_t len);
     /**
@@ -49,4 +51,11 @@ struct pouch_endpoint
      * @retval POUCH_ERROR An error occured, and the transfer should be aborted.
      */
     enum pouch_result (*send)(struct pouch_bearer *bearer, void *dst, size_t *dst_len);
+    /**
+     * Acknowledge callback, signalling that the receiving end has confirmed data.
+     * This optional callback is only used in sender endpoints.
+     *
+     * @param len Number of bytes confirmed since the previous call.
+     */
+    void (*ack)(struct pouch_bearer *bearer, size_t len);
 };
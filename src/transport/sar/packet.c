@@ -6,19 +6,24 @@
 #include <string.h>
 #include "packet.h"
 #include <errno.h>
+#include <pouch/port.h>
 
 #define TX_PKT_OFFSET_FLAGS 0
 #define TX_PKT_OFFSET_SEQ 1
 #define TX_PKT_OFFSET_FIN_CODE 1
 #define TX_PKT_OFFSET_DATA 2
 
+#define TX_PKT_EXT_OFFSET_DATA 3
+
 #define RX_PKT_OFFSET_CODE 0
 #define RX_PKT_OFFSET_SEQ 1
 #define RX_PKT_OFFSET_WINDOW 2
+#define RX_PKT_EXT_OFFSET_WINDOW 3
 
 
-#define POUCH_SAR_TX_PKT_FLAG_MASK \
-    (POUCH_SAR_TX_PKT_FLAG_FIRST | POUCH_SAR_TX_PKT_FLAG_LAST | POUCH_SAR_TX_PKT_FLAG_FIN)
+#define POUCH_SAR_TX_PKT_FLAG_MASK                                                          \
+    (POUCH_SAR_TX_PKT_FLAG_FIRST | POUCH_SAR_TX_PKT_FLAG_LAST | POUCH_SAR_TX_PKT_FLAG_FIN \
+     | POUCH_SAR_TX_PKT_FLAG_EXT)
 
 int pouch_sar_tx_pkt_decode(const void *buf, size_t buf_len, struct pouch_sar_tx_pkt *pkt)
 {
@@ -56,30 +61,56 @@ int pouch_sar_tx_pkt_decode(const void *buf, size_t buf_len, struct pouch_sar_tx
         return 0;
     }
 
-    pkt->seq = bytes[TX_PKT_OFFSET_SEQ];
-    if (buf_len == POUCH_SAR_TX_PKT_HEADER_LEN)
+    size_t header_len = POUCH_SAR_TX_PKT_HEADER_LEN;
+    if (pkt->flags & POUCH_SAR_TX_PKT_FLAG_EXT)
+    {
+        if (buf_len < POUCH_SAR_TX_PKT_EXT_HEADER_LEN)
+        {
+            return -EINVAL;
+        }
+
+        pkt->seq = pouch_get_be16(&bytes[TX_PKT_OFFSET_SEQ]);
+        header_len = POUCH_SAR_TX_PKT_EXT_HEADER_LEN;
+    }
+    else
+    {
+        pkt->seq = bytes[TX_PKT_OFFSET_SEQ];
+    }
+
+    if (buf_len == header_len)
     {
         pkt->data = NULL;
         pkt->len = 0;
         return 0;
     }
 
-    pkt->data = &bytes[POUCH_SAR_TX_PKT_HEADER_LEN];
-    pkt->len = buf_len - POUCH_SAR_TX_PKT_HEADER_LEN;
+    pkt->data = &bytes[header_len];
+    pkt->len = buf_len - header_len;
     return 0;
 }
 
 int pouch_sar_rx_pkt_decode(const void *buf, size_t buf_len, struct pouch_sar_rx_pkt *pkt)
 {
+    const uint8_t *bytes = buf;
+
+    if (buf_len == POUCH_SAR_RX_PKT_EXT_LEN)
+    {
+        pkt->code = bytes[RX_PKT_OFFSET_CODE];
+        pkt->seq = pouch_get_be16(&bytes[RX_PKT_OFFSET_SEQ]);
+        pkt->window = pouch_get_be16(&bytes[RX_PKT_EXT_OFFSET_WINDOW]);
+        pkt->ext = true;
+        return 0;
+    }
+
     if (buf_len != POUCH_SAR_RX_PKT_LEN)
     {
         return -EINVAL;
     }
 
-    const uint8_t *bytes = buf;
     pkt->code = bytes[RX_PKT_OFFSET_CODE];
     pkt->seq = bytes[RX_PKT_OFFSET_SEQ];
     pkt->window = bytes[RX_PKT_OFFSET_WINDOW];
+    pkt->ext = false;
 
     return 0;
 }
@@ -113,20 +144,39 @@ int pouch_sar_tx_pkt_encode(const struct pouch_sar_tx_pkt *pkt, void *dst, size_
         return -EINVAL;
     }
 
-    bytes[TX_PKT_OFFSET_SEQ] = pkt->seq;
-    if (pkt->data != &bytes[TX_PKT_OFFSET_DATA])
+    size_t offset = TX_PKT_OFFSET_DATA;
+    if (pkt->flags & POUCH_SAR_TX_PKT_FLAG_EXT)
     {
-        memcpy(&bytes[TX_PKT_OFFSET_DATA], pkt->data, pkt->len);
+        pouch_put_be16(pkt->seq, &bytes[TX_PKT_OFFSET_SEQ]);
+        offset = TX_PKT_EXT_OFFSET_DATA;
+    }
+    else
+    {
+        bytes[TX_PKT_OFFSET_SEQ] = pkt->seq;
     }
 
-    *len = TX_PKT_OFFSET_DATA + pkt->len;
+    if (pkt->data != &bytes[offset])
+    {
+        memmove(&bytes[offset], pkt->data, pkt->len);
+    }
+
+    *len = offset + pkt->len;
 
     return 0;
 }
 
-void pouch_sar_rx_pkt_encode(const struct pouch_sar_rx_pkt *pkt, uint8_t dst[POUCH_SAR_RX_PKT_LEN])
+size_t pouch_sar_rx_pkt_encode(const struct pouch_sar_rx_pkt *pkt, uint8_t *dst)
 {
     dst[RX_PKT_OFFSET_CODE] = pkt->code;
+
+    if (pkt->ext)
+    {
+        pouch_put_be16(pkt->seq, &dst[RX_PKT_OFFSET_SEQ]);
+        pouch_put_be16(pkt->window, &dst[RX_PKT_EXT_OFFSET_WINDOW]);
+        return POUCH_SAR_RX_PKT_EXT_LEN;
+    }
+
     dst[RX_PKT_OFFSET_SEQ] = pkt->seq;
     dst[RX_PKT_OFFSET_WINDOW] = pkt->window;
+    return POUCH_SAR_RX_PKT_LEN;
 }
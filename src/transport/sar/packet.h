@@ -8,12 +8,21 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <stdbool.h>
+
 #define POUCH_SAR_TX_PKT_HEADER_LEN 2
 #define POUCH_SAR_RX_PKT_LEN 3
 #define POUCH_SAR_SEQ_MAX 0xff
 #define POUCH_SAR_SEQ_MASK POUCH_SAR_SEQ_MAX
 #define POUCH_SAR_WINDOW_MAX 127
 
+/* Extended packets, with 16 bit sequence numbers and windows: */
+#define POUCH_SAR_TX_PKT_EXT_HEADER_LEN 3
+#define POUCH_SAR_RX_PKT_EXT_LEN 5
+#define POUCH_SAR_EXT_SEQ_MAX 0xffff
+#define POUCH_SAR_EXT_SEQ_MASK POUCH_SAR_EXT_SEQ_MAX
+#define POUCH_SAR_EXT_WINDOW_MAX 0x7fff
+
 enum pouch_sar_rx_pkt_code
 {
     POUCH_RECEIVER_CODE_ACK,
@@ -27,11 +36,13 @@ enum pouch_sar_tx_pkt_flag
     POUCH_SAR_TX_PKT_FLAG_LAST = (1 << 1),
     POUCH_SAR_TX_PKT_FLAG_FIN = (1 << 2),
     POUCH_SAR_TX_PKT_FLAG_IDLE = (1 << 3),
+    /** Extended packet with a 16 bit sequence number */
+    POUCH_SAR_TX_PKT_FLAG_EXT = (1 << 4),
 };
 
 struct pouch_sar_tx_pkt
 {
-    uint8_t seq;
+    uint16_t seq;
     enum pouch_sar_tx_pkt_flag flags;
     size_t len;
     const uint8_t *data;
@@ -40,12 +51,22 @@ struct pouch_sar_tx_pkt
 struct pouch_sar_rx_pkt
 {
     enum pouch_sar_rx_pkt_code code;
-    uint8_t seq;
-    uint8_t window;
+    uint16_t seq;
+    uint16_t window;
+    /** Extended packet with a 16 bit sequence number and window */
+    bool ext;
 };
 
 int pouch_sar_tx_pkt_decode(const void *buf, size_t buf_len, struct pouch_sar_tx_pkt *pkt);
 int pouch_sar_tx_pkt_encode(const struct pouch_sar_tx_pkt *pkt, void *dst, size_t *len);
 
 int pouch_sar_rx_pkt_decode(const void *buf, size_t buf_len, struct pouch_sar_rx_pkt *pkt);
-void pouch_sar_rx_pkt_encode(const struct pouch_sar_rx_pkt *pkt, uint8_t dst[POUCH_SAR_RX_PKT_LEN]);
+/**
+ * Encode an ack packet.
+ *
+ * @param dst Buffer of at least POUCH_SAR_RX_PKT_LEN bytes, or POUCH_SAR_RX_PKT_EXT_LEN bytes for
+ * extended packets.
+ *
+ * @return The length of the encoded packet.
+ */
+size_t pouch_sar_rx_pkt_encode(const struct pouch_sar_rx_pkt *pkt, uint8_t *dst);
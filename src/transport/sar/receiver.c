@@ -32,26 +32,175 @@ static void end(struct pouch_receiver *p, bool success)
     pouch_bearer_close(p->bearer, success);
 }
 
+static uint16_t seq_mask(const struct pouch_receiver *p)
+{
+    return p->ext ? POUCH_SAR_EXT_SEQ_MASK : POUCH_SAR_SEQ_MASK;
+}
+
+#define SEQ(p, seq) ((uint16_t) ((seq) & seq_mask(p)))
+
+#if CONFIG_POUCH_TRANSPORT_SAR_ADAPTIVE_WINDOW
+
+static void window_init(struct pouch_receiver *p)
+{
+    p->edge = SEQ(p, p->seq + p->window);
+    p->credit = 0;
+    p->recovering = false;
+    p->gap_avg = 0;
+}
+
+static void window_shrink(struct pouch_receiver *p)
+{
+    // Only shrink once per window, a burst of lost packets is one event:
+    if (p->recovering)
+    {
+        return;
+    }
+
+    p->window = (p->window > 1) ? p->window / 2 : 1;
+    p->credit = 0;
+    p->recover = p->edge;
+    p->recovering = true;
+
+    POUCH_LOG_DBG("Window shrunk to %u", p->window);
+}
+
+static void window_grow(struct pouch_receiver *p)
+{
+    uint16_t window_max = POUCH_SAR_WINDOW_MAX;
+#if CONFIG_POUCH_TRANSPORT_SAR_EXT
+    if (p->ext)
+    {
+        window_max = CONFIG_POUCH_TRANSPORT_SAR_EXT_WINDOW_MAX;
+    }
+#endif
+
+    if (p->recovering || p->window >= window_max)
+    {
+        return;
+    }
+
+    // Additive increase: one packet for every full window received in order
+    if (++p->credit < p->window)
+    {
+        return;
+    }
+
+    p->credit = 0;
+    p->window++;
+
+    POUCH_LOG_DBG("Window grown to %u", p->window);
+}
+
+/**
+ * Adjust the window after receiving an in-order packet.
+ *
+ * @param arrival Uptime when the packet arrived.
+ * @param busy Time the endpoint spent processing the packet.
+ */
+static void window_update(struct pouch_receiver *p,
+                          uint16_t seq,
+                          bool first,
+                          uint32_t arrival,
+                          uint32_t busy)
+{
+    if (!first)
+    {
+        uint32_t gap = arrival - p->last_rx;
+        if (p->gap_avg == 0)
+        {
+            p->gap_avg = gap * 8;
+        }
+        else
+        {
+            p->gap_avg += gap - p->gap_avg / 8;
+        }
+    }
+
+    p->last_rx = arrival;
+
+    if (p->recovering && seq == p->recover)
+    {
+        p->recovering = false;
+    }
+
+    if (busy * 8 > p->gap_avg + 8)
+    {
+        // The endpoint is slower than the sender, and packets are piling up in the bearer:
+        window_shrink(p);
+    }
+    else
+    {
+        window_grow(p);
+    }
+}
+
+/** Get the window to advertise, without moving the edge of the previous window backwards. */
+static uint16_t window_advertise(struct pouch_receiver *p)
+{
+    uint16_t window = p->window;
+    uint16_t remaining = SEQ(p, p->edge - p->seq);
+    if (remaining > window)
+    {
+        window = remaining;
+    }
+
+    p->edge = SEQ(p, p->seq + window);
+
+    return window;
+}
+
+#else
+
+static uint16_t window_advertise(struct pouch_receiver *p)
+{
+    return p->window;
+}
+
+#endif  // CONFIG_POUCH_TRANSPORT_SAR_ADAPTIVE_WINDOW
+
 static void schedule_ack(struct pouch_receiver *p)
 {
     pouch_work_schedule(&p->work, POUCH_MSEC(CONFIG_POUCH_TRANSPORT_ACK_TIMEOUT_MS));
 }
 
+/** Acknowledge an in-order packet, coalescing acks for packets in the middle of a window. */
+static void ack_packet(struct pouch_receiver *p, enum pouch_sar_tx_pkt_flag flags)
+{
+    uint16_t unacked = SEQ(p, p->seq - p->ack);
+
+    if ((flags & (POUCH_SAR_TX_PKT_FLAG_FIRST | POUCH_SAR_TX_PKT_FLAG_LAST))
+        || unacked >= CONFIG_POUCH_TRANSPORT_SAR_ACK_EVERY || unacked * 2 >= p->window)
+    {
+        p->ack_delayed = false;
+        pouch_work_reschedule(&p->work, POUCH_NO_WAIT);
+        return;
+    }
+
+    // Don't push out an ack that's already pending:
+    if (!p->ack_delayed)
+    {
+        p->ack_delayed = true;
+        pouch_work_reschedule(&p->work, POUCH_MSEC(CONFIG_POUCH_TRANSPORT_SAR_ACK_DELAY_MS));
+    }
+}
+
 static void send_ack(pouch_work_delayable_t *dwork)
 {
     struct pouch_receiver *p = CONTAINER_OF(dwork, struct pouch_receiver, work);
-    uint8_t buf[POUCH_SAR_RX_PKT_LEN];
+    uint8_t buf[POUCH_SAR_RX_PKT_EXT_LEN];
     struct pouch_sar_rx_pkt ack = {
         .code =
             p->state == STATE_FAILED ? POUCH_RECEIVER_CODE_NACK_UNKNOWN : POUCH_RECEIVER_CODE_ACK,
         .seq = p->seq,
-        .window = p->window,
+        .window = window_advertise(p),
+        .ext = p->ext,
     };
-    pouch_sar_rx_pkt_encode(&ack, buf);
+    size_t len = pouch_sar_rx_pkt_encode(&ack, buf);
 
     POUCH_LOG_DBG("Sending ack (0x%x window: %u)", ack.seq, ack.window);
 
-    int err = pouch_bearer_send(p->bearer, buf, sizeof(buf));
+    int err = pouch_bearer_send(p->bearer, buf, len);
     if (err)
     {
         // try again later:
@@ -61,22 +210,29 @@ static void send_ack(pouch_work_delayable_t *dwork)
             end(p, false);
             return;
         }
+
+        // The retry replaces the delayed ack, so new packets must be able to push it out again:
+        p->ack_delayed = false;
         schedule_ack(p);
         return;
     }
 
     schedule_ack(p);
     p->ack = ack.seq;
+    p->ack_delayed = false;
 }
 
-int pouch_receiver_open(struct pouch_receiver *recv, struct pouch_bearer *bearer, uint8_t window)
+static int receiver_open(struct pouch_receiver *recv,
+                         struct pouch_bearer *bearer,
+                         uint16_t window,
+                         bool ext)
 {
-    if (bearer->maxlen < POUCH_SAR_RX_PKT_LEN)
+    if (bearer->maxlen < (ext ? POUCH_SAR_RX_PKT_EXT_LEN : POUCH_SAR_RX_PKT_LEN))
     {
         return -EINVAL;
     }
 
-    if (window > POUCH_SAR_WINDOW_MAX)
+    if (window > (ext ? POUCH_SAR_EXT_WINDOW_MAX : POUCH_SAR_WINDOW_MAX))
     {
         return -EINVAL;
     }
@@ -95,9 +251,15 @@ int pouch_receiver_open(struct pouch_receiver *recv, struct pouch_bearer *bearer
 
     recv->bearer = bearer;
     recv->window = window;
-    recv->seq = POUCH_SAR_SEQ_MAX;
+    recv->ext = ext;
+    recv->seq = ext ? POUCH_SAR_EXT_SEQ_MAX : POUCH_SAR_SEQ_MAX;
+    recv->ack = recv->seq;
+    recv->ack_delayed = false;
     recv->state = STATE_READY;
     pouch_work_delayable_init(&recv->work, send_ack);
+#if CONFIG_POUCH_TRANSPORT_SAR_ADAPTIVE_WINDOW
+    window_init(recv);
+#endif
 
     if (recv->endpoint->start != NULL)
     {
@@ -115,6 +277,20 @@ int pouch_receiver_open(struct pouch_receiver *recv, struct pouch_bearer *bearer
     return 0;
 }
 
+int pouch_receiver_open(struct pouch_receiver *recv, struct pouch_bearer *bearer, uint8_t window)
+{
+    return receiver_open(recv, bearer, window, false);
+}
+
+#if CONFIG_POUCH_TRANSPORT_SAR_EXT
+int pouch_receiver_open_ext(struct pouch_receiver *recv,
+                            struct pouch_bearer *bearer,
+                            uint16_t window)
+{
+    return receiver_open(recv, bearer, window, true);
+}
+#endif
+
 int pouch_receiver_recv(struct pouch_receiver *recv, const uint8_t *buf, size_t len)
 {
     struct pouch_sar_tx_pkt pkt;
@@ -161,6 +337,29 @@ int pouch_receiver_recv(struct pouch_receiver *recv, const uint8_t *buf, size_t
         return 0;
     }
 
+    if (!!(pkt.flags & POUCH_SAR_TX_PKT_FLAG_EXT) != recv->ext)
+    {
+        POUCH_LOG_ERR("Unexpected packet format");
+        end(recv, false);
+        return -EINVAL;
+    }
+
+    // Out of order packets and retransmissions of packets that were already received are ignored
+    // before looking at their flags, so a lost packet doesn't end the transfer early:
+    if (pkt.seq != SEQ(recv, recv->seq + 1))
+    {
+        POUCH_LOG_WRN("OoO RX: %x (last: %x)", pkt.seq, recv->seq);
+#if CONFIG_POUCH_TRANSPORT_SAR_ADAPTIVE_WINDOW
+        window_shrink(recv);
+#endif
+        // out of order packet - should be ignored
+        pouch_work_reschedule(&recv->work, POUCH_NO_WAIT);  // ack last received packet instead
+        return 0;
+    }
+
+    // Restored if the endpoint can't take the packet:
+    uint8_t prev_state = recv->state;
+
     if (pkt.flags & POUCH_SAR_TX_PKT_FLAG_FIRST)
     {
         if (recv->state == STATE_ACTIVE)
@@ -198,17 +397,25 @@ int pouch_receiver_recv(struct pouch_receiver *recv, const uint8_t *buf, size_t
         recv->state = STATE_ENDED;
     }
 
-    if (pkt.seq != ((recv->seq + 1) & POUCH_SAR_SEQ_MASK))
-    {
-        POUCH_LOG_WRN("OoO RX: %x (last: %x)", pkt.seq, recv->seq);
-        // out of order packet - should be ignored
-        pouch_work_reschedule(&recv->work, POUCH_NO_WAIT);  // ack last received packet instead
-        return 0;
-    }
+#if CONFIG_POUCH_TRANSPORT_SAR_ADAPTIVE_WINDOW
+    uint32_t arrival = pouch_uptime_ms();
+#endif
 
     if (pkt.len > 0)
     {
         err = recv->endpoint->recv(recv->bearer, pkt.data, pkt.len);
+        if (err == -EAGAIN)
+        {
+            // The endpoint is out of buffers. Drop the packet as if it was lost, so the sender
+            // slows down and sends it again:
+            POUCH_LOG_WRN("Endpoint busy, dropping %x", pkt.seq);
+            recv->state = prev_state;
+#if CONFIG_POUCH_TRANSPORT_SAR_ADAPTIVE_WINDOW
+            window_shrink(recv);
+#endif
+            pouch_work_reschedule(&recv->work, POUCH_NO_WAIT);  // ack last received packet instead
+            return 0;
+        }
         if (err)
         {
             POUCH_LOG_ERR("RX callback failed: %d", err);
@@ -220,8 +427,15 @@ int pouch_receiver_recv(struct pouch_receiver *recv, const uint8_t *buf, size_t
 
     recv->seq = pkt.seq;
 
-    // send ack right away:
-    pouch_work_reschedule(&recv->work, POUCH_NO_WAIT);
+#if CONFIG_POUCH_TRANSPORT_SAR_ADAPTIVE_WINDOW
+    window_update(recv,
+                  pkt.seq,
+                  pkt.flags & POUCH_SAR_TX_PKT_FLAG_FIRST,
+                  arrival,
+                  pouch_uptime_ms() - arrival);
+#endif
+
+    ack_packet(recv, pkt.flags);
 
     return 0;
 }
@@ -14,15 +14,45 @@ struct pouch_receiver
     const struct pouch_endpoint *endpoint;
     struct pouch_bearer *bearer;
 
-    uint8_t seq;
-    uint8_t ack;
-    uint8_t window;
+    uint16_t seq;
+    uint16_t ack;
+    uint16_t window;
     uint8_t state;
+    /** Extended packets, with 16 bit sequence numbers */
+    bool ext;
+    /** An ack is scheduled to cover several packets */
+    bool ack_delayed;
+
+#if CONFIG_POUCH_TRANSPORT_SAR_ADAPTIVE_WINDOW
+    /** Last sequence number the sender has been allowed to send */
+    uint16_t edge;
+    /** Sequence number that ends the current window decrease */
+    uint16_t recover;
+    bool recovering;
+    /** In-order packets received since the window last changed */
+    uint16_t credit;
+    /** Uptime of the last in-order packet */
+    uint32_t last_rx;
+    /** Average time between in-order packets, in 1/8 ms */
+    uint32_t gap_avg;
+#endif
 
     pouch_work_delayable_t work;
 };
 
 int pouch_receiver_open(struct pouch_receiver *recv, struct pouch_bearer *bearer, uint8_t window);
+#if CONFIG_POUCH_TRANSPORT_SAR_EXT
+/**
+ * Open a receiver with extended packets.
+ *
+ * The 16 bit sequence numbers allow windows of up to POUCH_SAR_EXT_WINDOW_MAX packets, for bearers
+ * with a large bandwidth-delay product. The sender switches to extended packets when it receives
+ * the first ack, so this should only be used if the sender is known to support them.
+ */
+int pouch_receiver_open_ext(struct pouch_receiver *recv,
+                            struct pouch_bearer *bearer,
+                            uint16_t window);
+#endif
 int pouch_receiver_recv(struct pouch_receiver *recv, const uint8_t *buf, size_t len);
 void pouch_receiver_close(struct pouch_receiver *recv);
 void pouch_receiver_ready(struct pouch_receiver *recv);
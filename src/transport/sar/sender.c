@@ -4,13 +4,23 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 #include <pouch/port.h>
 
 #include "sender.h"
 #include "packet.h"
 
-#define SEQ(seq) ((uint8_t) ((seq) & POUCH_SAR_SEQ_MASK))
+#define SEQ(sender, seq) ((uint16_t) ((seq) & seq_mask(sender)))
+/** Index into the in-flight packet lengths. No more than a window of packets can be in flight. */
+#define LEN_INDEX(sender, seq) ((seq) & (lens_count(sender) - 1))
+
+#if CONFIG_POUCH_TRANSPORT_SAR_EXT
+POUCH_STATIC_ASSERT((CONFIG_POUCH_TRANSPORT_SAR_EXT_WINDOW_MAX
+                     & (CONFIG_POUCH_TRANSPORT_SAR_EXT_WINDOW_MAX - 1))
+                        == 0,
+                    "The extended window must be a power of two");
+#endif
 
 POUCH_LOG_REGISTER(pouch_sender, CONFIG_POUCH_TRANSPORT_LOG_LEVEL);
 
@@ -22,14 +32,295 @@ enum state
     STATE_FIN,
 };
 
-static void end(struct pouch_sender *sender, bool success)
+static uint16_t seq_mask(const struct pouch_sender *sender)
 {
-    if (sender->endpoint->end)
+    return sender->ext ? POUCH_SAR_EXT_SEQ_MASK : POUCH_SAR_SEQ_MASK;
+}
+
+static uint16_t window_max(const struct pouch_sender *sender)
+{
+    return sender->ext ? POUCH_SAR_EXT_WINDOW_MAX : POUCH_SAR_WINDOW_MAX;
+}
+
+static size_t header_len(const struct pouch_sender *sender)
+{
+    return sender->ext ? POUCH_SAR_TX_PKT_EXT_HEADER_LEN : POUCH_SAR_TX_PKT_HEADER_LEN;
+}
+
+/** Number of in-flight packet lengths that can be tracked */
+static size_t lens_count(const struct pouch_sender *sender)
+{
+#if CONFIG_POUCH_TRANSPORT_SAR_EXT
+    if (sender->ext)
+    {
+        return CONFIG_POUCH_TRANSPORT_SAR_EXT_WINDOW_MAX;
+    }
+#endif
+    return POUCH_SAR_WINDOW_MAX + 1;
+}
+
+static uint16_t in_flight(const struct pouch_sender *sender)
+{
+    return SEQ(sender, sender->seq - sender->acked - 1);
+}
+
+#if CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT
+
+POUCH_STATIC_ASSERT((CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT_WINDOW
+                     & (CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT_WINDOW - 1))
+                        == 0,
+                    "The retransmit window must be a power of two");
+
+#define RTX_SLOT(seq) ((seq) & (CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT_WINDOW - 1))
+
+static void lock_init(struct pouch_sender *sender)
+{
+    // Senders are zero initialized by the transports, so the lock is set up on the first open,
+    // before the retransmit timer can run:
+    if (!sender->rtx.lock_ready)
+    {
+        pouch_mutex_init(&sender->rtx.lock);
+        sender->rtx.lock_ready = true;
+    }
+}
+
+static void lock(struct pouch_sender *sender)
+{
+    pouch_mutex_lock(&sender->rtx.lock, POUCH_FOREVER);
+}
+
+static void unlock_sender(struct pouch_sender *sender)
+{
+    pouch_mutex_unlock(&sender->rtx.lock);
+}
+
+static void unlock(struct pouch_sender *sender);
+static void end(struct pouch_sender *sender, bool success);
+
+static uint8_t *rtx_packet(struct pouch_sender *sender, uint16_t seq)
+{
+    return &sender->rtx.buf[RTX_SLOT(seq) * sender->bearer->maxlen];
+}
+
+/** Retransmit the packets from rtx.resend_seq up to the last packet sent. */
+static int rtx_resend_pending(struct pouch_sender *sender)
+{
+    // Packets that were acked while the bearer was busy don't need to be sent again:
+    if (SEQ(sender, sender->rtx.resend_seq - sender->acked - 1) > in_flight(sender))
+    {
+        sender->rtx.resend_seq = SEQ(sender, sender->acked + 1);
+    }
+
+    while (sender->rtx.resend_seq != sender->seq)
+    {
+        uint16_t seq = sender->rtx.resend_seq;
+        int err = pouch_bearer_send(sender->bearer,
+                                    rtx_packet(sender, seq),
+                                    sender->rtx.lens[RTX_SLOT(seq)]);
+        if (err == -EAGAIN)
+        {
+            // The bearer calls ready once it can take more packets:
+            POUCH_LOG_DBG("Bearer busy, retransmit paused at seq: %x", seq);
+            return err;
+        }
+        if (err)
+        {
+            // The timer will try again:
+            POUCH_LOG_ERR("Retransmit failed (%d)", err);
+            sender->rtx.resending = false;
+            return err;
+        }
+
+        POUCH_LOG_DBG("Retransmitted seq: %x", seq);
+        sender->rtx.resend_seq = SEQ(sender, seq + 1);
+    }
+
+    sender->rtx.resending = false;
+    return 0;
+}
+
+/** Go back N: send all packets in flight again. */
+static void rtx_resend(struct pouch_sender *sender)
+{
+    // Karn's algorithm: the acks for retransmitted packets are ambiguous, and can't be timed
+    sender->rtx.rtt_active = false;
+    sender->rtx.resend_seq = SEQ(sender, sender->acked + 1);
+    sender->rtx.resending = true;
+
+    (void) rtx_resend_pending(sender);
+}
+
+static void rtx_timeout(pouch_work_delayable_t *dwork)
+{
+    struct pouch_sender *sender = CONTAINER_OF(dwork, struct pouch_sender, rtx.work);
+
+    lock(sender);
+
+    if (sender->bearer == NULL || in_flight(sender) == 0)
+    {
+        unlock(sender);
+        return;
+    }
+
+    if (++sender->rtx.retries > CONFIG_POUCH_TRANSPORT_SAR_MAX_RETRIES)
+    {
+        POUCH_LOG_ERR("No ack after %u retransmissions", CONFIG_POUCH_TRANSPORT_SAR_MAX_RETRIES);
+        end(sender, false);
+        unlock(sender);
+        return;
+    }
+
+    sender->rtx.rto = MIN(sender->rtx.rto * 2, CONFIG_POUCH_TRANSPORT_SAR_RTO_MAX_MS);
+
+    POUCH_LOG_WRN("Ack timeout, retransmitting %u packets", in_flight(sender));
+    rtx_resend(sender);
+
+    pouch_work_schedule(&sender->rtx.work, POUCH_MSEC(sender->rtx.rto));
+
+    unlock(sender);
+}
+
+static int rtx_open(struct pouch_sender *sender)
+{
+    sender->rtx.buf = malloc(CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT_WINDOW * sender->bearer->maxlen);
+    if (sender->rtx.buf == NULL)
+    {
+        return -ENOMEM;
+    }
+
+    sender->rtx.rto = CONFIG_POUCH_TRANSPORT_SAR_RTO_INITIAL_MS;
+    sender->rtx.srtt = 0;
+    sender->rtx.rttvar = 0;
+    sender->rtx.rtt_active = false;
+    sender->rtx.retries = 0;
+    sender->rtx.dup_acks = 0;
+    sender->rtx.resending = false;
+    pouch_work_delayable_init(&sender->rtx.work, rtx_timeout);
+
+    return 0;
+}
+
+static void rtx_close(struct pouch_sender *sender)
+{
+    if (sender->rtx.buf == NULL)
+    {
+        return;
+    }
+
+    pouch_work_cancel_delayable(&sender->rtx.work);
+    free(sender->rtx.buf);
+    sender->rtx.buf = NULL;
+}
+
+/** Keep a sent packet until it's acked */
+static void rtx_store(struct pouch_sender *sender, const uint8_t *buf, size_t len)
+{
+    memcpy(rtx_packet(sender, sender->seq), buf, len);
+    sender->rtx.lens[RTX_SLOT(sender->seq)] = len;
+
+    if (!sender->rtx.rtt_active)
+    {
+        sender->rtx.rtt_seq = sender->seq;
+        sender->rtx.rtt_start = pouch_uptime_ms();
+        sender->rtx.rtt_active = true;
+    }
+
+    pouch_work_schedule(&sender->rtx.work, POUCH_MSEC(sender->rtx.rto));
+}
+
+/** Update the round trip time estimate, as described in RFC 6298 */
+static void rtx_rtt_sample(struct pouch_sender *sender, uint32_t rtt)
+{
+    if (sender->rtx.srtt == 0)
+    {
+        sender->rtx.srtt = rtt * 8;
+        sender->rtx.rttvar = rtt * 2;
+    }
+    else
+    {
+        int32_t delta = (int32_t) rtt - (int32_t) (sender->rtx.srtt / 8);
+        sender->rtx.srtt += delta;
+        sender->rtx.rttvar += abs(delta) - sender->rtx.rttvar / 4;
+    }
+
+    uint32_t rto = sender->rtx.srtt / 8 + sender->rtx.rttvar;
+    if (rto < CONFIG_POUCH_TRANSPORT_SAR_RTO_MIN_MS)
+    {
+        rto = CONFIG_POUCH_TRANSPORT_SAR_RTO_MIN_MS;
+    }
+
+    sender->rtx.rto = MIN(rto, CONFIG_POUCH_TRANSPORT_SAR_RTO_MAX_MS);
+
+    POUCH_LOG_DBG("RTT: %u ms, RTO: %u ms", rtt, sender->rtx.rto);
+}
+
+static void rtx_ack(struct pouch_sender *sender, uint16_t seq)
+{
+    if (seq == sender->acked)
+    {
+        // The receiver is missing the next packet. Retransmit on the second duplicate:
+        if (in_flight(sender) > 0 && ++sender->rtx.dup_acks == 2)
+        {
+            POUCH_LOG_WRN("Duplicate acks, retransmitting %u packets", in_flight(sender));
+            rtx_resend(sender);
+        }
+        return;
+    }
+
+    if (sender->rtx.rtt_active && SEQ(sender, seq - sender->rtx.rtt_seq) <= window_max(sender))
+    {
+        rtx_rtt_sample(sender, pouch_uptime_ms() - sender->rtx.rtt_start);
+        sender->rtx.rtt_active = false;
+    }
+
+    sender->rtx.retries = 0;
+    sender->rtx.dup_acks = 0;
+
+    if (seq == SEQ(sender, sender->seq - 1))
+    {
+        pouch_work_cancel_delayable(&sender->rtx.work);
+    }
+    else
+    {
+        pouch_work_reschedule(&sender->rtx.work, POUCH_MSEC(sender->rtx.rto));
+    }
+}
+
+#else
+
+static void lock_init(struct pouch_sender *sender) {}
+
+static void lock(struct pouch_sender *sender) {}
+
+static void unlock_sender(struct pouch_sender *sender) {}
+
+#endif  // CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT
+
+/** Unlock the sender, and close the bearer if the transfer ended while it was locked. */
+static void unlock(struct pouch_sender *sender)
+{
+    struct pouch_bearer *bearer = sender->closing.bearer;
+    bool success = sender->closing.success;
+
+    sender->closing.bearer = NULL;
+    unlock_sender(sender);
+
+    // The bearer may call back into the transport, so it's closed without holding the lock:
+    if (bearer != NULL)
     {
-        sender->endpoint->end(sender->bearer, success);
+        pouch_bearer_close(bearer, success);
     }
+}
 
-    pouch_bearer_close(sender->bearer, success);
+/** End the transfer, and return the bearer for the caller to close. */
+static struct pouch_bearer *finish(struct pouch_sender *sender, bool success)
+{
+    struct pouch_bearer *bearer = sender->bearer;
+
+    if (sender->endpoint->end)
+    {
+        sender->endpoint->end(bearer, success);
+    }
 
     sender->seq = 0;
     sender->window = 0;
@@ -37,7 +328,42 @@ static void end(struct pouch_sender *sender, bool success)
 
     free(sender->buf);
     sender->buf = NULL;
+    free(sender->lens);
+    sender->lens = NULL;
+#if CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT
+    rtx_close(sender);
+#endif
     sender->bearer = NULL;
+
+    return bearer;
+}
+
+/** End the transfer. The bearer is closed when the sender is unlocked. */
+static void end(struct pouch_sender *sender, bool success)
+{
+    sender->closing.bearer = finish(sender, success);
+    sender->closing.success = success;
+}
+
+static void ack_packets(struct pouch_sender *sender, uint16_t seq)
+{
+    if (sender->lens == NULL)
+    {
+        sender->acked = seq;
+        return;
+    }
+
+    size_t len = 0;
+    while (sender->acked != seq)
+    {
+        sender->acked = SEQ(sender, sender->acked + 1);
+        len += sender->lens[LEN_INDEX(sender, sender->acked)];
+    }
+
+    if (len > 0)
+    {
+        sender->endpoint->ack(sender->bearer, len);
+    }
 }
 
 static void send_fin(struct pouch_sender *p)
@@ -70,16 +396,125 @@ static void send_fin(struct pouch_sender *p)
     p->state = STATE_IDLE;
 }
 
-static void push_fragments(struct pouch_sender *sender)
+/** Number of packets passed to the bearer in a single write */
+static size_t batch_size(const struct pouch_sender *sender)
+{
+    return sender->bearer->sendv ? CONFIG_POUCH_TRANSPORT_SAR_BATCH : 1;
+}
+
+static uint8_t *pending_packet(struct pouch_sender *sender, size_t index)
+{
+    return &sender->buf[index * sender->bearer->maxlen];
+}
+
+/** Number of packets that can be sent before the window or the in-flight limits are reached */
+static size_t send_room(const struct pouch_sender *sender)
+{
+    size_t room = SEQ(sender, sender->window - sender->seq);
+
+#if CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT
+    if (in_flight(sender) >= CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT_WINDOW)
+    {
+        // No room to keep more packets for retransmission, wait for acks.
+        return 0;
+    }
+
+    room = MIN(room, CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT_WINDOW - in_flight(sender));
+#endif
+    if (sender->lens)
+    {
+        if (in_flight(sender) >= lens_count(sender) - 1)
+        {
+            return 0;
+        }
+
+        room = MIN(room, lens_count(sender) - 1 - in_flight(sender));
+    }
+
+    return room;
+}
+
+static int send_pending(struct pouch_sender *sender, size_t max)
+{
+    struct pouch_bearer_pkt pkts[CONFIG_POUCH_TRANSPORT_SAR_BATCH];
+    size_t count = MIN(sender->pending.count, max);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        pkts[i].buf = pending_packet(sender, i);
+        pkts[i].len = sender->pending.len[i];
+    }
+
+    int sent = pouch_bearer_sendv(sender->bearer, pkts, count);
+    if (sent == -EAGAIN)
+    {
+        // The bearer is busy, and will call ready once it can take more packets.
+        POUCH_LOG_DBG("Bearer busy, seq: %x", sender->seq);
+        return sent;
+    }
+    if (sent < 0)
+    {
+        POUCH_LOG_ERR("TX failed (%d)", sent);
+        return sent;
+    }
+
+    for (int i = 0; i < sent; i++)
+    {
+        POUCH_LOG_DBG("Data sent. len: %u, seq: %x", sender->pending.data_len[i], sender->seq);
+
+        if (sender->lens)
+        {
+            sender->lens[LEN_INDEX(sender, sender->seq)] = sender->pending.data_len[i];
+        }
+
+#if CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT
+        rtx_store(sender, pkts[i].buf, pkts[i].len);
+#endif
+
+        sender->seq = SEQ(sender, sender->seq + 1);
+    }
+
+    sender->pending.count -= sent;
+    if (sender->pending.count > 0)
+    {
+        // Keep the packets the bearer didn't take at the start of the buffer:
+        memmove(sender->buf,
+                pending_packet(sender, sent),
+                sender->pending.count * sender->bearer->maxlen);
+        memmove(sender->pending.len,
+                &sender->pending.len[sent],
+                sender->pending.count * sizeof(sender->pending.len[0]));
+        memmove(sender->pending.data_len,
+                &sender->pending.data_len[sent],
+                sender->pending.count * sizeof(sender->pending.data_len[0]));
+    }
+
+    if (sent > 0)
+    {
+        bool fin = (sender->pending.count == 0 && sender->pending.last);
+        sender->state = fin ? STATE_FIN : STATE_ACTIVE;
+    }
+
+    return 0;
+}
+
+/** Pull up to @p max packets from the endpoint into the pending packets. */
+static int pull_fragments(struct pouch_sender *sender, size_t max)
 {
-    while (sender->seq != sender->window)
+    while (sender->pending.count < max && !sender->pending.last)
     {
+        size_t index = sender->pending.count;
+        uint8_t *buf = pending_packet(sender, index);
         struct pouch_sar_tx_pkt pkt = {
-            .seq = sender->seq,
-            .data = &sender->buf[POUCH_SAR_TX_PKT_HEADER_LEN],
-            .len = sender->bearer->maxlen - POUCH_SAR_TX_PKT_HEADER_LEN,
+            .seq = SEQ(sender, sender->seq + index),
+            .data = &buf[header_len(sender)],
+            .len = sender->bearer->maxlen - header_len(sender),
         };
-        if (sender->state == STATE_READY)
+        if (sender->ext)
+        {
+            pkt.flags |= POUCH_SAR_TX_PKT_FLAG_EXT;
+        }
+        if (sender->state == STATE_READY && index == 0)
         {
             pkt.flags |= POUCH_SAR_TX_PKT_FLAG_FIRST;
         }
@@ -88,13 +523,13 @@ static void push_fragments(struct pouch_sender *sender)
         if (res == POUCH_ERROR)
         {
             POUCH_LOG_ERR("Error from endpoint, aborting");
-            pouch_bearer_close(sender->bearer, false);
-            return;
+            end(sender, false);
+            return -EIO;
         }
         if (res == POUCH_MORE_DATA && pkt.len == 0)
         {
             // no data at this time, will come back later.
-            return;
+            return 0;
         }
 
         if (res == POUCH_NO_MORE_DATA)
@@ -104,34 +539,54 @@ static void push_fragments(struct pouch_sender *sender)
         }
 
         size_t len = sender->bearer->maxlen;
-        int err = pouch_sar_tx_pkt_encode(&pkt, sender->buf, &len);
+        int err = pouch_sar_tx_pkt_encode(&pkt, buf, &len);
         if (err)
         {
             POUCH_LOG_ERR("Encode failed (%d)", err);
-            return;
+            return err;
         }
 
-        err = pouch_bearer_send(sender->bearer, sender->buf, len);
-        if (err)
-        {
-            POUCH_LOG_ERR("TX failed (%d)", err);
-            return;
-        }
+        // The endpoint data is consumed, so the packet is kept until the bearer accepts it:
+        sender->pending.len[index] = len;
+        sender->pending.data_len[index] = pkt.len;
+        sender->pending.last = (res == POUCH_NO_MORE_DATA);
+        sender->pending.count++;
+    }
+
+    return 0;
+}
 
-        POUCH_LOG_DBG("Data sent. flags: %x, len: %u, seq: %x", pkt.flags, pkt.len, pkt.seq);
+static void push_fragments(struct pouch_sender *sender)
+{
+#if CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT
+    // Finish retransmitting before sending new packets:
+    if (sender->rtx.resending && rtx_resend_pending(sender))
+    {
+        return;
+    }
+#endif
 
-        sender->seq++;
-        sender->state = STATE_ACTIVE;
+    size_t room;
+    while ((room = send_room(sender)) > 0)
+    {
+        // Packets the bearer didn't take are retried before pulling more data:
+        if (sender->pending.count == 0)
+        {
+            if (pull_fragments(sender, MIN(room, batch_size(sender)))
+                || sender->pending.count == 0)
+            {
+                return;
+            }
+        }
 
-        if (res == POUCH_NO_MORE_DATA)
+        if (send_pending(sender, room) || sender->state == STATE_FIN)
         {
-            sender->state = STATE_FIN;
             return;
         }
     }
 }
 
-int pouch_sender_open(struct pouch_sender *sender, struct pouch_bearer *bearer)
+static int sender_open(struct pouch_sender *sender, struct pouch_bearer *bearer)
 {
     if (bearer->maxlen <= POUCH_SAR_TX_PKT_HEADER_LEN)
     {
@@ -139,16 +594,44 @@ int pouch_sender_open(struct pouch_sender *sender, struct pouch_bearer *bearer)
     }
 
     sender->bearer = bearer;
+    sender->ext = false;
     sender->seq = 0;
+    sender->acked = POUCH_SAR_SEQ_MAX;
     sender->window = 0;
     sender->state = STATE_READY;
+    sender->pending.count = 0;
+    sender->pending.last = false;
 
-    sender->buf = malloc(bearer->maxlen);
+    sender->buf = malloc(bearer->maxlen * batch_size(sender));
     if (sender->buf == NULL)
     {
         return -ENOMEM;
     }
 
+    sender->lens = NULL;
+    if (sender->endpoint->ack != NULL)
+    {
+        sender->lens = malloc((POUCH_SAR_WINDOW_MAX + 1) * sizeof(sender->lens[0]));
+        if (sender->lens == NULL)
+        {
+            free(sender->buf);
+            sender->buf = NULL;
+            return -ENOMEM;
+        }
+    }
+
+#if CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT
+    int err = rtx_open(sender);
+    if (err)
+    {
+        free(sender->buf);
+        sender->buf = NULL;
+        free(sender->lens);
+        sender->lens = NULL;
+        return err;
+    }
+#endif
+
     if (sender->endpoint->start != NULL)
     {
         int err = sender->endpoint->start(sender->bearer);
@@ -156,6 +639,11 @@ int pouch_sender_open(struct pouch_sender *sender, struct pouch_bearer *bearer)
         {
             free(sender->buf);
             sender->buf = NULL;
+            free(sender->lens);
+            sender->lens = NULL;
+#if CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT
+            rtx_close(sender);
+#endif
             return err;
         }
     }
@@ -165,7 +653,37 @@ int pouch_sender_open(struct pouch_sender *sender, struct pouch_bearer *bearer)
     return 0;
 }
 
-int pouch_sender_recv(struct pouch_sender *sender, const uint8_t *buf, size_t len)
+#if CONFIG_POUCH_TRANSPORT_SAR_EXT
+/** Switch to extended packets, before the first packet is sent. */
+static int use_ext(struct pouch_sender *sender)
+{
+    if (sender->bearer->maxlen <= POUCH_SAR_TX_PKT_EXT_HEADER_LEN)
+    {
+        return -EINVAL;
+    }
+
+    if (sender->lens)
+    {
+        uint16_t *lens = malloc(CONFIG_POUCH_TRANSPORT_SAR_EXT_WINDOW_MAX * sizeof(lens[0]));
+        if (lens == NULL)
+        {
+            return -ENOMEM;
+        }
+
+        free(sender->lens);
+        sender->lens = lens;
+    }
+
+    sender->ext = true;
+    sender->acked = POUCH_SAR_EXT_SEQ_MAX;
+
+    POUCH_LOG_DBG("Using extended packets");
+
+    return 0;
+}
+#endif
+
+static int sender_recv(struct pouch_sender *sender, const uint8_t *buf, size_t len)
 {
     struct pouch_sar_rx_pkt ack;
     if (sender->bearer == NULL)
@@ -188,26 +706,52 @@ int pouch_sender_recv(struct pouch_sender *sender, const uint8_t *buf, size_t le
         return -EIO;
     }
 
-    if (ack.window > POUCH_SAR_WINDOW_MAX)
+    if (ack.ext != sender->ext)
+    {
+        err = -EINVAL;
+#if CONFIG_POUCH_TRANSPORT_SAR_EXT
+        // The receiver picks the packet format in its first ack:
+        if (ack.ext && sender->state == STATE_READY && sender->pending.count == 0)
+        {
+            err = use_ext(sender);
+        }
+#endif
+        if (err)
+        {
+            POUCH_LOG_ERR("Unsupported ack format (%d)", err);
+            end(sender, false);
+            return err;
+        }
+    }
+
+    if (ack.window > window_max(sender))
     {
         POUCH_LOG_ERR("Invalid window");
         end(sender, false);
         return -EINVAL;
     }
 
-    uint8_t last_sent = (sender->seq - 1) & POUCH_SAR_SEQ_MASK;
-    uint8_t new_target = ack.seq + ack.window + 1;
+    uint16_t last_sent = SEQ(sender, sender->seq - 1);
+    uint16_t new_target = SEQ(sender, ack.seq + ack.window + 1);
 
     // If the acked sequence number is out of bounds, abort
-    if (((last_sent - ack.seq) & POUCH_SAR_SEQ_MASK) > POUCH_SAR_WINDOW_MAX)
+    if (SEQ(sender, last_sent - ack.seq) > window_max(sender))
     {
         POUCH_LOG_ERR("Out of order seq (%u, last sent: %u)", ack.seq, last_sent);
         end(sender, false);
         return -EINVAL;
     }
 
+    // A reordered or duplicated ack from before the last one can't confirm any more data,
+    // and its window is behind the current one:
+    if (SEQ(sender, ack.seq - sender->acked) > in_flight(sender))
+    {
+        POUCH_LOG_DBG("Ignoring stale ack (%x, acked: %x)", ack.seq, sender->acked);
+        return 0;
+    }
+
     // If the new target is lower than the current target, we're moving backwards, and should abort
-    if (((new_target - sender->window) & POUCH_SAR_SEQ_MASK) > POUCH_SAR_WINDOW_MAX)
+    if (SEQ(sender, new_target - sender->window) > window_max(sender))
     {
         POUCH_LOG_ERR("Unexpected window (%u, current: %u)", new_target, sender->window);
         end(sender, false);
@@ -216,6 +760,12 @@ int pouch_sender_recv(struct pouch_sender *sender, const uint8_t *buf, size_t le
 
     sender->window = new_target;
 
+#if CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT
+    rtx_ack(sender, ack.seq);
+#endif
+
+    ack_packets(sender, ack.seq);
+
     POUCH_LOG_DBG("Received ack (%x window: %u. New target seq: %x)",
                   ack.seq,
                   ack.window,
@@ -238,13 +788,37 @@ int pouch_sender_recv(struct pouch_sender *sender, const uint8_t *buf, size_t le
     return 0;
 }
 
+int pouch_sender_open(struct pouch_sender *sender, struct pouch_bearer *bearer)
+{
+    lock_init(sender);
+
+    lock(sender);
+    int err = sender_open(sender, bearer);
+    unlock(sender);
+
+    return err;
+}
+
+int pouch_sender_recv(struct pouch_sender *sender, const uint8_t *buf, size_t len)
+{
+    lock(sender);
+    int err = sender_recv(sender, buf, len);
+    unlock(sender);
+
+    return err;
+}
+
 void pouch_sender_ready(struct pouch_sender *sender)
 {
+    lock(sender);
     push_fragments(sender);
+    unlock(sender);
 }
 
 void pouch_sender_close(struct pouch_sender *sender)
 {
+    lock(sender);
+
     POUCH_LOG_DBG("%p bearer %p", sender, sender->bearer);
     switch ((enum state) sender->state)
     {
@@ -260,4 +834,6 @@ void pouch_sender_close(struct pouch_sender *sender)
             POUCH_LOG_DBG("Closed while idle");
             break;
     }
+
+    unlock(sender);
 }
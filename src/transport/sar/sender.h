@@ -5,6 +5,7 @@
  */
 
 #pragma once
+#include <pouch/port.h>
 #include "../bearer.h"
 #include <pouch/transport/types.h>
 #include "../endpoints/endpoint.h"
@@ -15,10 +16,64 @@ struct pouch_sender
     struct pouch_bearer *bearer;
 
     uint8_t *buf;
+    /** Payload length of each packet in flight. Only allocated if the endpoint takes acks. */
+    uint16_t *lens;
 
-    uint8_t seq;
-    uint8_t window;
+    uint16_t seq;
+    uint16_t acked;
+    uint16_t window;
     uint8_t state;
+    /** Encoded packets in buf that the bearer hasn't accepted yet, one per maxlen slot */
+    struct
+    {
+        /** Number of pending packets */
+        uint8_t count;
+        /** The last pending packet ends the transfer */
+        bool last;
+        /** Encoded length of each packet */
+        uint16_t len[CONFIG_POUCH_TRANSPORT_SAR_BATCH];
+        /** Payload length of each packet */
+        uint16_t data_len[CONFIG_POUCH_TRANSPORT_SAR_BATCH];
+    } pending;
+    /** Extended packets, with 16 bit sequence numbers. Selected by the receiver's first ack. */
+    bool ext;
+    /** Bearer to close once the sender is unlocked, after the transfer ended */
+    struct
+    {
+        struct pouch_bearer *bearer;
+        bool success;
+    } closing;
+
+#if CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT
+    struct
+    {
+        /** Encoded packets in flight, kept until they're acked */
+        uint8_t *buf;
+        /** Encoded length of each packet in flight */
+        uint16_t lens[CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT_WINDOW];
+        /** Retransmission timer */
+        pouch_work_delayable_t work;
+        /** Retransmission timeout, in ms */
+        uint32_t rto;
+        /** Smoothed round trip time, in 1/8 ms */
+        uint32_t srtt;
+        /** Round trip time variation, in 1/4 ms */
+        uint32_t rttvar;
+        /** Uptime when the packet that's being timed was sent */
+        uint32_t rtt_start;
+        /** Sequence number of the packet that's being timed */
+        uint16_t rtt_seq;
+        bool rtt_active;
+        uint8_t retries;
+        uint8_t dup_acks;
+        /** Next packet to retransmit, while the bearer is busy */
+        uint16_t resend_seq;
+        bool resending;
+        /** Serializes the retransmit timer with the transport's calls into the sender */
+        pouch_mutex_t lock;
+        bool lock_ready;
+    } rtx;
+#endif
 };
 
 int pouch_sender_open(struct pouch_sender *sender, struct pouch_bearer *bearer);
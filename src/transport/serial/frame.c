@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "frame.h"
+
+/** Largest COBS block: a code byte and 254 non-zero bytes */
+#define COBS_BLOCK_MAX 0xff
+
+/** CRC-16/CCITT-FALSE, 4 bits at a time */
+static uint16_t crc16_update(uint16_t crc, uint8_t byte)
+{
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+        0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+    };
+
+    crc = (crc << 4) ^ table[(crc >> 12) ^ (byte >> 4)];
+    crc = (crc << 4) ^ table[(crc >> 12) ^ (byte & 0x0f)];
+
+    return crc;
+}
+
+static uint16_t crc16(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xffff;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = crc16_update(crc, data[i]);
+    }
+
+    return crc;
+}
+
+struct encoder
+{
+    uint8_t *dst;
+    /** Position of the current block's code byte */
+    size_t code_pos;
+    size_t pos;
+};
+
+static void encode_byte(struct encoder *e, uint8_t byte)
+{
+    if (byte != 0)
+    {
+        e->dst[e->pos++] = byte;
+    }
+
+    if (byte == 0 || e->pos - e->code_pos == COBS_BLOCK_MAX)
+    {
+        e->dst[e->code_pos] = e->pos - e->code_pos;
+        e->code_pos = e->pos++;
+    }
+}
+
+size_t pouch_frame_encode(uint8_t channel, const uint8_t *packet, size_t len, uint8_t *dst)
+{
+    struct encoder e = {
+        .dst = dst,
+        .code_pos = 0,
+        .pos = 1,
+    };
+
+    uint16_t crc = crc16_update(0xffff, channel);
+    encode_byte(&e, channel);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = crc16_update(crc, packet[i]);
+        encode_byte(&e, packet[i]);
+    }
+
+    encode_byte(&e, crc >> 8);
+    encode_byte(&e, crc & 0xff);
+
+    dst[e.code_pos] = e.pos - e.code_pos;
+    dst[e.pos++] = POUCH_FRAME_DELIMITER;
+
+    return e.pos;
+}
+
+void pouch_frame_decoder_init(struct pouch_frame_decoder *decoder,
+                              uint8_t *buf,
+                              size_t size,
+                              pouch_frame_handler_t handler,
+                              void *ctx)
+{
+    *decoder = (struct pouch_frame_decoder){
+        .buf = buf,
+        .size = size,
+        .handler = handler,
+        .ctx = ctx,
+    };
+}
+
+static void append(struct pouch_frame_decoder *decoder, uint8_t byte)
+{
+    if (decoder->len < decoder->size)
+    {
+        decoder->buf[decoder->len++] = byte;
+    }
+    else
+    {
+        decoder->overflow = true;
+    }
+}
+
+/** Finish the current frame. Returns whether it was valid. */
+static bool finish(struct pouch_frame_decoder *decoder)
+{
+    size_t len = decoder->len;
+    bool truncated = (decoder->left != 0);
+    bool overflow = decoder->overflow;
+
+    decoder->len = 0;
+    decoder->left = 0;
+    decoder->code = 0;
+    decoder->overflow = false;
+
+    if (len == 0 && !truncated && !overflow)
+    {
+        // Repeated delimiters are allowed, and can be used to resynchronize the stream.
+        return true;
+    }
+
+    if (truncated || overflow || len < POUCH_FRAME_OVERHEAD)
+    {
+        return false;
+    }
+
+    uint16_t crc = ((uint16_t) decoder->buf[len - 2] << 8) | decoder->buf[len - 1];
+    if (crc16(decoder->buf, len - 2) != crc)
+    {
+        return false;
+    }
+
+    decoder->handler(decoder->ctx,
+                     decoder->buf[0],
+                     &decoder->buf[1],
+                     len - POUCH_FRAME_OVERHEAD);
+    return true;
+}
+
+int pouch_frame_decoder_push(struct pouch_frame_decoder *decoder, const uint8_t *data, size_t len)
+{
+    int dropped = 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        uint8_t byte = data[i];
+
+        if (byte == POUCH_FRAME_DELIMITER)
+        {
+            if (!finish(decoder))
+            {
+                dropped++;
+            }
+        }
+        else if (decoder->left == 0)
+        {
+            // Every block except the longest ones ends with an implicit zero, but it's only
+            // part of the frame if another block follows:
+            if (decoder->code != 0 && decoder->code != COBS_BLOCK_MAX)
+            {
+                append(decoder, 0);
+            }
+
+            decoder->code = byte;
+            decoder->left = byte - 1;
+        }
+        else
+        {
+            append(decoder, byte);
+            decoder->left--;
+        }
+    }
+
+    return dropped;
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Stream framing for SAR packets.
+ *
+ * Each frame holds a channel number, the packet and a CRC-16/CCITT of both, COBS encoded and
+ * terminated by a zero byte:
+ *
+ *     COBS(channel | packet | crc16) | 0x00
+ *
+ * COBS removes all zero bytes from the frame, so the receiver can always find the start of the next
+ * frame, even after losing bytes.
+ */
+
+/** Frame delimiter */
+#define POUCH_FRAME_DELIMITER 0x00
+
+/** Bytes added to the packet before encoding: channel (1) + CRC (2) */
+#define POUCH_FRAME_OVERHEAD 3
+
+/** Maximum encoded size of a frame carrying a packet of @p len bytes, including the delimiter */
+#define POUCH_FRAME_ENCODED_MAX(len) \
+    ((len) + POUCH_FRAME_OVERHEAD + (((len) + POUCH_FRAME_OVERHEAD) / 254) + 2)
+
+/**
+ * Called for every valid frame.
+ *
+ * The packet points into the decoder's buffer, and is only valid until the callback returns.
+ */
+typedef void (*pouch_frame_handler_t)(void *ctx, uint8_t channel, uint8_t *packet, size_t len);
+
+struct pouch_frame_decoder
+{
+    /** Buffer for the decoded frame */
+    uint8_t *buf;
+    size_t size;
+    size_t len;
+    /** Bytes left in the current COBS block */
+    uint8_t left;
+    /** Code of the current COBS block */
+    uint8_t code;
+    /** The frame didn't fit in the buffer, and is dropped */
+    bool overflow;
+
+    pouch_frame_handler_t handler;
+    void *ctx;
+};
+
+/**
+ * Encode a frame.
+ *
+ * @param channel Channel number
+ * @param packet Packet to carry in the frame
+ * @param len Length of the packet
+ * @param dst Destination buffer, at least POUCH_FRAME_ENCODED_MAX(len) bytes
+ *
+ * @return Length of the encoded frame, including the delimiter
+ */
+size_t pouch_frame_encode(uint8_t channel, const uint8_t *packet, size_t len, uint8_t *dst);
+
+/**
+ * Initialize a frame decoder.
+ *
+ * @param decoder Decoder to initialize
+ * @param buf Buffer for the decoded frames. Frames that don't fit in the buffer are dropped.
+ * @param size Size of @p buf
+ * @param handler Called for every valid frame
+ * @param ctx Context passed to @p handler
+ */
+void pouch_frame_decoder_init(struct pouch_frame_decoder *decoder,
+                              uint8_t *buf,
+                              size_t size,
+                              pouch_frame_handler_t handler,
+                              void *ctx);
+
+/**
+ * Push received bytes into the decoder.
+ *
+ * The bytes are decoded directly into the decoder's buffer, and the handler is called for each
+ * complete frame. Frames with an invalid encoding or CRC are dropped.
+ *
+ * @return The number of frames that were dropped.
+ */
+int pouch_frame_decoder_push(struct pouch_frame_decoder *decoder, const uint8_t *data, size_t len);
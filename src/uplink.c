@@ -17,13 +17,20 @@
 #include <pouch/port.h>
 #include <pouch/transport/uplink.h>
 
+#include <stdint.h>
 #include <stdlib.h>
 
+POUCH_LOG_REGISTER(pouch_uplink, CONFIG_POUCH_COMMON_LOG_LEVEL);
+
 enum flags
 {
     SESSION_ACTIVE,
     POUCH_CLOSING,
     POUCH_CLOSED,
+    /** The uplink handlers have run, the pouch closes when all holds are released */
+    HANDLERS_DONE,
+    /** The session resends an interrupted pouch, and takes no new entries */
+    RESUMED,
 };
 
 POUCH_THREAD_STACK_DEFINE(uplink_processing_stack, CONFIG_POUCH_UPLINK_PROCESSING_STACK_SIZE);
@@ -35,6 +42,18 @@ struct pouch_uplink
     pouch_atomic_t id;
     int error;
 
+    struct
+    {
+        /** Number of holds keeping the pouch open */
+        pouch_atomic_t count;
+        /** Closes the pouch if the holds aren't released in time */
+        pouch_work_delayable_t timeout;
+        /** Closes the pouch once the last hold is released */
+        pouch_work_t close;
+        /** Session that the timeout was scheduled for */
+        uint32_t session_id;
+    } hold;
+
     struct
     {
         /** Blocks that are ready for processing */
@@ -50,7 +69,31 @@ struct pouch_uplink
         struct pouch_bufview reader;
         /** Semaphore to signal available blocks in the queue */
         pouch_sem_t has_queue_sem;
+#if CONFIG_POUCH_UPLINK_RESUME
+        /** Buffers that have been passed to the transport, but haven't been confirmed */
+        pouch_buf_queue_t sent;
+        /** Header of the current transfer */
+        const struct pouch_buf *header;
+        /** Number of confirmed bytes in the first buffer of the sent queue */
+        size_t confirmed;
+        /** Number of blocks confirmed in the current transfer */
+        uint32_t confirmed_blocks;
+#endif
     } transport;
+#if CONFIG_POUCH_UPLINK_RESUME
+    /** Checkpoint of an interrupted pouch */
+    struct
+    {
+        /** Encrypted blocks that haven't been confirmed by the receiving end */
+        pouch_buf_queue_t blocks;
+        /** Index of the first unconfirmed block in the pouch */
+        uint32_t first_block;
+        /** Number of consecutive transfers that were interrupted */
+        unsigned int attempts;
+        /** Whether the checkpoint should be resumed in the next transfer */
+        bool pending;
+    } checkpoint;
+#endif
 };
 
 /** Single uplink session */
@@ -71,6 +114,14 @@ static bool pouch_is_closing(void)
     return pouch_atomic_test_bit(uplink.flags, POUCH_CLOSING);
 }
 
+static void header_submit(struct pouch_buf *header)
+{
+#if CONFIG_POUCH_UPLINK_RESUME
+    uplink.transport.header = header;
+#endif
+    buf_queue_submit(&uplink.transport.queue, header);
+}
+
 static void process_blocks(pouch_work_t *work)
 {
     while (session_is_active() && pouch_is_open() && !buf_queue_is_empty(&uplink.processing.queue))
@@ -83,7 +134,7 @@ static void process_blocks(pouch_work_t *work)
 
         if (uplink.header)
         {
-            buf_queue_submit(&uplink.transport.queue, uplink.header);
+            header_submit(uplink.header);
             uplink.header = NULL;
         }
 
@@ -98,7 +149,7 @@ static void process_blocks(pouch_work_t *work)
     pouch_sem_give(&uplink.transport.has_queue_sem);
 }
 
-static void end_session(void)
+static void end_session(bool suspend)
 {
     /*
      * Wait for any in-flight downlink decryption to finish before destroying
@@ -106,7 +157,14 @@ static void end_session(void)
      * which the async decrypt worker still needs.
      */
     pouch_downlink_flush();
-    crypto_session_end();
+    if (suspend)
+    {
+        crypto_session_suspend();
+    }
+    else
+    {
+        crypto_session_end();
+    }
     pouch_atomic_clear_bit(uplink.flags, SESSION_ACTIVE);
     pouch_event_emit(POUCH_EVENT_SESSION_END);
 }
@@ -131,11 +189,85 @@ int pouch_uplink_close(pouch_timeout_t timeout)
     return err;
 }
 
+int pouch_uplink_hold(void)
+{
+    if (!session_is_active())
+    {
+        return -ENODEV;
+    }
+
+    pouch_atomic_inc(&uplink.hold.count);
+
+    /* The pouch may have started closing before the hold was counted */
+    if (pouch_is_closing())
+    {
+        pouch_atomic_dec(&uplink.hold.count);
+        return -EALREADY;
+    }
+
+    return 0;
+}
+
+void pouch_uplink_release(void)
+{
+    long holds = pouch_atomic_dec(&uplink.hold.count);
+    if (holds <= 0)
+    {
+        /* The session ended, and its holds were dropped */
+        pouch_atomic_inc(&uplink.hold.count);
+        return;
+    }
+
+    if (holds > 1)
+    {
+        return;
+    }
+
+    if (pouch_atomic_test_bit(uplink.flags, HANDLERS_DONE))
+    {
+        /* The holder may be a downlink handler, which must not wait for the pouch to close */
+        pouch_work_cancel_delayable(&uplink.hold.timeout);
+        pouch_work_submit_to_queue(&uplink.processing.work_queue, &uplink.hold.close);
+    }
+}
+
+static bool hold_session_is_current(void)
+{
+    return uplink.hold.session_id == pouch_atomic_get_value(&uplink.id) && session_is_active();
+}
+
+static void hold_close(pouch_work_t *work)
+{
+    if (!hold_session_is_current())
+    {
+        return;
+    }
+
+    pouch_uplink_close(POUCH_FOREVER);
+}
+
+static void hold_timeout(pouch_work_delayable_t *dwork)
+{
+    if (!hold_session_is_current())
+    {
+        return;
+    }
+
+    POUCH_LOG_WRN("Uplink holds not released in time, closing pouch");
+    pouch_uplink_close(POUCH_FOREVER);
+}
+
 void uplink_init(void)
 {
     buf_queue_init(&uplink.processing.queue);
     buf_queue_init(&uplink.transport.queue);
+#if CONFIG_POUCH_UPLINK_RESUME
+    buf_queue_init(&uplink.transport.sent);
+    buf_queue_init(&uplink.checkpoint.blocks);
+#endif
     pouch_work_init(&uplink.processing.work, process_blocks);
+    pouch_work_delayable_init(&uplink.hold.timeout, hold_timeout);
+    pouch_work_init(&uplink.hold.close, hold_close);
 
     pouch_work_queue_init(&uplink.processing.work_queue);
     pouch_work_queue_start(&uplink.processing.work_queue,
@@ -152,6 +284,11 @@ uint32_t uplink_session_id(void)
     return pouch_atomic_get_value(&uplink.id);
 }
 
+uint32_t pouch_uplink_session_id(void)
+{
+    return uplink_session_id();
+}
+
 // emit uplink calls in event handler to ensure that they run in the pouch processing thread.
 static void event_handler(enum pouch_event evt, void *ctx)
 {
@@ -160,6 +297,12 @@ static void event_handler(enum pouch_event evt, void *ctx)
         return;
     }
 
+    /* The handlers already ran for the interrupted pouch. New entries go in the next one. */
+    if (pouch_atomic_test_bit(uplink.flags, RESUMED))
+    {
+        return;
+    }
+
     POUCH_TYPE_SECTION_FOREACH(pouch_uplink_handler_t, pouch_uplink_handler, handler)
     {
         if (handler != NULL)
@@ -168,39 +311,164 @@ static void event_handler(enum pouch_event evt, void *ctx)
         }
     }
 
+    pouch_atomic_set_bit(uplink.flags, HANDLERS_DONE);
+
+    if (pouch_atomic_get_value(&uplink.hold.count) > 0)
+    {
+        /* Keep the pouch open for the holders, but not indefinitely */
+        uplink.hold.session_id = pouch_atomic_get_value(&uplink.id);
+        pouch_work_schedule(&uplink.hold.timeout, POUCH_MSEC(CONFIG_POUCH_UPLINK_HOLD_TIMEOUT_MS));
+        return;
+    }
+
     pouch_uplink_close(POUCH_FOREVER);
 }
 
 POUCH_EVENT_HANDLER(event_handler, NULL);
 
-// Transport API:
+#if CONFIG_POUCH_UPLINK_RESUME
 
-struct pouch_uplink *pouch_uplink_start(void)
+static void buf_queue_move(pouch_buf_queue_t *dst, pouch_buf_queue_t *src)
+{
+    struct pouch_buf *buf;
+    while ((buf = buf_queue_get(src)))
+    {
+        if (buf == uplink.transport.header)
+        {
+            // The header is regenerated when resuming
+            buf_free(buf);
+            continue;
+        }
+
+        buf_queue_submit(dst, buf);
+    }
+}
+
+static void checkpoint_clear(void)
+{
+    struct pouch_buf *buf;
+    while ((buf = buf_queue_get(&uplink.checkpoint.blocks)))
+    {
+        buf_free(buf);
+    }
+
+    uplink.checkpoint.first_block = 0;
+    uplink.checkpoint.attempts = 0;
+    uplink.checkpoint.pending = false;
+}
+
+/**
+ * Store all unconfirmed blocks of the pouch in the checkpoint, so they can be resent in the next
+ * transfer.
+ *
+ * @return Whether the pouch should be resumed.
+ */
+static bool checkpoint_save(struct pouch_uplink *uplink)
+{
+    // Blocks that are still waiting for encryption aren't part of this pouch yet:
+    if (buf_queue_is_empty(&uplink->transport.sent) && buf_queue_is_empty(&uplink->transport.queue))
+    {
+        // Everything was delivered
+        return false;
+    }
+
+    if (++uplink->checkpoint.attempts > CONFIG_POUCH_UPLINK_RESUME_ATTEMPTS)
+    {
+        POUCH_LOG_WRN("Dropping pouch after %u attempts", uplink->checkpoint.attempts - 1);
+        return false;
+    }
+
+    // The sent queue includes the reader's buffer, and is ahead of the transport queue:
+    pouch_bufview_init(&uplink->transport.reader, NULL);
+    buf_queue_move(&uplink->checkpoint.blocks, &uplink->transport.sent);
+    buf_queue_move(&uplink->checkpoint.blocks, &uplink->transport.queue);
+
+    if (uplink->header)
+    {
+        buf_free(uplink->header);
+        uplink->header = NULL;
+    }
+
+    uplink->checkpoint.first_block += uplink->transport.confirmed_blocks;
+    uplink->checkpoint.pending = true;
+
+    POUCH_LOG_INF("Pouch interrupted, resuming from block %u",
+                  (unsigned int) uplink->checkpoint.first_block);
+
+    return true;
+}
+
+static int checkpoint_resume(void)
+{
+    struct pouch_buf *header = pouch_header_create(uplink.checkpoint.first_block);
+    if (!header)
+    {
+        return -ENOMEM;
+    }
+
+    header_submit(header);
+    buf_queue_move(&uplink.transport.queue, &uplink.checkpoint.blocks);
+    uplink.checkpoint.pending = false;
+
+    // The resumed pouch ends with the checkpoint's blocks:
+    pouch_atomic_set_bit(uplink.flags, RESUMED);
+    pouch_atomic_set_bit(uplink.flags, POUCH_CLOSING);
+    pouch_atomic_set_bit(uplink.flags, POUCH_CLOSED);
+
+    pouch_sem_give(&uplink.transport.has_queue_sem);
+
+    return 0;
+}
+
+#endif /* CONFIG_POUCH_UPLINK_RESUME */
+
+static int pouch_begin(void)
 {
     int err;
 
-    if (pouch_atomic_test_and_set_bit(uplink.flags, SESSION_ACTIVE))
+#if CONFIG_POUCH_UPLINK_RESUME
+    if (uplink.checkpoint.pending)
     {
-        return NULL;
+        // The crypto session is still active from the interrupted transfer
+        return checkpoint_resume();
     }
 
+    uplink.checkpoint.first_block = 0;
+#endif
+
     err = crypto_session_start();
     if (err)
     {
-        pouch_atomic_clear_bit(uplink.flags, SESSION_ACTIVE);
-        return NULL;
+        return err;
     }
 
     err = crypto_pouch_start();
     if (err)
     {
-        pouch_atomic_clear_bit(uplink.flags, SESSION_ACTIVE);
-        return NULL;
+        return err;
     }
 
     // Create the header, but don't push it to the queue until we have data to send:
-    uplink.header = pouch_header_create();
+    uplink.header = pouch_header_create(0);
     if (!uplink.header)
+    {
+        return -ENOMEM;
+    }
+
+    return 0;
+}
+
+// Transport API:
+
+struct pouch_uplink *pouch_uplink_start(void)
+{
+    if (pouch_atomic_test_and_set_bit(uplink.flags, SESSION_ACTIVE))
+    {
+        return NULL;
+    }
+
+    int err = pouch_begin();
+    if (err)
     {
         pouch_atomic_clear_bit(uplink.flags, SESSION_ACTIVE);
         return NULL;
@@ -242,6 +510,10 @@ enum pouch_result pouch_uplink_fill(struct pouch_uplink *uplink, uint8_t *dst, s
                 break;
             }
 
+#if CONFIG_POUCH_UPLINK_RESUME
+            // Keep the buffer until the transport confirms it:
+            buf_queue_submit(&uplink->transport.sent, buf);
+#endif
             pouch_bufview_init(&uplink->transport.reader, buf);
         }
 
@@ -249,7 +521,11 @@ enum pouch_result pouch_uplink_fill(struct pouch_uplink *uplink, uint8_t *dst, s
 
         if (!pouch_bufview_available(&uplink->transport.reader))
         {
+#if CONFIG_POUCH_UPLINK_RESUME
+            pouch_bufview_init(&uplink->transport.reader, NULL);
+#else
             pouch_bufview_free(&uplink->transport.reader);
+#endif
         }
     }
 
@@ -267,6 +543,38 @@ int pouch_uplink_error(struct pouch_uplink *uplink)
     return uplink->error;
 }
 
+void pouch_uplink_confirm(struct pouch_uplink *uplink, size_t len)
+{
+#if CONFIG_POUCH_UPLINK_RESUME
+    struct pouch_buf *buf;
+    while ((buf = buf_queue_peek(&uplink->transport.sent)))
+    {
+        size_t remaining = buf_size_get(buf) - uplink->transport.confirmed;
+        if (len < remaining || buf == uplink->transport.reader.buf)
+        {
+            // Only part of this buffer has been delivered
+            uplink->transport.confirmed += MIN(len, remaining);
+            return;
+        }
+
+        len -= remaining;
+        uplink->transport.confirmed = 0;
+
+        buf_queue_get(&uplink->transport.sent);
+        if (buf == uplink->transport.header)
+        {
+            uplink->transport.header = NULL;
+        }
+        else
+        {
+            uplink->transport.confirmed_blocks++;
+        }
+
+        buf_free(buf);
+    }
+#endif
+}
+
 void pouch_uplink_finish(struct pouch_uplink *uplink)
 {
     if (NULL == uplink)
@@ -274,6 +582,22 @@ void pouch_uplink_finish(struct pouch_uplink *uplink)
         return;
     }
 
+    bool suspend = false;
+
+#if CONFIG_POUCH_UPLINK_RESUME
+    suspend = checkpoint_save(uplink);
+    if (!suspend)
+    {
+        checkpoint_clear();
+        pouch_bufview_init(&uplink->transport.reader, NULL);
+        pouch_uplink_confirm(uplink, SIZE_MAX);
+    }
+
+    uplink->transport.header = NULL;
+    uplink->transport.confirmed = 0;
+    uplink->transport.confirmed_blocks = 0;
+#endif
+
     // Free any remaining blocks, as they won't be valid in the next pouch:
     struct pouch_buf *buf;
     while ((buf = buf_queue_get(&uplink->transport.queue)))
@@ -289,6 +613,9 @@ void pouch_uplink_finish(struct pouch_uplink *uplink)
         uplink->header = NULL;
     }
 
+    pouch_work_cancel_delayable(&uplink->hold.timeout);
+    pouch_atomic_clear(&uplink->hold.count);
+
     pouch_atomic_inc(&uplink->id);
     if (pouch_atomic_clear(uplink->flags) & BIT(SESSION_ACTIVE))
     {
@@ -298,6 +625,6 @@ void pouch_uplink_finish(struct pouch_uplink *uplink)
          * actually been pushed out and acknowledged by the transport
          * rather than at internal data-exhaustion time.
          */
-        end_session();
+        end_session(suspend);
     }
 }
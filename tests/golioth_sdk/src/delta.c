@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ */
+#include <zephyr/ztest.h>
+#include <errno.h>
+#include <string.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "delta.h"
+
+#define SOURCE_LEN 100
+#define PATCH_MAX_LEN 256
+#define OUTPUT_MAX_LEN 256
+
+static uint8_t source[SOURCE_LEN];
+static uint8_t output[OUTPUT_MAX_LEN];
+static size_t output_len;
+static size_t read_count;
+
+static uint8_t patch_buf[PATCH_MAX_LEN];
+static size_t patch_len;
+
+static struct delta_patch patch;
+
+static int source_read(size_t offset, void *buf, size_t len, void *user_data)
+{
+    zassert_equal(user_data, &patch);
+    zassert_true(len <= CONFIG_GOLIOTH_OTA_DELTA_BUF_SIZE);
+
+    read_count++;
+
+    if (offset + len > sizeof(source))
+    {
+        return -EINVAL;
+    }
+
+    memcpy(buf, &source[offset], len);
+    return 0;
+}
+
+static int output_write(const void *data, size_t len, void *user_data)
+{
+    zassert_equal(user_data, &patch);
+    zassert_true(output_len + len <= sizeof(output));
+
+    memcpy(&output[output_len], data, len);
+    output_len += len;
+    return 0;
+}
+
+static void record_add(enum delta_op op, uint32_t len, uint32_t src_offset, const void *data)
+{
+    zassert_true(patch_len + DELTA_HEADER_MAX_LEN + len <= sizeof(patch_buf));
+
+    patch_buf[patch_len++] = op;
+    sys_put_le32(len, &patch_buf[patch_len]);
+    patch_len += 4;
+
+    if (DELTA_OP_INSERT != op)
+    {
+        sys_put_le32(src_offset, &patch_buf[patch_len]);
+        patch_len += 4;
+    }
+
+    if (DELTA_OP_COPY != op)
+    {
+        memcpy(&patch_buf[patch_len], data, len);
+        patch_len += len;
+    }
+}
+
+static void reset(void)
+{
+    output_len = 0;
+    read_count = 0;
+    delta_patch_init(&patch, source_read, output_write, &patch);
+}
+
+static void before(void *f)
+{
+    for (size_t i = 0; i < sizeof(source); i++)
+    {
+        source[i] = 3 * i;
+    }
+
+    patch_len = 0;
+    reset();
+}
+
+ZTEST(delta, test_copy)
+{
+    record_add(DELTA_OP_COPY, 40, 10, NULL);
+
+    zassert_ok(delta_patch_feed(&patch, patch_buf, patch_len, true));
+    zassert_equal(output_len, 40);
+    zassert_mem_equal(output, &source[10], 40);
+
+    /* Copied in chunks that fit the scratch buffer */
+    zassert_equal(read_count, DIV_ROUND_UP(40, CONFIG_GOLIOTH_OTA_DELTA_BUF_SIZE));
+}
+
+ZTEST(delta, test_insert)
+{
+    static const uint8_t data[] = "Inserted data that spans a few buffers";
+
+    record_add(DELTA_OP_INSERT, sizeof(data), 0, data);
+
+    zassert_ok(delta_patch_feed(&patch, patch_buf, patch_len, true));
+    zassert_equal(output_len, sizeof(data));
+    zassert_mem_equal(output, data, sizeof(data));
+    zassert_equal(read_count, 0);
+}
+
+ZTEST(delta, test_diff)
+{
+    uint8_t diff[30];
+    for (size_t i = 0; i < sizeof(diff); i++)
+    {
+        diff[i] = 200 + i;
+    }
+
+    record_add(DELTA_OP_DIFF, sizeof(diff), 50, diff);
+
+    zassert_ok(delta_patch_feed(&patch, patch_buf, patch_len, true));
+    zassert_equal(output_len, sizeof(diff));
+    for (size_t i = 0; i < sizeof(diff); i++)
+    {
+        zassert_equal(output[i], (uint8_t) (source[50 + i] + diff[i]), "byte %zu", i);
+    }
+}
+
+ZTEST(delta, test_split)
+{
+    static const uint8_t data[] = {0xde, 0xad, 0xbe, 0xef};
+    static const uint8_t diff[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18};
+    uint8_t expected[OUTPUT_MAX_LEN];
+    size_t expected_len = 0;
+
+    record_add(DELTA_OP_COPY, 20, 0, NULL);
+    memcpy(&expected[expected_len], source, 20);
+    expected_len += 20;
+
+    record_add(DELTA_OP_INSERT, sizeof(data), 0, data);
+    memcpy(&expected[expected_len], data, sizeof(data));
+    expected_len += sizeof(data);
+
+    record_add(DELTA_OP_DIFF, sizeof(diff), 80, diff);
+    for (size_t i = 0; i < sizeof(diff); i++)
+    {
+        expected[expected_len++] = source[80 + i] + diff[i];
+    }
+
+    record_add(DELTA_OP_COPY, 0, 0, NULL);
+
+    for (size_t split = 0; split <= patch_len; split++)
+    {
+        reset();
+
+        zassert_ok(delta_patch_feed(&patch, patch_buf, split, false), "split at %zu", split);
+        zassert_ok(delta_patch_feed(&patch, &patch_buf[split], patch_len - split, true),
+                   "split at %zu",
+                   split);
+        zassert_equal(output_len, expected_len, "split at %zu", split);
+        zassert_mem_equal(output, expected, expected_len, "split at %zu", split);
+    }
+
+    reset();
+
+    for (size_t i = 0; i < patch_len; i++)
+    {
+        zassert_ok(delta_patch_feed(&patch, &patch_buf[i], 1, i == patch_len - 1));
+    }
+
+    zassert_equal(output_len, expected_len);
+    zassert_mem_equal(output, expected, expected_len);
+}
+
+ZTEST(delta, test_read_beyond_source)
+{
+    static const uint8_t diff[4] = {0};
+
+    record_add(DELTA_OP_COPY, 20, SOURCE_LEN - 10, NULL);
+
+    zassert_equal(delta_patch_feed(&patch, patch_buf, patch_len, true), -EINVAL);
+
+    patch_len = 0;
+    reset();
+
+    record_add(DELTA_OP_DIFF, sizeof(diff), SOURCE_LEN - 2, diff);
+
+    zassert_equal(delta_patch_feed(&patch, patch_buf, patch_len, true), -EINVAL);
+    zassert_equal(output_len, 0);
+}
+
+ZTEST(delta, test_truncated)
+{
+    static const uint8_t data[] = {1, 2, 3};
+
+    record_add(DELTA_OP_INSERT, sizeof(data), 0, data);
+    size_t first_record_len = patch_len;
+    record_add(DELTA_OP_DIFF, sizeof(data), 0, data);
+
+    for (size_t len = 1; len < patch_len; len++)
+    {
+        if (len == first_record_len)
+        {
+            /* Ends between two records, which is fine */
+            continue;
+        }
+
+        reset();
+
+        zassert_equal(delta_patch_feed(&patch, patch_buf, len, true), -EBADMSG, "len %zu", len);
+    }
+}
+
+ZTEST(delta, test_unknown_op)
+{
+    static const uint8_t data[] = {1, 2, 3};
+
+    record_add(DELTA_OP_INSERT, sizeof(data), 0, data);
+    patch_buf[patch_len++] = DELTA_OP_DIFF + 1;
+
+    zassert_equal(delta_patch_feed(&patch, patch_buf, patch_len, false), -EBADMSG);
+    zassert_equal(output_len, sizeof(data));
+}
+
+ZTEST_SUITE(delta, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ */
+#include <zephyr/ztest.h>
+#include <string.h>
+
+#include "dispatch.h"
+#include "downlink.h"
+
+#define STREAM_ID 3
+
+struct service_call
+{
+    const char *service;
+    golioth_downlink_id_t id;
+    char remainder[32];
+    size_t remainder_len;
+    bool has_remainder;
+    size_t data_len;
+    bool is_last;
+};
+
+static struct service_call call;
+
+static void service_start(const char *service,
+                          golioth_downlink_id_t id,
+                          const char *path_remainder,
+                          size_t path_remainder_len)
+{
+    zassert_is_null(call.service, "Matched both %s and %s", call.service, service);
+    zassert_true(path_remainder_len < sizeof(call.remainder));
+
+    call.service = service;
+    call.id = id;
+    call.has_remainder = (NULL != path_remainder);
+    call.remainder_len = path_remainder_len;
+    if (call.has_remainder)
+    {
+        memcpy(call.remainder, path_remainder, path_remainder_len);
+    }
+}
+
+static void service_data(const char *service,
+                         golioth_downlink_id_t id,
+                         const void *data,
+                         size_t len,
+                         bool is_last)
+{
+    zassert_not_null(call.service, "Data for %s without a start", service);
+    zassert_str_equal(call.service, service, "Data for %s went to %s", call.service, service);
+
+    call.data_len += len;
+    call.is_last = is_last;
+}
+
+#define TEST_SERVICE(_name, _path)                                                         \
+    static void _name##_start(golioth_downlink_id_t id, const char *path, size_t len)      \
+    {                                                                                      \
+        service_start(_path, id, path, len);                                               \
+    }                                                                                      \
+    static void _name##_data(golioth_downlink_id_t id, const void *data, size_t len,       \
+                             bool is_last)                                                 \
+    {                                                                                      \
+        service_data(_path, id, data, len, is_last);                                       \
+    }                                                                                      \
+    GOLIOTH_DOWNLINK_HANDLER(_name, _path, _name##_start, _name##_data)
+
+TEST_SERVICE(t_any, "/t/*");
+TEST_SERVICE(t_a, "/t/a");
+TEST_SERVICE(t_a_any, "/t/a/*");
+TEST_SERVICE(t_a_b_any, "/t/a/b/*");
+TEST_SERVICE(t_ab, "/t/ab");
+
+static void before(void *f)
+{
+    memset(&call, 0, sizeof(call));
+}
+
+/** Receive an entry on @p path, and check that it reached @p service with @p remainder */
+static void assert_route(const char *path, const char *service, const char *remainder)
+{
+    static const uint8_t data[] = {1, 2, 3};
+
+    memset(&call, 0, sizeof(call));
+
+    downlink_start(STREAM_ID, path);
+    downlink_data(STREAM_ID, data, sizeof(data), true);
+
+    if (NULL == service)
+    {
+        zassert_is_null(call.service, "%s matched %s", path, call.service);
+        return;
+    }
+
+    zassert_not_null(call.service, "%s didn't match any service", path);
+    zassert_str_equal(call.service, service, "%s matched %s", path, call.service);
+    zassert_equal(call.id, STREAM_ID);
+    zassert_equal(call.data_len, sizeof(data));
+    zassert_true(call.is_last);
+
+    if (NULL == remainder)
+    {
+        zassert_false(call.has_remainder, "%s had a remainder", path);
+        zassert_equal(call.remainder_len, 0);
+        return;
+    }
+
+    zassert_true(call.has_remainder, "%s had no remainder", path);
+    zassert_equal(call.remainder_len, strlen(remainder));
+    zassert_mem_equal(call.remainder, remainder, call.remainder_len);
+}
+
+ZTEST(dispatch, test_exact)
+{
+    assert_route("/t/a", "/t/a", NULL);
+    assert_route("/t/ab", "/t/ab", NULL);
+}
+
+ZTEST(dispatch, test_longest_prefix)
+{
+    assert_route("/t/a/b/c", "/t/a/b/*", "c");
+    assert_route("/t/a/b/c/d", "/t/a/b/*", "c/d");
+    assert_route("/t/a/x", "/t/a/*", "x");
+    assert_route("/t/a/bc", "/t/a/*", "bc");
+    assert_route("/t/z", "/t/*", "z");
+    assert_route("/t/", "/t/*", NULL);
+}
+
+ZTEST(dispatch, test_no_match)
+{
+    assert_route("/u", NULL, NULL);
+    assert_route("/t", NULL, NULL);
+    assert_route("/", NULL, NULL);
+    assert_route("/s/a", NULL, NULL);
+}
+
+ZTEST(dispatch, test_interrupted)
+{
+    static const uint8_t data[] = {1, 2, 3};
+
+    downlink_start(STREAM_ID, "/t/a/b/c");
+    downlink_data(STREAM_ID, data, sizeof(data), false);
+    zassert_str_equal(call.service, "/t/a/b/*");
+
+    /* A new entry on the same stream goes to its own service */
+    memset(&call, 0, sizeof(call));
+    downlink_start(STREAM_ID, "/t/ab");
+    downlink_data(STREAM_ID, data, sizeof(data), true);
+
+    zassert_str_equal(call.service, "/t/ab");
+    zassert_equal(call.data_len, sizeof(data));
+
+    /* The stream is done */
+    memset(&call, 0, sizeof(call));
+    downlink_data(STREAM_ID, data, sizeof(data), true);
+    zassert_equal(call.data_len, 0);
+}
+
+ZTEST(dispatch, test_ctx)
+{
+    int a;
+    int b;
+
+    for (golioth_downlink_id_t id = 0; id < 32; id++)
+    {
+        golioth_downlink_ctx_set(id, &a);
+        zassert_equal_ptr(golioth_downlink_ctx_get(id), &a);
+        golioth_downlink_ctx_set(id, NULL);
+        zassert_is_null(golioth_downlink_ctx_get(id));
+    }
+
+    /* Out of range IDs are ignored */
+    golioth_downlink_ctx_set(STREAM_ID, &a);
+    golioth_downlink_ctx_set(-1, &b);
+    golioth_downlink_ctx_set(32, &b);
+    golioth_downlink_ctx_set(DOWNLINK_ID_INVALID, &b);
+    zassert_is_null(golioth_downlink_ctx_get(-1));
+    zassert_is_null(golioth_downlink_ctx_get(32));
+    zassert_equal_ptr(golioth_downlink_ctx_get(STREAM_ID), &a);
+    golioth_downlink_ctx_set(STREAM_ID, NULL);
+}
+
+ZTEST(dispatch, test_ctx_cleared)
+{
+    static const uint8_t data[] = {1, 2, 3};
+    int ctx;
+
+    downlink_start(STREAM_ID, "/t/ab");
+    golioth_downlink_ctx_set(STREAM_ID, &ctx);
+
+    downlink_data(STREAM_ID, data, sizeof(data), false);
+    zassert_equal_ptr(golioth_downlink_ctx_get(STREAM_ID), &ctx);
+
+    downlink_data(STREAM_ID, data, sizeof(data), true);
+    zassert_is_null(golioth_downlink_ctx_get(STREAM_ID));
+
+    /* A new entry on the stream doesn't inherit the context of the interrupted one */
+    memset(&call, 0, sizeof(call));
+    downlink_start(STREAM_ID, "/t/ab");
+    golioth_downlink_ctx_set(STREAM_ID, &ctx);
+    downlink_data(STREAM_ID, data, sizeof(data), false);
+
+    memset(&call, 0, sizeof(call));
+    downlink_start(STREAM_ID, "/t/ab");
+    zassert_is_null(golioth_downlink_ctx_get(STREAM_ID));
+
+    /* ...even if it's not for any service */
+    golioth_downlink_ctx_set(STREAM_ID, &ctx);
+    downlink_start(STREAM_ID, "/u");
+    zassert_is_null(golioth_downlink_ctx_get(STREAM_ID));
+
+    /* Stream IDs wrap around at 32 */
+    memset(&call, 0, sizeof(call));
+    downlink_start(STREAM_ID + 32, "/t/ab");
+    zassert_equal(call.id, STREAM_ID);
+    golioth_downlink_ctx_set(STREAM_ID, &ctx);
+    downlink_data(STREAM_ID + 32, data, sizeof(data), true);
+    zassert_is_null(golioth_downlink_ctx_get(STREAM_ID));
+}
+
+ZTEST(dispatch, test_ctx_interleaved)
+{
+    static const uint8_t data[] = {1, 2, 3};
+    int a;
+    int b;
+
+    downlink_start(STREAM_ID, "/t/ab");
+    golioth_downlink_ctx_set(STREAM_ID, &a);
+
+    memset(&call, 0, sizeof(call));
+    downlink_start(STREAM_ID + 1, "/t/ab");
+    golioth_downlink_ctx_set(STREAM_ID + 1, &b);
+
+    downlink_data(STREAM_ID, data, sizeof(data), false);
+    downlink_data(STREAM_ID + 1, data, sizeof(data), false);
+    zassert_equal_ptr(golioth_downlink_ctx_get(STREAM_ID), &a);
+    zassert_equal_ptr(golioth_downlink_ctx_get(STREAM_ID + 1), &b);
+
+    /* Finishing one stream leaves the other one alone */
+    downlink_data(STREAM_ID, data, sizeof(data), true);
+    zassert_is_null(golioth_downlink_ctx_get(STREAM_ID));
+    zassert_equal_ptr(golioth_downlink_ctx_get(STREAM_ID + 1), &b);
+
+    downlink_data(STREAM_ID + 1, data, sizeof(data), true);
+    zassert_is_null(golioth_downlink_ctx_get(STREAM_ID + 1));
+}
+
+ZTEST_SUITE(dispatch, NULL, NULL, before, NULL, NULL);
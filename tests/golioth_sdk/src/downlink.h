@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ */
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <pouch/downlink.h>
+#include <pouch/port.h>
+#include <pouch/types.h>
+
+/** Test utility for starting a downlink entry, as if it was received by Pouch */
+static inline void downlink_start(unsigned int stream_id, const char *path)
+{
+    POUCH_STRUCT_SECTION_FOREACH(pouch_downlink_handler, handler)
+    {
+        handler->start_cb(stream_id, path, strlen(path), POUCH_CONTENT_TYPE_CBOR);
+    }
+}
+
+/** Test utility for passing a block of a downlink entry, as if it was received by Pouch */
+static inline void downlink_data(unsigned int stream_id,
+                                 const void *data,
+                                 size_t len,
+                                 bool is_last)
+{
+    POUCH_STRUCT_SECTION_FOREACH(pouch_downlink_handler, handler)
+    {
+        handler->data_cb(stream_id, data, len, is_last);
+    }
+}
+
+/** Test utility for receiving a whole downlink entry, in blocks of @p block_len */
+static inline void downlink_entry(unsigned int stream_id,
+                                  const char *path,
+                                  const void *data,
+                                  size_t len,
+                                  size_t block_len)
+{
+    const uint8_t *p = data;
+
+    downlink_start(stream_id, path);
+
+    do
+    {
+        size_t chunk = MIN(len, block_len);
+        downlink_data(stream_id, p, chunk, chunk == len);
+        p += chunk;
+        len -= chunk;
+    } while (len > 0);
+}
@@ -0,0 +1,395 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ */
+#include <zephyr/ztest.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+#include <psa/crypto.h>
+#include <zcbor_encode.h>
+#include <golioth/ota.h>
+
+#include "downlink.h"
+#include "ota.h"
+
+#define IMAGE_LEN 200
+#define BLOCK_LEN 64
+#define TARGET_VERSION "1.2.3"
+#define COMPONENT_PATH "/.u/c/main@" TARGET_VERSION
+
+struct received
+{
+    uint8_t data[IMAGE_LEN];
+    size_t len;
+    size_t last_count;
+};
+
+static struct received main_received;
+static struct received aux_received;
+static struct received extra_received;
+
+static uint8_t image[IMAGE_LEN];
+static uint8_t image_hash[GOLIOTH_OTA_COMPONENT_HASH_BIN_LEN];
+
+static void receive(struct received *received,
+                    const void *data,
+                    size_t offset,
+                    size_t len,
+                    bool is_last)
+{
+    /* Blocks are delivered in order */
+    zassert_equal(offset, received->len);
+    zassert_true(offset + len <= sizeof(received->data));
+
+    memcpy(&received->data[offset], data, len);
+    received->len += len;
+    if (is_last)
+    {
+        received->last_count++;
+    }
+}
+
+static void main_receive(const void *data, size_t offset, size_t len, bool is_last)
+{
+    receive(&main_received, data, offset, len, is_last);
+}
+
+static void aux_receive(const void *data, size_t offset, size_t len, bool is_last)
+{
+    receive(&aux_received, data, offset, len, is_last);
+}
+
+static void extra_receive(const void *data, size_t offset, size_t len, bool is_last)
+{
+    receive(&extra_received, data, offset, len, is_last);
+}
+
+GOLIOTH_OTA_COMPONENT(main, "main", "1.0.0", main_receive);
+GOLIOTH_OTA_COMPONENT(aux, "aux", "1.0.0", aux_receive);
+GOLIOTH_OTA_COMPONENT(extra, "extra", "1.0.0", extra_receive);
+
+struct manifest_component
+{
+    const char *package;
+    const char *version;
+    const uint8_t *hash;
+    int32_t size;
+    /** Version the artifact is a delta from, or NULL for the full image */
+    const char *delta_from;
+};
+
+/** Receive an OTA manifest with the given components */
+static void manifest_receive(const struct manifest_component *components, size_t count)
+{
+    uint8_t buf[512];
+    ZCBOR_STATE_E(zse, 3, buf, sizeof(buf), 1);
+
+    bool ok = zcbor_map_start_encode(zse, 1) && zcbor_uint32_put(zse, 3)
+           && zcbor_list_start_encode(zse, count);
+    zassert_true(ok);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        char hash_hex[2 * GOLIOTH_OTA_COMPONENT_HASH_BIN_LEN + 1];
+        bin2hex(components[i].hash, GOLIOTH_OTA_COMPONENT_HASH_BIN_LEN, hash_hex, sizeof(hash_hex));
+
+        ok = zcbor_map_start_encode(zse, 5) && zcbor_uint32_put(zse, 1)
+          && zcbor_tstr_put_term(zse, components[i].package, SIZE_MAX) && zcbor_uint32_put(zse, 2)
+          && zcbor_tstr_put_term(zse, components[i].version, SIZE_MAX) && zcbor_uint32_put(zse, 3)
+          && zcbor_tstr_put_term(zse, hash_hex, SIZE_MAX) && zcbor_uint32_put(zse, 4)
+          && zcbor_int32_put(zse, components[i].size);
+        zassert_true(ok);
+
+        if (NULL != components[i].delta_from)
+        {
+            ok = zcbor_uint32_put(zse, 7)
+              && zcbor_tstr_put_term(zse, components[i].delta_from, SIZE_MAX);
+            zassert_true(ok);
+        }
+
+        ok = zcbor_map_end_encode(zse, 5);
+        zassert_true(ok);
+    }
+
+    ok = zcbor_list_end_encode(zse, count) && zcbor_map_end_encode(zse, 1);
+    zassert_true(ok);
+
+    downlink_entry(0, "/.u/desired", buf, zse->payload - buf, BLOCK_LEN);
+}
+
+static void main_manifest_receive(const uint8_t *hash)
+{
+    const struct manifest_component component = {
+        .package = "main",
+        .version = TARGET_VERSION,
+        .hash = hash,
+        .size = IMAGE_LEN,
+    };
+
+    manifest_receive(&component, 1);
+}
+
+/** Receive a manifest with all components, and mark them for download */
+static void all_manifest_receive(void)
+{
+    const struct manifest_component components[] = {
+        {"main", TARGET_VERSION, image_hash, IMAGE_LEN},
+        {"aux", TARGET_VERSION, image_hash, IMAGE_LEN},
+        {"extra", TARGET_VERSION, image_hash, IMAGE_LEN},
+    };
+
+    manifest_receive(components, ARRAY_SIZE(components));
+
+    zassert_ok(golioth_ota_mark_for_download("main"));
+    zassert_ok(golioth_ota_mark_for_download("aux"));
+    zassert_ok(golioth_ota_mark_for_download("extra"));
+}
+
+static void assert_downloaded(const struct received *received)
+{
+    zassert_equal(received->len, sizeof(image));
+    zassert_mem_equal(received->data, image, sizeof(image));
+    zassert_equal(received->last_count, 1);
+}
+
+static void *suite_setup(void)
+{
+    zassert_equal(psa_crypto_init(), PSA_SUCCESS);
+
+    for (size_t i = 0; i < sizeof(image); i++)
+    {
+        image[i] = i * 7;
+    }
+
+    size_t hash_len;
+    zassert_equal(psa_hash_compute(PSA_ALG_SHA_256,
+                                   image,
+                                   sizeof(image),
+                                   image_hash,
+                                   sizeof(image_hash),
+                                   &hash_len),
+                  PSA_SUCCESS);
+
+    return NULL;
+}
+
+static void before(void *f)
+{
+    memset(&main_received, 0, sizeof(main_received));
+    memset(&aux_received, 0, sizeof(aux_received));
+    memset(&extra_received, 0, sizeof(extra_received));
+    golioth_ota_mark_idle("main");
+    golioth_ota_mark_idle("aux");
+    golioth_ota_mark_idle("extra");
+}
+
+ZTEST(ota, test_download)
+{
+    main_manifest_receive(image_hash);
+    zassert_str_equal(ota_component_data_main.target, TARGET_VERSION);
+    zassert_ok(golioth_ota_mark_for_download("main"));
+
+    downlink_entry(1, COMPONENT_PATH, image, sizeof(image), BLOCK_LEN);
+
+    zassert_equal(main_received.len, sizeof(image));
+    zassert_mem_equal(main_received.data, image, sizeof(image));
+    zassert_equal(main_received.last_count, 1);
+    zassert_equal(ota_component_data_main.state, GOLIOTH_OTA_STATE_DOWNLOADING);
+}
+
+ZTEST(ota, test_hash_mismatch)
+{
+    uint8_t bad_hash[GOLIOTH_OTA_COMPONENT_HASH_BIN_LEN];
+    memcpy(bad_hash, image_hash, sizeof(bad_hash));
+    bad_hash[0] ^= 0x01;
+
+    main_manifest_receive(bad_hash);
+    zassert_ok(golioth_ota_mark_for_download("main"));
+
+    downlink_entry(1, COMPONENT_PATH, image, sizeof(image), BLOCK_LEN);
+
+    /* The last block is dropped, and the image is rejected */
+    zassert_equal(main_received.len, 3 * BLOCK_LEN);
+    zassert_equal(main_received.last_count, 0);
+    zassert_equal(ota_component_data_main.state, GOLIOTH_OTA_STATE_IDLE);
+
+    /* The abandoned download can't be resumed */
+    main_manifest_receive(image_hash);
+    zassert_ok(golioth_ota_mark_for_download("main"));
+    downlink_start(1, COMPONENT_PATH "/192");
+    downlink_data(1, &image[3 * BLOCK_LEN], sizeof(image) - 3 * BLOCK_LEN, true);
+
+    zassert_equal(main_received.len, 3 * BLOCK_LEN);
+    zassert_equal(main_received.last_count, 0);
+
+    /* Starting over works */
+    memset(&main_received, 0, sizeof(main_received));
+    downlink_entry(1, COMPONENT_PATH, image, sizeof(image), BLOCK_LEN);
+
+    zassert_equal(main_received.len, sizeof(image));
+    zassert_mem_equal(main_received.data, image, sizeof(image));
+    zassert_equal(main_received.last_count, 1);
+}
+
+ZTEST(ota, test_resume)
+{
+    const size_t interrupted_at = 2 * BLOCK_LEN;
+
+    main_manifest_receive(image_hash);
+    zassert_ok(golioth_ota_mark_for_download("main"));
+
+    downlink_start(1, COMPONENT_PATH);
+    downlink_data(1, image, BLOCK_LEN, false);
+    downlink_data(1, &image[BLOCK_LEN], BLOCK_LEN, false);
+
+    /* The download can't be resumed while it's still going */
+    downlink_start(2, COMPONENT_PATH "/128");
+    downlink_data(2, &image[interrupted_at], BLOCK_LEN, false);
+    zassert_equal(main_received.len, interrupted_at);
+
+    /* Interrupt the download by reusing its stream */
+    downlink_start(1, "/u");
+
+    /* Offsets other than where the download stopped are refused */
+    downlink_start(2, COMPONENT_PATH "/64");
+    downlink_data(2, &image[BLOCK_LEN], BLOCK_LEN, false);
+    downlink_start(2, COMPONENT_PATH "/192");
+    downlink_data(2, &image[3 * BLOCK_LEN], sizeof(image) - 3 * BLOCK_LEN, true);
+    downlink_start(2, COMPONENT_PATH "/");
+    downlink_data(2, &image[interrupted_at], BLOCK_LEN, false);
+    downlink_start(2, COMPONENT_PATH "/12x");
+    downlink_data(2, &image[interrupted_at], BLOCK_LEN, false);
+    downlink_start(2, COMPONENT_PATH "/+128");
+    downlink_data(2, &image[interrupted_at], BLOCK_LEN, false);
+    zassert_equal(main_received.len, interrupted_at);
+
+    /* Offsets that overflow aren't wrapped around to the right one */
+    downlink_start(2, COMPONENT_PATH "/18446744073709551744");
+    downlink_data(2, &image[interrupted_at], BLOCK_LEN, false);
+    downlink_start(2, COMPONENT_PATH "/4294967424");
+    downlink_data(2, &image[interrupted_at], BLOCK_LEN, false);
+    zassert_equal(main_received.len, interrupted_at);
+
+    /* So is the offset of another version */
+    downlink_start(2, "/.u/c/main@1.2.4/128");
+    downlink_data(2, &image[interrupted_at], BLOCK_LEN, false);
+    zassert_equal(main_received.len, interrupted_at);
+
+    /* Resuming at the right offset completes the download, and verifies all of it */
+    downlink_start(2, COMPONENT_PATH "/128");
+    downlink_data(2, &image[interrupted_at], BLOCK_LEN, false);
+    downlink_data(2,
+                  &image[interrupted_at + BLOCK_LEN],
+                  sizeof(image) - interrupted_at - BLOCK_LEN,
+                  true);
+
+    zassert_equal(main_received.len, sizeof(image));
+    zassert_mem_equal(main_received.data, image, sizeof(image));
+    zassert_equal(main_received.last_count, 1);
+}
+
+ZTEST(ota, test_concurrent)
+{
+    all_manifest_receive();
+
+    downlink_start(1, COMPONENT_PATH);
+    downlink_start(2, "/.u/c/aux@" TARGET_VERSION);
+
+    for (size_t offset = 0; offset < sizeof(image); offset += BLOCK_LEN)
+    {
+        size_t len = MIN(BLOCK_LEN, sizeof(image) - offset);
+        bool is_last = (offset + len == sizeof(image));
+
+        downlink_data(2, &image[offset], len, is_last);
+        downlink_data(1, &image[offset], len, is_last);
+    }
+
+    assert_downloaded(&main_received);
+    assert_downloaded(&aux_received);
+}
+
+ZTEST(ota, test_out_of_slots)
+{
+    BUILD_ASSERT(CONFIG_GOLIOTH_OTA_MAX_CONCURRENT_DOWNLOADS == 2);
+
+    all_manifest_receive();
+
+    downlink_start(1, COMPONENT_PATH);
+    downlink_start(2, "/.u/c/aux@" TARGET_VERSION);
+    downlink_data(1, image, BLOCK_LEN, false);
+    downlink_data(2, image, BLOCK_LEN, false);
+
+    /* Both slots are taken by active downloads */
+    downlink_entry(3, "/.u/c/extra@" TARGET_VERSION, image, sizeof(image), BLOCK_LEN);
+    zassert_equal(extra_received.len, 0);
+
+    /* An interrupted download gives up its slot when it's needed */
+    downlink_start(2, "/u");
+    downlink_entry(3, "/.u/c/extra@" TARGET_VERSION, image, sizeof(image), BLOCK_LEN);
+    assert_downloaded(&extra_received);
+
+    /* ...so it can't be resumed anymore */
+    downlink_start(2, "/.u/c/aux@" TARGET_VERSION "/64");
+    downlink_data(2, &image[BLOCK_LEN], sizeof(image) - BLOCK_LEN, true);
+    zassert_equal(aux_received.len, BLOCK_LEN);
+    zassert_equal(aux_received.last_count, 0);
+
+    /* The active download was left alone */
+    downlink_data(1, &image[BLOCK_LEN], sizeof(image) - BLOCK_LEN, true);
+    assert_downloaded(&main_received);
+}
+
+/** Get the reported OTA state of a component */
+static void status_get(const char *package,
+                       const char **target,
+                       enum golioth_ota_state *state,
+                       enum golioth_ota_reason *reason)
+{
+    const char *name;
+    const char *current;
+
+    for (int i = 0; golioth_ota_get_status(i, &name, &current, target, state, reason); i++)
+    {
+        if (0 == strcmp(name, package))
+        {
+            return;
+        }
+    }
+
+    zassert_unreachable("No status for %s", package);
+}
+
+ZTEST(ota, test_delta_rejected)
+{
+    const char *target;
+    enum golioth_ota_state state;
+    enum golioth_ota_reason reason;
+
+    /* The component can't read its running version, so a delta can't be applied */
+    const struct manifest_component delta = {
+        .package = "main",
+        .version = TARGET_VERSION,
+        .hash = image_hash,
+        .size = IMAGE_LEN,
+        .delta_from = "1.0.0",
+    };
+
+    manifest_receive(&delta, 1);
+    zassert_equal(golioth_ota_mark_for_download("main"), -ENOTSUP);
+
+    /* The rejection is reported to the server */
+    status_get("main", &target, &state, &reason);
+    zassert_equal(state, GOLIOTH_OTA_STATE_IDLE);
+    zassert_equal(reason, GOLIOTH_OTA_REASON_UNSUPPORTED_PACKAGE_TYPE);
+    zassert_str_equal(target, "1.0.0");
+
+    /* The full image is accepted in its place */
+    main_manifest_receive(image_hash);
+    zassert_ok(golioth_ota_mark_for_download("main"));
+
+    status_get("main", &target, &state, &reason);
+    zassert_equal(state, GOLIOTH_OTA_STATE_DOWNLOADING);
+    zassert_equal(reason, GOLIOTH_OTA_REASON_READY);
+    zassert_str_equal(target, TARGET_VERSION);
+}
+
+ZTEST_SUITE(ota, NULL, suite_setup, before, NULL, NULL);
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ */
+#include <zephyr/ztest.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+#include <zcbor_decode.h>
+#include <zcbor_encode.h>
+#include <pouch/pouch.h>
+#include <golioth/rpc.h>
+
+#include "downlink.h"
+#include "mocks/transport.h"
+#include "utils.h"
+
+#define RPC_PATH "/.rpc"
+#define RPC_STATUS_PATH ".rpc/status"
+#define STREAM_ID 3
+#define BLOCK_LEN 16
+
+static const struct pouch_config pouch_config = {
+    .device_id = "test-device-id",
+};
+
+static size_t double_count;
+
+static enum golioth_rpc_status double_cb(zcbor_state_t *request_params_array,
+                                         zcbor_state_t *response_detail_map,
+                                         void *callback_arg)
+{
+    int32_t value;
+
+    double_count++;
+
+    if (!zcbor_int32_decode(request_params_array, &value))
+    {
+        return GOLIOTH_RPC_INVALID_ARGUMENT;
+    }
+
+    bool ok = zcbor_tstr_put_lit(response_detail_map, "value")
+           && zcbor_int32_put(response_detail_map, 2 * value);
+
+    return ok ? GOLIOTH_RPC_OK : GOLIOTH_RPC_RESOURCE_EXHAUSTED;
+}
+GOLIOTH_RPC_HANDLER("double", double_cb, NULL);
+
+struct reply
+{
+    char id[16];
+    bool has_value;
+    int32_t value;
+    uint32_t status;
+};
+
+/** Receive an RPC request, with a single string or integer parameter */
+static void request_receive(const char *id, const char *method, const char *str, int32_t value)
+{
+    uint8_t buf[256];
+    ZCBOR_STATE_E(zse, 2, buf, sizeof(buf), 1);
+
+    bool ok = zcbor_map_start_encode(zse, 3) && zcbor_tstr_put_lit(zse, "id")
+           && zcbor_tstr_put_term(zse, id, SIZE_MAX) && zcbor_tstr_put_lit(zse, "method")
+           && zcbor_tstr_put_term(zse, method, SIZE_MAX) && zcbor_tstr_put_lit(zse, "params")
+           && zcbor_list_start_encode(zse, 1);
+    zassert_true(ok);
+
+    ok = str ? zcbor_tstr_put_term(zse, str, SIZE_MAX) : zcbor_int32_put(zse, value);
+    zassert_true(ok);
+
+    ok = zcbor_list_end_encode(zse, 1) && zcbor_map_end_encode(zse, 3);
+    zassert_true(ok);
+
+    downlink_entry(STREAM_ID, RPC_PATH, buf, zse->payload - buf, BLOCK_LEN);
+}
+
+/** Pull the closed pouch, and find the RPC reply in it */
+static bool reply_pull(struct reply *reply)
+{
+    static uint8_t pouch[2048];
+    size_t len = 0;
+    enum pouch_result result;
+
+    do
+    {
+        size_t chunk = sizeof(pouch) - len;
+        result = transport_pull_data(&pouch[len], &chunk);
+        len += chunk;
+    } while (result == POUCH_MORE_DATA && len < sizeof(pouch));
+
+    zassert_equal(result, POUCH_NO_MORE_DATA, "The pouch is still open");
+
+    uint8_t *p = skip_pouch_header(pouch, &len);
+    uint8_t *end = p + len;
+
+    while (p < end)
+    {
+        struct block block;
+        pull_block(&p, &block);
+
+        /* Entries: data_len (2), content_type (2), path_len (1), path, data */
+        uint8_t *entry = block.data;
+        while (entry < &block.data[block.data_len])
+        {
+            uint16_t data_len = sys_get_be16(&entry[0]);
+            uint8_t path_len = entry[4];
+            const uint8_t *path = &entry[5];
+            uint8_t *data = &entry[5 + path_len];
+
+            entry = &data[data_len];
+
+            if (path_len != strlen(RPC_STATUS_PATH) || memcmp(path, RPC_STATUS_PATH, path_len))
+            {
+                continue;
+            }
+
+            struct zcbor_string id;
+            ZCBOR_STATE_D(zsd, 2, data, data_len, 1, 0);
+
+            bool ok = zcbor_map_start_decode(zsd) && zcbor_tstr_expect_lit(zsd, "id")
+                   && zcbor_tstr_decode(zsd, &id) && zcbor_tstr_expect_lit(zsd, "detail")
+                   && zcbor_map_start_decode(zsd);
+            zassert_true(ok, "Invalid reply");
+            zassert_true(id.len < sizeof(reply->id));
+
+            memcpy(reply->id, id.value, id.len);
+            reply->id[id.len] = '\0';
+
+            reply->has_value = !zcbor_array_at_end(zsd);
+            if (reply->has_value)
+            {
+                ok = zcbor_tstr_expect_lit(zsd, "value") && zcbor_int32_decode(zsd, &reply->value);
+                zassert_true(ok, "Invalid reply detail");
+            }
+
+            ok = zcbor_map_end_decode(zsd) && zcbor_tstr_expect_lit(zsd, "statusCode")
+              && zcbor_uint32_decode(zsd, &reply->status) && zcbor_map_end_decode(zsd);
+            zassert_true(ok, "Invalid reply");
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void assert_held(void)
+{
+    uint8_t buf[64];
+    size_t len = sizeof(buf);
+
+    zassert_equal(transport_pull_data(buf, &len), POUCH_MORE_DATA);
+    zassert_equal(len, 0);
+}
+
+static void *suite_setup(void)
+{
+    zassert_ok(pouch_init(&pouch_config));
+
+    return NULL;
+}
+
+static void before(void *f)
+{
+    double_count = 0;
+
+    transport_session_start();
+
+    /* let the uplink handlers run */
+    k_sleep(K_MSEC(1));
+}
+
+static void after(void *f)
+{
+    transport_session_end();
+}
+
+ZTEST(rpc, test_request)
+{
+    struct reply reply = {};
+
+    request_receive("call-1", "double", NULL, 21);
+
+    /* let the pouch close */
+    k_sleep(K_MSEC(1));
+
+    zassert_true(reply_pull(&reply), "No reply");
+    zassert_equal(double_count, 1);
+    zassert_str_equal(reply.id, "call-1");
+    zassert_equal(reply.status, GOLIOTH_RPC_OK);
+    zassert_true(reply.has_value);
+    zassert_equal(reply.value, 42);
+}
+
+ZTEST(rpc, test_invalid_params)
+{
+    struct reply reply = {};
+
+    request_receive("call-2", "double", "twenty-one", 0);
+
+    k_sleep(K_MSEC(1));
+
+    zassert_true(reply_pull(&reply), "No reply");
+    zassert_equal(double_count, 1);
+    zassert_str_equal(reply.id, "call-2");
+    zassert_equal(reply.status, GOLIOTH_RPC_INVALID_ARGUMENT);
+    zassert_false(reply.has_value);
+}
+
+ZTEST(rpc, test_unknown_method)
+{
+    struct reply reply = {};
+
+    request_receive("call-3", "triple", NULL, 21);
+
+    k_sleep(K_MSEC(1));
+
+    zassert_true(reply_pull(&reply), "No reply");
+    zassert_equal(double_count, 0);
+    zassert_str_equal(reply.id, "call-3");
+    zassert_equal(reply.status, GOLIOTH_RPC_UNIMPLEMENTED);
+    zassert_false(reply.has_value);
+}
+
+ZTEST(rpc, test_request_too_large)
+{
+    char param[CONFIG_GOLIOTH_RPC_MAX_REQUEST_LEN + 1];
+    struct reply reply = {};
+
+    memset(param, 'a', sizeof(param) - 1);
+    param[sizeof(param) - 1] = '\0';
+
+    request_receive("call-4", "double", param, 0);
+
+    k_sleep(K_MSEC(1));
+
+    /* The request is dropped, but it still releases the pouch */
+    zassert_false(reply_pull(&reply), "Unexpected reply");
+    zassert_equal(double_count, 0);
+}
+
+ZTEST(rpc, test_hold)
+{
+    struct reply reply = {};
+
+    /* The pouch waits for requests in the downlink */
+    assert_held();
+
+    /* A request that hasn't been received completely keeps the pouch open */
+    uint8_t buf[128];
+    ZCBOR_STATE_E(zse, 2, buf, sizeof(buf), 1);
+
+    bool ok = zcbor_map_start_encode(zse, 3) && zcbor_tstr_put_lit(zse, "id")
+           && zcbor_tstr_put_lit(zse, "call-5") && zcbor_tstr_put_lit(zse, "method")
+           && zcbor_tstr_put_lit(zse, "double") && zcbor_tstr_put_lit(zse, "params")
+           && zcbor_list_start_encode(zse, 1) && zcbor_int32_put(zse, 2)
+           && zcbor_list_end_encode(zse, 1) && zcbor_map_end_encode(zse, 3);
+    zassert_true(ok);
+
+    size_t len = zse->payload - buf;
+
+    downlink_start(STREAM_ID, RPC_PATH);
+    downlink_data(STREAM_ID, buf, len / 2, false);
+
+    k_sleep(K_MSEC(1));
+    assert_held();
+
+    /* The reply releases the pouch, and goes out in it */
+    downlink_data(STREAM_ID, &buf[len / 2], len - len / 2, true);
+
+    k_sleep(K_MSEC(1));
+
+    zassert_true(reply_pull(&reply), "No reply");
+    zassert_str_equal(reply.id, "call-5");
+    zassert_equal(reply.value, 4);
+}
+
+ZTEST_SUITE(rpc, NULL, suite_setup, before, after, NULL);
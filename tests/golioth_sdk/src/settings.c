@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ */
+#include <zephyr/ztest.h>
+#include <string.h>
+#include <zcbor_encode.h>
+#include <golioth/settings_callbacks.h>
+
+#include "downlink.h"
+#include "settings.h"
+
+#define SETTINGS_PATH "/.c"
+#define STREAM_ID 5
+
+static struct
+{
+    int32_t zulu;
+    size_t zulu_count;
+    bool alpha;
+    size_t alpha_count;
+    char mike[16];
+    size_t mike_count;
+    double charlie;
+    size_t charlie_count;
+    int32_t echo;
+    size_t echo_count;
+    size_t commit_count;
+} received;
+
+/* Registered out of order, so the handlers must be sorted to be found */
+
+static int zulu_set(int32_t new_value)
+{
+    received.zulu = new_value;
+    received.zulu_count++;
+    return 0;
+}
+GOLIOTH_SETTINGS_HANDLER(ZULU, zulu_set);
+
+static int alpha_set(bool new_value)
+{
+    received.alpha = new_value;
+    received.alpha_count++;
+    return 0;
+}
+GOLIOTH_SETTINGS_HANDLER(ALPHA, alpha_set);
+
+static int mike_set(const char *new_value, size_t len)
+{
+    zassert_true(len < sizeof(received.mike));
+    memcpy(received.mike, new_value, len);
+    received.mike[len] = '\0';
+    received.mike_count++;
+    return 0;
+}
+GOLIOTH_SETTINGS_HANDLER(MIKE, mike_set);
+
+static int charlie_set(double new_value)
+{
+    received.charlie = new_value;
+    received.charlie_count++;
+    return 0;
+}
+GOLIOTH_SETTINGS_HANDLER(CHARLIE, charlie_set);
+
+static int echo_set(int32_t new_value)
+{
+    received.echo = new_value;
+    received.echo_count++;
+    return 0;
+}
+GOLIOTH_SETTINGS_HANDLER(ECHO, echo_set);
+
+static void settings_commit(void)
+{
+    received.commit_count++;
+}
+GOLIOTH_SETTINGS_COMMIT_HANDLER(settings_commit);
+
+#define INT_SETTING(_key, _value) \
+    {.key = _key, .type = GOLIOTH_SETTING_VALUE_TYPE_INT, .int_val = _value}
+#define BOOL_SETTING(_key, _value) \
+    {.key = _key, .type = GOLIOTH_SETTING_VALUE_TYPE_BOOL, .bool_val = _value}
+#define FLOAT_SETTING(_key, _value) \
+    {.key = _key, .type = GOLIOTH_SETTING_VALUE_TYPE_FLOAT, .float_val = _value}
+#define STRING_SETTING(_key, _value)                \
+    {                                               \
+        .key = _key,                                \
+        .type = GOLIOTH_SETTING_VALUE_TYPE_STRING,  \
+        .str_val = {_value, sizeof(_value) - 1},    \
+    }
+
+/** Receive a settings downlink with @p values, in blocks of @p block_len */
+static void settings_receive(const struct setting_value *values, size_t count, size_t block_len)
+{
+    uint8_t buf[512];
+    ZCBOR_STATE_E(zse, 2, buf, sizeof(buf), 1);
+
+    bool ok = zcbor_map_start_encode(zse, 2) && zcbor_tstr_put_lit(zse, "version")
+           && zcbor_int32_put(zse, 1) && zcbor_tstr_put_lit(zse, "settings")
+           && zcbor_map_start_encode(zse, count);
+    zassert_true(ok);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        ok = zcbor_tstr_put_term(zse, values[i].key, SIZE_MAX);
+        zassert_true(ok);
+
+        switch (values[i].type)
+        {
+            case GOLIOTH_SETTING_VALUE_TYPE_INT:
+                ok = zcbor_int32_put(zse, values[i].int_val);
+                break;
+            case GOLIOTH_SETTING_VALUE_TYPE_BOOL:
+                ok = zcbor_bool_put(zse, values[i].bool_val);
+                break;
+            case GOLIOTH_SETTING_VALUE_TYPE_FLOAT:
+                ok = zcbor_float64_put(zse, values[i].float_val);
+                break;
+            case GOLIOTH_SETTING_VALUE_TYPE_STRING:
+                ok = zcbor_tstr_encode_ptr(zse, values[i].str_val.data, values[i].str_val.len);
+                break;
+            default:
+                ok = false;
+                break;
+        }
+        zassert_true(ok);
+    }
+
+    ok = zcbor_map_end_encode(zse, count) && zcbor_map_end_encode(zse, 2);
+    zassert_true(ok);
+
+    downlink_entry(STREAM_ID, SETTINGS_PATH, buf, zse->payload - buf, block_len);
+}
+
+static void before(void *f)
+{
+    memset(&received, 0, sizeof(received));
+}
+
+ZTEST(settings, test_handlers)
+{
+    const struct setting_value values[] = {
+        INT_SETTING("ECHO", 5),
+        STRING_SETTING("MIKE", "hello"),
+        BOOL_SETTING("ALPHA", true),
+        FLOAT_SETTING("CHARLIE", 1.5),
+        INT_SETTING("ZULU", -7),
+    };
+
+    settings_receive(values, ARRAY_SIZE(values), SIZE_MAX);
+
+    zassert_equal(received.alpha_count, 1);
+    zassert_true(received.alpha);
+    zassert_equal(received.charlie_count, 1);
+    zassert_equal(received.charlie, 1.5);
+    zassert_equal(received.echo_count, 1);
+    zassert_equal(received.echo, 5);
+    zassert_equal(received.mike_count, 1);
+    zassert_str_equal(received.mike, "hello");
+    zassert_equal(received.zulu_count, 1);
+    zassert_equal(received.zulu, -7);
+}
+
+ZTEST(settings, test_unknown_keys)
+{
+    /* Unknown keys before, between and after the registered ones */
+    const struct setting_value values[] = {
+        INT_SETTING("AAA", 1),
+        INT_SETTING("ALPH", 2),
+        INT_SETTING("ALPHAA", 3),
+        INT_SETTING("DELTA", 4),
+        INT_SETTING("ECHO", 5),
+        INT_SETTING("NOVEMBER", 6),
+        INT_SETTING("ZZZ", 7),
+        INT_SETTING("alpha", 8),
+        INT_SETTING("", 9),
+    };
+
+    settings_receive(values, ARRAY_SIZE(values), SIZE_MAX);
+
+    zassert_equal(received.echo_count, 1);
+    zassert_equal(received.echo, 5);
+    zassert_equal(received.alpha_count, 0);
+    zassert_equal(received.charlie_count, 0);
+    zassert_equal(received.mike_count, 0);
+    zassert_equal(received.zulu_count, 0);
+}
+
+ZTEST(settings, test_type_mismatch)
+{
+    const struct setting_value values[] = {
+        STRING_SETTING("ZULU", "7"),
+        INT_SETTING("ALPHA", 1),
+        BOOL_SETTING("ECHO", false),
+        INT_SETTING("MIKE", 2),
+    };
+
+    settings_receive(values, ARRAY_SIZE(values), SIZE_MAX);
+
+    zassert_equal(received.alpha_count, 0);
+    zassert_equal(received.echo_count, 0);
+    zassert_equal(received.mike_count, 0);
+    zassert_equal(received.zulu_count, 0);
+}
+
+ZTEST(settings, test_hash)
+{
+    const struct setting_value first[] = {INT_SETTING("ZULU", 100)};
+    const struct setting_value second[] = {INT_SETTING("ZULU", 101)};
+    const struct setting_value unknown[] = {INT_SETTING("NOVEMBER", 101)};
+    const struct setting_value mismatch[] = {STRING_SETTING("ZULU", "101")};
+    const struct setting_value other[] = {INT_SETTING("ECHO", 100)};
+
+    settings_receive(first, ARRAY_SIZE(first), SIZE_MAX);
+    uint32_t first_hash = golioth_settings_hash();
+
+    settings_receive(second, ARRAY_SIZE(second), SIZE_MAX);
+    uint32_t second_hash = golioth_settings_hash();
+    zassert_not_equal(second_hash, first_hash);
+
+    /* Only applied settings are part of the hash */
+    settings_receive(unknown, ARRAY_SIZE(unknown), SIZE_MAX);
+    zassert_equal(golioth_settings_hash(), second_hash);
+    settings_receive(mismatch, ARRAY_SIZE(mismatch), SIZE_MAX);
+    zassert_equal(golioth_settings_hash(), second_hash);
+
+    /* The hash follows the values, not the history */
+    settings_receive(first, ARRAY_SIZE(first), SIZE_MAX);
+    zassert_equal(golioth_settings_hash(), first_hash);
+    settings_receive(first, ARRAY_SIZE(first), SIZE_MAX);
+    zassert_equal(golioth_settings_hash(), first_hash);
+
+    /* The same value for another setting changes it */
+    settings_receive(other, ARRAY_SIZE(other), SIZE_MAX);
+    zassert_not_equal(golioth_settings_hash(), first_hash);
+}
+
+ZTEST(settings, test_hash_order)
+{
+    const struct setting_value values[] = {
+        STRING_SETTING("MIKE", "order"),
+        INT_SETTING("ZULU", 200),
+        BOOL_SETTING("ALPHA", false),
+    };
+    const struct setting_value reversed[] = {
+        BOOL_SETTING("ALPHA", false),
+        INT_SETTING("ZULU", 200),
+        STRING_SETTING("MIKE", "order"),
+    };
+
+    settings_receive(values, ARRAY_SIZE(values), SIZE_MAX);
+    uint32_t hash = golioth_settings_hash();
+
+    settings_receive(reversed, ARRAY_SIZE(reversed), SIZE_MAX);
+    zassert_equal(golioth_settings_hash(), hash);
+}
+
+ZTEST(settings, test_commit)
+{
+    const struct setting_value values[] = {
+        INT_SETTING("ECHO", 300),
+        STRING_SETTING("MIKE", "split"),
+        BOOL_SETTING("ALPHA", true),
+        FLOAT_SETTING("CHARLIE", -2.25),
+        INT_SETTING("ZULU", 301),
+    };
+
+    /* Settings are committed once for the whole downlink, however it's split up */
+    for (size_t block_len = 1; block_len <= 16; block_len++)
+    {
+        memset(&received, 0, sizeof(received));
+
+        settings_receive(values, ARRAY_SIZE(values), block_len);
+
+        zassert_equal(received.commit_count, 1, "block_len %zu", block_len);
+        zassert_equal(received.alpha_count, 1, "block_len %zu", block_len);
+        zassert_equal(received.charlie_count, 1, "block_len %zu", block_len);
+        zassert_equal(received.charlie, -2.25, "block_len %zu", block_len);
+        zassert_equal(received.echo_count, 1, "block_len %zu", block_len);
+        zassert_equal(received.mike_count, 1, "block_len %zu", block_len);
+        zassert_str_equal(received.mike, "split", "block_len %zu", block_len);
+        zassert_equal(received.zulu_count, 1, "block_len %zu", block_len);
+    }
+
+    /* Nothing to commit without any settings */
+    memset(&received, 0, sizeof(received));
+    settings_receive(NULL, 0, SIZE_MAX);
+    zassert_equal(received.commit_count, 0);
+}
+
+ZTEST(settings, test_commit_interrupted)
+{
+    const struct setting_value values[] = {
+        INT_SETTING("ECHO", 400),
+        INT_SETTING("ZULU", 401),
+    };
+    static const uint8_t data[] = {0xa1};
+
+    /* A downlink that never finishes isn't committed... */
+    downlink_start(STREAM_ID, SETTINGS_PATH);
+    downlink_data(STREAM_ID, data, sizeof(data), false);
+
+    /* ...and doesn't affect the next one */
+    settings_receive(values, ARRAY_SIZE(values), 4);
+    zassert_equal(received.commit_count, 1);
+    zassert_equal(received.echo, 400);
+    zassert_equal(received.zulu, 401);
+}
+
+ZTEST_SUITE(settings, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ */
+#include <zephyr/ztest.h>
+#include <errno.h>
+#include <string.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "zcbor_utils.h"
+
+#define MAX_EVENTS 32
+#define MAX_PAYLOAD 512
+
+struct recorded_event
+{
+    enum zcbor_stream_event_type type;
+    size_t depth;
+    size_t offset;
+    size_t len;
+};
+
+static struct recorded_event events[MAX_EVENTS];
+static size_t event_count;
+static uint8_t payloads[MAX_PAYLOAD];
+static size_t payloads_len;
+
+/** Depth of the container to collect, or -1 to not collect anything */
+static int collect_depth;
+static int step_err;
+
+static struct zcbor_stream stream;
+
+/* {"a": [1, 2, {"b": h'0102'}], "c": "text"} */
+static const uint8_t reference[] = {
+    0xa2, 0x61, 0x61, 0x83, 0x01, 0x02, 0xa1, 0x61, 0x62, 0x42,
+    0x01, 0x02, 0x61, 0x63, 0x64, 0x74, 0x65, 0x78, 0x74,
+};
+
+struct expected_event
+{
+    enum zcbor_stream_event_type type;
+    size_t depth;
+    const char *payload;
+    size_t len;
+};
+
+#define EXPECT(_type, _depth) {.type = ZCBOR_STREAM_##_type, .depth = _depth}
+#define EXPECT_ITEM(_depth, _payload) \
+    {.type = ZCBOR_STREAM_ITEM, .depth = _depth, .payload = _payload, .len = sizeof(_payload) - 1}
+
+static const struct expected_event reference_events[] = {
+    EXPECT(MAP_START, 0),
+    EXPECT_ITEM(1, "\x61\x61"),
+    EXPECT(LIST_START, 1),
+    EXPECT_ITEM(2, "\x01"),
+    EXPECT_ITEM(2, "\x02"),
+    EXPECT(MAP_START, 2),
+    EXPECT_ITEM(3, "\x61\x62"),
+    EXPECT_ITEM(3, "\x42\x01\x02"),
+    EXPECT(END, 2),
+    EXPECT(END, 1),
+    EXPECT_ITEM(1, "\x61\x63"),
+    EXPECT_ITEM(1, "\x64\x74\x65\x78\x74"),
+    EXPECT(END, 0),
+};
+
+static const struct expected_event collected_events[] = {
+    EXPECT(MAP_START, 0),
+    EXPECT_ITEM(1, "\x61\x61"),
+    EXPECT(LIST_START, 1),
+    EXPECT_ITEM(2, "\x01"),
+    EXPECT_ITEM(2, "\x02"),
+    EXPECT(MAP_START, 2),
+    EXPECT_ITEM(2, "\xa1\x61\x62\x42\x01\x02"),
+    EXPECT(END, 1),
+    EXPECT_ITEM(1, "\x61\x63"),
+    EXPECT_ITEM(1, "\x64\x74\x65\x78\x74"),
+    EXPECT(END, 0),
+};
+
+static int step(const struct zcbor_stream_event *event, void *user_data)
+{
+    zassert_true(event_count < MAX_EVENTS);
+
+    struct recorded_event *e = &events[event_count++];
+    e->type = event->type;
+    e->depth = event->depth;
+    e->offset = payloads_len;
+    e->len = event->len;
+
+    if (event->type == ZCBOR_STREAM_ITEM)
+    {
+        zassert_true(payloads_len + event->len <= MAX_PAYLOAD);
+        memcpy(&payloads[payloads_len], event->payload, event->len);
+        payloads_len += event->len;
+    }
+
+    if (step_err)
+    {
+        return step_err;
+    }
+
+    if (event->type == ZCBOR_STREAM_MAP_START && (int) event->depth == collect_depth)
+    {
+        return ZCBOR_STREAM_COLLECT;
+    }
+
+    return 0;
+}
+
+static void reset(void)
+{
+    event_count = 0;
+    payloads_len = 0;
+    collect_depth = -1;
+    step_err = 0;
+    zcbor_stream_init(&stream, step, NULL);
+}
+
+static void before(void *f)
+{
+    reset();
+}
+
+static void assert_events(const struct expected_event *expected, size_t count)
+{
+    zassert_equal(event_count, count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        zassert_equal(events[i].type, expected[i].type, "event %zu", i);
+        zassert_equal(events[i].depth, expected[i].depth, "event %zu", i);
+        zassert_equal(events[i].len, expected[i].len, "event %zu", i);
+        if (expected[i].len)
+        {
+            zassert_mem_equal(&payloads[events[i].offset],
+                              expected[i].payload,
+                              expected[i].len,
+                              "event %zu",
+                              i);
+        }
+    }
+}
+
+ZTEST(zcbor_stream, test_single_chunk)
+{
+    zassert_ok(zcbor_stream_feed(&stream, reference, sizeof(reference), true));
+    assert_events(reference_events, ARRAY_SIZE(reference_events));
+}
+
+ZTEST(zcbor_stream, test_split)
+{
+    for (size_t split = 0; split <= sizeof(reference); split++)
+    {
+        reset();
+
+        zassert_ok(zcbor_stream_feed(&stream, reference, split, false), "split at %zu", split);
+        zassert_ok(zcbor_stream_feed(&stream, &reference[split], sizeof(reference) - split, true),
+                   "split at %zu",
+                   split);
+        assert_events(reference_events, ARRAY_SIZE(reference_events));
+    }
+}
+
+ZTEST(zcbor_stream, test_byte_by_byte)
+{
+    for (size_t i = 0; i < sizeof(reference); i++)
+    {
+        zassert_ok(zcbor_stream_feed(&stream, &reference[i], 1, i == sizeof(reference) - 1));
+    }
+
+    assert_events(reference_events, ARRAY_SIZE(reference_events));
+}
+
+ZTEST(zcbor_stream, test_collect)
+{
+    for (size_t split = 0; split <= sizeof(reference); split++)
+    {
+        reset();
+        collect_depth = 2;
+
+        zassert_ok(zcbor_stream_feed(&stream, reference, split, false), "split at %zu", split);
+        zassert_ok(zcbor_stream_feed(&stream, &reference[split], sizeof(reference) - split, true),
+                   "split at %zu",
+                   split);
+        assert_events(collected_events, ARRAY_SIZE(collected_events));
+    }
+}
+
+ZTEST(zcbor_stream, test_indefinite)
+{
+    /* [_ 1, {_ "a": 2}] */
+    static const uint8_t data[] = {0x9f, 0x01, 0xbf, 0x61, 0x61, 0x02, 0xff, 0xff};
+    static const struct expected_event expected[] = {
+        EXPECT(LIST_START, 0),
+        EXPECT_ITEM(1, "\x01"),
+        EXPECT(MAP_START, 1),
+        EXPECT_ITEM(2, "\x61\x61"),
+        EXPECT_ITEM(2, "\x02"),
+        EXPECT(END, 1),
+        EXPECT(END, 0),
+    };
+
+    for (size_t split = 0; split <= sizeof(data); split++)
+    {
+        reset();
+
+        zassert_ok(zcbor_stream_feed(&stream, data, split, false), "split at %zu", split);
+        zassert_ok(zcbor_stream_feed(&stream, &data[split], sizeof(data) - split, true),
+                   "split at %zu",
+                   split);
+        assert_events(expected, ARRAY_SIZE(expected));
+    }
+}
+
+ZTEST(zcbor_stream, test_empty_containers)
+{
+    /* [[], {}] */
+    static const uint8_t data[] = {0x82, 0x80, 0xa0};
+    static const struct expected_event expected[] = {
+        EXPECT(LIST_START, 0),
+        EXPECT(LIST_START, 1),
+        EXPECT(END, 1),
+        EXPECT(MAP_START, 1),
+        EXPECT(END, 1),
+        EXPECT(END, 0),
+    };
+
+    zassert_ok(zcbor_stream_feed(&stream, data, sizeof(data), true));
+    assert_events(expected, ARRAY_SIZE(expected));
+}
+
+ZTEST(zcbor_stream, test_truncated)
+{
+    for (size_t len = 0; len < sizeof(reference); len++)
+    {
+        reset();
+
+        zassert_equal(zcbor_stream_feed(&stream, reference, len, true), -EBADMSG, "len %zu", len);
+    }
+}
+
+ZTEST(zcbor_stream, test_item_too_large)
+{
+    static uint8_t data[CONFIG_GOLIOTH_ZCBOR_STREAM_CARRY_LEN + 3];
+
+    /* Byte string that fills the whole buffer */
+    data[0] = 0x59;
+    sys_put_be16(sizeof(data) - 3, &data[1]);
+
+    /* The item is fine as long as it arrives in one piece: */
+    zassert_ok(zcbor_stream_feed(&stream, data, sizeof(data), true));
+    zassert_equal(event_count, 1);
+    zassert_equal(events[0].len, sizeof(data));
+
+    reset();
+
+    /* ...but it can't be carried over to the next chunk: */
+    int err = zcbor_stream_feed(&stream, data, sizeof(data) / 2, false);
+    if (err == 0)
+    {
+        err = zcbor_stream_feed(&stream,
+                                &data[sizeof(data) / 2],
+                                sizeof(data) - sizeof(data) / 2,
+                                false);
+    }
+    zassert_equal(err, -ENOMEM);
+    zassert_equal(event_count, 0);
+
+    /* The error sticks: */
+    zassert_equal(zcbor_stream_feed(&stream, reference, sizeof(reference), true), -ENOMEM);
+    zassert_equal(event_count, 0);
+}
+
+ZTEST(zcbor_stream, test_step_error)
+{
+    step_err = -ECANCELED;
+
+    zassert_equal(zcbor_stream_feed(&stream, reference, sizeof(reference), false), -ECANCELED);
+    zassert_equal(event_count, 1);
+
+    zassert_equal(zcbor_stream_feed(&stream, NULL, 0, true), -ECANCELED);
+    zassert_equal(event_count, 1);
+}
+
+ZTEST_SUITE(zcbor_stream, NULL, NULL, before, NULL, NULL);
@@ -19,6 +19,8 @@ void transport_session_start(void)
 void transport_session_end(void)
 {
     zassert_not_null(uplink, "uplink is NULL");
+    // everything that was pulled is delivered:
+    pouch_uplink_confirm(uplink, SIZE_MAX);
     pouch_uplink_finish(uplink);
     uplink = NULL;
 }
@@ -56,6 +58,7 @@ void transport_reset(void *unused)
         }
     }
 
+    pouch_uplink_confirm(uplink, SIZE_MAX);
     pouch_uplink_finish(uplink);
 
     // let processing run:
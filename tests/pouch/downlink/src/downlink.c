@@ -7,6 +7,9 @@
 #include <pouch/port.h>
 #include <pouch/pouch.h>
 #include <zephyr/ztest.h>
+#include <string.h>
+
+#include "downlink.h"
 
 POUCH_LOG_REGISTER(downlink_test, POUCH_LOG_LEVEL_DBG);
 
@@ -34,6 +37,12 @@ struct downlink_api_context
     size_t payload_len;
 
     const struct pouch_test_item_entry *entry;
+    /* The current entry has started, and hasn't received its last data yet */
+    bool started;
+
+    /* Hold the handler until the transport runs out of blocks */
+    bool hold;
+    struct k_sem release;
 };
 
 static struct downlink_api_context downlink_api;
@@ -44,20 +53,28 @@ static const struct pouch_config pouch_config = {
 
 static void *init_pouch(void)
 {
+    k_sem_init(&downlink_api.release, 0, 1);
     pouch_init(&pouch_config);
     return NULL;
 }
 
 ZTEST_SUITE(downlink, NULL, init_pouch, NULL, NULL, NULL);
 
-static void downlink_start(unsigned int stream_id, const char *path, uint16_t content_type)
+static void downlink_start(unsigned int stream_id,
+                           const char *path,
+                           size_t path_len,
+                           uint16_t content_type)
 {
     POUCH_LOG_DBG("Entry stream_id: %u", stream_id);
-    POUCH_LOG_DBG("Entry path: %s", path);
+    POUCH_LOG_DBG("Entry path: %.*s", (int) path_len, path);
     POUCH_LOG_DBG("Entry content_type: %u", content_type);
 
-    zassert_str_equal(path, "/.s/lorem", "invalid path");
+    zassert_equal(path_len, strlen("/.s/lorem"), "invalid path length");
+    zassert_mem_equal(path, "/.s/lorem", path_len, "invalid path");
     zassert_equal(content_type, POUCH_CONTENT_TYPE_JSON, "invalid content_type");
+    zassert_false(downlink_api.started, "previous entry didn't finish");
+
+    downlink_api.started = true;
 
     /* Initialize offset for received data */
     downlink_api.offset = 0;
@@ -70,6 +87,13 @@ static void downlink_data(unsigned int stream_id, const void *data, size_t len,
     POUCH_LOG_DBG("Entry is_last: %d", (int) is_last);
     POUCH_LOG_HEXDUMP(data, len, "Entry data");
 
+    if (downlink_api.hold)
+    {
+        k_sem_take(&downlink_api.release, K_FOREVER);
+        downlink_api.hold = false;
+    }
+
+    zassert_true(downlink_api.started, "data before start");
     zassert_mem_equal(data,
                       &downlink_api.entry->data[downlink_api.offset],
                       len,
@@ -84,6 +108,7 @@ static void downlink_data(unsigned int stream_id, const void *data, size_t len,
     if (is_last)
     {
         downlink_api.entry++;
+        downlink_api.started = false;
 
         /* Check if all data was received */
         zassert_equal(downlink_api.offset,
@@ -94,22 +119,41 @@ static void downlink_data(unsigned int stream_id, const void *data, size_t len,
     }
 }
 
+#if CONFIG_POUCH_DOWNLINK_HANDLER_WORK_QUEUE
+POUCH_DOWNLINK_HANDLER_QUEUED(lorem, downlink_start, downlink_data, NULL, 2);
+#else
 POUCH_DOWNLINK_HANDLER(downlink_start, downlink_data);
+#endif
 
-static void pouch_downlink_push_all(const uint8_t *data, size_t len, size_t mtu)
+/** Push all the data, and return the number of fragments that had to be pushed again */
+static size_t pouch_downlink_push_all(const uint8_t *data, size_t len, size_t mtu)
 {
+    size_t busy = 0;
+
     while (len)
     {
         size_t fragment_len = MIN(len, mtu);
 
-        pouch_downlink_push(data, fragment_len);
+        int err = pouch_downlink_push(data, fragment_len);
+        if (err == -EAGAIN)
+        {
+            /* Out of blocks. Like the transport, push the same fragment again later. */
+            busy++;
+            k_sem_give(&downlink_api.release);
+            k_sleep(K_MSEC(1));
+            continue;
+        }
+
+        zassert_ok(err);
 
         data += fragment_len;
         len -= fragment_len;
     }
+
+    return busy;
 }
 
-static void test_lorem(const struct pouch_test_item *test_item)
+static size_t test_lorem(const struct pouch_test_item *test_item)
 {
     downlink_api.entry = &test_item->entries[0];
 
@@ -118,15 +162,18 @@ static void test_lorem(const struct pouch_test_item *test_item)
     downlink_api.payload_len = test_item->entries[0].data_len;
 
     pouch_downlink_start();
-    pouch_downlink_push_all(test_item->data, test_item->data_len, CONFIG_POUCH_TRANSPORT_MTU);
+    size_t busy =
+        pouch_downlink_push_all(test_item->data, test_item->data_len, CONFIG_POUCH_TRANSPORT_MTU);
     pouch_downlink_finish();
 
-    /* Let all downlink messages be processed */
-    k_sleep(K_MSEC(100));
+    /* Wait for the handlers to process all the data */
+    pouch_downlink_flush();
 
     zassert_equal_ptr(downlink_api.entry,
                       &test_item->entries[test_item->num_entries],
                       "Number of last_count does not match number of messages within pouch");
+
+    return busy;
 }
 
 #include "lorem-10-x1.c"
@@ -191,3 +238,12 @@ ZTEST(downlink, test_lorem_09_1024_x5)
 {
     test_lorem(&lorem_1024_x5);
 }
+
+ZTEST(downlink, test_lorem_10_busy)
+{
+    k_sem_reset(&downlink_api.release);
+    downlink_api.hold = true;
+
+    /* The blocks held up by the handler are pushed again once it lets go */
+    zassert_true(test_lorem(&lorem_102400_x1) > 0);
+}
@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ */
+#include <zephyr/ztest.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/l2cap.h>
+#include <zephyr/net_buf.h>
+#include <errno.h>
+#include <string.h>
+
+#include "../common.h"
+#include "broker.h"
+#include "discover.h"
+#include "link.h"
+#include "transport/sar/receiver.h"
+#include "transport/sar/sender.h"
+#include "transport/endpoints/broker/endpoints.h"
+
+/* Opaque to everyone but the Bluetooth stack, only ever compared by address */
+static uint8_t conn_storage;
+#define TEST_CONN ((struct bt_conn *) &conn_storage)
+
+#define GATT_MTU 247
+#define L2CAP_TX_MTU 48
+#define UPLINK_PSM 0x80
+#define DOWNLINK_PSM 0x81
+#define INFO_HANDLE 0x10
+#define DOWNLINK_HANDLE 0x20
+#define UPLINK_HANDLE 0x30
+
+/* The characteristic's L2CAP channel isn't connecting or connected */
+#define L2CAP_IDLE 0
+
+const struct pouch_endpoint broker_endpoint_info;
+const struct pouch_endpoint broker_endpoint_device_cert;
+const struct pouch_endpoint broker_endpoint_server_cert;
+const struct pouch_endpoint broker_endpoint_uplink;
+const struct pouch_endpoint broker_endpoint_downlink;
+
+static struct broker_bt_gatt_device *device;
+
+/** State of the replaced Bluetooth stack functions */
+static struct
+{
+    broker_bt_gatt_discover_callback_t discover_cb;
+    broker_bt_gatt_link_callback_t link_cb;
+    size_t link_done_count;
+    /** GATT subscriptions, by value handle */
+    struct bt_gatt_subscribe_params *subs[0x40];
+    int l2cap_connect_ret;
+    size_t l2cap_connect_count;
+    /** L2CAP channels the broker connected, by PSM */
+    struct bt_l2cap_chan *chans[2];
+    /** SDUs queued in the stack, which the test releases */
+    struct net_buf *sent[CONFIG_POUCH_GATEWAY_GATT_L2CAP_TX_BUFS];
+    size_t sent_count;
+    size_t l2cap_disconnect_count;
+} bt;
+
+/** State of the replaced SAR transport */
+static struct
+{
+    struct pouch_bearer *uplink;
+    struct pouch_bearer *downlink;
+    atomic_t ready_count;
+} sar;
+
+static size_t end_count;
+
+int gateway_bt_discover(struct broker_bt_gatt_device *d,
+                        broker_bt_gatt_discover_callback_t on_complete)
+{
+    bt.discover_cb = on_complete;
+    return 0;
+}
+
+int gateway_bt_link_setup(struct broker_bt_gatt_device *d,
+                          broker_bt_gatt_link_callback_t on_complete)
+{
+    bt.link_cb = on_complete;
+    return 0;
+}
+
+void gateway_bt_link_done(struct broker_bt_gatt_device *d)
+{
+    bt.link_done_count++;
+}
+
+uint8_t bt_conn_index(const struct bt_conn *conn)
+{
+    zassert_equal_ptr(conn, TEST_CONN);
+    return 0;
+}
+
+uint16_t bt_gatt_get_mtu(struct bt_conn *conn)
+{
+    return GATT_MTU;
+}
+
+int bt_gatt_subscribe(struct bt_conn *conn, struct bt_gatt_subscribe_params *params)
+{
+    zassert_equal_ptr(conn, TEST_CONN);
+    zassert_true(params->value_handle < ARRAY_SIZE(bt.subs));
+
+    bt.subs[params->value_handle] = params;
+    return 0;
+}
+
+int bt_gatt_unsubscribe(struct bt_conn *conn, struct bt_gatt_subscribe_params *params)
+{
+    bt.subs[params->value_handle] = NULL;
+    return 0;
+}
+
+int bt_gatt_write_without_response_cb(struct bt_conn *conn,
+                                      uint16_t handle,
+                                      const void *data,
+                                      uint16_t length,
+                                      bool sign,
+                                      bt_gatt_complete_func_t func,
+                                      void *user_data)
+{
+    return 0;
+}
+
+int bt_l2cap_chan_connect(struct bt_conn *conn, struct bt_l2cap_chan *chan, uint16_t psm)
+{
+    zassert_equal_ptr(conn, TEST_CONN);
+    zassert_true(psm == UPLINK_PSM || psm == DOWNLINK_PSM);
+
+    bt.l2cap_connect_count++;
+    if (bt.l2cap_connect_ret)
+    {
+        return bt.l2cap_connect_ret;
+    }
+
+    bt.chans[psm - UPLINK_PSM] = chan;
+    return 0;
+}
+
+int bt_l2cap_chan_send(struct bt_l2cap_chan *chan, struct net_buf *buf)
+{
+    zassert_true(bt.sent_count < ARRAY_SIZE(bt.sent));
+
+    bt.sent[bt.sent_count++] = buf;
+    return 0;
+}
+
+int bt_l2cap_chan_disconnect(struct bt_l2cap_chan *chan)
+{
+    bt.l2cap_disconnect_count++;
+    return 0;
+}
+
+int pouch_sender_open(struct pouch_sender *sender, struct pouch_bearer *bearer)
+{
+    if (sender->endpoint == &broker_endpoint_downlink)
+    {
+        sar.downlink = bearer;
+    }
+
+    return 0;
+}
+
+void pouch_sender_ready(struct pouch_sender *sender)
+{
+    atomic_inc(&sar.ready_count);
+}
+
+int pouch_sender_recv(struct pouch_sender *sender, const uint8_t *buf, size_t len)
+{
+    return 0;
+}
+
+void pouch_sender_close(struct pouch_sender *sender) {}
+
+int pouch_receiver_open(struct pouch_receiver *recv, struct pouch_bearer *bearer, uint8_t window)
+{
+    if (recv->endpoint == &broker_endpoint_uplink)
+    {
+        sar.uplink = bearer;
+    }
+
+    return 0;
+}
+
+void pouch_receiver_ready(struct pouch_receiver *recv)
+{
+    atomic_inc(&sar.ready_count);
+}
+
+int pouch_receiver_recv(struct pouch_receiver *recv, const uint8_t *buf, size_t len)
+{
+    return 0;
+}
+
+void pouch_receiver_close(struct pouch_receiver *recv) {}
+
+static void on_end(struct bt_conn *conn)
+{
+    zassert_equal_ptr(conn, TEST_CONN);
+
+    end_count++;
+}
+
+/** Run the broker up to the point where it opens the uplink and downlink */
+static void start(uint16_t uplink_psm, uint16_t downlink_psm)
+{
+    device->node.server_cert_provisioned = true;
+    device->node.device_cert_provisioned = true;
+    device->node.l2cap_uplink_psm = uplink_psm;
+    device->node.l2cap_downlink_psm = downlink_psm;
+    device->chars[BROKER_BT_ATTR_INFO].handle.value = INFO_HANDLE;
+    device->chars[BROKER_BT_ATTR_DOWNLINK].handle.value = DOWNLINK_HANDLE;
+    device->chars[BROKER_BT_ATTR_UPLINK].handle.value = UPLINK_HANDLE;
+
+    zassert_ok(pouch_gateway_bt_start(TEST_CONN, on_end));
+
+    zassert_not_null(bt.discover_cb);
+    bt.discover_cb(device, true);
+    zassert_not_null(bt.link_cb);
+    bt.link_cb(device);
+
+    /* The info characteristic is read over GATT first */
+    struct bt_gatt_subscribe_params *info = bt.subs[INFO_HANDLE];
+    zassert_not_null(info);
+    info->notify(TEST_CONN, info, NULL, 0);
+}
+
+static struct bt_l2cap_chan *chan_get(uint16_t psm)
+{
+    struct bt_l2cap_chan *chan = bt.chans[psm - UPLINK_PSM];
+    zassert_not_null(chan, "No L2CAP channel for PSM 0x%x", psm);
+
+    return chan;
+}
+
+/** Accept the channel, the way the stack does when the device accepts it */
+static void chan_connected(uint16_t psm)
+{
+    struct bt_l2cap_chan *chan = chan_get(psm);
+
+    chan->conn = TEST_CONN;
+    CONTAINER_OF(chan, struct bt_l2cap_le_chan, chan)->tx.mtu = L2CAP_TX_MTU;
+    chan->ops->connected(chan);
+}
+
+static void chan_disconnected(uint16_t psm)
+{
+    struct bt_l2cap_chan *chan = chan_get(psm);
+
+    chan->ops->disconnected(chan);
+    chan->conn = NULL;
+}
+
+/** Release the oldest SDU queued in the stack */
+static void sent_release(void)
+{
+    zassert_true(bt.sent_count > 0);
+
+    net_buf_unref(bt.sent[0]);
+    memmove(&bt.sent[0], &bt.sent[1], (bt.sent_count - 1) * sizeof(bt.sent[0]));
+    bt.sent_count--;
+}
+
+static void before(void *f)
+{
+    device = broker_bt_gatt_device(TEST_CONN);
+
+    memset(&bt, 0, sizeof(bt));
+    memset(&sar, 0, sizeof(sar));
+    end_count = 0;
+}
+
+static void after(void *f)
+{
+    /* End whatever is left of the transfers, the way the stack reports it */
+    for (enum broker_bt_attr attr = BROKER_BT_ATTR_DOWNLINK; attr <= BROKER_BT_ATTR_UPLINK; attr++)
+    {
+        struct characteristic *c = &device->chars[attr];
+
+        for (int i = 0; i < 2 && c->subscribed; i++)
+        {
+            if (c->l2cap.state != L2CAP_IDLE)
+            {
+                c->l2cap.chan.chan.ops->disconnected(&c->l2cap.chan.chan);
+                c->l2cap.chan.chan.conn = NULL;
+            }
+            else
+            {
+                c->sub_params.notify(TEST_CONN, &c->sub_params, NULL, 0);
+            }
+        }
+
+        zassert_false(c->subscribed);
+    }
+
+    while (bt.sent_count > 0)
+    {
+        sent_release();
+    }
+
+    /* let the resume work run */
+    k_sleep(K_MSEC(1));
+}
+
+ZTEST(gatt_broker, test_l2cap)
+{
+    start(UPLINK_PSM, DOWNLINK_PSM);
+
+    zassert_equal(bt.l2cap_connect_count, 2);
+    zassert_is_null(bt.subs[DOWNLINK_HANDLE]);
+    zassert_is_null(bt.subs[UPLINK_HANDLE]);
+
+    /* The transport opens once the device accepts the channels */
+    zassert_is_null(sar.downlink);
+    chan_connected(DOWNLINK_PSM);
+    chan_connected(UPLINK_PSM);
+
+    zassert_not_null(sar.downlink);
+    zassert_not_null(sar.uplink);
+    zassert_equal(sar.downlink->maxlen, L2CAP_TX_MTU);
+    zassert_equal(sar.uplink->maxlen, L2CAP_TX_MTU);
+
+    /* The link is done when both channels are */
+    chan_disconnected(DOWNLINK_PSM);
+    zassert_equal(end_count, 0);
+    chan_disconnected(UPLINK_PSM);
+    zassert_equal(end_count, 1);
+    zassert_equal(bt.link_done_count, 1);
+}
+
+ZTEST(gatt_broker, test_no_psm)
+{
+    start(0, 0);
+
+    /* Devices without L2CAP channels are served over GATT */
+    zassert_equal(bt.l2cap_connect_count, 0);
+    zassert_not_null(bt.subs[DOWNLINK_HANDLE]);
+    zassert_not_null(bt.subs[UPLINK_HANDLE]);
+    zassert_equal(sar.downlink->maxlen, GATT_MTU - BT_ATT_OVERHEAD);
+    zassert_equal(sar.uplink->maxlen, GATT_MTU - BT_ATT_OVERHEAD);
+}
+
+ZTEST(gatt_broker, test_l2cap_connect_failed)
+{
+    bt.l2cap_connect_ret = -ENOMEM;
+
+    start(UPLINK_PSM, DOWNLINK_PSM);
+
+    /* Channels that can't be connected fall back to GATT right away */
+    zassert_equal(bt.l2cap_connect_count, 2);
+    zassert_not_null(bt.subs[DOWNLINK_HANDLE]);
+    zassert_not_null(bt.subs[UPLINK_HANDLE]);
+    zassert_equal(sar.downlink->maxlen, GATT_MTU - BT_ATT_OVERHEAD);
+    zassert_equal(sar.uplink->maxlen, GATT_MTU - BT_ATT_OVERHEAD);
+}
+
+ZTEST(gatt_broker, test_l2cap_rejected)
+{
+    start(UPLINK_PSM, DOWNLINK_PSM);
+
+    /* The device turns down the downlink channel, but accepts the uplink */
+    chan_disconnected(DOWNLINK_PSM);
+    chan_connected(UPLINK_PSM);
+
+    zassert_not_null(bt.subs[DOWNLINK_HANDLE]);
+    zassert_is_null(bt.subs[UPLINK_HANDLE]);
+    zassert_equal(sar.downlink->maxlen, GATT_MTU - BT_ATT_OVERHEAD);
+    zassert_equal(sar.uplink->maxlen, L2CAP_TX_MTU);
+
+    /* The transfer isn't over until both links are done */
+    zassert_equal(end_count, 0);
+    zassert_true(device->chars[BROKER_BT_ATTR_DOWNLINK].subscribed);
+}
+
+ZTEST(gatt_broker, test_l2cap_tx_pool_exhausted)
+{
+    static const uint8_t packet[] = {1, 2, 3, 4};
+
+    start(UPLINK_PSM, DOWNLINK_PSM);
+    chan_connected(DOWNLINK_PSM);
+    chan_connected(UPLINK_PSM);
+
+    for (int i = 0; i < CONFIG_POUCH_GATEWAY_GATT_L2CAP_TX_BUFS; i++)
+    {
+        zassert_ok(pouch_bearer_send(sar.downlink, packet, sizeof(packet)));
+    }
+
+    /* The pool is shared by all channels */
+    zassert_equal(pouch_bearer_send(sar.downlink, packet, sizeof(packet)), -EAGAIN);
+    zassert_equal(pouch_bearer_send(sar.uplink, packet, sizeof(packet)), -EAGAIN);
+
+    k_sleep(K_MSEC(1));
+    zassert_equal(atomic_get(&sar.ready_count), 0);
+
+    /* Releasing an SDU resumes both blocked transports */
+    sent_release();
+    k_sleep(K_MSEC(1));
+    zassert_equal(atomic_get(&sar.ready_count), 2);
+
+    zassert_ok(pouch_bearer_send(sar.downlink, packet, sizeof(packet)));
+}
+
+ZTEST(gatt_broker, test_l2cap_tx_pool_exhausted_disconnect)
+{
+    static const uint8_t packet[] = {1, 2, 3, 4};
+
+    start(UPLINK_PSM, DOWNLINK_PSM);
+    chan_connected(DOWNLINK_PSM);
+
+    for (int i = 0; i < CONFIG_POUCH_GATEWAY_GATT_L2CAP_TX_BUFS; i++)
+    {
+        zassert_ok(pouch_bearer_send(sar.downlink, packet, sizeof(packet)));
+    }
+    zassert_equal(pouch_bearer_send(sar.downlink, packet, sizeof(packet)), -EAGAIN);
+
+    chan_disconnected(DOWNLINK_PSM);
+
+    /* A channel that's gone isn't resumed when the stack releases its SDUs */
+    sent_release();
+    k_sleep(K_MSEC(1));
+    zassert_equal(atomic_get(&sar.ready_count), 0);
+}
+
+ZTEST_SUITE(gatt_broker, NULL, NULL, before, after, NULL);
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ */
+#include <zephyr/ztest.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <errno.h>
+#include <string.h>
+
+#include "broker.h"
+#include "link.h"
+
+/* Opaque to everyone but the Bluetooth stack, only ever compared by address */
+static uint8_t conn_storage;
+#define TEST_CONN ((struct bt_conn *) &conn_storage)
+
+static struct broker_bt_gatt_device device;
+
+/** State of the replaced Bluetooth stack functions */
+static struct
+{
+    int phy_ret;
+    size_t phy_count;
+    int data_len_ret;
+    size_t data_len_count;
+    int param_ret;
+    size_t param_count;
+    struct bt_le_conn_param param;
+    int mtu_ret;
+    size_t mtu_count;
+    struct bt_gatt_exchange_params *mtu_params;
+} bt;
+
+static size_t complete_count;
+
+int bt_conn_le_phy_update(struct bt_conn *conn, const struct bt_conn_le_phy_param *param)
+{
+    zassert_equal_ptr(conn, TEST_CONN);
+    zassert_equal(param->pref_tx_phy, BT_GAP_LE_PHY_2M);
+    zassert_equal(param->pref_rx_phy, BT_GAP_LE_PHY_2M);
+
+    bt.phy_count++;
+    return bt.phy_ret;
+}
+
+int bt_conn_le_data_len_update(struct bt_conn *conn, const struct bt_conn_le_data_len_param *param)
+{
+    zassert_equal_ptr(conn, TEST_CONN);
+    zassert_equal(param->tx_max_len, BT_GAP_DATA_LEN_MAX);
+
+    bt.data_len_count++;
+    return bt.data_len_ret;
+}
+
+int bt_conn_le_param_update(struct bt_conn *conn, const struct bt_le_conn_param *param)
+{
+    zassert_equal_ptr(conn, TEST_CONN);
+
+    bt.param = *param;
+    bt.param_count++;
+    return bt.param_ret;
+}
+
+int bt_gatt_exchange_mtu(struct bt_conn *conn, struct bt_gatt_exchange_params *params)
+{
+    zassert_equal_ptr(conn, TEST_CONN);
+    zassert_not_null(params->func);
+
+    bt.mtu_params = params;
+    bt.mtu_count++;
+    return bt.mtu_ret;
+}
+
+uint16_t bt_gatt_get_mtu(struct bt_conn *conn)
+{
+    return 247;
+}
+
+struct broker_bt_gatt_device *broker_bt_gatt_device(struct bt_conn *conn)
+{
+    zassert_equal_ptr(conn, TEST_CONN);
+
+    return &device;
+}
+
+static void on_complete(struct broker_bt_gatt_device *d)
+{
+    zassert_equal_ptr(d, &device);
+
+    complete_count++;
+}
+
+static void before(void *f)
+{
+    memset(&bt, 0, sizeof(bt));
+    memset(&device, 0, sizeof(device));
+    device.conn = TEST_CONN;
+    complete_count = 0;
+}
+
+static void assert_param(uint16_t interval_min, uint16_t interval_max)
+{
+    zassert_equal(bt.param_count, 1);
+    zassert_equal(bt.param.interval_min, interval_min);
+    zassert_equal(bt.param.interval_max, interval_max);
+    zassert_equal(bt.param.latency, 0);
+    zassert_equal(bt.param.timeout, CONFIG_POUCH_GATEWAY_GATT_SUPERVISION_TIMEOUT);
+}
+
+ZTEST(gatt_link, test_setup)
+{
+    device.stats.rx_bytes = 100;
+    device.stats.tx_bytes = 200;
+
+    zassert_ok(gateway_bt_link_setup(&device, on_complete));
+
+    zassert_equal(bt.phy_count, 1);
+    zassert_equal(bt.data_len_count, 1);
+    assert_param(CONFIG_POUCH_GATEWAY_GATT_TRANSFER_INTERVAL_MIN,
+                 CONFIG_POUCH_GATEWAY_GATT_TRANSFER_INTERVAL_MAX);
+    zassert_equal(bt.mtu_count, 1);
+    zassert_equal(device.stats.rx_bytes, 0);
+    zassert_equal(device.stats.tx_bytes, 0);
+
+    /* The link is ready once the MTU is settled */
+    zassert_equal(complete_count, 0);
+    bt.mtu_params->func(TEST_CONN, 0, bt.mtu_params);
+    zassert_equal(complete_count, 1);
+}
+
+ZTEST(gatt_link, test_setup_mtu_exchanged)
+{
+    bt.mtu_ret = -EALREADY;
+
+    zassert_ok(gateway_bt_link_setup(&device, on_complete));
+    zassert_equal(bt.mtu_count, 1);
+    zassert_equal(complete_count, 1);
+}
+
+ZTEST(gatt_link, test_setup_mtu_failed)
+{
+    bt.mtu_ret = -ENOMEM;
+
+    zassert_equal(gateway_bt_link_setup(&device, on_complete), -ENOMEM);
+    zassert_equal(complete_count, 0);
+}
+
+ZTEST(gatt_link, test_mtu_exchange_failed)
+{
+    zassert_ok(gateway_bt_link_setup(&device, on_complete));
+
+    /* The default MTU still works */
+    bt.mtu_params->func(TEST_CONN, BT_ATT_ERR_UNLIKELY, bt.mtu_params);
+    zassert_equal(complete_count, 1);
+}
+
+ZTEST(gatt_link, test_requests_refused)
+{
+    bt.phy_ret = -EIO;
+    bt.data_len_ret = -EIO;
+    bt.param_ret = -EALREADY;
+
+    /* The other parameters only affect the throughput */
+    zassert_ok(gateway_bt_link_setup(&device, on_complete));
+    zassert_equal(bt.mtu_count, 1);
+
+    bt.mtu_params->func(TEST_CONN, 0, bt.mtu_params);
+    zassert_equal(complete_count, 1);
+}
+
+ZTEST(gatt_link, test_done)
+{
+    gateway_bt_link_done(&device);
+
+    assert_param(CONFIG_POUCH_GATEWAY_GATT_IDLE_INTERVAL_MIN,
+                 CONFIG_POUCH_GATEWAY_GATT_IDLE_INTERVAL_MAX);
+}
+
+ZTEST(gatt_link, test_done_disconnected)
+{
+    device.conn = NULL;
+
+    gateway_bt_link_done(&device);
+
+    zassert_equal(bt.param_count, 0);
+}
+
+ZTEST_SUITE(gatt_link, NULL, NULL, before, NULL, NULL);
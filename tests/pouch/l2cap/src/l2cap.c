@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ */
+#include <zephyr/ztest.h>
+#include <zephyr/bluetooth/l2cap.h>
+#include <zephyr/net_buf.h>
+#include <errno.h>
+#include <string.h>
+
+#include "transport/sar/receiver.h"
+#include "transport/sar/sender.h"
+#include "transport/endpoints/device/endpoints.h"
+
+/* Opaque to everyone but the Bluetooth stack, only ever compared by address */
+static uint8_t conn_storage;
+#define TEST_CONN ((struct bt_conn *) &conn_storage)
+
+#define TX_MTU 48
+
+const struct pouch_endpoint pouch_device_endpoint_uplink;
+const struct pouch_endpoint pouch_device_endpoint_downlink;
+
+/** The L2CAP servers, registered by the transport at startup */
+static struct bt_l2cap_server *servers[2];
+static size_t server_count;
+/** The channels the servers accepted */
+static struct bt_l2cap_chan *chans[2];
+
+/** State of the replaced Bluetooth stack functions */
+static struct
+{
+    /** SDUs queued in the stack, which the test releases */
+    struct net_buf *sent[CONFIG_POUCH_TRANSPORT_L2CAP_TX_BUFS];
+    size_t sent_count;
+    int send_ret;
+    size_t disconnect_count;
+} bt;
+
+/** State of the replaced SAR transport */
+static struct
+{
+    struct pouch_bearer *bearer;
+    int open_ret;
+    size_t open_count;
+    size_t close_count;
+    atomic_t ready_count;
+    size_t recv_len;
+    uint8_t window;
+} sar;
+
+int bt_l2cap_server_register(struct bt_l2cap_server *server)
+{
+    zassert_true(server_count < ARRAY_SIZE(servers));
+
+    servers[server_count++] = server;
+    return 0;
+}
+
+int bt_l2cap_chan_send(struct bt_l2cap_chan *chan, struct net_buf *buf)
+{
+    zassert_equal_ptr(chan->conn, TEST_CONN);
+
+    if (bt.send_ret)
+    {
+        return bt.send_ret;
+    }
+
+    zassert_true(bt.sent_count < ARRAY_SIZE(bt.sent));
+    bt.sent[bt.sent_count++] = buf;
+    return 0;
+}
+
+int bt_l2cap_chan_disconnect(struct bt_l2cap_chan *chan)
+{
+    bt.disconnect_count++;
+    return 0;
+}
+
+int pouch_sender_open(struct pouch_sender *sender, struct pouch_bearer *bearer)
+{
+    sar.bearer = bearer;
+    sar.open_count++;
+    return sar.open_ret;
+}
+
+void pouch_sender_ready(struct pouch_sender *sender)
+{
+    atomic_inc(&sar.ready_count);
+}
+
+int pouch_sender_recv(struct pouch_sender *sender, const uint8_t *buf, size_t len)
+{
+    sar.recv_len += len;
+    return 0;
+}
+
+void pouch_sender_close(struct pouch_sender *sender)
+{
+    sar.close_count++;
+}
+
+int pouch_receiver_open(struct pouch_receiver *recv, struct pouch_bearer *bearer, uint8_t window)
+{
+    sar.bearer = bearer;
+    sar.window = window;
+    sar.open_count++;
+    return sar.open_ret;
+}
+
+void pouch_receiver_ready(struct pouch_receiver *recv)
+{
+    atomic_inc(&sar.ready_count);
+}
+
+int pouch_receiver_recv(struct pouch_receiver *recv, const uint8_t *buf, size_t len)
+{
+    sar.recv_len += len;
+    return 0;
+}
+
+void pouch_receiver_close(struct pouch_receiver *recv)
+{
+    sar.close_count++;
+}
+
+static size_t server_index(uint16_t psm)
+{
+    for (size_t i = 0; i < server_count; i++)
+    {
+        if (servers[i]->psm == psm)
+        {
+            return i;
+        }
+    }
+
+    zassert_unreachable("No server for PSM 0x%x", psm);
+    return 0;
+}
+
+static struct bt_l2cap_server *server_get(uint16_t psm)
+{
+    return servers[server_index(psm)];
+}
+
+/** Connect a channel to the server, the way the stack does when the gateway opens it */
+static struct bt_l2cap_chan *chan_connect(uint16_t psm)
+{
+    struct bt_l2cap_server *server = server_get(psm);
+    struct bt_l2cap_chan *chan = NULL;
+
+    zassert_ok(server->accept(TEST_CONN, server, &chan));
+    zassert_not_null(chan);
+    chans[server_index(psm)] = chan;
+
+    chan->conn = TEST_CONN;
+    CONTAINER_OF(chan, struct bt_l2cap_le_chan, chan)->tx.mtu = TX_MTU;
+    chan->ops->connected(chan);
+
+    return chan;
+}
+
+static void chan_disconnect(struct bt_l2cap_chan *chan)
+{
+    chan->ops->disconnected(chan);
+    chan->conn = NULL;
+}
+
+/** Release the oldest SDU queued in the stack */
+static void sent_release(void)
+{
+    zassert_true(bt.sent_count > 0);
+
+    net_buf_unref(bt.sent[0]);
+    memmove(&bt.sent[0], &bt.sent[1], (bt.sent_count - 1) * sizeof(bt.sent[0]));
+    bt.sent_count--;
+}
+
+static void fill_tx_pool(void)
+{
+    static const uint8_t packet[] = {1, 2, 3, 4};
+
+    for (int i = 0; i < CONFIG_POUCH_TRANSPORT_L2CAP_TX_BUFS; i++)
+    {
+        zassert_ok(pouch_bearer_send(sar.bearer, packet, sizeof(packet)));
+    }
+
+    zassert_equal(pouch_bearer_send(sar.bearer, packet, sizeof(packet)), -EAGAIN);
+}
+
+static void before(void *f)
+{
+    memset(&bt, 0, sizeof(bt));
+    memset(&sar, 0, sizeof(sar));
+}
+
+static void after(void *f)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(chans); i++)
+    {
+        if (chans[i] != NULL && chans[i]->conn != NULL)
+        {
+            chan_disconnect(chans[i]);
+        }
+    }
+
+    while (bt.sent_count > 0)
+    {
+        sent_release();
+    }
+
+    /* let the resume work run */
+    k_sleep(K_MSEC(1));
+}
+
+ZTEST(l2cap, test_servers)
+{
+    zassert_equal(server_count, 2);
+    zassert_not_null(server_get(CONFIG_POUCH_TRANSPORT_L2CAP_UPLINK_PSM));
+    zassert_not_null(server_get(CONFIG_POUCH_TRANSPORT_L2CAP_DOWNLINK_PSM));
+}
+
+ZTEST(l2cap, test_uplink_open)
+{
+    struct bt_l2cap_chan *chan = chan_connect(CONFIG_POUCH_TRANSPORT_L2CAP_UPLINK_PSM);
+
+    zassert_equal(sar.open_count, 1);
+    zassert_not_null(sar.bearer);
+    zassert_equal(sar.bearer->maxlen, TX_MTU);
+
+    /* Only one channel per server */
+    struct bt_l2cap_server *server = server_get(CONFIG_POUCH_TRANSPORT_L2CAP_UPLINK_PSM);
+    struct bt_l2cap_chan *second = NULL;
+    zassert_equal(server->accept(TEST_CONN, server, &second), -ENOMEM);
+
+    chan_disconnect(chan);
+    zassert_equal(sar.close_count, 1);
+}
+
+ZTEST(l2cap, test_downlink_recv)
+{
+    static const uint8_t packet[] = {1, 2, 3, 4, 5};
+    struct bt_l2cap_chan *chan = chan_connect(CONFIG_POUCH_TRANSPORT_L2CAP_DOWNLINK_PSM);
+
+    zassert_equal(sar.open_count, 1);
+    zassert_equal(sar.window, CONFIG_POUCH_TRANSPORT_L2CAP_WINDOW_SIZE);
+
+    struct net_buf *buf = chan->ops->alloc_buf(chan);
+    zassert_not_null(buf);
+    net_buf_add_mem(buf, packet, sizeof(packet));
+
+    zassert_ok(chan->ops->recv(chan, buf));
+    zassert_equal(sar.recv_len, sizeof(packet));
+
+    net_buf_unref(buf);
+}
+
+ZTEST(l2cap, test_open_failed)
+{
+    sar.open_ret = -ENOMEM;
+
+    chan_connect(CONFIG_POUCH_TRANSPORT_L2CAP_UPLINK_PSM);
+
+    zassert_equal(bt.disconnect_count, 1);
+}
+
+ZTEST(l2cap, test_tx_pool_exhausted)
+{
+    chan_connect(CONFIG_POUCH_TRANSPORT_L2CAP_UPLINK_PSM);
+
+    fill_tx_pool();
+    zassert_equal(bt.sent_count, CONFIG_POUCH_TRANSPORT_L2CAP_TX_BUFS);
+
+    k_sleep(K_MSEC(1));
+    zassert_equal(atomic_get(&sar.ready_count), 0);
+
+    /* Releasing an SDU lets the blocked transport send again */
+    sent_release();
+    k_sleep(K_MSEC(1));
+    zassert_equal(atomic_get(&sar.ready_count), 1);
+
+    static const uint8_t packet[] = {1, 2, 3, 4};
+    zassert_ok(pouch_bearer_send(sar.bearer, packet, sizeof(packet)));
+
+    /* Releasing the rest doesn't resume a transport that isn't blocked */
+    sent_release();
+    sent_release();
+    k_sleep(K_MSEC(1));
+    zassert_equal(atomic_get(&sar.ready_count), 1);
+}
+
+ZTEST(l2cap, test_tx_pool_exhausted_disconnect)
+{
+    struct bt_l2cap_chan *chan = chan_connect(CONFIG_POUCH_TRANSPORT_L2CAP_UPLINK_PSM);
+
+    fill_tx_pool();
+    chan_disconnect(chan);
+
+    /* The stack releases the SDUs after the channel is gone */
+    sent_release();
+    k_sleep(K_MSEC(1));
+    zassert_equal(atomic_get(&sar.ready_count), 0);
+}
+
+ZTEST(l2cap, test_send_failed)
+{
+    static const uint8_t packet[] = {1, 2, 3, 4};
+
+    chan_connect(CONFIG_POUCH_TRANSPORT_L2CAP_UPLINK_PSM);
+
+    bt.send_ret = -ENOTCONN;
+    zassert_equal(pouch_bearer_send(sar.bearer, packet, sizeof(packet)), -ENOTCONN);
+
+    /* The buffer went back to the pool */
+    bt.send_ret = 0;
+    fill_tx_pool();
+}
+
+ZTEST_SUITE(l2cap, NULL, NULL, before, after, NULL);
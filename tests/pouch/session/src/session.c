@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ */
+#include <zephyr/ztest.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+#include <psa/crypto.h>
+
+#include "block.h"
+#include "buf.h"
+#include "saead/session.h"
+
+#define POUCH_ID 7
+#define NONCE_LEN 12
+#define BLOCK_COUNT 3
+#define PAYLOAD_LEN 32
+
+static const uint8_t key_data[32] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
+};
+
+static struct session session;
+static uint8_t payloads[BLOCK_COUNT][PAYLOAD_LEN];
+
+/** Nonce of the block at the given index, as the server builds it */
+static void nonce_build(enum pouch_role sender, uint32_t block_index, uint8_t nonce[NONCE_LEN])
+{
+    memset(nonce, 0, NONCE_LEN);
+    sys_put_be16(POUCH_ID, &nonce[0]);
+    sys_put_be16(block_index, &nonce[2]);
+    nonce[4] = sender;
+}
+
+static struct pouch_buf *plaintext_block(const uint8_t *data, size_t len)
+{
+    struct pouch_buf *block = session_block_buf_alloc();
+    zassert_not_null(block);
+
+    block_size_write(block, len);
+    buf_write(block, data, len);
+
+    return block;
+}
+
+/** Encrypt a block for the device, the way the server does in an independent session */
+static struct pouch_buf *server_block_encrypt(uint32_t block_index, const uint8_t *data, size_t len)
+{
+    struct pouch_buf *block = buf_alloc(MAX_CIPHERTEXT_BLOCK_SIZE);
+    zassert_not_null(block);
+
+    uint8_t nonce[NONCE_LEN];
+    nonce_build(POUCH_ROLE_SERVER, block_index, nonce);
+
+    size_t ciphertext_len = len + AUTH_TAG_LEN;
+    block_size_write(block, ciphertext_len);
+
+    psa_status_t status = psa_aead_encrypt(session.key,
+                                           session.algorithm,
+                                           nonce,
+                                           sizeof(nonce),
+                                           NULL,
+                                           0,
+                                           data,
+                                           len,
+                                           buf_claim(block, ciphertext_len),
+                                           ciphertext_len,
+                                           &ciphertext_len);
+    zassert_equal(status, PSA_SUCCESS);
+
+    return block;
+}
+
+/** Decrypt a device block, the way the server does in an independent session */
+static psa_status_t device_block_decrypt(struct pouch_buf *block,
+                                         uint32_t block_index,
+                                         uint8_t *data,
+                                         size_t *len)
+{
+    struct pouch_bufview v;
+    uint16_t ciphertext_len;
+    uint8_t nonce[NONCE_LEN];
+
+    nonce_build(POUCH_ROLE_DEVICE, block_index, nonce);
+
+    pouch_bufview_init(&v, block);
+    zassert_ok(pouch_bufview_read_be16(&v, &ciphertext_len));
+
+    return psa_aead_decrypt(session.key,
+                            session.algorithm,
+                            nonce,
+                            sizeof(nonce),
+                            NULL,
+                            0,
+                            pouch_bufview_read(&v, ciphertext_len),
+                            ciphertext_len,
+                            data,
+                            *len,
+                            len);
+}
+
+static void assert_plaintext(struct pouch_buf *block, const uint8_t *data, size_t len)
+{
+    struct pouch_bufview v;
+    uint16_t plaintext_len;
+
+    pouch_bufview_init(&v, block);
+    zassert_ok(pouch_bufview_read_be16(&v, &plaintext_len));
+    zassert_equal(plaintext_len, len);
+    zassert_equal(pouch_bufview_available(&v), len);
+    zassert_mem_equal(pouch_bufview_read(&v, len), data, len);
+}
+
+static void *suite_setup(void)
+{
+    zassert_equal(psa_crypto_init(), PSA_SUCCESS);
+
+    for (int i = 0; i < BLOCK_COUNT; i++)
+    {
+        memset(payloads[i], 'a' + i, PAYLOAD_LEN);
+    }
+
+    return NULL;
+}
+
+static void before(void *f)
+{
+    psa_key_attributes_t attributes = PSA_KEY_ATTRIBUTES_INIT;
+
+    psa_set_key_type(&attributes, PSA_KEY_TYPE_CHACHA20);
+    psa_set_key_bits(&attributes, 256);
+    psa_set_key_algorithm(&attributes, PSA_ALG_CHACHA20_POLY1305);
+    psa_set_key_usage_flags(&attributes, PSA_KEY_USAGE_ENCRYPT | PSA_KEY_USAGE_DECRYPT);
+
+    memset(&session, 0, sizeof(session));
+    session.algorithm = PSA_ALG_CHACHA20_POLY1305;
+    session.block_mode = SESSION_BLOCK_MODE_INDEPENDENT;
+
+    zassert_equal(psa_import_key(&attributes, key_data, sizeof(key_data), &session.key),
+                  PSA_SUCCESS);
+
+    pouch_atomic_set_bit(&session.flags, SESSION_ACTIVE);
+    zassert_ok(session_pouch_start(&session, POUCH_ID));
+}
+
+static void after(void *f)
+{
+    session_end(&session);
+}
+
+ZTEST(session, test_uplink_round_trip)
+{
+    struct pouch_buf *blocks[BLOCK_COUNT];
+
+    for (int i = 0; i < BLOCK_COUNT; i++)
+    {
+        struct pouch_buf *plaintext = plaintext_block(payloads[i], PAYLOAD_LEN);
+        blocks[i] = session_encrypt_block(&session, plaintext);
+        buf_free(plaintext);
+        zassert_not_null(blocks[i]);
+    }
+
+    /* Every block can be decrypted on its own, in any order */
+    for (int i = BLOCK_COUNT - 1; i >= 0; i--)
+    {
+        uint8_t data[PAYLOAD_LEN];
+        size_t len = sizeof(data);
+
+        zassert_equal(device_block_decrypt(blocks[i], i, data, &len), PSA_SUCCESS);
+        zassert_equal(len, PAYLOAD_LEN);
+        zassert_mem_equal(data, payloads[i], PAYLOAD_LEN);
+    }
+
+    /* ...but only at its own position in the pouch */
+    uint8_t data[PAYLOAD_LEN];
+    size_t len = sizeof(data);
+    zassert_not_equal(device_block_decrypt(blocks[1], 2, data, &len), PSA_SUCCESS);
+
+    for (int i = 0; i < BLOCK_COUNT; i++)
+    {
+        buf_free(blocks[i]);
+    }
+}
+
+ZTEST(session, test_decrypt_in_order)
+{
+    for (int i = 0; i < BLOCK_COUNT; i++)
+    {
+        struct pouch_buf *block = server_block_encrypt(i, payloads[i], PAYLOAD_LEN);
+
+        zassert_ok(session_decrypt_block(&session, block));
+        assert_plaintext(block, payloads[i], PAYLOAD_LEN);
+
+        buf_free(block);
+    }
+}
+
+ZTEST(session, test_decrypt_out_of_order)
+{
+    static const uint32_t order[BLOCK_COUNT] = {2, 0, 1};
+
+    for (int i = 0; i < BLOCK_COUNT; i++)
+    {
+        uint32_t index = order[i];
+        struct pouch_buf *block = server_block_encrypt(index, payloads[index], PAYLOAD_LEN);
+
+        zassert_ok(session_decrypt_block_at(&session, block, index));
+        assert_plaintext(block, payloads[index], PAYLOAD_LEN);
+
+        buf_free(block);
+    }
+
+    /* Decrypting at an index doesn't move the session on */
+    zassert_equal(session.pouch.block_index, 0);
+}
+
+ZTEST(session, test_decrypt_resume)
+{
+    /* Start in the middle of the pouch, without the blocks before */
+    struct pouch_buf *block = server_block_encrypt(2, payloads[2], PAYLOAD_LEN);
+
+    zassert_ok(session_decrypt_block_at(&session, block, 2));
+    assert_plaintext(block, payloads[2], PAYLOAD_LEN);
+
+    buf_free(block);
+}
+
+ZTEST(session, test_decrypt_tampered)
+{
+    struct pouch_buf *block = server_block_encrypt(1, payloads[1], PAYLOAD_LEN);
+
+    /* Flip a bit in the ciphertext, after the size field */
+    buf_next(block)[-AUTH_TAG_LEN - 1] ^= 0x01;
+
+    zassert_not_equal(session_decrypt_block_at(&session, block, 1), 0);
+
+    buf_free(block);
+
+    /* A tampered tag is rejected the same way */
+    block = server_block_encrypt(1, payloads[1], PAYLOAD_LEN);
+    buf_next(block)[-1] ^= 0x80;
+
+    zassert_not_equal(session_decrypt_block_at(&session, block, 1), 0);
+
+    buf_free(block);
+}
+
+ZTEST(session, test_decrypt_moved)
+{
+    struct pouch_buf *block = server_block_encrypt(1, payloads[1], PAYLOAD_LEN);
+
+    /* A block is bound to its position, and can't be replayed at another index */
+    zassert_not_equal(session_decrypt_block_at(&session, block, 2), 0);
+    zassert_not_equal(session_decrypt_block_at(&session, block, 0), 0);
+
+    buf_free(block);
+
+    /* The same goes for the sequential path, where the block is expected at index 0 */
+    block = server_block_encrypt(1, payloads[1], PAYLOAD_LEN);
+
+    zassert_not_equal(session_decrypt_block(&session, block), 0);
+    zassert_equal(session.pouch.block_index, 0);
+
+    buf_free(block);
+}
+
+ZTEST(session, test_decrypt_at_chained)
+{
+    struct pouch_buf *block = server_block_encrypt(0, payloads[0], PAYLOAD_LEN);
+
+    /* Chained blocks can't be decrypted without the blocks before them */
+    session.block_mode = SESSION_BLOCK_MODE_CHAINED;
+
+    zassert_equal(session_decrypt_block_at(&session, block, 0), -ENOTSUP);
+
+    buf_free(block);
+}
+
+ZTEST_SUITE(session, NULL, suite_setup, before, after, NULL);
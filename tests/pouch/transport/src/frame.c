@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ */
+#include <zephyr/ztest.h>
+#include <string.h>
+#include "transport/serial/frame.h"
+
+#define PACKET_MAX 600
+
+static uint8_t decode_buf[PACKET_MAX + POUCH_FRAME_OVERHEAD];
+static uint8_t encoded[POUCH_FRAME_ENCODED_MAX(PACKET_MAX) * 2];
+static uint8_t packet[PACKET_MAX];
+static struct pouch_frame_decoder decoder;
+
+static struct
+{
+    int frames;
+    uint8_t channel;
+    uint8_t data[PACKET_MAX];
+    size_t len;
+} received;
+
+static void handler(void *ctx, uint8_t channel, uint8_t *data, size_t len)
+{
+    zassert_equal(ctx, &received);
+    zassert_true(len <= sizeof(received.data));
+
+    received.frames++;
+    received.channel = channel;
+    received.len = len;
+    memcpy(received.data, data, len);
+}
+
+static void reset(void *f)
+{
+    memset(&received, 0, sizeof(received));
+    pouch_frame_decoder_init(&decoder, decode_buf, sizeof(decode_buf), handler, &received);
+}
+
+static void assert_no_zeros(const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len - 1; i++)
+    {
+        zassert_not_equal(data[i], POUCH_FRAME_DELIMITER, "Zero byte at %u", i);
+    }
+
+    zassert_equal(data[len - 1], POUCH_FRAME_DELIMITER);
+}
+
+static void assert_received(uint8_t channel, const uint8_t *data, size_t len)
+{
+    zassert_equal(received.frames, 1);
+    zassert_equal(received.channel, channel);
+    zassert_equal(received.len, len);
+    zassert_mem_equal(received.data, data, len);
+}
+
+/** Encode and decode a packet, checking that it survives the round trip */
+static void round_trip(uint8_t channel, size_t len)
+{
+    size_t encoded_len = pouch_frame_encode(channel, packet, len, encoded);
+    zassert_true(encoded_len <= POUCH_FRAME_ENCODED_MAX(len));
+    assert_no_zeros(encoded, encoded_len);
+
+    zassert_equal(pouch_frame_decoder_push(&decoder, encoded, encoded_len), 0);
+    assert_received(channel, packet, len);
+
+    received.frames = 0;
+}
+
+ZTEST_SUITE(transport_frame, NULL, NULL, reset, NULL, NULL);
+
+ZTEST(transport_frame, test_round_trip)
+{
+    for (size_t i = 0; i < 32; i++)
+    {
+        packet[i] = i * 7 + 1;
+    }
+
+    round_trip(3, 32);
+}
+
+ZTEST(transport_frame, test_empty_packet)
+{
+    round_trip(0, 0);
+}
+
+ZTEST(transport_frame, test_zeros)
+{
+    memset(packet, 0, sizeof(packet));
+
+    round_trip(0, 1);
+    round_trip(0, 2);
+    round_trip(0, 300);
+}
+
+ZTEST(transport_frame, test_long_runs)
+{
+    // Runs of non-zero bytes around the COBS block length:
+    for (size_t len = 250; len <= 260; len++)
+    {
+        memset(packet, 0xaa, len);
+        round_trip(1, len);
+    }
+
+    memset(packet, 0x55, PACKET_MAX);
+    round_trip(1, PACKET_MAX);
+
+    // A zero right after a full block:
+    memset(packet, 0xaa, PACKET_MAX);
+    packet[253] = 0;
+    packet[254] = 0;
+    round_trip(1, PACKET_MAX);
+}
+
+ZTEST(transport_frame, test_split_pushes)
+{
+    for (size_t i = 0; i < 300; i++)
+    {
+        packet[i] = i;
+    }
+
+    size_t encoded_len = pouch_frame_encode(2, packet, 300, encoded);
+
+    for (size_t i = 0; i < encoded_len; i++)
+    {
+        zassert_equal(pouch_frame_decoder_push(&decoder, &encoded[i], 1), 0);
+        zassert_equal(received.frames, (i == encoded_len - 1) ? 1 : 0);
+    }
+
+    assert_received(2, packet, 300);
+}
+
+ZTEST(transport_frame, test_back_to_back)
+{
+    memset(packet, 0x11, 20);
+
+    size_t len = pouch_frame_encode(1, packet, 20, encoded);
+    len += pouch_frame_encode(1, packet, 20, &encoded[len]);
+
+    zassert_equal(pouch_frame_decoder_push(&decoder, encoded, len), 0);
+    zassert_equal(received.frames, 2);
+}
+
+ZTEST(transport_frame, test_repeated_delimiters)
+{
+    const uint8_t delimiters[] = {0, 0, 0};
+
+    zassert_equal(pouch_frame_decoder_push(&decoder, delimiters, sizeof(delimiters)), 0);
+    zassert_equal(received.frames, 0);
+
+    memset(packet, 0x22, 10);
+    round_trip(4, 10);
+}
+
+ZTEST(transport_frame, test_bad_crc)
+{
+    memset(packet, 0x33, 16);
+
+    size_t len = pouch_frame_encode(1, packet, 16, encoded);
+    encoded[5] ^= 0x01;
+
+    zassert_equal(pouch_frame_decoder_push(&decoder, encoded, len), 1);
+    zassert_equal(received.frames, 0);
+
+    // The next frame is unaffected:
+    round_trip(1, 16);
+}
+
+ZTEST(transport_frame, test_truncated)
+{
+    memset(packet, 0x44, 16);
+
+    size_t len = pouch_frame_encode(1, packet, 16, encoded);
+
+    // Lose the middle of the frame, but keep the delimiter:
+    encoded[8] = POUCH_FRAME_DELIMITER;
+    zassert_equal(pouch_frame_decoder_push(&decoder, encoded, len), 2);
+    zassert_equal(received.frames, 0);
+
+    round_trip(1, 16);
+}
+
+ZTEST(transport_frame, test_too_short)
+{
+    const uint8_t frame[] = {0x02, 0x01, 0x00};
+
+    zassert_equal(pouch_frame_decoder_push(&decoder, frame, sizeof(frame)), 1);
+    zassert_equal(received.frames, 0);
+}
+
+ZTEST(transport_frame, test_overflow)
+{
+    uint8_t small[16];
+    pouch_frame_decoder_init(&decoder, small, sizeof(small), handler, &received);
+
+    memset(packet, 0x66, 32);
+    size_t len = pouch_frame_encode(1, packet, 32, encoded);
+    zassert_equal(pouch_frame_decoder_push(&decoder, encoded, len), 1);
+    zassert_equal(received.frames, 0);
+
+    // Frames that fit are still accepted:
+    round_trip(1, sizeof(small) - POUCH_FRAME_OVERHEAD);
+}
@@ -27,6 +27,7 @@ enum endpoint_flags
     ENDPOINT_ENDED,
     ENDPOINT_FAILED,
     ENDPOINT_FAIL_RECV,
+    ENDPOINT_BUSY_RECV,
     ENDPOINT_EXPECT_START,
     ENDPOINT_EXPECT_RECV,
     ENDPOINT_EXPECT_DATA_REQ,
@@ -37,6 +38,7 @@ static struct
 {
     size_t available_data;
     size_t received_data;
+    size_t acked_data;
     atomic_t send_calls;
     atomic_t recv_calls;
     atomic_t flags;
@@ -97,6 +99,11 @@ static int recv(struct pouch_bearer *bearer, const void *buf, size_t len)
     zassert_true(atomic_test_bit(&test_endpoint.flags, ENDPOINT_STARTED));
     zassert_false(atomic_test_bit(&test_endpoint.flags, ENDPOINT_ENDED));
 
+    if (atomic_test_bit(&test_endpoint.flags, ENDPOINT_BUSY_RECV))
+    {
+        return -EAGAIN;
+    }
+
     test_endpoint.received_data += len;
     atomic_inc(&test_endpoint.recv_calls);
 
@@ -33,8 +33,9 @@ enum bearer_flags
 static struct
 {
     atomic_t flags;
-    uint8_t ack_seq;
-    uint8_t ack_window;
+    uint16_t ack_seq;
+    uint16_t ack_window;
+    bool ack_ext;
     atomic_t acks;
     struct k_sem sem;
 } test_bearer;
@@ -60,6 +61,7 @@ static int bearer_send(struct pouch_bearer *bearer, const uint8_t *buf, size_t l
 
     test_bearer.ack_seq = pkt.seq;
     test_bearer.ack_window = pkt.window;
+    test_bearer.ack_ext = pkt.ext;
 
     k_sem_give(&test_bearer.sem);
 
@@ -220,7 +222,8 @@ ZTEST(transport_sar_receiver, test_invalid_duplicate_first_packet)
     uint8_t buf[2] = {POUCH_SAR_TX_PKT_FLAG_FIRST};
     zassert_ok(pouch_receiver_recv(&receiver, buf, sizeof(buf)));
 
-    // FIRST again
+    // FIRST again, in the next packet
+    buf[1]++;
     atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_END);
     atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_CLOSE);
     zassert_not_ok(pouch_receiver_recv(&receiver, buf, sizeof(buf)));
@@ -229,6 +232,85 @@ ZTEST(transport_sar_receiver, test_invalid_duplicate_first_packet)
     zassert_true(atomic_test_bit(&test_endpoint.flags, ENDPOINT_ENDED));
 }
 
+ZTEST(transport_sar_receiver, test_retransmitted_first_packet)
+{
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+
+    zassert_ok(pouch_receiver_open(&receiver, &bearer, 4));
+
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(1)));
+
+    uint8_t buf[2] = {POUCH_SAR_TX_PKT_FLAG_FIRST};
+    zassert_ok(pouch_receiver_recv(&receiver, buf, sizeof(buf)));
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(10)));
+    zassert_equal(test_bearer.ack_seq, 0);
+
+    // The sender didn't get the ack, and sends the same packet again:
+    zassert_ok(pouch_receiver_recv(&receiver, buf, sizeof(buf)));
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(10)));
+    zassert_equal(test_bearer.ack_seq, 0);
+
+    zassert_false(atomic_test_bit(&test_bearer.flags, BEARER_CLOSED));
+}
+
+ZTEST(transport_sar_receiver, test_rx_ooo_last_packet)
+{
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_RECV);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+
+    zassert_ok(pouch_receiver_open(&receiver, &bearer, 4));
+
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(1)));
+
+    uint8_t data = 0xaa;
+    uint8_t buf[3];
+    size_t len = sizeof(buf);
+    struct pouch_sar_tx_pkt pkt = {
+        .flags = POUCH_SAR_TX_PKT_FLAG_FIRST,
+        .data = &data,
+        .len = sizeof(data),
+    };
+    zassert_ok(pouch_sar_tx_pkt_encode(&pkt, buf, &len));
+    zassert_ok(pouch_receiver_recv(&receiver, buf, len));
+
+    // The packet before the last one is lost:
+    pkt.flags = POUCH_SAR_TX_PKT_FLAG_LAST;
+    pkt.seq = 2;
+    len = sizeof(buf);
+    zassert_ok(pouch_sar_tx_pkt_encode(&pkt, buf, &len));
+    zassert_ok(pouch_receiver_recv(&receiver, buf, len));
+    zassert_equal(test_endpoint.received_data, 1);
+
+    // The sender goes back, and sends both packets again:
+    pkt.flags = 0;
+    pkt.seq = 1;
+    len = sizeof(buf);
+    zassert_ok(pouch_sar_tx_pkt_encode(&pkt, buf, &len));
+    zassert_ok(pouch_receiver_recv(&receiver, buf, len));
+
+    pkt.flags = POUCH_SAR_TX_PKT_FLAG_LAST;
+    pkt.seq = 2;
+    len = sizeof(buf);
+    zassert_ok(pouch_sar_tx_pkt_encode(&pkt, buf, &len));
+    zassert_ok(pouch_receiver_recv(&receiver, buf, len));
+    zassert_equal(test_endpoint.received_data, 3);
+
+    struct pouch_sar_tx_pkt fin = {
+        .flags = POUCH_SAR_TX_PKT_FLAG_FIN | POUCH_SAR_TX_PKT_FLAG_IDLE,
+    };
+    len = sizeof(buf);
+    zassert_ok(pouch_sar_tx_pkt_encode(&fin, buf, &len));
+
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_END);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_CLOSE);
+    zassert_ok(pouch_receiver_recv(&receiver, buf, len));
+
+    zassert_true(atomic_test_bit(&test_bearer.flags, BEARER_CLOSED));
+    zassert_true(atomic_test_bit(&test_endpoint.flags, ENDPOINT_ENDED));
+}
+
 ZTEST(transport_sar_receiver, test_rx_single_packet_transfer)
 {
     atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
@@ -631,6 +713,43 @@ ZTEST(transport_sar_receiver, test_endpoint_recv_fails)
     zassert_ok(pouch_sar_rx_pkt_decode(ack_buf, sizeof(ack_buf), &decoded));
 }
 
+ZTEST(transport_sar_receiver, test_endpoint_busy)
+{
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+
+    zassert_ok(pouch_receiver_open(&receiver, &bearer, 4));
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(10)));
+
+    uint8_t data = 0xaa;
+    uint8_t buf[10];
+    size_t len = sizeof(buf);
+    struct pouch_sar_tx_pkt pkt = {
+        .flags = POUCH_SAR_TX_PKT_FLAG_FIRST,
+        .data = &data,
+        .len = sizeof(data),
+    };
+    zassert_ok(pouch_sar_tx_pkt_encode(&pkt, buf, &len));
+
+    // The endpoint is out of buffers, so the packet is dropped without ending the transfer:
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_RECV);
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_BUSY_RECV);
+    zassert_ok(pouch_receiver_recv(&receiver, buf, len));
+
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(10)));
+    zassert_equal(test_bearer.ack_seq, POUCH_SAR_SEQ_MAX);
+    zassert_equal(test_endpoint.received_data, 0);
+    zassert_false(atomic_test_bit(&test_bearer.flags, BEARER_CLOSED));
+
+    // The sender sends it again once the endpoint has caught up:
+    atomic_clear_bit(&test_endpoint.flags, ENDPOINT_BUSY_RECV);
+    zassert_ok(pouch_receiver_recv(&receiver, buf, len));
+
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(10)));
+    zassert_equal(test_bearer.ack_seq, 0);
+    zassert_equal(test_endpoint.received_data, sizeof(data));
+}
+
 ZTEST(transport_sar_receiver, test_bearer_send_ack_fails)
 {
     atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
@@ -699,6 +818,182 @@ ZTEST(transport_sar_receiver, test_ack_timeout_retransmission)
     zassert_equal(test_bearer.ack_window, ack_window);
 }
 
+#if CONFIG_POUCH_TRANSPORT_SAR_ADAPTIVE_WINDOW
+
+static void recv_data_packet(uint8_t seq, enum pouch_sar_tx_pkt_flag flags)
+{
+    uint8_t data = 0xaa;
+    uint8_t buf[3];
+    size_t len = sizeof(buf);
+    struct pouch_sar_tx_pkt pkt = {
+        .seq = seq,
+        .flags = flags,
+        .data = &data,
+        .len = sizeof(data),
+    };
+    zassert_ok(pouch_sar_tx_pkt_encode(&pkt, buf, &len));
+    zassert_ok(pouch_receiver_recv(&receiver, buf, len));
+
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(CONFIG_POUCH_TRANSPORT_SAR_ACK_DELAY_MS + 10)));
+}
+
+ZTEST(transport_sar_receiver, test_window_grows)
+{
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_RECV);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+
+    zassert_ok(pouch_receiver_open(&receiver, &bearer, 2));
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(10)));
+    zassert_equal(test_bearer.ack_window, 2);
+
+    recv_data_packet(0, POUCH_SAR_TX_PKT_FLAG_FIRST);
+    zassert_equal(test_bearer.ack_seq, 0);
+    zassert_equal(test_bearer.ack_window, 2);
+
+    // A full window was received in order:
+    recv_data_packet(1, 0);
+    zassert_equal(test_bearer.ack_seq, 1);
+    zassert_equal(test_bearer.ack_window, 3);
+}
+
+ZTEST(transport_sar_receiver, test_window_shrinks_on_ooo)
+{
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_RECV);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+
+    zassert_ok(pouch_receiver_open(&receiver, &bearer, 4));
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(10)));
+
+    recv_data_packet(0, POUCH_SAR_TX_PKT_FLAG_FIRST);
+    zassert_equal(test_bearer.ack_window, 4);
+
+    // Packet 1 is lost. The window is halved, but the sender may still send up to seq 4:
+    recv_data_packet(2, 0);
+    zassert_equal(test_bearer.ack_seq, 0);
+    zassert_equal(test_bearer.ack_window, 4);
+
+    recv_data_packet(1, 0);
+    zassert_equal(test_bearer.ack_seq, 1);
+    zassert_equal(test_bearer.ack_window, 3);
+
+    recv_data_packet(2, 0);
+    zassert_equal(test_bearer.ack_seq, 2);
+    zassert_equal(test_bearer.ack_window, 2);
+}
+
+#if CONFIG_POUCH_TRANSPORT_SAR_ACK_EVERY > 1
+
+ZTEST(transport_sar_receiver, test_coalesced_acks)
+{
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_RECV);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+
+    zassert_ok(pouch_receiver_open(&receiver, &bearer, 16));
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(10)));
+
+    uint8_t data = 0xaa;
+    uint8_t buf[3];
+    size_t len = sizeof(buf);
+    struct pouch_sar_tx_pkt pkt = {
+        .flags = POUCH_SAR_TX_PKT_FLAG_FIRST,
+        .data = &data,
+        .len = sizeof(data),
+    };
+
+    // The first packet is acked right away:
+    zassert_ok(pouch_sar_tx_pkt_encode(&pkt, buf, &len));
+    zassert_ok(pouch_receiver_recv(&receiver, buf, len));
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(10)));
+    zassert_equal(test_bearer.ack_seq, 0);
+    zassert_equal(test_bearer.acks, 2);
+
+    // The following packets are coalesced into a single ack:
+    pkt.flags = 0;
+    for (int i = 1; i <= CONFIG_POUCH_TRANSPORT_SAR_ACK_EVERY; i++)
+    {
+        zassert_equal(test_bearer.acks, 2);
+
+        pkt.seq++;
+        len = sizeof(buf);
+        zassert_ok(pouch_sar_tx_pkt_encode(&pkt, buf, &len));
+        zassert_ok(pouch_receiver_recv(&receiver, buf, len));
+    }
+
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(10)));
+    zassert_equal(test_bearer.ack_seq, CONFIG_POUCH_TRANSPORT_SAR_ACK_EVERY);
+    zassert_equal(test_bearer.acks, 3);
+
+    // A single packet is acked after the coalescing delay:
+    pkt.seq++;
+    len = sizeof(buf);
+    zassert_ok(pouch_sar_tx_pkt_encode(&pkt, buf, &len));
+    zassert_ok(pouch_receiver_recv(&receiver, buf, len));
+    zassert_not_ok(k_sem_take(&test_bearer.sem, K_NO_WAIT));
+
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(CONFIG_POUCH_TRANSPORT_SAR_ACK_DELAY_MS + 10)));
+    zassert_equal(test_bearer.ack_seq, pkt.seq);
+    zassert_equal(test_bearer.acks, 4);
+}
+
+#endif
+
+#if CONFIG_POUCH_TRANSPORT_SAR_EXT
+
+ZTEST(transport_sar_receiver, test_ext_transfer)
+{
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_RECV);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+
+    zassert_ok(pouch_receiver_open_ext(&receiver, &bearer, 300));
+
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(10)));
+    zassert_true(test_bearer.ack_ext);
+    zassert_equal(test_bearer.ack_seq, POUCH_SAR_EXT_SEQ_MAX);
+    zassert_equal(test_bearer.ack_window, 300);
+
+    uint8_t data = 0xaa;
+    uint8_t buf[4];
+    size_t len = sizeof(buf);
+    struct pouch_sar_tx_pkt pkt = {
+        .flags = POUCH_SAR_TX_PKT_FLAG_FIRST | POUCH_SAR_TX_PKT_FLAG_EXT,
+        .data = &data,
+        .len = sizeof(data),
+    };
+    zassert_ok(pouch_sar_tx_pkt_encode(&pkt, buf, &len));
+    zassert_equal(len, POUCH_SAR_TX_PKT_EXT_HEADER_LEN + sizeof(data));
+    zassert_ok(pouch_receiver_recv(&receiver, buf, len));
+
+    zassert_ok(k_sem_take(&test_bearer.sem, K_MSEC(10)));
+    zassert_true(test_bearer.ack_ext);
+    zassert_equal(test_bearer.ack_seq, 0);
+    zassert_equal(test_endpoint.received_data, 1);
+
+    // Packets without the extended header are rejected:
+    pkt.flags = 0;
+    pkt.seq = 1;
+    len = sizeof(buf);
+    zassert_ok(pouch_sar_tx_pkt_encode(&pkt, buf, &len));
+
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_END);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_CLOSE);
+    zassert_not_ok(pouch_receiver_recv(&receiver, buf, len));
+    zassert_true(atomic_test_bit(&test_bearer.flags, BEARER_CLOSED));
+}
+
+ZTEST(transport_sar_receiver, test_ext_invalid_window)
+{
+    zassert_equal(pouch_receiver_open_ext(&receiver, &bearer, POUCH_SAR_EXT_WINDOW_MAX + 1),
+                  -EINVAL);
+
+    zassert_false(atomic_test_bit(&test_endpoint.flags, ENDPOINT_STARTED));
+}
+
+#endif
+
 ZTEST(transport_sar_receiver, test_double_close)
 {
     atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
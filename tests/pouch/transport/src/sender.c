@@ -29,6 +29,9 @@ enum bearer_flags
     BEARER_EXPECT_SEND,
     BEARER_EXPECT_CLOSE,
     BEARER_FAIL_SEND_ONCE,
+    BEARER_BUSY_ONCE,
+    BEARER_EXPECT_RETRANSMIT,
+    BEARER_SENT_EXT,
 };
 
 static struct
@@ -36,6 +39,10 @@ static struct
     size_t sent_data;
     atomic_t sent_packets;
     atomic_t flags;
+    uint16_t last_seq;
+    atomic_t sendv_calls;
+    /** Number of packets the next vectored send accepts, or 0 to accept all of them */
+    size_t sendv_accept;
 } test_bearer;
 
 static void bearer_ready(struct pouch_bearer *bearer)
@@ -52,6 +59,10 @@ static int bearer_send(struct pouch_bearer *bearer, const uint8_t *buf, size_t l
     {
         return -EIO;
     }
+    if (atomic_test_and_clear_bit(&test_bearer.flags, BEARER_BUSY_ONCE))
+    {
+        return -EAGAIN;
+    }
 
     struct pouch_sar_tx_pkt pkt;
     zassert_ok(pouch_sar_tx_pkt_decode(buf, len, &pkt));
@@ -60,6 +71,12 @@ static int bearer_send(struct pouch_bearer *bearer, const uint8_t *buf, size_t l
         atomic_set_bit(&test_bearer.flags, BEARER_SENT_FIN);
         atomic_inc(&test_bearer.sent_packets);
     }
+    else if (atomic_test_bit(&test_bearer.flags, BEARER_EXPECT_RETRANSMIT))
+    {
+        // Retransmitted packets reuse their seqnum:
+        atomic_inc(&test_bearer.sent_packets);
+        test_bearer.last_seq = pkt.seq;
+    }
     else
     {
         // FIN packets don't have a seq, but for everything else, we want to validate the seqnum:
@@ -69,12 +86,47 @@ static int bearer_send(struct pouch_bearer *bearer, const uint8_t *buf, size_t l
     {
         atomic_set_bit(&test_bearer.flags, BEARER_SENT_LAST_PACKET);
     }
+    if (pkt.flags & POUCH_SAR_TX_PKT_FLAG_EXT)
+    {
+        atomic_set_bit(&test_bearer.flags, BEARER_SENT_EXT);
+    }
 
     test_bearer.sent_data += pkt.len;
 
     return 0;
 }
 
+static int bearer_sendv(struct pouch_bearer *bearer,
+                        const struct pouch_bearer_pkt *pkts,
+                        size_t count)
+{
+    atomic_inc(&test_bearer.sendv_calls);
+
+    size_t accept = count;
+    if (test_bearer.sendv_accept && test_bearer.sendv_accept < count)
+    {
+        // Take some of the packets, and report busy on the next attempt:
+        accept = test_bearer.sendv_accept;
+        test_bearer.sendv_accept = 0;
+    }
+
+    for (size_t i = 0; i < accept; i++)
+    {
+        int err = bearer_send(bearer, pkts[i].buf, pkts[i].len);
+        if (err)
+        {
+            return (i > 0) ? (int) i : err;
+        }
+    }
+
+    if (accept < count)
+    {
+        atomic_set_bit(&test_bearer.flags, BEARER_BUSY_ONCE);
+    }
+
+    return accept;
+}
+
 static void bearer_close(struct pouch_bearer *bearer, bool success)
 {
     zassert_true(atomic_test_bit(&test_bearer.flags, BEARER_EXPECT_CLOSE));
@@ -92,9 +144,25 @@ static void reset_mocks(void)
     memset(&test_endpoint, 0, sizeof(test_endpoint));
     memset(&test_bearer, 0, sizeof(test_bearer));
     bearer.maxlen = 10;
+    bearer.sendv = NULL;
 }
 
 
+static void ack(struct pouch_bearer *bearer, size_t len)
+{
+    zassert_true(atomic_test_bit(&test_endpoint.flags, ENDPOINT_STARTED));
+    zassert_false(atomic_test_bit(&test_endpoint.flags, ENDPOINT_ENDED));
+
+    test_endpoint.acked_data += len;
+}
+
+static const struct pouch_endpoint endpoint_with_ack = {
+    .start = start,
+    .send = send,
+    .end = end,
+    .ack = ack,
+};
+
 static struct pouch_sender sender = {
     .endpoint = &endpoint,
 };
@@ -103,6 +171,11 @@ static void reset(void *unused)
 {
     reset_mocks();
 
+#if CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT
+    pouch_work_cancel_delayable(&sender.rtx.work);
+    k_sleep(K_MSEC(1));
+#endif
+
     sender = (struct pouch_sender){
         .endpoint = &endpoint,
     };
@@ -254,6 +327,135 @@ ZTEST(transport_sar_sender, test_recv_acks)
     zassert_equal(test_bearer.sent_data, 5 * (bearer.maxlen - 2), "got %u", test_bearer.sent_data);
 }
 
+ZTEST(transport_sar_sender, test_recv_acks_confirm_data)
+{
+    sender.endpoint = &endpoint_with_ack;
+
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    zassert_ok(pouch_sender_open(&sender, &bearer));
+
+    struct pouch_sar_rx_pkt ack = {
+        .code = POUCH_RECEIVER_CODE_ACK,
+        .seq = 0xff,
+        .window = 4,
+    };
+    uint8_t buf[POUCH_SAR_RX_PKT_LEN];
+    pouch_sar_rx_pkt_encode(&ack, buf);
+
+    test_endpoint.available_data = 3 * (bearer.maxlen - 2) + 5;
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_DATA_REQ);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+
+    // Nothing is confirmed until the receiver acks it:
+    zassert_ok(pouch_sender_recv(&sender, buf, sizeof(buf)));
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 4);
+    zassert_equal(test_endpoint.acked_data, 0);
+
+    // ack the first two packets:
+    ack.seq = 1;
+    pouch_sar_rx_pkt_encode(&ack, buf);
+    zassert_ok(pouch_sender_recv(&sender, buf, sizeof(buf)));
+    zassert_equal(test_endpoint.acked_data, 2 * (bearer.maxlen - 2));
+
+    // repeated acks don't confirm anything new:
+    zassert_ok(pouch_sender_recv(&sender, buf, sizeof(buf)));
+    zassert_equal(test_endpoint.acked_data, 2 * (bearer.maxlen - 2));
+
+    // ack the rest, including the short packet:
+    ack.seq = 3;
+    pouch_sar_rx_pkt_encode(&ack, buf);
+    zassert_ok(pouch_sender_recv(&sender, buf, sizeof(buf)));
+    zassert_equal(test_endpoint.acked_data, 3 * (bearer.maxlen - 2) + 5);
+}
+
+ZTEST(transport_sar_sender, test_recv_stale_ack)
+{
+    sender.endpoint = &endpoint_with_ack;
+
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    zassert_ok(pouch_sender_open(&sender, &bearer));
+
+    struct pouch_sar_rx_pkt ack = {
+        .code = POUCH_RECEIVER_CODE_ACK,
+        .seq = 0xff,
+        .window = 4,
+    };
+    uint8_t buf[POUCH_SAR_RX_PKT_LEN];
+    pouch_sar_rx_pkt_encode(&ack, buf);
+
+    test_endpoint.available_data = 10 * (bearer.maxlen - 2);
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_DATA_REQ);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+
+    zassert_ok(pouch_sender_recv(&sender, buf, sizeof(buf)));
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 4);
+
+    // ack the first three packets, moving the window:
+    ack.seq = 2;
+    pouch_sar_rx_pkt_encode(&ack, buf);
+    zassert_ok(pouch_sender_recv(&sender, buf, sizeof(buf)));
+    zassert_equal(test_endpoint.acked_data, 3 * (bearer.maxlen - 2));
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 7);
+
+    // a delayed ack from before the last one is ignored, even if its window is still valid:
+    ack.seq = 1;
+    ack.window = 6;
+    pouch_sar_rx_pkt_encode(&ack, buf);
+    zassert_ok(pouch_sender_recv(&sender, buf, sizeof(buf)));
+    zassert_equal(test_endpoint.acked_data, 3 * (bearer.maxlen - 2));
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 7);
+}
+
+ZTEST(transport_sar_sender, test_recv_reordered_ack)
+{
+    sender.endpoint = &endpoint_with_ack;
+
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    zassert_ok(pouch_sender_open(&sender, &bearer));
+
+    struct pouch_sar_rx_pkt ack = {
+        .code = POUCH_RECEIVER_CODE_ACK,
+        .seq = 0xff,
+        .window = 4,
+    };
+    uint8_t buf[POUCH_SAR_RX_PKT_LEN];
+    pouch_sar_rx_pkt_encode(&ack, buf);
+
+    test_endpoint.available_data = 10 * (bearer.maxlen - 2);
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_DATA_REQ);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+
+    zassert_ok(pouch_sender_recv(&sender, buf, sizeof(buf)));
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 4);
+
+    // the receiver acks the first two packets, then the third, with the same window:
+    uint8_t first[POUCH_SAR_RX_PKT_LEN];
+    ack.seq = 1;
+    pouch_sar_rx_pkt_encode(&ack, first);
+
+    uint8_t second[POUCH_SAR_RX_PKT_LEN];
+    ack.seq = 2;
+    pouch_sar_rx_pkt_encode(&ack, second);
+
+    // the acks arrive out of order. The first one to arrive moves the window:
+    zassert_ok(pouch_sender_recv(&sender, second, sizeof(second)));
+    zassert_equal(test_endpoint.acked_data, 3 * (bearer.maxlen - 2));
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 7);
+
+    // the late one would move the window back, but it's ignored instead of ending the transfer:
+    zassert_ok(pouch_sender_recv(&sender, first, sizeof(first)));
+    zassert_false(atomic_test_bit(&test_bearer.flags, BEARER_CLOSED));
+    zassert_equal(test_endpoint.acked_data, 3 * (bearer.maxlen - 2));
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 7);
+
+    // the transfer carries on:
+    ack.seq = 3;
+    pouch_sar_rx_pkt_encode(&ack, buf);
+    zassert_ok(pouch_sender_recv(&sender, buf, sizeof(buf)));
+    zassert_equal(test_endpoint.acked_data, 4 * (bearer.maxlen - 2));
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 8);
+}
+
 ZTEST(transport_sar_sender, test_recv_ack_out_of_order)
 {
     atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
@@ -598,6 +800,139 @@ ZTEST(transport_sar_sender, test_bearer_send_packet_fails)
     zassert_not_equal(sender.window, 0);
 }
 
+ZTEST(transport_sar_sender, test_endpoint_error)
+{
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    zassert_ok(pouch_sender_open(&sender, &bearer));
+
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_DATA_REQ);
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_FAILED);
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_END);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_CLOSE);
+
+    struct pouch_sar_rx_pkt ack = {
+        .code = POUCH_RECEIVER_CODE_ACK,
+        .seq = POUCH_SAR_SEQ_MAX,
+        .window = 3,
+    };
+    uint8_t buf[POUCH_SAR_RX_PKT_LEN];
+    pouch_sar_rx_pkt_encode(&ack, buf);
+
+    zassert_ok(pouch_sender_recv(&sender, buf, sizeof(buf)));
+
+    // The transfer is ended before the bearer is closed:
+    zassert_equal(atomic_get(&test_endpoint.send_calls), 1);
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 0);
+    zassert_true(atomic_test_bit(&test_endpoint.flags, ENDPOINT_ENDED));
+    zassert_true(atomic_test_bit(&test_bearer.flags, BEARER_CLOSED));
+    zassert_is_null(sender.bearer);
+
+    // Closing the ended sender doesn't end it again:
+    pouch_sender_close(&sender);
+}
+
+ZTEST(transport_sar_sender, test_bearer_busy)
+{
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    zassert_ok(pouch_sender_open(&sender, &bearer));
+
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_DATA_REQ);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+    test_endpoint.available_data = 3 * (bearer.maxlen - 2);
+
+    // The bearer can't take the first packet:
+    atomic_set_bit(&test_bearer.flags, BEARER_BUSY_ONCE);
+
+    struct pouch_sar_rx_pkt ack = {
+        .code = POUCH_RECEIVER_CODE_ACK,
+        .seq = POUCH_SAR_SEQ_MAX,
+        .window = 4,
+    };
+    uint8_t buf[POUCH_SAR_RX_PKT_LEN];
+    pouch_sar_rx_pkt_encode(&ack, buf);
+
+    zassert_ok(pouch_sender_recv(&sender, buf, sizeof(buf)));
+    zassert_equal(atomic_get(&test_endpoint.send_calls), 1);
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 0);
+
+    // The bearer calls ready when it can take more packets, and the packet is sent without losing
+    // any data:
+    pouch_sender_ready(&sender);
+    zassert_equal(atomic_get(&test_endpoint.send_calls), 4);
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 3);
+    zassert_equal(test_bearer.sent_data, 3 * (bearer.maxlen - 2), "got %u", test_bearer.sent_data);
+}
+
+ZTEST(transport_sar_sender, test_bearer_sendv)
+{
+    bearer.sendv = bearer_sendv;
+
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    zassert_ok(pouch_sender_open(&sender, &bearer));
+
+    struct pouch_sar_rx_pkt ack = {
+        .code = POUCH_RECEIVER_CODE_ACK,
+        .seq = POUCH_SAR_SEQ_MAX,
+        .window = 4,
+    };
+    uint8_t buf[POUCH_SAR_RX_PKT_LEN];
+    pouch_sar_rx_pkt_encode(&ack, buf);
+
+    test_endpoint.available_data = 10 * (bearer.maxlen - 2);
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_DATA_REQ);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+
+    // The whole window goes out in a single bearer write:
+    zassert_ok(pouch_sender_recv(&sender, buf, sizeof(buf)));
+    zassert_equal(atomic_get(&test_endpoint.send_calls), 4);
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 4);
+    zassert_equal(atomic_get(&test_bearer.sendv_calls), 1);
+    zassert_equal(test_bearer.sent_data, 4 * (bearer.maxlen - 2), "got %u", test_bearer.sent_data);
+
+    // The batch never exceeds the room in the window:
+    ack.seq = 0;
+    pouch_sar_rx_pkt_encode(&ack, buf);
+    zassert_ok(pouch_sender_recv(&sender, buf, sizeof(buf)));
+    zassert_equal(atomic_get(&test_endpoint.send_calls), 5);
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 5);
+    zassert_equal(atomic_get(&test_bearer.sendv_calls), 2);
+}
+
+ZTEST(transport_sar_sender, test_bearer_sendv_partial)
+{
+    bearer.sendv = bearer_sendv;
+
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    zassert_ok(pouch_sender_open(&sender, &bearer));
+
+    struct pouch_sar_rx_pkt ack = {
+        .code = POUCH_RECEIVER_CODE_ACK,
+        .seq = POUCH_SAR_SEQ_MAX,
+        .window = 4,
+    };
+    uint8_t buf[POUCH_SAR_RX_PKT_LEN];
+    pouch_sar_rx_pkt_encode(&ack, buf);
+
+    test_endpoint.available_data = 10 * (bearer.maxlen - 2);
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_DATA_REQ);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+
+    // The bearer only takes half of the batch, then reports busy:
+    test_bearer.sendv_accept = 2;
+
+    zassert_ok(pouch_sender_recv(&sender, buf, sizeof(buf)));
+    zassert_equal(atomic_get(&test_endpoint.send_calls), 4);
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 2);
+    zassert_equal(sender.seq, 2);
+
+    // The remaining packets are sent in order once the bearer is ready, without pulling more data:
+    pouch_sender_ready(&sender);
+    zassert_equal(atomic_get(&test_endpoint.send_calls), 4);
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 4);
+    zassert_equal(test_bearer.sent_data, 4 * (bearer.maxlen - 2), "got %u", test_bearer.sent_data);
+}
+
 ZTEST(transport_sar_sender, test_double_close)
 {
     atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
@@ -655,3 +990,185 @@ ZTEST(transport_sar_sender, test_recv_after_close)
     zassert_equal(sender.bearer, NULL);
     zassert_equal(sender.buf, NULL);
 }
+
+#if CONFIG_POUCH_TRANSPORT_SAR_RETRANSMIT
+
+static void recv_ack(uint8_t seq, uint8_t window)
+{
+    const struct pouch_sar_rx_pkt ack = {
+        .code = POUCH_RECEIVER_CODE_ACK,
+        .seq = seq,
+        .window = window,
+    };
+    uint8_t buf[POUCH_SAR_RX_PKT_LEN];
+    pouch_sar_rx_pkt_encode(&ack, buf);
+
+    zassert_ok(pouch_sender_recv(&sender, buf, sizeof(buf)));
+}
+
+ZTEST(transport_sar_sender, test_retransmit_timeout)
+{
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    zassert_ok(pouch_sender_open(&sender, &bearer));
+
+    test_endpoint.available_data = 2 * (bearer.maxlen - 2);
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_DATA_REQ);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_RETRANSMIT);
+
+    recv_ack(0xff, 4);
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 2);
+
+    // No ack: both packets are sent again
+    k_sleep(K_MSEC(CONFIG_POUCH_TRANSPORT_SAR_RTO_INITIAL_MS + 50));
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 4);
+    zassert_equal(test_bearer.last_seq, 1);
+
+    // Once everything is acked, nothing is retransmitted
+    recv_ack(1, 4);
+    k_sleep(K_MSEC(CONFIG_POUCH_TRANSPORT_SAR_RTO_MAX_MS + 50));
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 4);
+}
+
+ZTEST(transport_sar_sender, test_retransmit_bearer_busy)
+{
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    zassert_ok(pouch_sender_open(&sender, &bearer));
+
+    test_endpoint.available_data = 2 * (bearer.maxlen - 2);
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_DATA_REQ);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_RETRANSMIT);
+
+    recv_ack(0xff, 4);
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 2);
+
+    // The bearer can't take the retransmitted packets when the timer expires:
+    atomic_set_bit(&test_bearer.flags, BEARER_BUSY_ONCE);
+    k_sleep(K_MSEC(CONFIG_POUCH_TRANSPORT_SAR_RTO_INITIAL_MS + 50));
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 2);
+
+    // The retransmission resumes once the bearer is ready:
+    pouch_sender_ready(&sender);
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 4);
+    zassert_equal(test_bearer.last_seq, 1);
+
+    recv_ack(1, 4);
+}
+
+ZTEST(transport_sar_sender, test_retransmit_duplicate_acks)
+{
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    zassert_ok(pouch_sender_open(&sender, &bearer));
+
+    test_endpoint.available_data = 3 * (bearer.maxlen - 2);
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_DATA_REQ);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_RETRANSMIT);
+
+    recv_ack(0xff, 4);
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 3);
+
+    // Packet 1 is lost, and the receiver acks packet 0 for every packet after it:
+    recv_ack(0, 4);
+    recv_ack(0, 4);
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 3);
+
+    // Go back to packet 1 on the second duplicate ack:
+    recv_ack(0, 4);
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 5);
+    zassert_equal(test_bearer.last_seq, 2);
+}
+
+ZTEST(transport_sar_sender, test_retransmit_gives_up)
+{
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    zassert_ok(pouch_sender_open(&sender, &bearer));
+
+    test_endpoint.available_data = bearer.maxlen - 2;
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_DATA_REQ);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_RETRANSMIT);
+
+    recv_ack(0xff, 4);
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 1);
+
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_END);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_CLOSE);
+
+    // Retransmission timeouts back off until they reach the maximum:
+    k_sleep(K_MSEC((CONFIG_POUCH_TRANSPORT_SAR_MAX_RETRIES + 1)
+                       * CONFIG_POUCH_TRANSPORT_SAR_RTO_MAX_MS
+                   + 100));
+
+    zassert_equal(atomic_get(&test_bearer.sent_packets),
+                  1 + CONFIG_POUCH_TRANSPORT_SAR_MAX_RETRIES);
+    zassert_true(atomic_test_bit(&test_bearer.flags, BEARER_CLOSED));
+    zassert_true(atomic_test_bit(&test_endpoint.flags, ENDPOINT_ENDED));
+}
+
+#endif
+
+#if CONFIG_POUCH_TRANSPORT_SAR_EXT
+
+ZTEST(transport_sar_sender, test_ext_window)
+{
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    zassert_ok(pouch_sender_open(&sender, &bearer));
+
+    // The receiver asks for extended packets in its first ack, with a window beyond the basic
+    // sequence space:
+    const struct pouch_sar_rx_pkt ack = {
+        .code = POUCH_RECEIVER_CODE_ACK,
+        .seq = POUCH_SAR_EXT_SEQ_MAX,
+        .window = 200,
+        .ext = true,
+    };
+    uint8_t buf[POUCH_SAR_RX_PKT_EXT_LEN];
+    size_t len = pouch_sar_rx_pkt_encode(&ack, buf);
+    zassert_equal(len, POUCH_SAR_RX_PKT_EXT_LEN);
+
+    test_endpoint.available_data = 100000;
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_DATA_REQ);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+
+    zassert_ok(pouch_sender_recv(&sender, buf, len));
+    zassert_true(atomic_test_bit(&test_bearer.flags, BEARER_SENT_EXT));
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 200);
+    zassert_equal(test_bearer.sent_data,
+                  200 * (bearer.maxlen - POUCH_SAR_TX_PKT_EXT_HEADER_LEN),
+                  "got %u",
+                  test_bearer.sent_data);
+}
+
+ZTEST(transport_sar_sender, test_ext_ack_after_start)
+{
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_START);
+    zassert_ok(pouch_sender_open(&sender, &bearer));
+
+    struct pouch_sar_rx_pkt ack = {
+        .code = POUCH_RECEIVER_CODE_ACK,
+        .seq = POUCH_SAR_SEQ_MAX,
+        .window = 4,
+    };
+    uint8_t buf[POUCH_SAR_RX_PKT_EXT_LEN];
+    size_t len = pouch_sar_rx_pkt_encode(&ack, buf);
+
+    test_endpoint.available_data = 100;
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_DATA_REQ);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_SEND);
+    zassert_ok(pouch_sender_recv(&sender, buf, len));
+    zassert_equal(atomic_get(&test_bearer.sent_packets), 4);
+
+    // The packet format can't change once the transfer has started:
+    ack.seq = 3;
+    ack.ext = true;
+    len = pouch_sar_rx_pkt_encode(&ack, buf);
+
+    atomic_set_bit(&test_endpoint.flags, ENDPOINT_EXPECT_END);
+    atomic_set_bit(&test_bearer.flags, BEARER_EXPECT_CLOSE);
+    zassert_not_ok(pouch_sender_recv(&sender, buf, len));
+    zassert_true(atomic_test_bit(&test_bearer.flags, BEARER_CLOSED));
+}
+
+#endif
@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2026 Golioth, Inc.
+ */
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/net/net_ip.h>
+#include <zephyr/net/socket.h>
+#include <string.h>
+
+#include <pouch/pouch.h>
+#include <pouch/gateway/udp.h>
+#include <pouch/transport/udp.h>
+
+#include "session.h"
+#include "transport/sar/packet.h"
+
+#define SYNC_TIMEOUT K_SECONDS(1)
+#define NO_SYNC_TIMEOUT K_MSEC(200)
+
+/** Devices simulated by the test, on top of the one on the UDP transport */
+#define DEVICES 3
+
+static const struct pouch_config pouch_config = {
+    .device_id = "test-device-id",
+};
+
+/** Packet passed to a session by the broker */
+struct received
+{
+    struct pouch_mux_session *session;
+    uint8_t channel;
+    uint8_t data[128];
+    size_t len;
+};
+
+K_MSGQ_DEFINE(started, sizeof(struct pouch_mux_session *), 8, sizeof(void *));
+K_MSGQ_DEFINE(ended, sizeof(uint16_t), 8, sizeof(uint16_t));
+K_MSGQ_DEFINE(packets, sizeof(struct received), 8, sizeof(void *));
+
+static struct pouch_mux_session *sessions[CONFIG_POUCH_GATEWAY_UDP_MAX_SESSIONS];
+static size_t session_count;
+static atomic_t abort_count;
+static int devices[DEVICES];
+
+/*
+ * The broker's mux sessions, replaced by the test. The sessions are started, aborted and
+ * receive packets on the broker's RX thread.
+ */
+
+void pouch_mux_session_init(struct pouch_mux_session *session,
+                            struct pouch_mux_link *link,
+                            pouch_mux_session_end_t end)
+{
+    zassert_true(session_count < ARRAY_SIZE(sessions));
+
+    session->link = link;
+    session->end = end;
+    session->active = false;
+    sessions[session_count++] = session;
+}
+
+int pouch_mux_session_start(struct pouch_mux_session *session)
+{
+    if (session->active)
+    {
+        return -EBUSY;
+    }
+
+    session->active = true;
+    zassert_ok(k_msgq_put(&started, &session, K_NO_WAIT));
+
+    return 0;
+}
+
+void pouch_mux_session_abort(struct pouch_mux_session *session)
+{
+    if (!session->active)
+    {
+        return;
+    }
+
+    atomic_inc(&abort_count);
+    session->active = false;
+    session->end(session);
+}
+
+void pouch_mux_session_recv(struct pouch_mux_session *session,
+                            uint8_t channel,
+                            uint8_t *packet,
+                            size_t len)
+{
+    struct received r = {
+        .session = session,
+        .channel = channel,
+        .len = len,
+    };
+
+    memcpy(r.data, packet, MIN(len, sizeof(r.data)));
+    zassert_ok(k_msgq_put(&packets, &r, K_NO_WAIT));
+}
+
+static void session_ended(const struct sockaddr *peer)
+{
+    uint16_t port = ntohs(net_sin(peer)->sin_port);
+
+    zassert_ok(k_msgq_put(&ended, &port, K_NO_WAIT));
+}
+
+/** Open a socket for a simulated device, connected to the broker */
+static int device_open(size_t i)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(CONFIG_POUCH_UDP_PORT),
+    };
+
+    zassert_equal(zsock_inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr), 1);
+
+    int sock = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    zassert_true(sock >= 0, "Failed to create socket: %d", errno);
+    zassert_ok(zsock_connect(sock, (struct sockaddr *) &addr, sizeof(addr)));
+
+    devices[i] = sock;
+    return sock;
+}
+
+static uint16_t device_port(int sock)
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+
+    zassert_ok(zsock_getsockname(sock, (struct sockaddr *) &addr, &addr_len));
+
+    return ntohs(addr.sin_port);
+}
+
+static void device_send(int sock, const uint8_t *datagram, size_t len)
+{
+    zassert_equal(zsock_send(sock, datagram, len, 0), (ssize_t) len);
+}
+
+static void device_sync(int sock)
+{
+    static const uint8_t sync[] = {POUCH_MUX_CONTROL, POUCH_MUX_CMD_SYNC};
+
+    device_send(sock, sync, sizeof(sync));
+}
+
+static struct pouch_mux_session *assert_started(void)
+{
+    struct pouch_mux_session *session;
+
+    zassert_ok(k_msgq_get(&started, &session, SYNC_TIMEOUT), "No session started");
+    zassert_true(session->active);
+
+    return session;
+}
+
+static void assert_not_started(void)
+{
+    struct pouch_mux_session *session;
+
+    zassert_equal(k_msgq_get(&started, &session, NO_SYNC_TIMEOUT), -EAGAIN);
+}
+
+static void assert_received(struct pouch_mux_session *session,
+                            uint8_t channel,
+                            struct received *r)
+{
+    zassert_ok(k_msgq_get(&packets, r, SYNC_TIMEOUT), "Nothing received");
+    zassert_equal_ptr(r->session, session);
+    zassert_equal(r->channel, channel);
+}
+
+static void assert_ended(uint16_t port)
+{
+    uint16_t ended_port;
+
+    zassert_ok(k_msgq_get(&ended, &ended_port, SYNC_TIMEOUT), "No session ended");
+    zassert_equal(ended_port, port);
+}
+
+static void *suite_setup(void)
+{
+    zassert_ok(pouch_init(&pouch_config));
+    zassert_ok(pouch_gateway_udp_start(session_ended));
+
+    return NULL;
+}
+
+static void before(void *f)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(devices); i++)
+    {
+        devices[i] = -1;
+    }
+
+    atomic_clear(&abort_count);
+}
+
+static void after(void *f)
+{
+    // End the sessions the test left running, so their slots are free for the next one:
+    for (size_t i = 0; i < session_count; i++)
+    {
+        pouch_mux_session_abort(sessions[i]);
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(devices); i++)
+    {
+        if (devices[i] >= 0)
+        {
+            zsock_close(devices[i]);
+        }
+    }
+
+    k_msgq_purge(&started);
+    k_msgq_purge(&ended);
+    k_msgq_purge(&packets);
+}
+
+ZTEST(udp, test_transport_sync)
+{
+    zassert_ok(pouch_udp_start());
+
+    struct pouch_mux_session *session = assert_started();
+
+    // Open the device's info channel, and let it send its first packets:
+    struct pouch_sar_rx_pkt ack = {
+        .code = POUCH_RECEIVER_CODE_ACK,
+        .seq = POUCH_SAR_SEQ_MAX,
+        .window = 4,
+    };
+    uint8_t buf[POUCH_SAR_RX_PKT_LEN];
+    size_t len = pouch_sar_rx_pkt_encode(&ack, buf);
+
+    zassert_ok(pouch_mux_control(session->link, POUCH_MUX_CHANNEL_INFO, POUCH_MUX_CMD_OPEN));
+    zassert_ok(session->link->send(session->link, POUCH_MUX_CHANNEL_INFO, buf, len, K_NO_WAIT));
+
+    struct received r;
+    assert_received(session, POUCH_MUX_CHANNEL_INFO, &r);
+
+    struct pouch_sar_tx_pkt pkt;
+    zassert_true(r.len <= sizeof(r.data));
+    zassert_ok(pouch_sar_tx_pkt_decode(r.data, r.len, &pkt));
+    zassert_equal(pkt.seq, 0);
+    zassert_true(pkt.flags & POUCH_SAR_TX_PKT_FLAG_FIRST);
+}
+
+ZTEST(udp, test_transport_resync)
+{
+    zassert_ok(pouch_udp_start());
+    struct pouch_mux_session *session = assert_started();
+
+    // The device started over, so the session in progress is replaced:
+    zassert_ok(pouch_udp_start());
+    zassert_equal_ptr(assert_started(), session);
+    zassert_equal(atomic_get(&abort_count), 1);
+    zassert_equal(k_msgq_num_used_get(&ended), 1);
+}
+
+ZTEST(udp, test_recv)
+{
+    static const uint8_t packet[] = {POUCH_MUX_CHANNEL_UPLINK, 1, 2, 3};
+
+    int a = device_open(0);
+    int b = device_open(1);
+
+    device_sync(a);
+    struct pouch_mux_session *session = assert_started();
+
+    device_send(a, packet, sizeof(packet));
+
+    struct received r;
+    assert_received(session, POUCH_MUX_CHANNEL_UPLINK, &r);
+    zassert_equal(r.len, sizeof(packet) - 1);
+    zassert_mem_equal(r.data, &packet[1], r.len);
+
+    // Devices without a session are ignored:
+    device_send(b, packet, sizeof(packet));
+    zassert_equal(k_msgq_get(&packets, &r, NO_SYNC_TIMEOUT), -EAGAIN);
+}
+
+ZTEST(udp, test_sessions)
+{
+    BUILD_ASSERT(CONFIG_POUCH_GATEWAY_UDP_MAX_SESSIONS == 2);
+
+    int a = device_open(0);
+    int b = device_open(1);
+    int c = device_open(2);
+
+    device_sync(a);
+    struct pouch_mux_session *session_a = assert_started();
+    device_sync(b);
+    struct pouch_mux_session *session_b = assert_started();
+    zassert_not_equal(session_a, session_b);
+
+    // Out of sessions:
+    device_sync(c);
+    assert_not_started();
+
+    // Ending a session frees it up for the next device:
+    pouch_mux_session_abort(session_a);
+    assert_ended(device_port(a));
+
+    device_sync(c);
+    zassert_equal_ptr(assert_started(), session_a);
+
+    // The session of the other device was left alone:
+    zassert_true(session_b->active);
+    zassert_equal(k_msgq_num_used_get(&ended), 0);
+}
+
+ZTEST(udp, test_resync)
+{
+    int a = device_open(0);
+
+    device_sync(a);
+    struct pouch_mux_session *session = assert_started();
+
+    device_sync(a);
+    zassert_equal_ptr(assert_started(), session);
+    zassert_equal(atomic_get(&abort_count), 1);
+    assert_ended(device_port(a));
+}
+
+ZTEST(udp, test_send_too_long)
+{
+    static uint8_t packet[CONFIG_POUCH_UDP_MTU + 1];
+
+    int a = device_open(0);
+
+    device_sync(a);
+    struct pouch_mux_session *session = assert_started();
+
+    zassert_equal(session->link->send(session->link,
+                                      POUCH_MUX_CHANNEL_DOWNLINK,
+                                      packet,
+                                      sizeof(packet),
+                                      K_NO_WAIT),
+                  -EMSGSIZE);
+}
+
+ZTEST_SUITE(udp, NULL, suite_setup, before, after, NULL);
@@ -31,6 +31,7 @@ K_SEM_DEFINE(write_done, 0, UINT16_MAX);
 static size_t write_data_len;
 static bool write_data_expect_fail;
 static bool uplink_handler_enabled;
+static bool uplink_hold_enabled;
 
 static void write_to_uplink(struct k_work *work)
 {
@@ -90,6 +91,12 @@ static void uplink_handler(void)
         // disabled by default:
         uplink_handler_enabled = false;
     }
+
+    if (uplink_hold_enabled)
+    {
+        zassert_ok(pouch_uplink_hold());
+        uplink_hold_enabled = false;
+    }
 }
 POUCH_UPLINK_HANDLER(uplink_handler);
 
@@ -312,6 +319,69 @@ ZTEST(uplink, test_submit_after_close)
     zassert_mem_equal(&buf[42 - sizeof(data2)], data2, sizeof(data2));
 }
 
+ZTEST(uplink, test_hold)
+{
+    const char *path = "test/path";
+    const uint8_t data[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+
+    uplink_hold_enabled = true;
+    transport_session_start();
+
+    // let uplink handler and processing run:
+    k_sleep(K_MSEC(1));
+
+    // the hold keeps the pouch open after the uplink handlers:
+    zassert_ok(pouch_uplink_entry_write(path,
+                                        POUCH_CONTENT_TYPE_OCTET_STREAM,
+                                        data,
+                                        sizeof(data),
+                                        POUCH_FOREVER));
+
+    // let processing run:
+    k_sleep(K_MSEC(1));
+
+    uint8_t buf[CONFIG_POUCH_BLOCK_SIZE];
+    size_t len = sizeof(buf);
+    enum pouch_result result = transport_pull_data(buf, &len);
+    zassert_equal(len, 42);
+    zassert_mem_equal(&buf[42 - sizeof(data)], data, sizeof(data));
+    zassert_equal(result, POUCH_MORE_DATA, "expected POUCH_MORE_DATA, got %d", result);
+
+    pouch_uplink_release();
+
+    // let processing run:
+    k_sleep(K_MSEC(1));
+
+    len = sizeof(buf);
+    result = transport_pull_data(buf, &len);
+    zassert_equal(len, 0);
+    zassert_equal(result, POUCH_NO_MORE_DATA, "expected POUCH_NO_MORE_DATA, got %d", result);
+}
+
+ZTEST(uplink, test_hold_timeout)
+{
+    uplink_hold_enabled = true;
+    transport_session_start();
+
+    // let uplink handler and processing run:
+    k_sleep(K_MSEC(1));
+
+    uint8_t buf[CONFIG_POUCH_BLOCK_SIZE];
+    size_t len = sizeof(buf);
+    enum pouch_result result = transport_pull_data(buf, &len);
+    zassert_equal(result, POUCH_MORE_DATA, "expected POUCH_MORE_DATA, got %d", result);
+
+    // the pouch is closed without a release once the timeout expires:
+    k_sleep(K_MSEC(CONFIG_POUCH_UPLINK_HOLD_TIMEOUT_MS + 10));
+
+    len = sizeof(buf);
+    result = transport_pull_data(buf, &len);
+    zassert_equal(result, POUCH_NO_MORE_DATA, "expected POUCH_NO_MORE_DATA, got %d", result);
+
+    // releasing after the timeout is harmless:
+    pouch_uplink_release();
+}
+
 ZTEST(uplink, test_multithread_writer)
 {
     // Block the uplink handler from finishing and closing up the pouch:
@@ -767,3 +837,134 @@ ZTEST(uplink, test_stream_length_aligned_to_block_size)
                   blockbuf - start_of_blocks,
                   len);
 }
+
+#if CONFIG_POUCH_UPLINK_RESUME
+
+/**
+ * Send a pouch with two blocks, and interrupt the session after the first one was delivered.
+ *
+ * @return Length of the unconfirmed data, which starts at @p unconfirmed.
+ */
+static size_t interrupt_pouch(uint8_t **unconfirmed)
+{
+    struct pouch_uplink *session = pouch_uplink_start();
+    zassert_not_null(session);
+
+    struct pouch_stream *stream =
+        pouch_uplink_stream_open("test/path", POUCH_CONTENT_TYPE_OCTET_STREAM, K_FOREVER);
+    zassert_not_null(stream, "Failed to open stream");
+
+    // write more data than a single block can hold:
+    uint8_t data[CONFIG_POUCH_BLOCK_SIZE + 50];
+    for (int i = 0; i < sizeof(data); i++)
+    {
+        data[i] = i & 0xff;  // dummy data
+    }
+
+    size_t written = pouch_stream_write(stream, (void *) data, sizeof(data), POUCH_NO_WAIT);
+    zassert_equal(written, sizeof(data), "Unexpected write length %d", written);
+
+    zassert_ok(pouch_stream_close(stream, POUCH_NO_WAIT));
+
+    // let processing run:
+    k_sleep(K_MSEC(1));
+
+    static uint8_t sent[CONFIG_POUCH_BLOCK_SIZE + 200];
+    size_t sent_len = sizeof(sent);
+    enum pouch_result result = pouch_uplink_fill(session, sent, &sent_len);
+    zassert_equal(result, POUCH_NO_MORE_DATA, "Unexpected result %d", result);
+
+    size_t len = sent_len;
+    uint8_t *second_block = skip_pouch_header(sent, &len);
+    struct block first_block;
+    pull_block(&second_block, &first_block);
+
+    // The session is interrupted after the header and the first block were delivered:
+    pouch_uplink_confirm(session, second_block - sent);
+    pouch_uplink_finish(session);
+
+    *unconfirmed = second_block;
+    return sent_len - (second_block - sent);
+}
+
+ZTEST(uplink, test_resume_interrupted)
+{
+    uint8_t *second_block;
+    size_t remaining = interrupt_pouch(&second_block);
+
+    struct pouch_uplink *session = pouch_uplink_start();
+    zassert_not_null(session);
+
+    // let processing run:
+    k_sleep(K_MSEC(1));
+
+    static uint8_t resumed[CONFIG_POUCH_BLOCK_SIZE + 200];
+    size_t len = sizeof(resumed);
+    enum pouch_result result = pouch_uplink_fill(session, resumed, &len);
+    zassert_not_equal(result, POUCH_ERROR, "Unexpected result %d", result);
+
+    // The resumed pouch only contains the unconfirmed block:
+    uint8_t *block = skip_pouch_header(resumed, &len);
+    zassert_equal(len, remaining, "Unexpected length %d", len);
+    zassert_mem_equal(block, second_block, remaining, "Unexpected block");
+
+    pouch_uplink_confirm(session, SIZE_MAX);
+    pouch_uplink_finish(session);
+}
+
+ZTEST(uplink, test_resume_no_new_entries)
+{
+    const uint8_t data[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+    uint8_t *second_block;
+    size_t remaining = interrupt_pouch(&second_block);
+
+    uplink_handler_enabled = true;
+
+    struct pouch_uplink *session = pouch_uplink_start();
+    zassert_not_null(session);
+
+    // The uplink handlers already ran for this pouch:
+    k_sleep(K_MSEC(1));
+    zassert_true(uplink_handler_enabled);
+    uplink_handler_enabled = false;
+
+    zassert_ok(pouch_uplink_entry_write("test/path",
+                                        POUCH_CONTENT_TYPE_OCTET_STREAM,
+                                        data,
+                                        sizeof(data),
+                                        POUCH_FOREVER));
+
+    // let processing run:
+    k_sleep(K_MSEC(1));
+
+    // The resumed pouch ends after the unconfirmed block:
+    static uint8_t resumed[CONFIG_POUCH_BLOCK_SIZE + 200];
+    size_t len = sizeof(resumed);
+    enum pouch_result result = pouch_uplink_fill(session, resumed, &len);
+    zassert_equal(result, POUCH_NO_MORE_DATA, "Unexpected result %d", result);
+
+    skip_pouch_header(resumed, &len);
+    zassert_equal(len, remaining, "Unexpected length %d", len);
+
+    pouch_uplink_confirm(session, SIZE_MAX);
+    pouch_uplink_finish(session);
+
+    // The entry goes in the next pouch:
+    session = pouch_uplink_start();
+    zassert_not_null(session);
+
+    // let processing run:
+    k_sleep(K_MSEC(1));
+
+    static uint8_t next[CONFIG_POUCH_BLOCK_SIZE + 200];
+    len = sizeof(next);
+    result = pouch_uplink_fill(session, next, &len);
+    zassert_equal(result, POUCH_NO_MORE_DATA, "Unexpected result %d", result);
+    zassert_equal(len, 42, "Unexpected length %d", len);
+    zassert_mem_equal(&next[42 - sizeof(data)], data, sizeof(data));
+
+    pouch_uplink_confirm(session, SIZE_MAX);
+    pouch_uplink_finish(session);
+}
+
+#endif /* CONFIG_POUCH_UPLINK_RESUME */